@@ -125,6 +125,7 @@ type
             m_Gesture:          Integer;
             m_AnimCached:       Boolean;
             m_Cached:           Boolean;
+            m_InterpolatedMesh: TQRMesh;
 
             {**
              Configures OpenGL
@@ -1074,7 +1075,6 @@ procedure TMainForm.OnDrawModelItem(const pGroup: TQRModelGroup;
                           const pMesh, pNextMesh: PQRMesh;
                   const pAABBTree, pNextAABBTree: TQRAABBTree);
 var
-    mesh:            TQRMesh;
     pNextMeshToDraw: PQRMesh;
 begin
     if (not Assigned(pModel)) then
@@ -1105,10 +1105,13 @@ begin
     else
     begin
         // get next frame to draw
-        TQRModelHelper.Interpolate(interpolationFactor, pMesh^, pNextMeshToDraw^, mesh);
+        TQRModelHelper.InterpolateTo(interpolationFactor,
+                                     pMesh^,
+                                     pNextMeshToDraw^,
+                                     m_InterpolatedMesh);
 
         // draw mesh
-        TQROpenGLHelper.Draw(mesh, matrix, textures);
+        TQROpenGLHelper.Draw(m_InterpolatedMesh, matrix, textures);
     end;
 
     DetectAndDrawCollisions(matrix, pAABBTree);
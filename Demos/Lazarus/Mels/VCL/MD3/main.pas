@@ -123,6 +123,7 @@ type
             m_CurLegsGesture:   Integer;
             m_AnimCached:       Boolean;
             m_Cached:           Boolean;
+            m_InterpolatedMesh: TQRMesh;
 
             {**
              Configures OpenGL
@@ -1108,7 +1109,6 @@ procedure TMainForm.OnDrawModelItem(const pGroup: TQRModelGroup;
                           const pMesh, pNextMesh: PQRMesh;
                   const pAABBTree, pNextAABBTree: TQRAABBTree);
 var
-    mesh:            TQRMesh;
     pNextMeshToDraw: PQRMesh;
 begin
     if (not Assigned(pModel)) then
@@ -1139,10 +1139,13 @@ begin
     else
     begin
         // get next frame to draw
-        TQRModelHelper.Interpolate(interpolationFactor, pMesh^, pNextMeshToDraw^, mesh);
+        TQRModelHelper.InterpolateTo(interpolationFactor,
+                                     pMesh^,
+                                     pNextMeshToDraw^,
+                                     m_InterpolatedMesh);
 
         // draw mesh
-        TQROpenGLHelper.Draw(mesh, matrix, textures);
+        TQROpenGLHelper.Draw(m_InterpolatedMesh, matrix, textures);
     end;
 
     DetectAndDrawCollisions(matrix, pAABBTree);
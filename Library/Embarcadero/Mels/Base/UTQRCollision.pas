@@ -29,7 +29,9 @@ unit UTQRCollision;
 
 interface
 
-uses System.Math,
+uses System.Classes,
+     System.SyncObjs,
+     System.Math,
      UTQRCommon,
      UTQRGeometry,
      UTQR3D;
@@ -42,571 +44,4507 @@ const
     {$ENDREGION}
     QR_Epsilon = 1.0E-3;
 
+    {$REGION 'Documentation'}
+    {**
+     Bin count used on each axis to evaluate the surface area heuristic split candidates
+    }
+    {$ENDREGION}
+    QR_SAH_Bin_Count = 16;
+
+    {$REGION 'Documentation'}
+    {**
+     Cost of a node traversal, relatively to the cost of a polygon intersection test, used by the
+     surface area heuristic
+    }
+    {$ENDREGION}
+    QR_SAH_Traversal_Cost = 1.0;
+
+    {$REGION 'Documentation'}
+    {**
+     Polygon count below which the surface area heuristic may decide to keep a node as a leaf
+    }
+    {$ENDREGION}
+    QR_SAH_Max_Leaf_Polygons = 8;
+
+    {$REGION 'Documentation'}
+    {**
+     Maximum aligned-axis bounding box tree depth. Deeper nodes are kept as leaves, in order to
+     allow the tree to be traversed using a fixed size stack
+    }
+    {$ENDREGION}
+    QR_AABB_Max_Depth = 64;
+
+    {$REGION 'Documentation'}
+    {**
+     Polygon count from which an aligned-axis bounding box tree is built on several threads
+    }
+    {$ENDREGION}
+    QR_AABB_Parallel_Min_Polygons = 4096;
+
+    {$REGION 'Documentation'}
+    {**
+     Subtree build task count created for each thread while a tree is built on several threads.
+     More tasks than threads are created, in order to balance the thread workload
+    }
+    {$ENDREGION}
+    QR_AABB_Tasks_Per_Thread = 4;
+
+    {$REGION 'Documentation'}
+    {**
+     Determinant threshold below which a ray is considered as parallel to a triangle
+    }
+    {$ENDREGION}
+    QR_Ray_Triangle_Epsilon = 1.0E-7;
+
+    {$REGION 'Documentation'}
+    {**
+     Ray count traversing an aligned-axis bounding box tree together in a ray packet
+    }
+    {$ENDREGION}
+    QR_Ray_Packet_Size = 4;
+
+    {$REGION 'Documentation'}
+    {**
+     Inverse direction used in a ray packet instead of an infinite value, when a ray is parallel to
+     an axis. Keeping the inverse directions finite allows to test the box slabs without checking
+     if each of them is infinite
+    }
+    {$ENDREGION}
+    QR_Ray_Packet_Max_Inv_Dir = 1.0E30;
+
+    {$REGION 'Documentation'}
+    {**
+     Signature written at the beginning of an aligned-axis bounding box tree stream, matches with
+     'QRAT' in ASCII
+    }
+    {$ENDREGION}
+    QR_AABB_Stream_Signature = $54415251;
+
+    {$REGION 'Documentation'}
+    {**
+     Aligned-axis bounding box tree stream format version. Should be incremented each time the
+     stream format changes, in order to reject the streams written in a previous format
+    }
+    {$ENDREGION}
+    QR_AABB_Stream_Version = 1;
+
+    {$REGION 'Documentation'}
+    {**
+     Signature written at the beginning of an aligned-axis bounding box tree cache file, matches
+     with 'QRAC' in ASCII
+    }
+    {$ENDREGION}
+    QR_AABB_Cache_Signature = $43415251;
+
+    {$REGION 'Documentation'}
+    {**
+     Aligned-axis bounding box tree cache file format version
+    }
+    {$ENDREGION}
+    QR_AABB_Cache_Version = 1;
+
+    {$REGION 'Documentation'}
+    {**
+     Extension appended to a model file name to get his aligned-axis bounding box tree cache file
+     name
+    }
+    {$ENDREGION}
+    QR_AABB_Cache_File_Ext = '.aabb';
+
 type
     {$REGION 'Documentation'}
     {**
-     Aligned-axis bounding box tree node pointer (needed to be declared before record itself)
+     Aligned-axis bounding box tree build mode
+     @value(EQR_BM_Midpoint Each node box is cut in half on his longest axis, and each polygon is
+                            added to the first half containing one of his vertices)
+     @value(EQR_BM_SAH Each node is split on the axis and position minimizing the surface area
+                       heuristic cost, evaluated on a fixed count of bins on the 3 axis. The build
+                       is slower, but the resulting tree is better balanced and less polygons are
+                       returned while resolved)
     }
     {$ENDREGION}
-    PQRAABBNode = ^TQRAABBNode;
+    EQRAABBTreeBuildMode =
+    (
+        EQR_BM_Midpoint = 0,
+        EQR_BM_SAH
+    );
 
     {$REGION 'Documentation'}
     {**
-     Aligned-axis bounding box tree node
+     Shape to test in an aligned-axis bounding box tree overlap query
+     @value(EQR_OS_Sphere The query tests a sphere)
+     @value(EQR_OS_Box The query tests an aligned-axis box)
+     @value(EQR_OS_Frustum The query tests a 6 planes frustum)
     }
     {$ENDREGION}
-    TQRAABBNode = record
+    EQRAABBOverlapShape =
+    (
+        EQR_OS_Sphere = 0,
+        EQR_OS_Box,
+        EQR_OS_Frustum
+    );
+
+    {$REGION 'Documentation'}
+    {**
+     Ray hit, contains the result of a closest hit ray query
+    }
+    {$ENDREGION}
+    TQRRayHit = record
         {$REGION 'Documentation'}
         {**
-         Parent of this node in the AABB tree
+         Distance between the ray position and the hit point, expressed in ray direction length
+         units, i.e. the hit point is equal to Pos + (Dir * m_Distance)
         }
         {$ENDREGION}
-        m_pParent: PQRAABBNode;
+        m_Distance: Single;
 
         {$REGION 'Documentation'}
         {**
-         Left child node, contains the collision data that were detected inside the left child box
-         after the division
+         Index of the hit polygon in the polygon array used to populate the tree, -1 if no polygon
+         was hit
         }
         {$ENDREGION}
-        m_pLeft: PQRAABBNode;
+        m_PolygonIndex: NativeInt;
 
         {$REGION 'Documentation'}
         {**
-         Right child node, contains the collision data that were detected inside the right child box
-         after the division
+         Barycentric coordinate of the hit point matching with the polygon second vertex
         }
         {$ENDREGION}
-        m_pRight: PQRAABBNode;
+        m_U: Single;
 
         {$REGION 'Documentation'}
         {**
-         Bounding box matching with this node
+         Barycentric coordinate of the hit point matching with the polygon third vertex. The first
+         vertex coordinate is equal to 1.0 - m_U - m_V
         }
         {$ENDREGION}
-        m_pBox: PQRBox;
+        m_V: Single;
 
         {$REGION 'Documentation'}
         {**
-         Subdivided polygons that the bounding box surrounds
+         Hit polygon
         }
         {$ENDREGION}
-        m_Polygons: TQRPolygons;
+        m_Polygon: TQRPolygon;
     end;
 
+    PQRRayHit = ^TQRRayHit;
+
     {$REGION 'Documentation'}
     {**
-     Aligned-axis bounding box tree
+     Ray hit list
     }
     {$ENDREGION}
-    TQRAABBTree = class
-        private
-            m_pRoot: PQRAABBNode;
-
-        protected
-            {$REGION 'Documentation'}
-            {**
-             Releases tree content
-             @param(pNode Root node from which content should be released)
-            }
-            {$ENDREGION}
-            procedure Release(pNode: PQRAABBNode); virtual;
-
-            {$REGION 'Documentation'}
-            {**
-             Checks if a value is between 2 values
-             @param(value Value to test)
-             @param(valueStart Start value)
-             @param(valueEnd End value)
-             @param(epsilon Epsilon value for tolerance)
-             @return(@true if value is between values, otherwise @false)
-            }
-            {$ENDREGION}
-            function ValueIsBetween(const value, valueStart, valueEnd, epsilon: Single): Boolean; virtual;
-
-            {$REGION 'Documentation'}
-            {**
-             Checks if a point is between 2 vertices
-             @param(point Point to test)
-             @param(pointStart Start vertex)
-             @param(pointEnd End vertex)
-             @param(epsilon Epsilon value for tolerance)
-             @return(@true if value is between points, otherwise @false)
-            }
-            {$ENDREGION}
-            function VectorIsBetween(const point, pointStart, pointEnd: TQRVector3D;
-                                                         const epsilon: Single): Boolean; virtual;
+    TQRRayHits = array of TQRRayHit;
 
-            {$REGION 'Documentation'}
-            {**
-             Adds a polygon inside an existing bounding box
-             @param(polygon Polygon to add)
-             @param(box Bounding box in which polygon should be added)
-             @param(empty @bold([in, out]) If @true, box is empty an still no contains any polygon)
-            }
-            {$ENDREGION}
-            procedure AddPolygonToBoundingBox(polygon: TQRPolygon;
-                                                 pBox: PQRBox;
-                                            var empty: Boolean); virtual;
+    {$REGION 'Documentation'}
+    {**
+     Ray batch, contains several rays whose coordinates are stored by component (i.e. all the x
+     positions, then all the y positions, ...), in order to be read contiguously while the rays are
+     processed together
+     @br @bold(NOTE) The rays are grouped in packets in the batch order, so rays following each other
+                     should be coherent (e.g. rays starting from neighbour pixels), in order to
+                     traverse the same nodes
+    }
+    {$ENDREGION}
+    TQRRayBatch = record
+        private
+            m_PosX: TQRVertexBuffer;
+            m_PosY: TQRVertexBuffer;
+            m_PosZ: TQRVertexBuffer;
+            m_DirX: TQRVertexBuffer;
+            m_DirY: TQRVertexBuffer;
+            m_DirZ: TQRVertexBuffer;
 
             {$REGION 'Documentation'}
             {**
-             Populates AABB tree
-             @param(pNode Root or parent node to create from)
-             @param(polygons Source polygon array)
-             @param(hIsCanceled Callback function that allows to break the operation, can be @nil)
-             @return(@true on success, otherwise @false)
+             Gets the ray count
+             @return(The ray count)
             }
             {$ENDREGION}
-            function Populate(pNode: PQRAABBNode;
-                     const polygons: TQRPolygons;
-                        hIsCanceled: TQRIsCanceledEvent): Boolean; overload; virtual;
+            function GetCount: NativeUInt;
 
             {$REGION 'Documentation'}
             {**
-             Resolves AABB tree
-             @param(pRay Ray against which tree boxes will be tested)
-             @param(pNode Root or parent node to resolve)
-             @param(polygons @bold([in, out]) Polygons belonging to boxes hit by ray)
-             @return(@true on success, otherwise @false)
-             @br @bold(NOTE) Polygon list content should be deleted when useless
+             Sets the ray count
+             @param(value The ray count)
             }
             {$ENDREGION}
-            function Resolve(const pRay: TQRRay;
-                            const pNode: PQRAABBNode;
-                           var polygons: TQRPolygons): Boolean; overload; virtual;
+            procedure SetCount(value: NativeUInt);
 
         public
             {$REGION 'Documentation'}
             {**
-             Constructor
+             Sets a ray in the batch
+             @param(index Ray index)
+             @param(pos Ray position)
+             @param(dir Ray direction)
             }
             {$ENDREGION}
-            constructor Create; virtual;
+            procedure SetRay(index: NativeUInt; const pos, dir: TQRVector3D);
 
             {$REGION 'Documentation'}
             {**
-             Destructor
+             Gets a ray position
+             @param(index Ray index)
+             @return(Ray position)
             }
             {$ENDREGION}
-            destructor Destroy; override;
+            function GetPos(index: NativeUInt): TQRVector3D; inline;
 
             {$REGION 'Documentation'}
             {**
-             Populates AABB tree
-             @param(polygons Source polygon array)
-             @param(hIsCanceled Callback function that allows to break the operation, can be @nil)
-             @return(@true on success, otherwise @false)
+             Gets a ray direction
+             @param(index Ray index)
+             @return(Ray direction)
             }
             {$ENDREGION}
-            function Populate(const polygons: TQRPolygons;
-                                 hIsCanceled: TQRIsCanceledEvent = nil): Boolean; overload; virtual;
+            function GetDir(index: NativeUInt): TQRVector3D; inline;
 
+        // Properties
+        public
             {$REGION 'Documentation'}
             {**
-             Resolves AABB tree
-             @param(pRay Ray against which tree boxes will be tested)
-             @param(polygons @bold([in, out]) Polygons belonging to boxes hit by ray)
-             @return(@true on success, otherwise @false)
-             @br @bold(NOTE) Polygon list content should be deleted when useless
+             Gets or sets the ray count
             }
             {$ENDREGION}
-            function Resolve(const pRay: TQRRay;
-                           var polygons: TQRPolygons): Boolean; overload; virtual;
+            property Count: NativeUInt read GetCount write SetCount;
     end;
 
+    PQRRayBatch = ^TQRRayBatch;
+
     {$REGION 'Documentation'}
     {**
-     3D collision detection helper
+     Ray packet, contains the rays traversing an aligned-axis bounding box tree together, and their
+     best hit distance found so far
     }
     {$ENDREGION}
-    TQRCollisionHelper = class
-        protected
-            {$REGION 'Documentation'}
-            {**
-             Adds polygon to array
-             @param(vb Source vertex buffer)
-             @param(v1 First polygon vertex index in vertex buffer)
-             @param(v2 Second polygon vertex index in vertex buffer)
-             @param(v3 Third polygon vertex index in vertex buffer)
-             @param(polygons @bold([in, out]) Polygon array that contains generated polygons)
-             @br @bold(NOTE) Generated polygons should be deleted when useless
-            }
-            {$ENDREGION}
-            class procedure AddPolygon(const vb: TQRVertexBuffer;
-                                     v1, v2, v3: NativeUInt;
-                                   var polygons: TQRPolygons); static;
-
-        public
-            {$REGION 'Documentation'}
-            {**
-             Tests collision between a ray and a polygon
-             @param(pRay Ray)
-             @param(polygon Polygon to check)
-             @return(@true if ray intersects polygon, otherwise @false)
-            }
-            {$ENDREGION}
-            class function GetRayPolygonCollision(const pRay: TQRRay;
-                                               const polygon: TQRPolygon): Boolean; static;
-
-            {$REGION 'Documentation'}
-            {**
-             Tests collision between a ray and a box
-             @param(pRay Ray)
-             @param(pBox Box)
-             @return(@true if ray intersects box, otherwise @false)
-            }
-            {$ENDREGION}
-            class function GetRayBoxCollision(const pRay: TQRRay; const pBox: PQRBox): Boolean; static;
-
-            {$REGION 'Documentation'}
-            {**
-             Gets polygons from vertex
-             @param(vertex Source vertex descriptor, contains buffer to get from)
-             @param(polygons @bold([in, out]) Polygon list to populate)
-             @param(hIsCanceled Callback function that allows to break the operation, can be @nil)
-             @return(@true on success, otherwise @false)
-             @br @bold(NOTE) Polygon list content should be deleted when useless
-            }
-            {$ENDREGION}
-            class function GetPolygons(const vertex: TQRVertex;
-                                       var polygons: TQRPolygons;
-                                        hIsCanceled: TQRIsCanceledEvent = nil): Boolean; static;
-    end;
+    TQRRayPacket = record
+        {$REGION 'Documentation'}
+        {**
+         Ray x positions
+        }
+        {$ENDREGION}
+        m_PosX: array [0..QR_Ray_Packet_Size - 1] of Single;
 
-implementation
-//--------------------------------------------------------------------------------------------------
-// TQRAABBTree
-//--------------------------------------------------------------------------------------------------
-constructor TQRAABBTree.Create;
-begin
-    inherited Create;
+        {$REGION 'Documentation'}
+        {**
+         Ray y positions
+        }
+        {$ENDREGION}
+        m_PosY: array [0..QR_Ray_Packet_Size - 1] of Single;
 
-    m_pRoot := nil;
-end;
-//--------------------------------------------------------------------------------------------------
-destructor  TQRAABBTree.Destroy;
-begin
-    // delete entire tree hierarchy
-    Release(m_pRoot);
+        {$REGION 'Documentation'}
+        {**
+         Ray z positions
+        }
+        {$ENDREGION}
+        m_PosZ: array [0..QR_Ray_Packet_Size - 1] of Single;
 
-    inherited Destroy;
-end;
-//--------------------------------------------------------------------------------------------------
-procedure TQRAABBTree.Release(pNode: PQRAABBNode);
-begin
-    // nothing to do?
-    if (not Assigned(pNode)) then
-        Exit;
+        {$REGION 'Documentation'}
+        {**
+         Ray x directions
+        }
+        {$ENDREGION}
+        m_DirX: array [0..QR_Ray_Packet_Size - 1] of Single;
 
-    // release all children on left side
-    if (Assigned(pNode.m_pLeft)) then
-        Release(pNode.m_pLeft);
+        {$REGION 'Documentation'}
+        {**
+         Ray y directions
+        }
+        {$ENDREGION}
+        m_DirY: array [0..QR_Ray_Packet_Size - 1] of Single;
 
-    // release all children on right side
-    if (Assigned(pNode.m_pRight)) then
-        Release(pNode.m_pRight);
+        {$REGION 'Documentation'}
+        {**
+         Ray z directions
+        }
+        {$ENDREGION}
+        m_DirZ: array [0..QR_Ray_Packet_Size - 1] of Single;
 
-    // delete aabb box
-    if (Assigned(pNode.m_pBox)) then
-        Dispose(pNode.m_pBox);
+        {$REGION 'Documentation'}
+        {**
+         Ray inverse x directions, always finite
+        }
+        {$ENDREGION}
+        m_InvDirX: array [0..QR_Ray_Packet_Size - 1] of Single;
 
-    // delete polygons
-    SetLength(pNode.m_Polygons, 0);
+        {$REGION 'Documentation'}
+        {**
+         Ray inverse y directions, always finite
+        }
+        {$ENDREGION}
+        m_InvDirY: array [0..QR_Ray_Packet_Size - 1] of Single;
+
+        {$REGION 'Documentation'}
+        {**
+         Ray inverse z directions, always finite
+        }
+        {$ENDREGION}
+        m_InvDirZ: array [0..QR_Ray_Packet_Size - 1] of Single;
+
+        {$REGION 'Documentation'}
+        {**
+         Best hit distance found so far for each ray
+        }
+        {$ENDREGION}
+        m_Best: array [0..QR_Ray_Packet_Size - 1] of Single;
+    end;
+
+    PQRRayPacket = ^TQRRayPacket;
+
+    {$REGION 'Documentation'}
+    {**
+     Frustum, delimited by 6 planes whose normals point to the frustum inside. The planes are
+     ordered as follow: left, right, bottom, top, near and far
+     @br @bold(NOTE) A point is inside the frustum if his distance to each plane is positive or zero
+    }
+    {$ENDREGION}
+    TQRFrustum = array [0..5] of TQRPlane;
+
+    PQRFrustum = ^TQRFrustum;
+
+    {$REGION 'Documentation'}
+    {**
+     Aligned-axis bounding box tree overlap query
+    }
+    {$ENDREGION}
+    TQRAABBOverlapQuery = record
+        {$REGION 'Documentation'}
+        {**
+         Shape to test, the matching field below contains the shape
+        }
+        {$ENDREGION}
+        m_Shape: EQRAABBOverlapShape;
+
+        {$REGION 'Documentation'}
+        {**
+         Sphere to test, if m_Shape is EQR_OS_Sphere
+        }
+        {$ENDREGION}
+        m_Sphere: TQRSphere;
+
+        {$REGION 'Documentation'}
+        {**
+         Box to test, if m_Shape is EQR_OS_Box
+        }
+        {$ENDREGION}
+        m_Box: TQRBox;
+
+        {$REGION 'Documentation'}
+        {**
+         Frustum to test, if m_Shape is EQR_OS_Frustum
+        }
+        {$ENDREGION}
+        m_Frustum: TQRFrustum;
+    end;
+
+    PQRAABBOverlapQuery = ^TQRAABBOverlapQuery;
+
+    {$REGION 'Documentation'}
+    {**
+     Aligned-axis bounding box tree node. Nodes are stored in a single contiguous array owned by
+     the tree, and refer to each other, and to the polygons they contain, by index
+    }
+    {$ENDREGION}
+    TQRAABBNode = record
+        {$REGION 'Documentation'}
+        {**
+         Bounding box matching with this node
+        }
+        {$ENDREGION}
+        m_Box: TQRBox;
+
+        {$REGION 'Documentation'}
+        {**
+         Left child node index in the tree node array, -1 if the node is a leaf
+        }
+        {$ENDREGION}
+        m_Left: Integer;
+
+        {$REGION 'Documentation'}
+        {**
+         Right child node index in the tree node array, -1 if the node is a leaf
+        }
+        {$ENDREGION}
+        m_Right: Integer;
+
+        {$REGION 'Documentation'}
+        {**
+         Index of the first polygon the node surrounds, in the tree polygon array
+        }
+        {$ENDREGION}
+        m_Start: Cardinal;
+
+        {$REGION 'Documentation'}
+        {**
+         Polygon count the node surrounds. For a leaf, these polygons are stored contiguously from
+         m_Start in the tree polygon array
+        }
+        {$ENDREGION}
+        m_Count: Cardinal;
+    end;
+
+    {$REGION 'Documentation'}
+    {**
+     Aligned-axis bounding box tree node pointer
+    }
+    {$ENDREGION}
+    PQRAABBNode = ^TQRAABBNode;
+
+    {$REGION 'Documentation'}
+    {**
+     Aligned-axis bounding box tree node list
+    }
+    {$ENDREGION}
+    TQRAABBNodes = array of TQRAABBNode;
+
+    {$REGION 'Documentation'}
+    {**
+     Aligned-axis bounding box tree polygon index list
+    }
+    {$ENDREGION}
+    TQRAABBIndices = array of Cardinal;
+
+    {$REGION 'Documentation'}
+    {**
+     Aligned-axis bounding box tree stream header
+     @br @bold(NOTE) The node and polygon record sizes are written in the header, in order to
+                     reject a stream written by a build using another record layout
+    }
+    {$ENDREGION}
+    TQRAABBStreamHeader = record
+        {$REGION 'Documentation'}
+        {**
+         Stream signature, should be equal to QR_AABB_Stream_Signature
+        }
+        {$ENDREGION}
+        m_Signature: TQRUInt32;
+
+        {$REGION 'Documentation'}
+        {**
+         Stream format version, should be equal to QR_AABB_Stream_Version
+        }
+        {$ENDREGION}
+        m_Version: TQRUInt32;
+
+        {$REGION 'Documentation'}
+        {**
+         Node record size, in bytes
+        }
+        {$ENDREGION}
+        m_NodeSize: TQRUInt32;
+
+        {$REGION 'Documentation'}
+        {**
+         Polygon record size, in bytes
+        }
+        {$ENDREGION}
+        m_PolygonSize: TQRUInt32;
+
+        {$REGION 'Documentation'}
+        {**
+         Build mode used to populate the tree
+        }
+        {$ENDREGION}
+        m_BuildMode: TQRUInt32;
+
+        {$REGION 'Documentation'}
+        {**
+         Node count
+        }
+        {$ENDREGION}
+        m_NodeCount: TQRUInt32;
+
+        {$REGION 'Documentation'}
+        {**
+         Polygon count
+        }
+        {$ENDREGION}
+        m_PolygonCount: TQRUInt32;
+    end;
+
+    PQRAABBStreamHeader = ^TQRAABBStreamHeader;
+
+    {$REGION 'Documentation'}
+    {**
+     Aligned-axis bounding box tree cache file header. The header is followed by the tree streams
+    }
+    {$ENDREGION}
+    TQRAABBCacheHeader = record
+        {$REGION 'Documentation'}
+        {**
+         File signature, should be equal to QR_AABB_Cache_Signature
+        }
+        {$ENDREGION}
+        m_Signature: TQRUInt32;
+
+        {$REGION 'Documentation'}
+        {**
+         File format version, should be equal to QR_AABB_Cache_Version
+        }
+        {$ENDREGION}
+        m_Version: TQRUInt32;
+
+        {$REGION 'Documentation'}
+        {**
+         Key identifying the source the trees were built from, e.g. a model file content hash. The
+         cached trees should be ignored if the key no longer matches
+        }
+        {$ENDREGION}
+        m_Key: TQRUInt32;
+
+        {$REGION 'Documentation'}
+        {**
+         Cached tree count
+        }
+        {$ENDREGION}
+        m_TreeCount: TQRUInt32;
+    end;
+
+    PQRAABBCacheHeader = ^TQRAABBCacheHeader;
+
+    {$REGION 'Documentation'}
+    {**
+     Aligned-axis bounding box subtree build task. A task builds a subtree in his own node array,
+     which is merged in the tree node array once all the tasks are done
+    }
+    {$ENDREGION}
+    TQRAABBBuildTask = record
+        {$REGION 'Documentation'}
+        {**
+         Subtree node array, the subtree root is the first node
+        }
+        {$ENDREGION}
+        m_Nodes: TQRAABBNodes;
+
+        {$REGION 'Documentation'}
+        {**
+         Subtree node count
+        }
+        {$ENDREGION}
+        m_NodeCount: NativeUInt;
+
+        {$REGION 'Documentation'}
+        {**
+         Index of the tree node the subtree root will replace
+        }
+        {$ENDREGION}
+        m_NodeIndex: Integer;
+
+        {$REGION 'Documentation'}
+        {**
+         First polygon the subtree surrounds in the tree index array
+        }
+        {$ENDREGION}
+        m_Start: NativeUInt;
+
+        {$REGION 'Documentation'}
+        {**
+         Polygon count the subtree surrounds
+        }
+        {$ENDREGION}
+        m_Count: NativeUInt;
+
+        {$REGION 'Documentation'}
+        {**
+         Subtree root depth in the tree
+        }
+        {$ENDREGION}
+        m_Depth: NativeUInt;
+
+        {$REGION 'Documentation'}
+        {**
+         If @true, the subtree was successfully built
+        }
+        {$ENDREGION}
+        m_Success: Boolean;
+    end;
+
+    PQRAABBBuildTask  = ^TQRAABBBuildTask;
+    TQRAABBBuildTasks = array of TQRAABBBuildTask;
+
+    {$REGION 'Documentation'}
+    {**
+     Aligned-axis bounding box tree
+     @br @bold(NOTE) The whole tree is stored in 2 flat arrays, one containing the nodes, and one
+                     containing the polygons, sorted in such a manner that each leaf surrounds a
+                     contiguous polygon range. A child node index is always higher than his
+                     parent index
+    }
+    {$ENDREGION}
+    TQRAABBTree = class
+        private
+            m_Nodes:      TQRAABBNodes;
+            m_Polygons:   TQRPolygons;
+            m_Indices:    TQRAABBIndices;
+            m_Centers:    array of TQRVector3D;
+            m_Tasks:      TQRAABBBuildTasks;
+            m_pTaskLock:  TCriticalSection;
+            m_NextTask:   NativeUInt;
+            m_TaskDepth:  NativeUInt;
+            m_NodeCount:  NativeUInt;
+            m_MaxThreads: NativeUInt;
+            m_BuildMode:  EQRAABBTreeBuildMode;
+
+        protected
+            {$REGION 'Documentation'}
+            {**
+             Releases tree content
+            }
+            {$ENDREGION}
+            procedure Release; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Checks if a value is between 2 values
+             @param(value Value to test)
+             @param(valueStart Start value)
+             @param(valueEnd End value)
+             @param(epsilon Epsilon value for tolerance)
+             @return(@true if value is between values, otherwise @false)
+            }
+            {$ENDREGION}
+            function ValueIsBetween(const value, valueStart, valueEnd, epsilon: Single): Boolean; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Checks if a point is between 2 vertices
+             @param(point Point to test)
+             @param(pointStart Start vertex)
+             @param(pointEnd End vertex)
+             @param(epsilon Epsilon value for tolerance)
+             @return(@true if value is between points, otherwise @false)
+            }
+            {$ENDREGION}
+            function VectorIsBetween(const point, pointStart, pointEnd: TQRVector3D;
+                                                         const epsilon: Single): Boolean; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Adds a polygon inside an existing bounding box
+             @param(polygon Polygon to add)
+             @param(box Bounding box in which polygon should be added)
+             @param(empty @bold([in, out]) If @true, box is empty an still no contains any polygon)
+            }
+            {$ENDREGION}
+            procedure AddPolygonToBoundingBox(const polygon: TQRPolygon;
+                                                       pBox: PQRBox;
+                                                  var empty: Boolean); virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Adds a box inside an existing bounding box
+             @param(box Box to add)
+             @param(pBox Bounding box in which box should be added)
+             @param(empty @bold([in, out]) If @true, box is empty an still no contains anything)
+            }
+            {$ENDREGION}
+            procedure AddBoxToBoundingBox(const box: TQRBox;
+                                               pBox: PQRBox;
+                                          var empty: Boolean); virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Gets the surface area of a box
+             @param(box Box for which the surface area should be calculated)
+             @return(The box surface area)
+            }
+            {$ENDREGION}
+            function GetBoxArea(const box: TQRBox): Single; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Gets a vector coordinate from an axis index
+             @param(vector Vector from which the coordinate should be get)
+             @param(axis Axis index, 0 for x, 1 for y and 2 for z)
+             @return(The vector coordinate matching with the axis)
+            }
+            {$ENDREGION}
+            function GetAxisValue(const vector: TQRVector3D; axis: NativeUInt): Single; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Adds a new empty node at the end of the node array
+             @param(pTask Subtree build task owning the node array, if @nil the node is added to
+                          the tree node array)
+             @return(The new node index)
+            }
+            {$ENDREGION}
+            function AddNode(pTask: PQRAABBBuildTask): Integer; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Gets a node while the tree is built
+             @param(pTask Subtree build task owning the node array, if @nil the node is get from
+                          the tree node array)
+             @param(index Node index)
+             @return(Node)
+            }
+            {$ENDREGION}
+            function GetBuildNode(pTask: PQRAABBBuildTask; index: Integer): PQRAABBNode; inline;
+
+            {$REGION 'Documentation'}
+            {**
+             Swaps 2 polygon indices in the index array
+             @param(first First index to swap)
+             @param(second Second index to swap)
+            }
+            {$ENDREGION}
+            procedure SwapIndices(first, second: NativeUInt); inline;
+
+            {$REGION 'Documentation'}
+            {**
+             Splits a polygon range in 2 sides by cutting the node box in half on his longest axis
+             @param(box Node bounding box)
+             @param(start First polygon index to split in the index array)
+             @param(count Polygon count to split)
+             @param(leftCount @bold([out]) Polygon count moved on the left side, the remaining
+                                           polygons belong to the right side)
+             @param(hIsCanceled Callback function that allows to break the operation, can be @nil)
+             @return(@true on success, @false if canceled)
+            }
+            {$ENDREGION}
+            function SplitMidpoint(const box: TQRBox;
+                                start, count: NativeUInt;
+                               out leftCount: NativeUInt;
+                                 hIsCanceled: TQRIsCanceledEvent): Boolean; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Splits a polygon range in 2 sides on the axis and position minimizing the surface area
+             heuristic cost. Polygon centers are distributed in QR_SAH_Bin_Count bins on each axis,
+             and each bin boundary is evaluated as split candidate
+             @param(box Node bounding box)
+             @param(start First polygon index to split in the index array)
+             @param(count Polygon count to split)
+             @param(leftCount @bold([out]) Polygon count moved on the left side, the remaining
+                                           polygons belong to the right side)
+             @param(hIsCanceled Callback function that allows to break the operation, can be @nil)
+             @return(@true on success, @false if canceled)
+             @br @bold(NOTE) leftCount is set to 0 if keeping the node as a leaf is cheaper
+            }
+            {$ENDREGION}
+            function SplitSAH(const box: TQRBox;
+                           start, count: NativeUInt;
+                          out leftCount: NativeUInt;
+                            hIsCanceled: TQRIsCanceledEvent): Boolean; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Populates AABB tree
+             @param(nodeIndex Root or parent node index to create from)
+             @param(start First polygon the node surrounds in the index array)
+             @param(count Polygon count the node surrounds)
+             @param(depth Node depth in the tree, 0 for the root node)
+             @param(pTask Subtree build task in which the nodes are created, if @nil the nodes are
+                          created in the tree node array)
+             @param(hIsCanceled Callback function that allows to break the operation, can be @nil)
+             @return(@true on success, otherwise @false)
+             @br @bold(NOTE) While the tree is built on several threads, the nodes reaching the
+                             task depth are kept as leaves and a subtree build task is added for
+                             each of them
+            }
+            {$ENDREGION}
+            function Populate(nodeIndex: Integer;
+                    start, count, depth: NativeUInt;
+                                  pTask: PQRAABBBuildTask;
+                            hIsCanceled: TQRIsCanceledEvent): Boolean; overload; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Gets the thread count to use to build the tree
+             @param(polygonCount Polygon count the tree will contain)
+             @return(The thread count, 1 if the tree should be built on the calling thread only)
+            }
+            {$ENDREGION}
+            function GetBuildThreadCount(polygonCount: NativeUInt): NativeUInt; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Processes the pending subtree build tasks, until no task remains
+             @param(hIsCanceled Callback function that allows to break the operation, can be @nil)
+             @br @bold(NOTE) This function is called by each build thread, including the calling
+                             thread
+            }
+            {$ENDREGION}
+            procedure ProcessBuildTasks(hIsCanceled: TQRIsCanceledEvent); virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Builds the subtree build tasks on several threads, and merges the resulting subtrees
+             in the tree node array
+             @param(threadCount Thread count to use, including the calling thread)
+             @param(hIsCanceled Callback function that allows to break the operation, can be @nil)
+             @return(@true on success, otherwise @false)
+            }
+            {$ENDREGION}
+            function BuildTasks(threadCount: NativeUInt; hIsCanceled: TQRIsCanceledEvent): Boolean; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Checks if the tree content is consistent, i.e. if all the node and polygon indices are
+             in range, if each child index is higher than his parent index, and if the tree depth
+             doesn't exceed QR_AABB_Max_Depth
+             @return(@true if the tree content is consistent, otherwise @false)
+             @br @bold(NOTE) This function is used to validate a tree loaded from a stream, before
+                             it is traversed
+            }
+            {$ENDREGION}
+            function IsContentValid: Boolean; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Gets the closest polygons that the rays of a packet intersect, traversing the tree with
+             all the packet rays together
+             @param(rays Ray batch containing the packet rays)
+             @param(start Index of the first packet ray in the batch)
+             @param(count Packet ray count, between 1 and QR_Ray_Packet_Size)
+             @param(maxDistance Maximum hit distance to consider)
+             @param(hits @bold([in, out]) Hit list, the hit of each packet ray is written at the
+                                          same index as the ray in the batch)
+             @return(Packet ray count that hit a polygon)
+            }
+            {$ENDREGION}
+            function RaycastPacket(const rays: TQRRayBatch;
+                                 start, count: NativeUInt;
+                            const maxDistance: Single;
+                                     var hits: TQRRayHits): NativeUInt; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Checks if a node box overlaps the shape of a query
+             @param(query Overlap query)
+             @param(box Node box)
+             @return(@true if the box overlaps the query shape, otherwise @false)
+            }
+            {$ENDREGION}
+            function BoxOverlaps(const query: TQRAABBOverlapQuery; const box: TQRBox): Boolean; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Checks if a polygon overlaps the shape of a query
+             @param(query Overlap query)
+             @param(polygon Polygon)
+             @return(@true if the polygon overlaps the query shape, otherwise @false)
+            }
+            {$ENDREGION}
+            function PolygonOverlaps(const query: TQRAABBOverlapQuery;
+                                   const polygon: TQRPolygon): Boolean; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Gets the polygons overlapping the shape of a query
+             @param(query Overlap query)
+             @param(indices @bold([in, out]) Index list to populate with the overlapping polygon
+                                             indices, in the polygon array used to populate the
+                                             tree. The list isn't resized, and only the first
+                                             Length(indices) overlapping polygons are written)
+             @param(firstOnly If @true, the query stops on the first overlapping polygon)
+             @return(Overlapping polygon count, may be higher than the index list length)
+            }
+            {$ENDREGION}
+            function Overlap(const query: TQRAABBOverlapQuery;
+                             var indices: TQRAABBIndices;
+                               firstOnly: Boolean): NativeUInt; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Resolves AABB tree
+             @param(pRay Ray against which tree boxes will be tested)
+             @param(nodeIndex Root or parent node index to resolve)
+             @param(polygons @bold([in, out]) Polygons belonging to boxes hit by ray)
+             @return(@true on success, otherwise @false)
+             @br @bold(NOTE) Polygon list content should be deleted when useless
+            }
+            {$ENDREGION}
+            function Resolve(const pRay: TQRRay;
+                              nodeIndex: Integer;
+                           var polygons: TQRPolygons): Boolean; overload; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Gets node at index
+             @param(index Node index)
+             @return(Node, @nil if not found)
+            }
+            {$ENDREGION}
+            function GetNode(index: NativeUInt): PQRAABBNode; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Gets polygon at index, in the tree internal order
+             @param(index Polygon index)
+             @return(Polygon, @nil if not found)
+            }
+            {$ENDREGION}
+            function GetPolygon(index: NativeUInt): PQRPolygon; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Gets the polygon count
+             @return(The polygon count)
+            }
+            {$ENDREGION}
+            function GetPolygonCount: NativeUInt; virtual;
+
+        public
+            {$REGION 'Documentation'}
+            {**
+             Constructor
+            }
+            {$ENDREGION}
+            constructor Create; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Destructor
+            }
+            {$ENDREGION}
+            destructor Destroy; override;
+
+            {$REGION 'Documentation'}
+            {**
+             Populates AABB tree
+             @param(polygons Source polygon array)
+             @param(hIsCanceled Callback function that allows to break the operation, can be @nil)
+             @return(@true on success, otherwise @false)
+            }
+            {$ENDREGION}
+            function Populate(const polygons: TQRPolygons;
+                                 hIsCanceled: TQRIsCanceledEvent = nil): Boolean; overload; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Resolves AABB tree
+             @param(pRay Ray against which tree boxes will be tested)
+             @param(polygons @bold([in, out]) Polygons belonging to boxes hit by ray)
+             @return(@true on success, otherwise @false)
+             @br @bold(NOTE) Polygon list content should be deleted when useless
+            }
+            {$ENDREGION}
+            function Resolve(const pRay: TQRRay;
+                           var polygons: TQRPolygons): Boolean; overload; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Gets the original index of a polygon, i.e. his index in the array used to populate the
+             tree
+             @param(index Polygon index, in the tree internal order)
+             @return(Polygon index in the source array)
+            }
+            {$ENDREGION}
+            function GetSourceIndex(index: NativeUInt): NativeUInt; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Copies the content of another tree
+             @param(pOther Other tree to copy from)
+            }
+            {$ENDREGION}
+            procedure Assign(const pOther: TQRAABBTree); virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Refits the tree on new polygon positions. The tree hierarchy is kept, and only the node
+             boxes are updated, from the leaves to the root. This is much faster than populating
+             the tree again, e.g. to update the tree of an animated model, whose all frames share
+             the same topology
+             @param(polygons New polygon positions, in the same order and count as the polygons
+                             used to populate the tree)
+             @return(@true on success, otherwise @false)
+             @br @bold(NOTE) The more the new polygons differ from the polygons used to populate the
+                             tree, the more the boxes overlap, and the less efficient the tree is
+            }
+            {$ENDREGION}
+            function Refit(const polygons: TQRPolygons): Boolean; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Gets the polygon closest to the ray position that the ray intersects. The tree is
+             traversed from front to back, and subtrees farther than the best hit found so far are
+             skipped
+             @param(pRay Ray to test)
+             @param(hit @bold([out]) Closest hit, m_PolygonIndex is set to -1 if nothing was hit)
+             @return(@true if the ray hit a polygon, otherwise @false)
+             @br @bold(NOTE) Only polygons located in front of the ray position are considered
+            }
+            {$ENDREGION}
+            function RaycastClosest(const pRay: TQRRay; out hit: TQRRayHit): Boolean; overload; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Gets the polygon closest to the ray position that the ray intersects. The tree is
+             traversed from front to back, and subtrees farther than the best hit found so far are
+             skipped
+             @param(pRay Ray to test)
+             @param(maxDistance Maximum hit distance to consider)
+             @param(hit @bold([out]) Closest hit, m_PolygonIndex is set to -1 if nothing was hit)
+             @return(@true if the ray hit a polygon, otherwise @false)
+             @br @bold(NOTE) Only polygons located in front of the ray position are considered
+            }
+            {$ENDREGION}
+            function RaycastClosest(const pRay: TQRRay;
+                             const maxDistance: Single;
+                                       out hit: TQRRayHit): Boolean; overload; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Gets the closest polygon that each ray of a batch intersects. The rays are grouped in
+             packets of QR_Ray_Packet_Size rays, and the rays of a packet traverse the tree together
+             @param(rays Ray batch to test)
+             @param(hits @bold([out]) Hit list, contains the hit of each ray at the same index as the
+                                      ray in the batch. m_PolygonIndex is set to -1 if the ray hit
+                                      nothing)
+             @return(Ray count that hit a polygon)
+             @br @bold(NOTE) Only polygons located in front of the ray positions are considered
+            }
+            {$ENDREGION}
+            function RaycastClosest(const rays: TQRRayBatch;
+                                    out hits: TQRRayHits): NativeUInt; overload; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Gets the closest polygon that each ray of a batch range intersects. The rays are
+             grouped in packets of QR_Ray_Packet_Size rays, and the rays of a packet traverse the
+             tree together
+             @param(rays Ray batch to test)
+             @param(start Index of the first ray to test in the batch)
+             @param(count Ray count to test)
+             @param(maxDistance Maximum hit distance to consider)
+             @param(hits @bold([in, out]) Hit list, should contain at least as many items as the
+                                          batch. The hit of each tested ray is written at the same
+                                          index as the ray in the batch, and m_PolygonIndex is set
+                                          to -1 if the ray hit nothing)
+             @return(Ray count that hit a polygon, 0 if the range is out of bounds)
+             @br @bold(NOTE) This function only reads the tree, so several threads may test
+                             distinct ranges of the same batch at the same time, writing their
+                             result in the same hit list, provided that the tree isn't modified
+                             meanwhile
+            }
+            {$ENDREGION}
+            function RaycastClosest(const rays: TQRRayBatch;
+                                  start, count: NativeUInt;
+                             const maxDistance: Single;
+                                      var hits: TQRRayHits): NativeUInt; overload; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Checks if at least one polygon overlaps a sphere
+             @param(sphere Sphere to test)
+             @return(@true if a polygon overlaps the sphere, otherwise @false)
+            }
+            {$ENDREGION}
+            function OverlapSphere(const sphere: TQRSphere): Boolean; overload; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Gets the polygons overlapping a sphere
+             @param(sphere Sphere to test)
+             @param(indices @bold([in, out]) Index list to populate with the overlapping polygon
+                                             indices, in the polygon array used to populate the
+                                             tree. The list isn't resized, and only the first
+                                             Length(indices) overlapping polygons are written)
+             @return(Overlapping polygon count, may be higher than the index list length, in which
+                     case the query may be repeated with a larger list)
+             @br @bold(NOTE) Nothing is allocated while the query is executed
+            }
+            {$ENDREGION}
+            function OverlapSphere(const sphere: TQRSphere;
+                                    var indices: TQRAABBIndices): NativeUInt; overload; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Checks if at least one polygon overlaps an aligned-axis box
+             @param(box Box to test)
+             @return(@true if a polygon overlaps the box, otherwise @false)
+            }
+            {$ENDREGION}
+            function OverlapBox(const box: TQRBox): Boolean; overload; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Gets the polygons overlapping an aligned-axis box
+             @param(box Box to test)
+             @param(indices @bold([in, out]) Index list to populate with the overlapping polygon
+                                             indices, in the polygon array used to populate the
+                                             tree. The list isn't resized, and only the first
+                                             Length(indices) overlapping polygons are written)
+             @return(Overlapping polygon count, may be higher than the index list length, in which
+                     case the query may be repeated with a larger list)
+             @br @bold(NOTE) Nothing is allocated while the query is executed
+            }
+            {$ENDREGION}
+            function OverlapBox(const box: TQRBox;
+                              var indices: TQRAABBIndices): NativeUInt; overload; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Checks if at least one polygon overlaps a frustum
+             @param(frustum Frustum to test)
+             @return(@true if a polygon overlaps the frustum, otherwise @false)
+            }
+            {$ENDREGION}
+            function OverlapFrustum(const frustum: TQRFrustum): Boolean; overload; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Gets the polygons overlapping a frustum
+             @param(frustum Frustum to test)
+             @param(indices @bold([in, out]) Index list to populate with the overlapping polygon
+                                             indices, in the polygon array used to populate the
+                                             tree. The list isn't resized, and only the first
+                                             Length(indices) overlapping polygons are written)
+             @return(Overlapping polygon count, may be higher than the index list length, in which
+                     case the query may be repeated with a larger list)
+             @br @bold(NOTE) Nothing is allocated while the query is executed
+            }
+            {$ENDREGION}
+            function OverlapFrustum(const frustum: TQRFrustum;
+                                      var indices: TQRAABBIndices): NativeUInt; overload; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Saves the tree content to a stream, in a compact binary format
+             @param(pStream Stream to save to)
+             @return(@true on success, otherwise @false)
+             @br @bold(NOTE) The tree is written from the current stream position, and the stream
+                             position is set after the tree data when function ends
+            }
+            {$ENDREGION}
+            function SaveToStream(pStream: TStream): Boolean; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Loads the tree content from a stream written by SaveToStream
+             @param(pStream Stream to load from)
+             @return(@true on success, otherwise @false)
+             @br @bold(NOTE) The tree is read from the current stream position. The tree content
+                             is validated while loaded, and the tree is left empty if the stream
+                             is corrupted or was written in another format version
+            }
+            {$ENDREGION}
+            function LoadFromStream(pStream: TStream): Boolean; virtual;
+
+        // Properties
+        public
+            {$REGION 'Documentation'}
+            {**
+             Gets or sets the build mode to use while the tree is populated
+             @br @bold(NOTE) Changing the build mode has no effect on an already populated tree
+            }
+            {$ENDREGION}
+            property BuildMode: EQRAABBTreeBuildMode read m_BuildMode write m_BuildMode;
+
+            {$REGION 'Documentation'}
+            {**
+             Gets or sets the maximum thread count to use to build the tree, 0 to use one thread per
+             processor, 1 to build the tree on the calling thread only
+             @br @bold(NOTE) Trees containing less than QR_AABB_Parallel_Min_Polygons polygons are
+                             always built on the calling thread
+            }
+            {$ENDREGION}
+            property MaxThreads: NativeUInt read m_MaxThreads write m_MaxThreads;
+
+            {$REGION 'Documentation'}
+            {**
+             Gets the node at index, the root node is always at index 0
+            }
+            {$ENDREGION}
+            property Nodes[index: NativeUInt]: PQRAABBNode read GetNode;
+
+            {$REGION 'Documentation'}
+            {**
+             Gets the node count
+            }
+            {$ENDREGION}
+            property NodeCount: NativeUInt read m_NodeCount;
+
+            {$REGION 'Documentation'}
+            {**
+             Gets the polygon at index, in the tree internal order
+            }
+            {$ENDREGION}
+            property Polygons[index: NativeUInt]: PQRPolygon read GetPolygon;
+
+            {$REGION 'Documentation'}
+            {**
+             Gets the polygon count
+            }
+            {$ENDREGION}
+            property PolygonCount: NativeUInt read GetPolygonCount;
+    end;
+
+    {$REGION 'Documentation'}
+    {**
+     Called by a build worker to process the pending build tasks
+     @param(hIsCanceled Callback function that allows to break the operation, can be @nil)
+    }
+    {$ENDREGION}
+    TQRAABBBuildProcessEvent = procedure(hIsCanceled: TQRIsCanceledEvent) of object;
+
+    {$REGION 'Documentation'}
+    {**
+     Aligned-axis bounding box tree build worker, processes pending build tasks on a separate
+     thread
+    }
+    {$ENDREGION}
+    TQRAABBTreeBuildWorker = class(TThread)
+        private
+            m_fOnProcess:  TQRAABBBuildProcessEvent;
+            m_hIsCanceled: TQRIsCanceledEvent;
+
+        protected
+            {$REGION 'Documentation'}
+            {**
+             Executes the thread
+            }
+            {$ENDREGION}
+            procedure Execute; override;
+
+        public
+            {$REGION 'Documentation'}
+            {**
+             Constructor
+             @param(fOnProcess Function processing the pending build tasks)
+             @param(hIsCanceled Callback function that allows to break the operation, can be @nil)
+             @br @bold(NOTE) The thread starts immediately
+            }
+            {$ENDREGION}
+            constructor Create(fOnProcess: TQRAABBBuildProcessEvent;
+                              hIsCanceled: TQRIsCanceledEvent); reintroduce; virtual;
+    end;
+
+    {$REGION 'Documentation'}
+    {**
+     Called when a tree was built by a tree builder
+     @param(pTree Built tree)
+     @param(builtCount Tree count already built, including this one)
+     @param(totalCount Total tree count to build)
+     @br @bold(NOTE) This function is called from the build threads, but never concurrently
+    }
+    {$ENDREGION}
+    TQRAABBTreeBuiltEvent = procedure(pTree: TQRAABBTree; builtCount, totalCount: NativeUInt) of object;
+
+    {$REGION 'Documentation'}
+    {**
+     Aligned-axis bounding box tree build item
+    }
+    {$ENDREGION}
+    TQRAABBTreeBuildItem = record
+        {$REGION 'Documentation'}
+        {**
+         Polygons the tree should contain, released once the tree is built
+        }
+        {$ENDREGION}
+        m_Polygons: TQRPolygons;
+
+        {$REGION 'Documentation'}
+        {**
+         Tree to build
+        }
+        {$ENDREGION}
+        m_pTree: TQRAABBTree;
+
+        {$REGION 'Documentation'}
+        {**
+         If @true, the tree was successfully built
+        }
+        {$ENDREGION}
+        m_Success: Boolean;
+    end;
+
+    PQRAABBTreeBuildItem = ^TQRAABBTreeBuildItem;
+
+    {$REGION 'Documentation'}
+    {**
+     Aligned-axis bounding box tree builder, builds several independent trees concurrently, e.g.
+     the trees of each model frame
+    }
+    {$ENDREGION}
+    TQRAABBTreeBuilder = class
+        private
+            m_Items:        array of TQRAABBTreeBuildItem;
+            m_pLock:        TCriticalSection;
+            m_PendingItem:  NativeUInt;
+            m_NextItem:     NativeUInt;
+            m_BuiltCount:   NativeUInt;
+            m_MaxThreads:   NativeUInt;
+            m_Refit:        Boolean;
+            m_fOnTreeBuilt: TQRAABBTreeBuiltEvent;
+
+        protected
+            {$REGION 'Documentation'}
+            {**
+             Builds the pending trees, until no tree remains
+             @param(hIsCanceled Callback function that allows to break the operation, can be @nil)
+             @br @bold(NOTE) This function is called by each build thread, including the calling
+                             thread
+            }
+            {$ENDREGION}
+            procedure ProcessItems(hIsCanceled: TQRIsCanceledEvent); virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Gets the tree count
+             @return(The tree count)
+            }
+            {$ENDREGION}
+            function GetCount: NativeUInt; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Gets the tree at index
+             @param(index Tree index)
+             @return(Tree, @nil if not found or extracted)
+            }
+            {$ENDREGION}
+            function GetTree(index: NativeUInt): TQRAABBTree; virtual;
+
+        public
+            {$REGION 'Documentation'}
+            {**
+             Constructor
+            }
+            {$ENDREGION}
+            constructor Create; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Destructor
+             @br @bold(NOTE) The trees that were not extracted are deleted
+            }
+            {$ENDREGION}
+            destructor Destroy; override;
+
+            {$REGION 'Documentation'}
+            {**
+             Adds a tree to build
+             @param(polygons Polygons the tree should contain)
+             @param(pTree Tree to build)
+             @return(Tree index in the builder)
+             @br @bold(NOTE) From now the builder takes care of the tree, until it is extracted
+             @br @bold(NOTE) Trees may be added after a build, in which case only the newly added
+                             trees are built by the next build
+            }
+            {$ENDREGION}
+            function Add(const polygons: TQRPolygons; pTree: TQRAABBTree): NativeUInt; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Builds the trees added since the previous build, on several threads
+             @param(hIsCanceled Callback function that allows to break the operation, can be @nil)
+             @return(@true if all the trees were built, otherwise @false)
+             @br @bold(NOTE) While several trees are built concurrently, each tree is built on a
+                             single thread, unless there are less trees than threads
+             @br @bold(NOTE) The tree polygons are released as soon as the tree is built, so
+                             adding and building the trees by batches limits the polygon count kept
+                             in memory
+            }
+            {$ENDREGION}
+            function Build(hIsCanceled: TQRIsCanceledEvent = nil): Boolean; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Extracts a tree from the builder, the builder no longer takes care of it
+             @param(index Tree index)
+             @return(Tree, @nil if not found or already extracted)
+            }
+            {$ENDREGION}
+            function Extract(index: NativeUInt): TQRAABBTree; virtual;
+
+        // Properties
+        public
+            {$REGION 'Documentation'}
+            {**
+             Gets the tree at index
+            }
+            {$ENDREGION}
+            property Trees[index: NativeUInt]: TQRAABBTree read GetTree;
+
+            {$REGION 'Documentation'}
+            {**
+             Gets the tree count
+            }
+            {$ENDREGION}
+            property Count: NativeUInt read GetCount;
+
+            {$REGION 'Documentation'}
+            {**
+             Gets or sets the maximum thread count to use, 0 to use one thread per processor
+             @br @bold(NOTE) This limit also applies to the threads a tree build may start, thus
+                             the tree thread count is overwritten while the trees are built
+            }
+            {$ENDREGION}
+            property MaxThreads: NativeUInt read m_MaxThreads write m_MaxThreads;
+
+            {$REGION 'Documentation'}
+            {**
+             Gets or sets if the trees should be refitted. If @true, only the first tree is
+             populated, and the other trees copy his hierarchy and are refitted on their own
+             polygons. All the polygon lists should have the same count and topology, as e.g. the
+             frames of an animated model
+             @br @bold(NOTE) The first tree should not be extracted while other trees remain to be
+                             built
+            }
+            {$ENDREGION}
+            property Refit: Boolean read m_Refit write m_Refit;
+
+            {$REGION 'Documentation'}
+            {**
+             Gets or sets the OnTreeBuilt event, allows e.g. to report the build progress
+            }
+            {$ENDREGION}
+            property OnTreeBuilt: TQRAABBTreeBuiltEvent read m_fOnTreeBuilt write m_fOnTreeBuilt;
+    end;
+
+    {$REGION 'Documentation'}
+    {**
+     Scene tree item, references a model aligned-axis bounding box tree and the matrix placing the
+     model in the scene
+    }
+    {$ENDREGION}
+    TQRAABBSceneItem = record
+        {$REGION 'Documentation'}
+        {**
+         Model tree, expressed in model coordinates
+         @br @bold(NOTE) The tree isn't owned by the scene, and should be kept alive as long as the
+                         scene references it
+        }
+        {$ENDREGION}
+        m_pTree: TQRAABBTree;
+
+        {$REGION 'Documentation'}
+        {**
+         Model matrix, transforms the model coordinates to the scene coordinates
+        }
+        {$ENDREGION}
+        m_Matrix: TQRMatrix4x4;
+
+        {$REGION 'Documentation'}
+        {**
+         Inverse of the model matrix, transforms the scene coordinates to the model coordinates
+        }
+        {$ENDREGION}
+        m_InvMatrix: TQRMatrix4x4;
+
+        {$REGION 'Documentation'}
+        {**
+         Box surrounding the model tree, expressed in scene coordinates
+        }
+        {$ENDREGION}
+        m_Box: TQRBox;
+
+        {$REGION 'Documentation'}
+        {**
+         User data, e.g. the model group owning the tree
+        }
+        {$ENDREGION}
+        m_pData: Pointer;
+
+        {$REGION 'Documentation'}
+        {**
+         If @false, the item is ignored while the scene is queried, because his tree is empty or
+         his matrix cannot be inverted
+        }
+        {$ENDREGION}
+        m_Enabled: Boolean;
+    end;
+
+    PQRAABBSceneItem = ^TQRAABBSceneItem;
+
+    {$REGION 'Documentation'}
+    {**
+     Scene ray hit, contains the result of a closest hit scene ray query
+    }
+    {$ENDREGION}
+    TQRAABBSceneRayHit = record
+        {$REGION 'Documentation'}
+        {**
+         Hit in the model tree. The hit polygon is expressed in model coordinates, whereas the hit
+         distance is expressed in scene ray direction length units, i.e. the hit point in scene
+         coordinates is equal to Pos + (Dir * m_Distance)
+        }
+        {$ENDREGION}
+        m_Hit: TQRRayHit;
+
+        {$REGION 'Documentation'}
+        {**
+         Index of the hit item in the scene, -1 if nothing was hit
+        }
+        {$ENDREGION}
+        m_ItemIndex: NativeInt;
+
+        {$REGION 'Documentation'}
+        {**
+         Hit item user data, @nil if nothing was hit
+        }
+        {$ENDREGION}
+        m_pData: Pointer;
+    end;
+
+    PQRAABBSceneRayHit = ^TQRAABBSceneRayHit;
+
+    {$REGION 'Documentation'}
+    {**
+     Aligned-axis bounding box scene tree. This top level tree surrounds the scene boxes of several
+     model trees, and allows to query all the models at once, without transforming the ray for each
+     of them
+     @br @bold(NOTE) The tree is stored in a flat node array, in the same manner as the model trees.
+                     Each leaf surrounds a contiguous item range in the tree index array. Changing
+                     an item matrix or tree only refits the node boxes, whereas adding or deleting
+                     an item rebuilds the whole hierarchy. In both cases the tree is updated on the
+                     next query, or when Update is called
+    }
+    {$ENDREGION}
+    TQRAABBSceneTree = class
+        private
+            m_Items:     array of TQRAABBSceneItem;
+            m_Nodes:     TQRAABBNodes;
+            m_Indices:   TQRAABBIndices;
+            m_Centers:   array of TQRVector3D;
+            m_NodeCount: NativeUInt;
+            m_Rebuild:   Boolean;
+            m_Refit:     Boolean;
+
+        protected
+            {$REGION 'Documentation'}
+            {**
+             Adds a box to a bounding box
+             @param(box Box to add)
+             @param(pBox Bounding box to extend)
+             @param(empty @bold([in, out]) If @true, the bounding box is empty and will be
+                                           initialized with the box to add)
+            }
+            {$ENDREGION}
+            procedure AddBoxToBoundingBox(const box: TQRBox;
+                                               pBox: PQRBox;
+                                          var empty: Boolean); virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Calculates the inverse matrix and the scene box of an item
+             @param(pItem Item to update)
+            }
+            {$ENDREGION}
+            procedure UpdateItem(pItem: PQRAABBSceneItem); virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Populates a node and his children
+             @param(nodeIndex Index of the node to populate)
+             @param(start First item the node surrounds in the tree index array)
+             @param(count Item count the node surrounds)
+             @param(depth Node depth in the tree)
+            }
+            {$ENDREGION}
+            procedure Populate(nodeIndex: Integer; start, count, depth: NativeUInt); virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Rebuilds the tree hierarchy from the enabled items
+            }
+            {$ENDREGION}
+            procedure Rebuild; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Refits the node boxes on the item boxes, from the leaves to the root
+            }
+            {$ENDREGION}
+            procedure Refit; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Gets item at index
+             @param(index Item index)
+             @return(Item, @nil if not found)
+            }
+            {$ENDREGION}
+            function GetItem(index: NativeUInt): PQRAABBSceneItem; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Gets item count
+             @return(Item count)
+            }
+            {$ENDREGION}
+            function GetCount: NativeUInt; virtual;
+
+        public
+            {$REGION 'Documentation'}
+            {**
+             Constructor
+            }
+            {$ENDREGION}
+            constructor Create; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Destructor
+            }
+            {$ENDREGION}
+            destructor Destroy; override;
+
+            {$REGION 'Documentation'}
+            {**
+             Clears the scene
+            }
+            {$ENDREGION}
+            procedure Clear; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Adds a model tree to the scene
+             @param(pTree Model tree, expressed in model coordinates)
+             @param(matrix Model matrix, transforms the model coordinates to the scene coordinates)
+             @param(pData User data, e.g. the model group owning the tree, can be @nil)
+             @return(Added item index)
+             @br @bold(NOTE) The tree isn't owned by the scene, and should be kept alive as long as
+                             the scene references it
+            }
+            {$ENDREGION}
+            function Add(pTree: TQRAABBTree;
+                const matrix: TQRMatrix4x4;
+                       pData: Pointer = nil): NativeUInt; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Deletes an item from the scene
+             @param(index Item index to delete)
+             @br @bold(NOTE) The indices of the next items are decreased by one
+            }
+            {$ENDREGION}
+            procedure Delete(index: NativeUInt); virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Sets an item model matrix, e.g. when the model moved
+             @param(index Item index)
+             @param(matrix New model matrix)
+            }
+            {$ENDREGION}
+            procedure SetMatrix(index: NativeUInt; const matrix: TQRMatrix4x4); virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Sets an item model tree, e.g. when the model animation shows another frame
+             @param(index Item index)
+             @param(pTree New model tree)
+            }
+            {$ENDREGION}
+            procedure SetTree(index: NativeUInt; pTree: TQRAABBTree); virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Rebuilds or refits the tree if items were added, deleted or modified since the last
+             update
+             @br @bold(NOTE) This function is called automatically before each query. Calling it
+                             explicitly allows to choose when the update cost is paid, and to query
+                             the scene from several threads once updated
+            }
+            {$ENDREGION}
+            procedure Update; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Gets the polygon closest to the ray position that the ray intersects in all the scene
+             models
+             @param(pRay Ray to test, expressed in scene coordinates)
+             @param(hit @bold([out]) Closest hit, m_ItemIndex is set to -1 if nothing was hit)
+             @return(@true if the ray hit a polygon, otherwise @false)
+            }
+            {$ENDREGION}
+            function RaycastClosest(const pRay: TQRRay;
+                                       out hit: TQRAABBSceneRayHit): Boolean; overload; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Gets the polygon closest to the ray position that the ray intersects in all the scene
+             models
+             @param(pRay Ray to test, expressed in scene coordinates)
+             @param(maxDistance Maximum hit distance to consider, in ray direction length units)
+             @param(hit @bold([out]) Closest hit, m_ItemIndex is set to -1 if nothing was hit)
+             @return(@true if the ray hit a polygon, otherwise @false)
+             @br @bold(NOTE) The model subtrees farther than the best hit found so far are skipped,
+                             as well as the models whose scene box is farther
+            }
+            {$ENDREGION}
+            function RaycastClosest(const pRay: TQRRay;
+                             const maxDistance: Single;
+                                       out hit: TQRAABBSceneRayHit): Boolean; overload; virtual;
+
+        // Properties
+        public
+            {$REGION 'Documentation'}
+            {**
+             Gets the item at index
+            }
+            {$ENDREGION}
+            property Items[index: NativeUInt]: PQRAABBSceneItem read GetItem;
+
+            {$REGION 'Documentation'}
+            {**
+             Gets the item count
+            }
+            {$ENDREGION}
+            property Count: NativeUInt read GetCount;
+    end;
+
+    {$REGION 'Documentation'}
+    {**
+     3D collision detection helper
+    }
+    {$ENDREGION}
+    TQRCollisionHelper = class
+        protected
+            {$REGION 'Documentation'}
+            {**
+             Adds polygon to array
+             @param(vb Source vertex buffer)
+             @param(v1 First polygon vertex index in vertex buffer)
+             @param(v2 Second polygon vertex index in vertex buffer)
+             @param(v3 Third polygon vertex index in vertex buffer)
+             @param(polygons @bold([in, out]) Polygon array that contains generated polygons)
+             @br @bold(NOTE) Generated polygons should be deleted when useless
+            }
+            {$ENDREGION}
+            class procedure AddPolygon(const vb: TQRVertexBuffer;
+                                     v1, v2, v3: NativeUInt;
+                                   var polygons: TQRPolygons); static;
+
+            {$REGION 'Documentation'}
+            {**
+             Gets the distances where a ray enters and exits a box slab on a single axis
+             @param(boxMin Box min edge on the axis)
+             @param(boxMax Box max edge on the axis)
+             @param(rayPos Ray position on the axis)
+             @param(rayInvDir Inverse of the ray direction on the axis)
+             @param(tNear @bold([out]) Distance where the ray enters the slab)
+             @param(tFar @bold([out]) Distance where the ray exits the slab)
+             @return(@true if the ray crosses the slab, @false if it is parallel and outside)
+            }
+            {$ENDREGION}
+            class function GetRaySlabCollision(const boxMin, boxMax, rayPos, rayInvDir: Single;
+                                                                out tNear, tFar: Single): Boolean; static;
+
+            {$REGION 'Documentation'}
+            {**
+             Checks if an axis separates a triangle from a box centered on the origin
+             @param(axis Axis to test, not necessarily normalized)
+             @param(v1 First triangle vertex, relative to the box center)
+             @param(v2 Second triangle vertex, relative to the box center)
+             @param(v3 Third triangle vertex, relative to the box center)
+             @param(extents Box half size on each axis)
+             @return(@true if the axis separates the triangle from the box, otherwise @false)
+            }
+            {$ENDREGION}
+            class function IsSeparatingAxis(const axis, v1, v2, v3, extents: TQRVector3D): Boolean; static;
+
+        public
+            {$REGION 'Documentation'}
+            {**
+             Tests collision between a ray and a polygon
+             @param(pRay Ray)
+             @param(polygon Polygon to check)
+             @return(@true if ray intersects polygon, otherwise @false)
+             @br @bold(NOTE) The ray is considered as an infinite line, i.e. polygons located
+                             behind the ray position are also detected
+            }
+            {$ENDREGION}
+            class function GetRayPolygonCollision(const pRay: TQRRay;
+                                               const polygon: TQRPolygon): Boolean; static;
+
+            {$REGION 'Documentation'}
+            {**
+             Tests collision between a ray and a triangle polygon, using the Moller-Trumbore
+             algorithm, and gets the hit location
+             @param(pRay Ray)
+             @param(polygon Polygon to check)
+             @param(distance @bold([out]) Distance between the ray position and the hit point,
+                                          negative if the hit point is behind the ray position)
+             @param(u @bold([out]) Hit point barycentric coordinate matching with second vertex)
+             @param(v @bold([out]) Hit point barycentric coordinate matching with third vertex)
+             @return(@true if ray line intersects polygon, otherwise @false)
+            }
+            {$ENDREGION}
+            class function GetRayTriangleCollision(const pRay: TQRRay;
+                                                const polygon: TQRPolygon;
+                                            out distance, u, v: Single): Boolean; overload; static;
+
+            {$REGION 'Documentation'}
+            {**
+             Tests collision between a ray and a triangle polygon, using the Moller-Trumbore
+             algorithm, and gets the hit location
+             @param(rayPos Ray position)
+             @param(rayDir Ray direction)
+             @param(polygon Polygon to check)
+             @param(distance @bold([out]) Distance between the ray position and the hit point,
+                                          negative if the hit point is behind the ray position)
+             @param(u @bold([out]) Hit point barycentric coordinate matching with second vertex)
+             @param(v @bold([out]) Hit point barycentric coordinate matching with third vertex)
+             @return(@true if ray line intersects polygon, otherwise @false)
+            }
+            {$ENDREGION}
+            class function GetRayTriangleCollision(const rayPos, rayDir: TQRVector3D;
+                                                        const polygon: TQRPolygon;
+                                                    out distance, u, v: Single): Boolean; overload; static;
+
+            {$REGION 'Documentation'}
+            {**
+             Gets the closest triangle polygon, located in front of the ray position, that a ray
+             intersects in a polygon list
+             @param(pRay Ray)
+             @param(pPolygons First polygon of the list to check)
+             @param(count Polygon count to check)
+             @param(hit @bold([in, out]) Closest hit, only polygons closer than hit.m_Distance are
+                                         considered, and on success m_PolygonIndex is set to the
+                                         polygon index in the list)
+             @return(@true if a closer polygon was hit, otherwise @false)
+            }
+            {$ENDREGION}
+            class function GetRayTriangleCollision(const pRay: TQRRay;
+                                              const pPolygons: PQRPolygon;
+                                                        count: NativeUInt;
+                                                      var hit: TQRRayHit): Boolean; overload; static;
+
+            {$REGION 'Documentation'}
+            {**
+             Gets the closest triangle polygon, located in front of the ray position, that a ray
+             intersects in a polygon list
+             @param(rayPos Ray position)
+             @param(rayDir Ray direction)
+             @param(pPolygons First polygon of the list to check)
+             @param(count Polygon count to check)
+             @param(hit @bold([in, out]) Closest hit, only polygons closer than hit.m_Distance are
+                                         considered, and on success m_PolygonIndex is set to the
+                                         polygon index in the list)
+             @return(@true if a closer polygon was hit, otherwise @false)
+            }
+            {$ENDREGION}
+            class function GetRayTriangleCollision(const rayPos, rayDir: TQRVector3D;
+                                                      const pPolygons: PQRPolygon;
+                                                                count: NativeUInt;
+                                                              var hit: TQRRayHit): Boolean; overload; static;
+
+            {$REGION 'Documentation'}
+            {**
+             Gets the closest triangle polygon, located in front of the ray position, that a ray
+             intersects in a polygon list
+             @param(pRay Ray)
+             @param(polygons Polygon list to check)
+             @param(hit @bold([out]) Closest hit, m_PolygonIndex is set to -1 if nothing was hit)
+             @return(@true if a polygon was hit, otherwise @false)
+            }
+            {$ENDREGION}
+            class function GetRayTriangleCollision(const pRay: TQRRay;
+                                             const polygons: TQRPolygons;
+                                                    out hit: TQRRayHit): Boolean; overload; static;
+
+            {$REGION 'Documentation'}
+            {**
+             Tests collision between a ray and a box
+             @param(pRay Ray)
+             @param(pBox Box)
+             @return(@true if ray intersects box, otherwise @false)
+            }
+            {$ENDREGION}
+            class function GetRayBoxCollision(const pRay: TQRRay; const pBox: PQRBox): Boolean; overload; static;
+
+            {$REGION 'Documentation'}
+            {**
+             Tests collision between a ray and a box, and gets the distances where the ray enters
+             and exits the box
+             @param(pRay Ray)
+             @param(pBox Box)
+             @param(tNear @bold([out]) Distance where the ray enters the box, may be negative if
+                                       the ray position is inside the box)
+             @param(tFar @bold([out]) Distance where the ray exits the box)
+             @return(@true if ray intersects box, otherwise @false)
+            }
+            {$ENDREGION}
+            class function GetRayBoxCollision(const pRay: TQRRay;
+                                              const pBox: PQRBox;
+                                         out tNear, tFar: Single): Boolean; overload; static;
+
+            {$REGION 'Documentation'}
+            {**
+             Gets the inverse of a ray direction component, to use in a ray packet
+             @param(value Direction component)
+             @return(Inverse direction component, QR_Ray_Packet_Max_Inv_Dir with the matching sign
+                     instead of an infinite value if the component is equal to 0)
+            }
+            {$ENDREGION}
+            class function GetPacketInvDir(const value: Single): Single; static; inline;
+
+            {$REGION 'Documentation'}
+            {**
+             Tests collision between the rays of a packet and a box
+             @param(packet Ray packet)
+             @param(box Box)
+             @param(mask Mask of the packet rays to test, bit n matches with ray n)
+             @param(tMin @bold([out]) Smallest distance where a ray enters the box, among the rays
+                                      hitting it, clamped to 0)
+             @return(Mask of the tested rays that intersect the box in front of their position, and
+                     not farther than their best hit)
+            }
+            {$ENDREGION}
+            class function GetRayPacketBoxCollision(const packet: TQRRayPacket;
+                                                       const box: TQRBox;
+                                                            mask: Byte;
+                                                        out tMin: Single): Byte; static;
+
+            {$REGION 'Documentation'}
+            {**
+             Gets the point of a triangle polygon closest to another point
+             @param(point Point)
+             @param(polygon Polygon)
+             @return(Closest point, located on the polygon surface or edges)
+            }
+            {$ENDREGION}
+            class function GetClosestPointOnTriangle(const point: TQRVector3D;
+                                                   const polygon: TQRPolygon): TQRVector3D; static;
+
+            {$REGION 'Documentation'}
+            {**
+             Tests collision between a sphere and a box
+             @param(sphere Sphere)
+             @param(box Box)
+             @return(@true if sphere intersects box, otherwise @false)
+            }
+            {$ENDREGION}
+            class function GetSphereBoxCollision(const sphere: TQRSphere;
+                                                    const box: TQRBox): Boolean; static;
+
+            {$REGION 'Documentation'}
+            {**
+             Tests collision between 2 boxes
+             @param(box1 First box)
+             @param(box2 Second box)
+             @return(@true if boxes intersect, otherwise @false)
+            }
+            {$ENDREGION}
+            class function GetBoxBoxCollision(const box1, box2: TQRBox): Boolean; static;
+
+            {$REGION 'Documentation'}
+            {**
+             Tests collision between a frustum and a box
+             @param(frustum Frustum)
+             @param(box Box)
+             @return(@true if box is inside or intersects frustum, otherwise @false)
+             @br @bold(NOTE) The test is conservative, i.e. a box located outside the frustum,
+                             near a frustum corner, may be detected as intersecting it
+            }
+            {$ENDREGION}
+            class function GetFrustumBoxCollision(const frustum: TQRFrustum;
+                                                      const box: TQRBox): Boolean; static;
+
+            {$REGION 'Documentation'}
+            {**
+             Tests collision between a sphere and a triangle polygon
+             @param(sphere Sphere)
+             @param(polygon Polygon)
+             @return(@true if sphere intersects polygon, otherwise @false)
+            }
+            {$ENDREGION}
+            class function GetSphereTriangleCollision(const sphere: TQRSphere;
+                                                     const polygon: TQRPolygon): Boolean; static;
+
+            {$REGION 'Documentation'}
+            {**
+             Tests collision between a box and a triangle polygon, using the separating axis theorem
+             @param(box Box)
+             @param(polygon Polygon)
+             @return(@true if box intersects polygon, otherwise @false)
+            }
+            {$ENDREGION}
+            class function GetBoxTriangleCollision(const box: TQRBox;
+                                               const polygon: TQRPolygon): Boolean; static;
+
+            {$REGION 'Documentation'}
+            {**
+             Tests collision between a frustum and a triangle polygon
+             @param(frustum Frustum)
+             @param(polygon Polygon)
+             @return(@true if polygon is inside or intersects frustum, otherwise @false)
+             @br @bold(NOTE) The test is conservative, i.e. a polygon located outside the frustum,
+                             near a frustum corner, may be detected as intersecting it
+            }
+            {$ENDREGION}
+            class function GetFrustumTriangleCollision(const frustum: TQRFrustum;
+                                                       const polygon: TQRPolygon): Boolean; static;
+
+            {$REGION 'Documentation'}
+            {**
+             Extracts the frustum planes from a matrix
+             @param(matrix Matrix, usually the view matrix multiplied by the projection matrix)
+             @return(Frustum)
+             @br @bold(NOTE) Extracting the frustum from a model, view and projection matrix product
+                             gives the frustum in model coordinates, that can be used directly to
+                             query the model tree
+            }
+            {$ENDREGION}
+            class function GetFrustum(const matrix: TQRMatrix4x4): TQRFrustum; static;
+
+            {$REGION 'Documentation'}
+            {**
+             Gets polygons from vertex
+             @param(vertex Source vertex descriptor, contains buffer to get from)
+             @param(polygons @bold([in, out]) Polygon list to populate)
+             @param(hIsCanceled Callback function that allows to break the operation, can be @nil)
+             @return(@true on success, otherwise @false)
+             @br @bold(NOTE) Polygon list content should be deleted when useless
+            }
+            {$ENDREGION}
+            class function GetPolygons(const vertex: TQRVertex;
+                                       var polygons: TQRPolygons;
+                                        hIsCanceled: TQRIsCanceledEvent = nil): Boolean; static;
+    end;
+
+implementation
+//--------------------------------------------------------------------------------------------------
+// TQRRayBatch
+//--------------------------------------------------------------------------------------------------
+function TQRRayBatch.GetCount: NativeUInt;
+begin
+    Result := Length(m_PosX);
+end;
+//--------------------------------------------------------------------------------------------------
+procedure TQRRayBatch.SetCount(value: NativeUInt);
+begin
+    SetLength(m_PosX, value);
+    SetLength(m_PosY, value);
+    SetLength(m_PosZ, value);
+    SetLength(m_DirX, value);
+    SetLength(m_DirY, value);
+    SetLength(m_DirZ, value);
+end;
+//--------------------------------------------------------------------------------------------------
+procedure TQRRayBatch.SetRay(index: NativeUInt; const pos, dir: TQRVector3D);
+begin
+    m_PosX[index] := pos.X;
+    m_PosY[index] := pos.Y;
+    m_PosZ[index] := pos.Z;
+    m_DirX[index] := dir.X;
+    m_DirY[index] := dir.Y;
+    m_DirZ[index] := dir.Z;
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRRayBatch.GetPos(index: NativeUInt): TQRVector3D;
+begin
+    Result := TQRVector3D.Create(m_PosX[index], m_PosY[index], m_PosZ[index]);
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRRayBatch.GetDir(index: NativeUInt): TQRVector3D;
+begin
+    Result := TQRVector3D.Create(m_DirX[index], m_DirY[index], m_DirZ[index]);
+end;
+//--------------------------------------------------------------------------------------------------
+// TQRAABBTree
+//--------------------------------------------------------------------------------------------------
+constructor TQRAABBTree.Create;
+begin
+    inherited Create;
+
+    m_pTaskLock  := nil;
+    m_NextTask   := 0;
+    m_TaskDepth  := 0;
+    m_NodeCount  := 0;
+    m_MaxThreads := 0;
+    m_BuildMode  := EQR_BM_Midpoint;
+end;
+//--------------------------------------------------------------------------------------------------
+destructor  TQRAABBTree.Destroy;
+begin
+    // delete entire tree hierarchy
+    Release;
+
+    inherited Destroy;
+end;
+//--------------------------------------------------------------------------------------------------
+procedure TQRAABBTree.Release;
+begin
+    SetLength(m_Nodes,    0);
+    SetLength(m_Polygons, 0);
+    SetLength(m_Indices,  0);
+    SetLength(m_Centers,  0);
+    SetLength(m_Tasks,    0);
+
+    m_NodeCount := 0;
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRAABBTree.ValueIsBetween(const value, valueStart, valueEnd, epsilon: Single): Boolean;
+var
+    minVal, maxVal: Single;
+begin
+    minVal := Min(valueStart, valueEnd);
+    maxVal := Max(valueStart, valueEnd);
+
+    // check if each value is between start and end limits considering tolerance
+    Result := ((value >= (minVal - epsilon)) and (value <= (maxVal + epsilon)));
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRAABBTree.VectorIsBetween(const point, pointStart, pointEnd: TQRVector3D;
+                                                         const epsilon: Single): Boolean;
+begin
+    // check if each vector component is between start and end limits
+    Result := (ValueIsBetween(point.X, pointStart.X, pointEnd.X, epsilon) and
+               ValueIsBetween(point.Y, pointStart.Y, pointEnd.Y, epsilon) and
+               ValueIsBetween(point.Z, pointStart.Z, pointEnd.Z, epsilon));
+end;
+//--------------------------------------------------------------------------------------------------
+procedure TQRAABBTree.AddPolygonToBoundingBox(const polygon: TQRPolygon;
+                                                       pBox: PQRBox;
+                                                  var empty: Boolean);
+var
+    i: Byte;
+begin
+    // no box to add to
+    if (not Assigned(pBox)) then
+        Exit;
+
+    // iterate through polygon vertices
+    for i := 0 to 2 do
+    begin
+        // is box empty?
+        if (empty) then
+        begin
+            // initialize bounding box with first vertex
+            pBox.Min.Assign(polygon.GetVertex(i));
+            pBox.Max.Assign(polygon.GetVertex(i));
+            empty := False;
+            continue;
+        end;
+
+        // search for box min edge
+        pBox.Min.Assign(TQRVector3D.Create(Min(pBox.Min.X, polygon.GetVertex(i).X),
+                                           Min(pBox.Min.Y, polygon.GetVertex(i).Y),
+                                           Min(pBox.Min.Z, polygon.GetVertex(i).Z)));
+
+        // search for box max edge
+        pBox.Max.Assign(TQRVector3D.Create(Max(pBox.Max.X, polygon.GetVertex(i).X),
+                                           Max(pBox.Max.Y, polygon.GetVertex(i).Y),
+                                           Max(pBox.Max.Z, polygon.GetVertex(i).Z)));
+    end;
+end;
+//--------------------------------------------------------------------------------------------------
+procedure TQRAABBTree.AddBoxToBoundingBox(const box: TQRBox;
+                                               pBox: PQRBox;
+                                          var empty: Boolean);
+begin
+    // no box to add to
+    if (not Assigned(pBox)) then
+        Exit;
+
+    // is box empty?
+    if (empty) then
+    begin
+        // initialize bounding box with the box to add
+        pBox.Min.Assign(box.Min^);
+        pBox.Max.Assign(box.Max^);
+        empty := False;
+        Exit;
+    end;
+
+    // search for box min edge
+    pBox.Min.Assign(TQRVector3D.Create(Min(pBox.Min.X, box.Min.X),
+                                       Min(pBox.Min.Y, box.Min.Y),
+                                       Min(pBox.Min.Z, box.Min.Z)));
+
+    // search for box max edge
+    pBox.Max.Assign(TQRVector3D.Create(Max(pBox.Max.X, box.Max.X),
+                                       Max(pBox.Max.Y, box.Max.Y),
+                                       Max(pBox.Max.Z, box.Max.Z)));
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRAABBTree.GetBoxArea(const box: TQRBox): Single;
+var
+    x, y, z: Single;
+begin
+    // calculate each edge length
+    x := box.Max.X - box.Min.X;
+    y := box.Max.Y - box.Min.Y;
+    z := box.Max.Z - box.Min.Z;
+
+    Result := 2.0 * ((x * y) + (y * z) + (z * x));
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRAABBTree.GetAxisValue(const vector: TQRVector3D; axis: NativeUInt): Single;
+begin
+    case axis of
+        0: Result := vector.X;
+        1: Result := vector.Y;
+    else
+        Result := vector.Z;
+    end;
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRAABBTree.AddNode(pTask: PQRAABBBuildTask): Integer;
+begin
+    // add node to a subtree build task?
+    if (Assigned(pTask)) then
+    begin
+        // node array is full? (should never happen, as it is allocated for the worst case)
+        if (pTask.m_NodeCount >= NativeUInt(Length(pTask.m_Nodes))) then
+            SetLength(pTask.m_Nodes, Max(1, Length(pTask.m_Nodes) * 2));
+
+        Result := pTask.m_NodeCount;
+        Inc(pTask.m_NodeCount);
+        Exit;
+    end;
+
+    // node array is full? (should never happen, as it is allocated for the worst case while the
+    // tree is populated)
+    if (m_NodeCount >= NativeUInt(Length(m_Nodes))) then
+        SetLength(m_Nodes, Max(1, Length(m_Nodes) * 2));
+
+    Result := m_NodeCount;
+    Inc(m_NodeCount);
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRAABBTree.GetBuildNode(pTask: PQRAABBBuildTask; index: Integer): PQRAABBNode;
+begin
+    if (Assigned(pTask)) then
+        Result := @pTask.m_Nodes[index]
+    else
+        Result := @m_Nodes[index];
+end;
+//--------------------------------------------------------------------------------------------------
+procedure TQRAABBTree.SwapIndices(first, second: NativeUInt);
+var
+    index: Cardinal;
+begin
+    index             := m_Indices[first];
+    m_Indices[first]  := m_Indices[second];
+    m_Indices[second] := index;
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRAABBTree.SplitMidpoint(const box: TQRBox;
+                                start, count: NativeUInt;
+                               out leftCount: NativeUInt;
+                                 hIsCanceled: TQRIsCanceledEvent): Boolean;
+var
+    first, last:                NativeInt;
+    i:                          Byte;
+    nodeBox, leftBox, rightBox: TQRBox;
+    isLeft:                     Boolean;
+begin
+    leftCount := 0;
+    nodeBox   := box;
+
+    // divide box in 2 sub-boxes
+    nodeBox.Cut(leftBox, rightBox);
+
+    first := start;
+    last  := NativeInt(start + count) - 1;
+
+    // move the polygons belonging to the left box on the range beginning, and the polygons
+    // belonging to the right box on the range end
+    while (first <= last) do
+    begin
+        // is canceled?
+        if (Assigned(hIsCanceled) and hIsCanceled) then
+            Exit(False);
+
+        isLeft := False;
+
+        // the first polygon vertex found inside a sub-box decides to which side the polygon belongs
+        for i := 0 to 2 do
+            if (VectorIsBetween(m_Polygons[m_Indices[first]].GetVertex(i),
+                                leftBox.Min^,
+                                leftBox.Max^,
+                                QR_Epsilon))
+            then
+            begin
+                isLeft := True;
+                break;
+            end
+            else
+            if (VectorIsBetween(m_Polygons[m_Indices[first]].GetVertex(i),
+                                rightBox.Min^,
+                                rightBox.Max^,
+                                QR_Epsilon))
+            then
+                break;
+
+        if (isLeft) then
+            Inc(first)
+        else
+        begin
+            SwapIndices(first, last);
+            Dec(last);
+        end;
+    end;
+
+    leftCount := NativeUInt(first) - start;
+    Result    := True;
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRAABBTree.SplitSAH(const box: TQRBox;
+                           start, count: NativeUInt;
+                          out leftCount: NativeUInt;
+                            hIsCanceled: TQRIsCanceledEvent): Boolean;
+var
+    axis, bestAxis, bin, bestBin, i: NativeUInt;
+    sideCount:                       NativeUInt;
+    first, last:                     NativeInt;
+    binBoxes:                        array [0..QR_SAH_Bin_Count - 1] of TQRBox;
+    binEmpty:                        array [0..QR_SAH_Bin_Count - 1] of Boolean;
+    binCounts, leftCounts:           array [0..QR_SAH_Bin_Count - 1] of NativeUInt;
+    leftAreas:                       array [0..QR_SAH_Bin_Count - 1] of Single;
+    center:                          TQRVector3D;
+    centerBox, accumBox:             TQRBox;
+    centerMin, extent, scale:        Single;
+    cost, bestCost, nodeArea:        Single;
+    centerEmpty, accumEmpty:         Boolean;
+begin
+    leftCount := 0;
+
+    // too few polygons to be split?
+    if (count < 2) then
+        Exit(True);
+
+    nodeArea := GetBoxArea(box);
+
+    // flat box, the heuristic cannot be applied
+    if (nodeArea <= 0.0) then
+        Exit(SplitMidpoint(box, start, count, leftCount, hIsCanceled));
+
+    centerEmpty := True;
+
+    // calculate the box surrounding the polygon centers
+    for i := start to start + count - 1 do
+    begin
+        center := m_Centers[m_Indices[i]];
+
+        if (centerEmpty) then
+        begin
+            centerBox.Min.Assign(center);
+            centerBox.Max.Assign(center);
+            centerEmpty := False;
+            continue;
+        end;
+
+        centerBox.Min.Assign(TQRVector3D.Create(Min(centerBox.Min.X, center.X),
+                                                Min(centerBox.Min.Y, center.Y),
+                                                Min(centerBox.Min.Z, center.Z)));
+        centerBox.Max.Assign(TQRVector3D.Create(Max(centerBox.Max.X, center.X),
+                                                Max(centerBox.Max.Y, center.Y),
+                                                Max(centerBox.Max.Z, center.Z)));
+    end;
+
+    // keeping all the polygons in a leaf costs one intersection test per polygon
+    bestCost := count;
+    bestAxis := 0;
+    bestBin  := 0;
+
+    // iterate through axis to evaluate
+    for axis := 0 to 2 do
+    begin
+        // is canceled?
+        if (Assigned(hIsCanceled) and hIsCanceled) then
+            Exit(False);
+
+        centerMin := GetAxisValue(centerBox.Min^, axis);
+        extent    := GetAxisValue(centerBox.Max^, axis) - centerMin;
+
+        // all polygon centers are on the same position on this axis, nothing to split
+        if (extent <= QR_Epsilon) then
+            continue;
+
+        scale := QR_SAH_Bin_Count / extent;
+
+        // clear bins
+        for bin := 0 to QR_SAH_Bin_Count - 1 do
+        begin
+            binEmpty[bin]  := True;
+            binCounts[bin] := 0;
+        end;
+
+        // distribute polygons in bins
+        for i := start to start + count - 1 do
+        begin
+            bin := Min(Trunc((GetAxisValue(m_Centers[m_Indices[i]], axis) - centerMin) * scale),
+                       QR_SAH_Bin_Count - 1);
+
+            AddPolygonToBoundingBox(m_Polygons[m_Indices[i]], @binBoxes[bin], binEmpty[bin]);
+            Inc(binCounts[bin]);
+        end;
+
+        accumEmpty := True;
+        sideCount  := 0;
+
+        // sweep from left to right to get the area and polygon count on the left of each boundary
+        for bin := 0 to QR_SAH_Bin_Count - 2 do
+        begin
+            if (not binEmpty[bin]) then
+                AddBoxToBoundingBox(binBoxes[bin], @accumBox, accumEmpty);
+
+            Inc(sideCount, binCounts[bin]);
+            leftCounts[bin] := sideCount;
+
+            if (accumEmpty) then
+                leftAreas[bin] := 0.0
+            else
+                leftAreas[bin] := GetBoxArea(accumBox);
+        end;
+
+        accumEmpty := True;
+        sideCount  := 0;
+
+        // sweep from right to left and evaluate the cost of each boundary
+        for bin := QR_SAH_Bin_Count - 1 downto 1 do
+        begin
+            if (not binEmpty[bin]) then
+                AddBoxToBoundingBox(binBoxes[bin], @accumBox, accumEmpty);
+
+            Inc(sideCount, binCounts[bin]);
+
+            // one of the sides is empty, not a valid split
+            if ((sideCount = 0) or (leftCounts[bin - 1] = 0)) then
+                continue;
+
+            // calculate the split cost, i.e. the probability to hit each side multiplied by the
+            // polygon count it contains
+            cost := QR_SAH_Traversal_Cost +
+                    (((leftAreas[bin - 1] * leftCounts[bin - 1]) +
+                      (GetBoxArea(accumBox) * sideCount)) / nodeArea);
+
+            if (cost < bestCost) then
+            begin
+                bestCost := cost;
+                bestAxis := axis;
+                bestBin  := bin;
+            end;
+        end;
+    end;
+
+    // no split cheaper than a leaf was found?
+    if (bestBin = 0) then
+    begin
+        // small enough to become a leaf
+        if (count <= QR_SAH_Max_Leaf_Polygons) then
+            Exit(True);
+
+        // too many polygons for a leaf, fallback to a midpoint split
+        Exit(SplitMidpoint(box, start, count, leftCount, hIsCanceled));
+    end;
+
+    centerMin := GetAxisValue(centerBox.Min^, bestAxis);
+    scale     := QR_SAH_Bin_Count / (GetAxisValue(centerBox.Max^, bestAxis) - centerMin);
+    first     := start;
+    last      := NativeInt(start + count) - 1;
+
+    // move the polygons located before the best boundary on the range beginning, and the others on
+    // the range end
+    while (first <= last) do
+    begin
+        bin := Min(Trunc((GetAxisValue(m_Centers[m_Indices[first]], bestAxis) - centerMin) * scale),
+                   QR_SAH_Bin_Count - 1);
+
+        if (bin < bestBin) then
+            Inc(first)
+        else
+        begin
+            SwapIndices(first, last);
+            Dec(last);
+        end;
+    end;
+
+    leftCount := NativeUInt(first) - start;
+    Result    := True;
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRAABBTree.Populate(nodeIndex: Integer;
+                    start, count, depth: NativeUInt;
+                                  pTask: PQRAABBBuildTask;
+                            hIsCanceled: TQRIsCanceledEvent): Boolean;
+var
+    i, leftCount:          NativeUInt;
+    leftIndex, rightIndex: Integer;
+    pNode:                 PQRAABBNode;
+    boxEmpty:              Boolean;
+begin
+    boxEmpty := True;
+    Result   := False;
+    pNode    := GetBuildNode(pTask, nodeIndex);
+
+    // initialize node content
+    pNode.m_Box   := Default(TQRBox);
+    pNode.m_Left  := -1;
+    pNode.m_Right := -1;
+    pNode.m_Start := start;
+    pNode.m_Count := count;
+
+    // is canceled?
+    if (Assigned(hIsCanceled) and hIsCanceled) then
+        Exit;
+
+    // nothing to divide?
+    if (count = 0) then
+        Exit(True);
+
+    // iterate through polygons to divide
+    for i := start to start + count - 1 do
+        // calculate bounding box
+        AddPolygonToBoundingBox(m_Polygons[m_Indices[i]], @pNode.m_Box, boxEmpty);
+
+    // maximum depth reached? Keep the node as a leaf
+    if (depth >= QR_AABB_Max_Depth) then
+        Exit(True);
+
+    // task depth reached while the tree is built on several threads? Keep the node as a leaf
+    // for now, the subtree will be built later by a build thread
+    if ((not Assigned(pTask)) and (m_TaskDepth > 0) and (depth >= m_TaskDepth)) then
+    begin
+        i := Length(m_Tasks);
+        SetLength(m_Tasks, i + 1);
+
+        m_Tasks[i].m_NodeIndex := nodeIndex;
+        m_Tasks[i].m_NodeCount := 0;
+        m_Tasks[i].m_Start     := start;
+        m_Tasks[i].m_Count     := count;
+        m_Tasks[i].m_Depth     := depth;
+        m_Tasks[i].m_Success   := False;
+
+        Exit(True);
+    end;
+
+    // split the polygons on the left and right sides, using the selected build mode
+    case m_BuildMode of
+        EQR_BM_SAH:
+            if (not SplitSAH(pNode.m_Box, start, count, leftCount, hIsCanceled)) then
+                Exit;
+    else
+        if (not SplitMidpoint(pNode.m_Box, start, count, leftCount, hIsCanceled)) then
+            Exit;
+    end;
+
+    // leaf reached?
+    if ((leftCount = 0) or (leftCount >= count)) then
+        Exit(True);
+
+    // create and populate left node. NOTE the node array may be reallocated while a node is added,
+    // so the node should be get again
+    leftIndex                             := AddNode(pTask);
+    GetBuildNode(pTask, nodeIndex).m_Left := leftIndex;
+
+    if (not Populate(leftIndex, start, leftCount, depth + 1, pTask, hIsCanceled)) then
+        Exit;
+
+    // create and populate right node
+    rightIndex                             := AddNode(pTask);
+    GetBuildNode(pTask, nodeIndex).m_Right := rightIndex;
+
+    Result := Populate(rightIndex, start + leftCount, count - leftCount, depth + 1, pTask, hIsCanceled);
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRAABBTree.GetBuildThreadCount(polygonCount: NativeUInt): NativeUInt;
+begin
+    // too few polygons to benefit from several threads?
+    if (polygonCount < QR_AABB_Parallel_Min_Polygons) then
+        Exit(1);
+
+    // use one thread per processor, if not limited by the user
+    if (m_MaxThreads = 0) then
+        Result := TThread.ProcessorCount
+    else
+        Result := m_MaxThreads;
+
+    // at least the calling thread is used
+    if (Result = 0) then
+        Result := 1;
+end;
+//--------------------------------------------------------------------------------------------------
+procedure TQRAABBTree.ProcessBuildTasks(hIsCanceled: TQRIsCanceledEvent);
+var
+    taskIndex: NativeUInt;
+    pTask:     PQRAABBBuildTask;
+begin
+    while (True) do
+    begin
+        // get the next pending task, if any
+        m_pTaskLock.Enter;
+
+        try
+            taskIndex := m_NextTask;
+            Inc(m_NextTask);
+        finally
+            m_pTaskLock.Leave;
+        end;
+
+        // no more task to process?
+        if (taskIndex >= NativeUInt(Length(m_Tasks))) then
+            Exit;
+
+        pTask := @m_Tasks[taskIndex];
+
+        // a tree in which each node owns 0 or 2 children contains at most 2n - 1 nodes
+        SetLength(pTask.m_Nodes, (pTask.m_Count * 2) - 1);
+
+        // build the subtree. NOTE each task owns a separate polygon range in the index array, so
+        // the tasks can be built concurrently
+        pTask.m_Success := Populate(AddNode(pTask),
+                                    pTask.m_Start,
+                                    pTask.m_Count,
+                                    pTask.m_Depth,
+                                    pTask,
+                                    hIsCanceled);
+
+        // failed or canceled? Stop the other threads as soon as possible
+        if (not pTask.m_Success) then
+        begin
+            m_pTaskLock.Enter;
+
+            try
+                m_NextTask := Length(m_Tasks);
+            finally
+                m_pTaskLock.Leave;
+            end;
+
+            Exit;
+        end;
+    end;
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRAABBTree.BuildTasks(threadCount: NativeUInt; hIsCanceled: TQRIsCanceledEvent): Boolean;
+var
+    workers:           array of TQRAABBTreeBuildWorker;
+    workerCount, i, j: NativeInt;
+    offset:            Integer;
+    pTask:             PQRAABBBuildTask;
+    pNode:             PQRAABBNode;
+begin
+    // no task to build?
+    if (Length(m_Tasks) = 0) then
+        Exit(True);
+
+    m_NextTask  := 0;
+    m_pTaskLock := TCriticalSection.Create;
+
+    try
+        // the calling thread also processes tasks, so one thread less should be created. Also don't
+        // create more threads than tasks
+        if (threadCount < NativeUInt(Length(m_Tasks))) then
+            workerCount := NativeInt(threadCount) - 1
+        else
+            workerCount := Length(m_Tasks) - 1;
+
+        SetLength(workers, workerCount);
+
+        try
+            // start the build threads
+            for i := 0 to workerCount - 1 do
+                workers[i] := TQRAABBTreeBuildWorker.Create(ProcessBuildTasks, hIsCanceled);
+
+            // process tasks on the calling thread too
+            ProcessBuildTasks(hIsCanceled);
+        finally
+            // wait until all the build threads are done
+            for i := 0 to Length(workers) - 1 do
+                if (Assigned(workers[i])) then
+                begin
+                    workers[i].WaitFor;
+                    workers[i].Free;
+                end;
+        end;
+    finally
+        m_pTaskLock.Free;
+        m_pTaskLock := nil;
+    end;
+
+    // check if all tasks succeeded
+    for i := 0 to Length(m_Tasks) - 1 do
+        if (not m_Tasks[i].m_Success) then
+            Exit(False);
+
+    // iterate through tasks and merge each subtree in the tree node array
+    for i := 0 to Length(m_Tasks) - 1 do
+    begin
+        pTask := @m_Tasks[i];
+
+        // the subtree root replaces the task node, the other nodes are appended to the tree nodes,
+        // and their children indices are shifted accordingly
+        offset := Integer(m_NodeCount) - 1;
+
+        for j := 0 to NativeInt(pTask.m_NodeCount) - 1 do
+        begin
+            if (j = 0) then
+                pNode := @m_Nodes[pTask.m_NodeIndex]
+            else
+                pNode := @m_Nodes[AddNode(nil)];
+
+            pNode^ := pTask.m_Nodes[j];
+
+            if (pNode.m_Left >= 0) then
+                Inc(pNode.m_Left, offset);
+
+            if (pNode.m_Right >= 0) then
+                Inc(pNode.m_Right, offset);
+        end;
+
+        // subtree nodes are no longer needed
+        SetLength(pTask.m_Nodes, 0);
+    end;
+
+    Result := True;
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRAABBTree.IsContentValid: Boolean;
+var
+    polygonCount, i:  NativeUInt;
+    nodeIndex, child: NativeInt;
+    pNode:            PQRAABBNode;
+    depths:           array of NativeUInt;
+    hasParent:        array of Boolean;
+begin
+    polygonCount := Length(m_Polygons);
+
+    // check the polygon indices
+    if (polygonCount > 0) then
+        for i := 0 to polygonCount - 1 do
+            if (m_Indices[i] >= polygonCount) then
+                Exit(False);
+
+    // nothing else to check?
+    if (m_NodeCount = 0) then
+        Exit(True);
+
+    // the root depth is 0, the other depths are calculated while their parent is visited. As a
+    // child index should always be higher than his parent index, each parent is visited before his
+    // children
+    SetLength(depths,    m_NodeCount);
+    SetLength(hasParent, m_NodeCount);
+    depths[0] := 0;
+
+    // iterate through nodes
+    for nodeIndex := 0 to NativeInt(m_NodeCount) - 1 do
+    begin
+        pNode := @m_Nodes[nodeIndex];
+
+        // check the polygon range the node surrounds
+        if ((UInt64(pNode.m_Start) + UInt64(pNode.m_Count)) > UInt64(polygonCount)) then
+            Exit(False);
+
+        // is leaf?
+        if ((pNode.m_Left < 0) and (pNode.m_Right < 0)) then
+            continue;
+
+        // the traversal stack is only large enough for QR_AABB_Max_Depth levels
+        if (depths[nodeIndex] >= QR_AABB_Max_Depth) then
+            Exit(False);
+
+        // iterate through children
+        for i := 0 to 1 do
+        begin
+            if (i = 0) then
+                child := pNode.m_Left
+            else
+                child := pNode.m_Right;
+
+            // no child on this side?
+            if (child < 0) then
+                continue;
+
+            // child index should be higher than his parent index, and lower than the node count
+            if ((child <= nodeIndex) or (child >= NativeInt(m_NodeCount))) then
+                Exit(False);
+
+            // a node should have only one parent, otherwise the content isn't a tree, and the
+            // depth calculated from the other parent may hide a subtree deeper than allowed
+            if (hasParent[child]) then
+                Exit(False);
+
+            hasParent[child] := True;
+            depths[child]    := depths[nodeIndex] + 1;
+        end;
+    end;
+
+    Result := True;
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRAABBTree.RaycastPacket(const rays: TQRRayBatch;
+                                 start, count: NativeUInt;
+                            const maxDistance: Single;
+                                     var hits: TQRRayHits): NativeUInt;
+type
+    IQRStackEntry = record
+        m_NodeIndex: Integer;
+        m_Mask:      Byte;
+        m_Near:      Single;
+    end;
+var
+    stack:                     array [0..QR_AABB_Max_Depth + 1] of IQRStackEntry;
+    packet:                    TQRRayPacket;
+    stackSize:                 NativeInt;
+    lane:                      NativeUInt;
+    nearIndex, farIndex:       Integer;
+    pNode:                     PQRAABBNode;
+    laneHit:                   TQRRayHit;
+    mask, leftMask, rightMask: Byte;
+    nearMask, farMask:         Byte;
+    tMin, leftNear, rightNear: Single;
+    nearDist, farDist:         Single;
+    visit:                     Boolean;
+begin
+    Result := 0;
+    mask   := 0;
+
+    // is packet ray count out of bounds?
+    if ((count = 0) or (count > QR_Ray_Packet_Size)) then
+        Exit;
+
+    // iterate through packet rays
+    for lane := 0 to count - 1 do
+    begin
+        // copy the ray in the packet, and calculate his inverse direction
+        packet.m_PosX[lane]    := rays.m_PosX[start + lane];
+        packet.m_PosY[lane]    := rays.m_PosY[start + lane];
+        packet.m_PosZ[lane]    := rays.m_PosZ[start + lane];
+        packet.m_DirX[lane]    := rays.m_DirX[start + lane];
+        packet.m_DirY[lane]    := rays.m_DirY[start + lane];
+        packet.m_DirZ[lane]    := rays.m_DirZ[start + lane];
+        packet.m_InvDirX[lane] := TQRCollisionHelper.GetPacketInvDir(packet.m_DirX[lane]);
+        packet.m_InvDirY[lane] := TQRCollisionHelper.GetPacketInvDir(packet.m_DirY[lane]);
+        packet.m_InvDirZ[lane] := TQRCollisionHelper.GetPacketInvDir(packet.m_DirZ[lane]);
+        packet.m_Best[lane]    := maxDistance;
+
+        // initialize the ray hit
+        hits[start + lane].m_Distance     := maxDistance;
+        hits[start + lane].m_PolygonIndex := -1;
+        hits[start + lane].m_U            := 0.0;
+        hits[start + lane].m_V            := 0.0;
+
+        mask := mask or Byte(1 shl lane);
+    end;
+
+    // empty tree?
+    if (m_NodeCount = 0) then
+        Exit;
+
+    // check which rays intersect the root box
+    mask := TQRCollisionHelper.GetRayPacketBoxCollision(packet, m_Nodes[0].m_Box, mask, tMin);
+
+    if (mask = 0) then
+        Exit;
+
+    // push the root node on the stack
+    stack[0].m_NodeIndex := 0;
+    stack[0].m_Mask      := mask;
+    stack[0].m_Near      := tMin;
+    stackSize            := 1;
+
+    // iterate through nodes to visit
+    while (stackSize > 0) do
+    begin
+        // pop the next node to visit
+        Dec(stackSize);
+
+        mask  := stack[stackSize].m_Mask;
+        visit := False;
+
+        // check if at least one ray didn't find a closer hit since this node was pushed
+        for lane := 0 to count - 1 do
+            if (((mask and (1 shl lane)) <> 0) and (stack[stackSize].m_Near <= packet.m_Best[lane])) then
+            begin
+                visit := True;
+                break;
+            end;
+
+        if (not visit) then
+            continue;
+
+        pNode := @m_Nodes[stack[stackSize].m_NodeIndex];
+
+        // is leaf?
+        if ((pNode.m_Left < 0) and (pNode.m_Right < 0)) then
+        begin
+            // empty leaf?
+            if (pNode.m_Count = 0) then
+                continue;
+
+            // iterate through packet rays reaching the leaf
+            for lane := 0 to count - 1 do
+            begin
+                if ((mask and (1 shl lane)) = 0) then
+                    continue;
+
+                laneHit.m_Distance     := packet.m_Best[lane];
+                laneHit.m_PolygonIndex := -1;
+
+                // test all the leaf polygons at once and keep the closest hit
+                if (TQRCollisionHelper.GetRayTriangleCollision(TQRVector3D.Create(packet.m_PosX[lane],
+                                                                                  packet.m_PosY[lane],
+                                                                                  packet.m_PosZ[lane]),
+                                                               TQRVector3D.Create(packet.m_DirX[lane],
+                                                                                  packet.m_DirY[lane],
+                                                                                  packet.m_DirZ[lane]),
+                                                               @m_Polygons[pNode.m_Start],
+                                                               pNode.m_Count,
+                                                               laneHit))
+                then
+                begin
+                    packet.m_Best[lane]    := laneHit.m_Distance;
+                    laneHit.m_PolygonIndex := m_Indices[NativeInt(pNode.m_Start) + laneHit.m_PolygonIndex];
+                    hits[start + lane]     := laneHit;
+                end;
+            end;
+
+            continue;
+        end;
+
+        // check which rays intersect the child boxes
+        if (pNode.m_Left >= 0) then
+            leftMask := TQRCollisionHelper.GetRayPacketBoxCollision(packet,
+                                                                    m_Nodes[pNode.m_Left].m_Box,
+                                                                    mask,
+                                                                    leftNear)
+        else
+            leftMask := 0;
+
+        if (pNode.m_Right >= 0) then
+            rightMask := TQRCollisionHelper.GetRayPacketBoxCollision(packet,
+                                                                     m_Nodes[pNode.m_Right].m_Box,
+                                                                     mask,
+                                                                     rightNear)
+        else
+            rightMask := 0;
+
+        // only one child to visit?
+        if ((leftMask <> 0) and (rightMask = 0)) then
+        begin
+            stack[stackSize].m_NodeIndex := pNode.m_Left;
+            stack[stackSize].m_Mask      := leftMask;
+            stack[stackSize].m_Near      := leftNear;
+            Inc(stackSize);
+            continue;
+        end;
+
+        if ((rightMask <> 0) and (leftMask = 0)) then
+        begin
+            stack[stackSize].m_NodeIndex := pNode.m_Right;
+            stack[stackSize].m_Mask      := rightMask;
+            stack[stackSize].m_Near      := rightNear;
+            Inc(stackSize);
+            continue;
+        end;
+
+        // no child to visit?
+        if (leftMask = 0) then
+            continue;
+
+        // sort the children by the nearest distance any packet ray enters them
+        if (leftNear <= rightNear) then
+        begin
+            nearIndex := pNode.m_Left;
+            nearMask  := leftMask;
+            nearDist  := leftNear;
+            farIndex  := pNode.m_Right;
+            farMask   := rightMask;
+            farDist   := rightNear;
+        end
+        else
+        begin
+            nearIndex := pNode.m_Right;
+            nearMask  := rightMask;
+            nearDist  := rightNear;
+            farIndex  := pNode.m_Left;
+            farMask   := leftMask;
+            farDist   := leftNear;
+        end;
+
+        // push the farthest child first, so the nearest is visited first
+        stack[stackSize].m_NodeIndex     := farIndex;
+        stack[stackSize].m_Mask          := farMask;
+        stack[stackSize].m_Near          := farDist;
+        stack[stackSize + 1].m_NodeIndex := nearIndex;
+        stack[stackSize + 1].m_Mask      := nearMask;
+        stack[stackSize + 1].m_Near      := nearDist;
+        Inc(stackSize, 2);
+    end;
+
+    // count the rays that hit a polygon
+    for lane := 0 to count - 1 do
+        if (hits[start + lane].m_PolygonIndex >= 0) then
+            Inc(Result);
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRAABBTree.BoxOverlaps(const query: TQRAABBOverlapQuery; const box: TQRBox): Boolean;
+begin
+    case (query.m_Shape) of
+        EQR_OS_Sphere:  Result := TQRCollisionHelper.GetSphereBoxCollision(query.m_Sphere, box);
+        EQR_OS_Box:     Result := TQRCollisionHelper.GetBoxBoxCollision(query.m_Box, box);
+        EQR_OS_Frustum: Result := TQRCollisionHelper.GetFrustumBoxCollision(query.m_Frustum, box);
+    else
+        Result := False;
+    end;
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRAABBTree.PolygonOverlaps(const query: TQRAABBOverlapQuery;
+                                   const polygon: TQRPolygon): Boolean;
+begin
+    case (query.m_Shape) of
+        EQR_OS_Sphere:  Result := TQRCollisionHelper.GetSphereTriangleCollision(query.m_Sphere, polygon);
+        EQR_OS_Box:     Result := TQRCollisionHelper.GetBoxTriangleCollision(query.m_Box, polygon);
+        EQR_OS_Frustum: Result := TQRCollisionHelper.GetFrustumTriangleCollision(query.m_Frustum, polygon);
+    else
+        Result := False;
+    end;
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRAABBTree.Overlap(const query: TQRAABBOverlapQuery;
+                             var indices: TQRAABBIndices;
+                               firstOnly: Boolean): NativeUInt;
+var
+    stack:               array [0..QR_AABB_Max_Depth + 1] of Integer;
+    stackSize:           NativeInt;
+    i, polyEnd, maxHits: NativeUInt;
+    pNode:               PQRAABBNode;
+begin
+    Result := 0;
+
+    // empty tree, or root box outside the query shape?
+    if ((m_NodeCount = 0) or (not BoxOverlaps(query, m_Nodes[0].m_Box))) then
+        Exit;
+
+    maxHits := Length(indices);
+
+    // push the root node on the stack
+    stack[0]  := 0;
+    stackSize := 1;
+
+    // iterate through nodes to visit
+    while (stackSize > 0) do
+    begin
+        // pop the next node to visit. NOTE the node box was already tested before it was pushed
+        Dec(stackSize);
+        pNode := @m_Nodes[stack[stackSize]];
+
+        // is leaf?
+        if ((pNode.m_Left < 0) and (pNode.m_Right < 0)) then
+        begin
+            polyEnd := NativeUInt(pNode.m_Start) + pNode.m_Count;
+            i       := pNode.m_Start;
+
+            // iterate through leaf polygons
+            while (i < polyEnd) do
+            begin
+                if (PolygonOverlaps(query, m_Polygons[i])) then
+                begin
+                    // add the polygon index to the result, if the list is large enough
+                    if (Result < maxHits) then
+                        indices[Result] := m_Indices[i];
+
+                    Inc(Result);
+
+                    // only the first overlapping polygon is required?
+                    if (firstOnly) then
+                        Exit;
+                end;
+
+                Inc(i);
+            end;
+
+            continue;
+        end;
+
+        // push the child nodes overlapping the query shape
+        if ((pNode.m_Left >= 0) and BoxOverlaps(query, m_Nodes[pNode.m_Left].m_Box)) then
+        begin
+            stack[stackSize] := pNode.m_Left;
+            Inc(stackSize);
+        end;
+
+        if ((pNode.m_Right >= 0) and BoxOverlaps(query, m_Nodes[pNode.m_Right].m_Box)) then
+        begin
+            stack[stackSize] := pNode.m_Right;
+            Inc(stackSize);
+        end;
+    end;
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRAABBTree.Resolve(const pRay: TQRRay;
+                              nodeIndex: Integer;
+                           var polygons: TQRPolygons): Boolean;
+var
+    i, index:                    NativeUInt;
+    pNode:                       PQRAABBNode;
+    leftResolved, rightResolved: Boolean;
+begin
+    // no node to resolve? (this should never happen, but...)
+    if ((nodeIndex < 0) or (NativeUInt(nodeIndex) >= m_NodeCount)) then
+        Exit(False);
+
+    pNode         := @m_Nodes[nodeIndex];
+    leftResolved  := False;
+    rightResolved := False;
+
+    // is leaf?
+    if ((pNode.m_Left < 0) and (pNode.m_Right < 0)) then
+    begin
+        // nothing to copy?
+        if (pNode.m_Count = 0) then
+            Exit(True);
+
+        // get current output list index
+        index := Length(polygons);
+
+        // add all the leaf polygons to output list at once
+        SetLength(polygons, index + pNode.m_Count);
+
+        // copy polygon content, the leaf polygons are contiguous in the tree polygon list
+        for i := 0 to pNode.m_Count - 1 do
+            polygons[index + i] := m_Polygons[pNode.m_Start + i];
+
+        Exit(True);
+    end;
+
+    // check if ray intersects the left box
+    if ((pNode.m_Left >= 0) and TQRCollisionHelper.GetRayBoxCollision(pRay, @m_Nodes[pNode.m_Left].m_Box)) then
+        // resolve left node
+        leftResolved := Resolve(pRay, pNode.m_Left, polygons);
+
+    // check if ray intersects the right box
+    if ((pNode.m_Right >= 0) and TQRCollisionHelper.GetRayBoxCollision(pRay, @m_Nodes[pNode.m_Right].m_Box)) then
+        // resolve right node
+        rightResolved := Resolve(pRay, pNode.m_Right, polygons);
+
+    Result := (leftResolved or rightResolved);
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRAABBTree.GetNode(index: NativeUInt): PQRAABBNode;
+begin
+    if (index >= m_NodeCount) then
+        Exit(nil);
+
+    Result := @m_Nodes[index];
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRAABBTree.GetPolygon(index: NativeUInt): PQRPolygon;
+begin
+    if (index >= NativeUInt(Length(m_Polygons))) then
+        Exit(nil);
+
+    Result := @m_Polygons[index];
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRAABBTree.GetPolygonCount: NativeUInt;
+begin
+    Result := Length(m_Polygons);
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRAABBTree.Populate(const polygons: TQRPolygons;
+                                 hIsCanceled: TQRIsCanceledEvent): Boolean;
+var
+    polygonCount, i, threadCount: NativeUInt;
+    rootIndex:                    Integer;
+    sorted:                       TQRPolygons;
+begin
+    // tree was already populated? Clear it first
+    Release;
+
+    polygonCount := Length(polygons);
+
+    // copy the source polygons, and initialize the index array, that will be sorted in such a
+    // manner that each leaf will surround a contiguous polygon range
+    SetLength(m_Polygons, polygonCount);
+    SetLength(m_Indices,  polygonCount);
+
+    if (polygonCount > 0) then
+    begin
+        for i := 0 to polygonCount - 1 do
+        begin
+            m_Polygons[i] := polygons[i];
+            m_Indices[i]  := i;
+        end;
+
+        // a tree in which each node owns 0 or 2 children contains at most 2n - 1 nodes
+        SetLength(m_Nodes, (polygonCount * 2) - 1);
+    end
+    else
+        SetLength(m_Nodes, 1);
+
+    // the surface area heuristic evaluates the polygon centers many times, calculate them once
+    if (m_BuildMode = EQR_BM_SAH) then
+    begin
+        SetLength(m_Centers, polygonCount);
+
+        if (polygonCount > 0) then
+            for i := 0 to polygonCount - 1 do
+                m_Centers[i] := m_Polygons[i].GetCenter;
+    end;
+
+    // get the thread count to use, and if several threads may be used, calculate the depth from
+    // which the subtrees will be built by separate tasks
+    threadCount := GetBuildThreadCount(polygonCount);
+
+    if (threadCount > 1) then
+        m_TaskDepth := Ceil(Log2(threadCount * QR_AABB_Tasks_Per_Thread))
+    else
+        m_TaskDepth := 0;
+
+    // create root node and populate tree
+    rootIndex := AddNode(nil);
+    Result    := Populate(rootIndex, 0, polygonCount, 0, nil, hIsCanceled);
+
+    // build the pending subtrees on several threads
+    if (Result) then
+        Result := BuildTasks(threadCount, hIsCanceled);
+
+    // tasks are no longer needed
+    SetLength(m_Tasks, 0);
+    m_TaskDepth := 0;
+
+    // centers are no longer needed
+    SetLength(m_Centers, 0);
+
+    // failed or canceled?
+    if (not Result) then
+    begin
+        Release;
+        Exit;
+    end;
+
+    // release the unused nodes
+    SetLength(m_Nodes, m_NodeCount);
+
+    // sort the polygons in the leaf order
+    SetLength(sorted, polygonCount);
+
+    if (polygonCount > 0) then
+        for i := 0 to polygonCount - 1 do
+            sorted[i] := m_Polygons[m_Indices[i]];
+
+    m_Polygons := sorted;
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRAABBTree.Resolve(const pRay: TQRRay; var polygons: TQRPolygons): Boolean;
+begin
+    Result := Resolve(pRay, 0, polygons);
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRAABBTree.GetSourceIndex(index: NativeUInt): NativeUInt;
+begin
+    Result := m_Indices[index];
+end;
+//--------------------------------------------------------------------------------------------------
+procedure TQRAABBTree.Assign(const pOther: TQRAABBTree);
+begin
+    Release;
+
+    // nothing to copy from?
+    if (not Assigned(pOther)) then
+        Exit;
+
+    // copy the tree content. NOTE the arrays are copied, so both trees may be modified separately
+    m_Nodes      := Copy(pOther.m_Nodes, 0, pOther.m_NodeCount);
+    m_Polygons   := Copy(pOther.m_Polygons);
+    m_Indices    := Copy(pOther.m_Indices);
+    m_NodeCount  := pOther.m_NodeCount;
+    m_MaxThreads := pOther.m_MaxThreads;
+    m_BuildMode  := pOther.m_BuildMode;
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRAABBTree.Refit(const polygons: TQRPolygons): Boolean;
+var
+    polygonCount, i: NativeUInt;
+    nodeIndex:       NativeInt;
+    pNode:           PQRAABBNode;
+    boxEmpty:        Boolean;
+begin
+    polygonCount := Length(polygons);
+
+    // the tree hierarchy can only be kept if the polygon count is unchanged
+    if (polygonCount <> NativeUInt(Length(m_Polygons))) then
+        Exit(False);
+
+    // copy the new polygon positions, in the tree internal order
+    if (polygonCount > 0) then
+        for i := 0 to polygonCount - 1 do
+            m_Polygons[i] := polygons[m_Indices[i]];
+
+    // iterate through nodes, from the last to the first. As a child index is always higher than
+    // his parent index, each child box is updated before his parent box
+    for nodeIndex := NativeInt(m_NodeCount) - 1 downto 0 do
+    begin
+        pNode       := @m_Nodes[nodeIndex];
+        pNode.m_Box := Default(TQRBox);
+        boxEmpty    := True;
+
+        // is leaf?
+        if ((pNode.m_Left < 0) and (pNode.m_Right < 0)) then
+        begin
+            // calculate the leaf box from his polygons
+            if (pNode.m_Count > 0) then
+                for i := pNode.m_Start to pNode.m_Start + pNode.m_Count - 1 do
+                    AddPolygonToBoundingBox(m_Polygons[i], @pNode.m_Box, boxEmpty);
+
+            continue;
+        end;
+
+        // calculate the node box from his children boxes
+        if (pNode.m_Left >= 0) then
+            AddBoxToBoundingBox(m_Nodes[pNode.m_Left].m_Box, @pNode.m_Box, boxEmpty);
+
+        if (pNode.m_Right >= 0) then
+            AddBoxToBoundingBox(m_Nodes[pNode.m_Right].m_Box, @pNode.m_Box, boxEmpty);
+    end;
+
+    Result := True;
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRAABBTree.RaycastClosest(const pRay: TQRRay; out hit: TQRRayHit): Boolean;
+begin
+    Result := RaycastClosest(pRay, Infinity, hit);
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRAABBTree.RaycastClosest(const pRay: TQRRay;
+                             const maxDistance: Single;
+                                       out hit: TQRRayHit): Boolean;
+type
+    IQRStackEntry = record
+        m_NodeIndex: Integer;
+        m_Near:      Single;
+    end;
+var
+    stack:                                  array [0..QR_AABB_Max_Depth + 1] of IQRStackEntry;
+    stackSize, bestIndex:                   NativeInt;
+    nearIndex, farIndex:                    Integer;
+    pNode:                                  PQRAABBNode;
+    leftHit, rightHit:                      Boolean;
+    tNear, tFar, leftNear, rightNear, best: Single;
+    nearDist, farDist:                      Single;
+begin
+    hit.m_Distance     := maxDistance;
+    hit.m_PolygonIndex := -1;
+    hit.m_U            := 0.0;
+    hit.m_V            := 0.0;
+
+    // no ray or empty tree?
+    if ((not Assigned(pRay)) or (m_NodeCount = 0)) then
+        Exit(False);
+
+    // check if ray intersects the root box, and if this box isn't behind the ray
+    if ((not TQRCollisionHelper.GetRayBoxCollision(pRay, @m_Nodes[0].m_Box, tNear, tFar)) or
+        (tFar < 0.0) or (tNear > maxDistance))
+    then
+        Exit(False);
+
+    best      := maxDistance;
+    bestIndex := -1;
+
+    // push the root node on the stack
+    stack[0].m_NodeIndex := 0;
+    stack[0].m_Near      := Max(tNear, 0.0);
+    stackSize            := 1;
+
+    // iterate through nodes to visit, from the nearest to the farthest
+    while (stackSize > 0) do
+    begin
+        // pop the next node to visit
+        Dec(stackSize);
+
+        // a closer hit was found since this node was pushed?
+        if (stack[stackSize].m_Near > best) then
+            continue;
+
+        pNode := @m_Nodes[stack[stackSize].m_NodeIndex];
+
+        // is leaf?
+        if ((pNode.m_Left < 0) and (pNode.m_Right < 0)) then
+        begin
+            // test all the leaf polygons at once and keep the closest hit
+            if ((pNode.m_Count > 0) and
+                 TQRCollisionHelper.GetRayTriangleCollision(pRay,
+                                                            @m_Polygons[pNode.m_Start],
+                                                            pNode.m_Count,
+                                                            hit))
+            then
+            begin
+                best      := hit.m_Distance;
+                bestIndex := NativeInt(pNode.m_Start) + hit.m_PolygonIndex;
+            end;
+
+            continue;
+        end;
+
+        // check if ray intersects the child boxes, ignoring the boxes behind the ray or farther
+        // than the best hit
+        leftHit  := (pNode.m_Left >= 0) and
+                    TQRCollisionHelper.GetRayBoxCollision(pRay, @m_Nodes[pNode.m_Left].m_Box, tNear, tFar) and
+                    (tFar >= 0.0) and (tNear <= best);
+        leftNear := Max(tNear, 0.0);
+
+        rightHit  := (pNode.m_Right >= 0) and
+                     TQRCollisionHelper.GetRayBoxCollision(pRay, @m_Nodes[pNode.m_Right].m_Box, tNear, tFar) and
+                     (tFar >= 0.0) and (tNear <= best);
+        rightNear := Max(tNear, 0.0);
+
+        // only one child to visit?
+        if (leftHit and not rightHit) then
+        begin
+            stack[stackSize].m_NodeIndex := pNode.m_Left;
+            stack[stackSize].m_Near      := leftNear;
+            Inc(stackSize);
+            continue;
+        end;
+
+        if (rightHit and not leftHit) then
+        begin
+            stack[stackSize].m_NodeIndex := pNode.m_Right;
+            stack[stackSize].m_Near      := rightNear;
+            Inc(stackSize);
+            continue;
+        end;
+
+        // no child to visit?
+        if (not leftHit) then
+            continue;
+
+        // sort the children by distance
+        if (leftNear <= rightNear) then
+        begin
+            nearIndex := pNode.m_Left;
+            nearDist  := leftNear;
+            farIndex  := pNode.m_Right;
+            farDist   := rightNear;
+        end
+        else
+        begin
+            nearIndex := pNode.m_Right;
+            nearDist  := rightNear;
+            farIndex  := pNode.m_Left;
+            farDist   := leftNear;
+        end;
+
+        // push the farthest child first, so the nearest is visited first
+        stack[stackSize].m_NodeIndex     := farIndex;
+        stack[stackSize].m_Near          := farDist;
+        stack[stackSize + 1].m_NodeIndex := nearIndex;
+        stack[stackSize + 1].m_Near      := nearDist;
+        Inc(stackSize, 2);
+    end;
+
+    // nothing hit?
+    if (bestIndex < 0) then
+        Exit(False);
+
+    hit.m_PolygonIndex := m_Indices[bestIndex];
+    Result             := True;
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRAABBTree.RaycastClosest(const rays: TQRRayBatch; out hits: TQRRayHits): NativeUInt;
+begin
+    SetLength(hits, rays.Count);
+
+    Result := RaycastClosest(rays, 0, rays.Count, Infinity, hits);
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRAABBTree.RaycastClosest(const rays: TQRRayBatch;
+                                  start, count: NativeUInt;
+                             const maxDistance: Single;
+                                      var hits: TQRRayHits): NativeUInt;
+var
+    index, packetCount: NativeUInt;
+begin
+    Result := 0;
+
+    // is range out of bounds?
+    if (((start + count) > rays.Count) or ((start + count) > NativeUInt(Length(hits)))) then
+        Exit;
+
+    index := start;
+
+    // iterate through ray packets to test
+    while (index < (start + count)) do
+    begin
+        // calculate the packet ray count, the last packet may be incomplete
+        packetCount := (start + count) - index;
+
+        if (packetCount > QR_Ray_Packet_Size) then
+            packetCount := QR_Ray_Packet_Size;
+
+        Inc(Result, RaycastPacket(rays, index, packetCount, maxDistance, hits));
+        Inc(index, packetCount);
+    end;
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRAABBTree.OverlapSphere(const sphere: TQRSphere): Boolean;
+var
+    query:   TQRAABBOverlapQuery;
+    indices: TQRAABBIndices;
+begin
+    query.m_Shape := EQR_OS_Sphere;
+    query.m_Sphere := sphere;
+
+    // the index list remains empty, only the first overlapping polygon is searched
+    Result := (Overlap(query, indices, True) > 0);
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRAABBTree.OverlapSphere(const sphere: TQRSphere;
+                                    var indices: TQRAABBIndices): NativeUInt;
+var
+    query: TQRAABBOverlapQuery;
+begin
+    query.m_Shape := EQR_OS_Sphere;
+    query.m_Sphere := sphere;
+
+    Result := Overlap(query, indices, False);
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRAABBTree.OverlapBox(const box: TQRBox): Boolean;
+var
+    query:   TQRAABBOverlapQuery;
+    indices: TQRAABBIndices;
+begin
+    query.m_Shape := EQR_OS_Box;
+    query.m_Box   := box;
+
+    // the index list remains empty, only the first overlapping polygon is searched
+    Result := (Overlap(query, indices, True) > 0);
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRAABBTree.OverlapBox(const box: TQRBox;
+                              var indices: TQRAABBIndices): NativeUInt;
+var
+    query: TQRAABBOverlapQuery;
+begin
+    query.m_Shape := EQR_OS_Box;
+    query.m_Box   := box;
+
+    Result := Overlap(query, indices, False);
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRAABBTree.OverlapFrustum(const frustum: TQRFrustum): Boolean;
+var
+    query:   TQRAABBOverlapQuery;
+    indices: TQRAABBIndices;
+begin
+    query.m_Shape := EQR_OS_Frustum;
+    query.m_Frustum := frustum;
+
+    // the index list remains empty, only the first overlapping polygon is searched
+    Result := (Overlap(query, indices, True) > 0);
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRAABBTree.OverlapFrustum(const frustum: TQRFrustum;
+                                      var indices: TQRAABBIndices): NativeUInt;
+var
+    query: TQRAABBOverlapQuery;
+begin
+    query.m_Shape := EQR_OS_Frustum;
+    query.m_Frustum := frustum;
+
+    Result := Overlap(query, indices, False);
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRAABBTree.SaveToStream(pStream: TStream): Boolean;
+var
+    header:       TQRAABBStreamHeader;
+    polygonCount: NativeUInt;
+begin
+    // no stream to save to?
+    if (not Assigned(pStream)) then
+        Exit(False);
+
+    polygonCount := Length(m_Polygons);
+
+    // populate the header
+    header.m_Signature    := QR_AABB_Stream_Signature;
+    header.m_Version      := QR_AABB_Stream_Version;
+    header.m_NodeSize     := SizeOf(TQRAABBNode);
+    header.m_PolygonSize  := SizeOf(TQRPolygon);
+    header.m_BuildMode    := TQRUInt32(Ord(m_BuildMode));
+    header.m_NodeCount    := m_NodeCount;
+    header.m_PolygonCount := polygonCount;
+
+    try
+        pStream.WriteBuffer(header, SizeOf(TQRAABBStreamHeader));
+
+        // write the nodes, the polygons and the polygon indices. NOTE all these arrays are
+        // contiguous, so each of them is written in a single block
+        if (m_NodeCount > 0) then
+            pStream.WriteBuffer(m_Nodes[0], m_NodeCount * SizeOf(TQRAABBNode));
+
+        if (polygonCount > 0) then
+        begin
+            pStream.WriteBuffer(m_Polygons[0], polygonCount * SizeOf(TQRPolygon));
+            pStream.WriteBuffer(m_Indices[0],  polygonCount * SizeOf(Cardinal));
+        end;
+    except
+        Exit(False);
+    end;
+
+    Result := True;
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRAABBTree.LoadFromStream(pStream: TStream): Boolean;
+var
+    header:       TQRAABBStreamHeader;
+    dataSize:     Int64;
+    maxNodeCount: UInt64;
+begin
+    // clear the previous tree content, if any
+    Release;
+
+    // no stream to load from?
+    if (not Assigned(pStream)) then
+        Exit(False);
+
+    Result := False;
+
+    try
+        try
+            // read the header
+            if (pStream.Read(header, SizeOf(TQRAABBStreamHeader)) <> SizeOf(TQRAABBStreamHeader)) then
+                Exit;
+
+            // check if the stream matches with the expected format
+            if ((header.m_Signature   <> QR_AABB_Stream_Signature)                     or
+                (header.m_Version     <> QR_AABB_Stream_Version)                       or
+                (header.m_NodeSize    <> SizeOf(TQRAABBNode))                          or
+                (header.m_PolygonSize <> SizeOf(TQRPolygon))                           or
+                (header.m_BuildMode   >  TQRUInt32(Ord(High(EQRAABBTreeBuildMode)))))
+            then
+                Exit;
+
+            // a tree contains at most 2 * n - 1 nodes for n polygons, as each leaf surrounds at
+            // least one polygon. A tree without polygons contains only an empty root
+            if (header.m_PolygonCount = 0) then
+                maxNodeCount := 1
+            else
+                maxNodeCount := (UInt64(header.m_PolygonCount) * 2) - 1;
+
+            if (UInt64(header.m_NodeCount) > maxNodeCount) then
+                Exit;
+
+            // calculate the data size to read, and check if the stream is large enough to contain
+            // them. This prevents to allocate a huge memory amount from a corrupted header
+            dataSize := (Int64(header.m_NodeCount)    *  SizeOf(TQRAABBNode)) +
+                        (Int64(header.m_PolygonCount) * (SizeOf(TQRPolygon) + SizeOf(Cardinal)));
+
+            if (dataSize > (pStream.Size - pStream.Position)) then
+                Exit;
+
+            SetLength(m_Nodes,    header.m_NodeCount);
+            SetLength(m_Polygons, header.m_PolygonCount);
+            SetLength(m_Indices,  header.m_PolygonCount);
+
+            // read the nodes, the polygons and the polygon indices
+            if (header.m_NodeCount > 0) then
+                pStream.ReadBuffer(m_Nodes[0], header.m_NodeCount * SizeOf(TQRAABBNode));
+
+            if (header.m_PolygonCount > 0) then
+            begin
+                pStream.ReadBuffer(m_Polygons[0], header.m_PolygonCount * SizeOf(TQRPolygon));
+                pStream.ReadBuffer(m_Indices[0],  header.m_PolygonCount * SizeOf(Cardinal));
+            end;
+
+            m_NodeCount := header.m_NodeCount;
+            m_BuildMode := EQRAABBTreeBuildMode(header.m_BuildMode);
+
+            // check the loaded content, a corrupted tree may cause an infinite loop or an invalid
+            // memory access while traversed
+            Result := IsContentValid;
+        except
+            Result := False;
+        end;
+    finally
+        // failed? Don't keep a partially loaded tree
+        if (not Result) then
+            Release;
+    end;
+end;
+//--------------------------------------------------------------------------------------------------
+// TQRAABBTreeBuildWorker
+//--------------------------------------------------------------------------------------------------
+constructor TQRAABBTreeBuildWorker.Create(fOnProcess: TQRAABBBuildProcessEvent;
+                                         hIsCanceled: TQRIsCanceledEvent);
+begin
+    inherited Create(False);
+
+    m_fOnProcess  := fOnProcess;
+    m_hIsCanceled := hIsCanceled;
+end;
+//--------------------------------------------------------------------------------------------------
+procedure TQRAABBTreeBuildWorker.Execute;
+begin
+    m_fOnProcess(m_hIsCanceled);
+end;
+//--------------------------------------------------------------------------------------------------
+// TQRAABBTreeBuilder
+//--------------------------------------------------------------------------------------------------
+constructor TQRAABBTreeBuilder.Create;
+begin
+    inherited Create;
 
-    // delete node
-    Dispose(pNode);
+    m_pLock        := nil;
+    m_PendingItem  := 0;
+    m_NextItem     := 0;
+    m_BuiltCount   := 0;
+    m_MaxThreads   := 0;
+    m_Refit        := False;
+    m_fOnTreeBuilt := nil;
 end;
 //--------------------------------------------------------------------------------------------------
-function TQRAABBTree.ValueIsBetween(const value, valueStart, valueEnd, epsilon: Single): Boolean;
+destructor TQRAABBTreeBuilder.Destroy;
 var
-    minVal, maxVal: Single;
+    i: NativeInt;
 begin
-    minVal := Min(valueStart, valueEnd);
-    maxVal := Max(valueStart, valueEnd);
+    // delete the trees that were not extracted
+    for i := 0 to Length(m_Items) - 1 do
+        m_Items[i].m_pTree.Free;
 
-    // check if each value is between start and end limits considering tolerance
-    Result := ((value >= (minVal - epsilon)) and (value <= (maxVal + epsilon)));
+    inherited Destroy;
 end;
 //--------------------------------------------------------------------------------------------------
-function TQRAABBTree.VectorIsBetween(const point, pointStart, pointEnd: TQRVector3D;
-                                                         const epsilon: Single): Boolean;
+procedure TQRAABBTreeBuilder.ProcessItems(hIsCanceled: TQRIsCanceledEvent);
+var
+    itemIndex, builtCount: NativeUInt;
+    pItem:                 PQRAABBTreeBuildItem;
 begin
-    // check if each vector component is between start and end limits
-    Result := (ValueIsBetween(point.X, pointStart.X, pointEnd.X, epsilon) and
-               ValueIsBetween(point.Y, pointStart.Y, pointEnd.Y, epsilon) and
-               ValueIsBetween(point.Z, pointStart.Z, pointEnd.Z, epsilon));
+    while (True) do
+    begin
+        // get the next pending item, if any
+        m_pLock.Enter;
+
+        try
+            itemIndex := m_NextItem;
+            Inc(m_NextItem);
+        finally
+            m_pLock.Leave;
+        end;
+
+        // no more item to process?
+        if (itemIndex >= NativeUInt(Length(m_Items))) then
+            Exit;
+
+        pItem := @m_Items[itemIndex];
+
+        // refit the first tree hierarchy on the item polygons, or build a new tree. The polygons
+        // are no longer needed after that
+        if (m_Refit and (itemIndex > 0)) then
+        begin
+            pItem.m_pTree.Assign(m_Items[0].m_pTree);
+            pItem.m_Success := pItem.m_pTree.Refit(pItem.m_Polygons);
+        end
+        else
+            pItem.m_Success := pItem.m_pTree.Populate(pItem.m_Polygons, hIsCanceled);
+
+        SetLength(pItem.m_Polygons, 0);
+
+        m_pLock.Enter;
+
+        try
+            // failed or canceled? Stop the other threads as soon as possible
+            if (not pItem.m_Success) then
+            begin
+                m_NextItem := Length(m_Items);
+                Exit;
+            end;
+
+            Inc(m_BuiltCount);
+            builtCount := m_BuiltCount;
+
+            // notify that a tree was built. NOTE the notification is sent while the lock is kept,
+            // so it is never called concurrently
+            if (Assigned(m_fOnTreeBuilt)) then
+                m_fOnTreeBuilt(pItem.m_pTree, builtCount, Length(m_Items));
+        finally
+            m_pLock.Leave;
+        end;
+    end;
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRAABBTreeBuilder.GetCount: NativeUInt;
+begin
+    Result := Length(m_Items);
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRAABBTreeBuilder.GetTree(index: NativeUInt): TQRAABBTree;
+begin
+    if (index >= NativeUInt(Length(m_Items))) then
+        Exit(nil);
+
+    Result := m_Items[index].m_pTree;
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRAABBTreeBuilder.Add(const polygons: TQRPolygons; pTree: TQRAABBTree): NativeUInt;
+begin
+    Result := Length(m_Items);
+    SetLength(m_Items, Result + 1);
+
+    m_Items[Result].m_Polygons := polygons;
+    m_Items[Result].m_pTree    := pTree;
+    m_Items[Result].m_Success  := False;
 end;
 //--------------------------------------------------------------------------------------------------
-procedure TQRAABBTree.AddPolygonToBoundingBox(polygon: TQRPolygon;
-                                                 pBox: PQRBox;
-                                            var empty: Boolean);
+function TQRAABBTreeBuilder.Build(hIsCanceled: TQRIsCanceledEvent): Boolean;
 var
-    i: Byte;
+    workers:                                      array of TQRAABBTreeBuildWorker;
+    threadCount, workerCount, treeThreadCount, i: NativeInt;
+begin
+    // nothing to build? NOTE the trees built by a previous build are kept as is
+    if (m_PendingItem >= NativeUInt(Length(m_Items))) then
+        Exit(True);
+
+    m_NextItem   := m_PendingItem;
+    m_BuiltCount := m_PendingItem;
+
+    // use one thread per processor, if not limited by the user
+    if (m_MaxThreads = 0) then
+        threadCount := TThread.ProcessorCount
+    else
+        threadCount := m_MaxThreads;
+
+    // do refit trees? The first tree should be populated before the others copy his hierarchy
+    if (m_Refit and (m_PendingItem = 0)) then
+    begin
+        // the first tree is built alone, so it may use all the allowed threads
+        m_Items[0].m_pTree.MaxThreads := Max(threadCount, 1);
+
+        m_Items[0].m_Success := m_Items[0].m_pTree.Populate(m_Items[0].m_Polygons, hIsCanceled);
+        SetLength(m_Items[0].m_Polygons, 0);
+
+        if (not m_Items[0].m_Success) then
+            Exit(False);
+
+        m_NextItem   := 1;
+        m_BuiltCount := 1;
+
+        // notify that the first tree was built
+        if (Assigned(m_fOnTreeBuilt)) then
+            m_fOnTreeBuilt(m_Items[0].m_pTree, m_BuiltCount, Length(m_Items));
+    end;
+
+    // the calling thread also builds trees, so one thread less should be created. Also don't
+    // create more threads than remaining trees
+    workerCount := Max(Min(threadCount, Length(m_Items) - NativeInt(m_NextItem)), 1) - 1;
+
+    // several trees are built concurrently? Don't split each tree build on several threads,
+    // otherwise the tree may use all the allowed threads
+    if (workerCount > 0) then
+        treeThreadCount := 1
+    else
+        treeThreadCount := Max(threadCount, 1);
+
+    for i := NativeInt(m_NextItem) to Length(m_Items) - 1 do
+        m_Items[i].m_pTree.MaxThreads := treeThreadCount;
+
+    m_pLock := TCriticalSection.Create;
+
+    try
+        SetLength(workers, workerCount);
+
+        try
+            // start the build threads
+            for i := 0 to workerCount - 1 do
+                workers[i] := TQRAABBTreeBuildWorker.Create(ProcessItems, hIsCanceled);
+
+            // build trees on the calling thread too
+            ProcessItems(hIsCanceled);
+        finally
+            // wait until all the build threads are done
+            for i := 0 to Length(workers) - 1 do
+                if (Assigned(workers[i])) then
+                begin
+                    workers[i].WaitFor;
+                    workers[i].Free;
+                end;
+        end;
+    finally
+        m_pLock.Free;
+        m_pLock := nil;
+    end;
+
+    // check if all trees were built
+    for i := NativeInt(m_PendingItem) to Length(m_Items) - 1 do
+        if (not m_Items[i].m_Success) then
+            Exit(False);
+
+    // from now only the trees added later should be built
+    m_PendingItem := Length(m_Items);
+
+    Result := True;
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRAABBTreeBuilder.Extract(index: NativeUInt): TQRAABBTree;
+begin
+    if (index >= NativeUInt(Length(m_Items))) then
+        Exit(nil);
+
+    Result                 := m_Items[index].m_pTree;
+    m_Items[index].m_pTree := nil;
+end;
+//--------------------------------------------------------------------------------------------------
+// TQRAABBSceneTree
+//--------------------------------------------------------------------------------------------------
+constructor TQRAABBSceneTree.Create;
+begin
+    inherited Create;
+
+    m_NodeCount := 0;
+    m_Rebuild   := False;
+    m_Refit     := False;
+end;
+//--------------------------------------------------------------------------------------------------
+destructor TQRAABBSceneTree.Destroy;
+begin
+    Clear;
+
+    inherited Destroy;
+end;
+//--------------------------------------------------------------------------------------------------
+procedure TQRAABBSceneTree.AddBoxToBoundingBox(const box: TQRBox;
+                                                    pBox: PQRBox;
+                                               var empty: Boolean);
 begin
     // no box to add to
     if (not Assigned(pBox)) then
         Exit;
 
-    // iterate through polygon vertices
-    for i := 0 to 2 do
+    // is box empty?
+    if (empty) then
     begin
-        // is box empty?
-        if (empty) then
-        begin
-            // initialize bounding box with first vertex
-            pBox.Min.Assign(polygon.GetVertex(i));
-            pBox.Max.Assign(polygon.GetVertex(i));
-            empty := False;
-            continue;
-        end;
+        // initialize bounding box with the box to add
+        pBox.Min.Assign(box.Min^);
+        pBox.Max.Assign(box.Max^);
+        empty := False;
+        Exit;
+    end;
 
-        // search for box min edge
-        pBox.Min.Assign(TQRVector3D.Create(Min(pBox.Min.X, polygon.GetVertex(i).X),
-                                           Min(pBox.Min.Y, polygon.GetVertex(i).Y),
-                                           Min(pBox.Min.Z, polygon.GetVertex(i).Z)));
+    // search for box min edge
+    pBox.Min.Assign(TQRVector3D.Create(Min(pBox.Min.X, box.Min.X),
+                                       Min(pBox.Min.Y, box.Min.Y),
+                                       Min(pBox.Min.Z, box.Min.Z)));
 
-        // search for box max edge
-        pBox.Max.Assign(TQRVector3D.Create(Max(pBox.Max.X, polygon.GetVertex(i).X),
-                                           Max(pBox.Max.Y, polygon.GetVertex(i).Y),
-                                           Max(pBox.Max.Z, polygon.GetVertex(i).Z)));
-    end;
+    // search for box max edge
+    pBox.Max.Assign(TQRVector3D.Create(Max(pBox.Max.X, box.Max.X),
+                                       Max(pBox.Max.Y, box.Max.Y),
+                                       Max(pBox.Max.Z, box.Max.Z)));
 end;
 //--------------------------------------------------------------------------------------------------
-function TQRAABBTree.Populate(pNode: PQRAABBNode;
-                     const polygons: TQRPolygons;
-                        hIsCanceled: TQRIsCanceledEvent): Boolean;
+procedure TQRAABBSceneTree.UpdateItem(pItem: PQRAABBSceneItem);
 var
-    polygonIndex,
-    leftPolygonIndex,
-    rightPolygonIndex,
-    polygonCount,
-    leftPolygonCount,
-    rightPolygonCount:                         NativeUInt;
-    polygon:                                   TQRPolygon;
-    i, j:                                      Byte;
-    pLeftBox, pRightBox:                       PQRBox;
-    leftPolygons, rightPolygons:               TQRPolygons;
-    boxEmpty, canResolveLeft, canResolveRight: Boolean;
+    pRoot:       PQRAABBNode;
+    corner:      TQRVector3D;
+    cornerBox:   TQRBox;
+    x, y, z:     Single;
+    determinant: Single;
+    boxEmpty:    Boolean;
+    i:           Byte;
 begin
-    boxEmpty := True;
-    Result   := False;
+    pItem.m_Box     := Default(TQRBox);
+    pItem.m_Enabled := False;
 
-    // initialize node content
-    pNode.m_pLeft  := nil;
-    pNode.m_pRight := nil;
-    pNode.m_pBox   := nil;
-    SetLength(pNode.m_Polygons, 0);
+    // no tree, or empty tree?
+    if ((not Assigned(pItem.m_pTree)) or (pItem.m_pTree.NodeCount = 0)) then
+        Exit;
 
-    // is canceled?
-    if (Assigned(hIsCanceled) and hIsCanceled) then
+    // calculate the matrix that transforms the scene coordinates to the model coordinates
+    pItem.m_InvMatrix := pItem.m_Matrix.Inverse(determinant);
+
+    // matrix cannot be inverted? In this case the ray cannot be transformed to the model
+    // coordinates, and the model is ignored
+    if (determinant = 0.0) then
         Exit;
 
-    // create a collision box
-    New(pNode.m_pBox);
+    pRoot    := pItem.m_pTree.Nodes[0];
+    boxEmpty := True;
 
-    // iterate through polygons to divide
-    for polygon in polygons do
+    // iterate through the model tree root box corners
+    for i := 0 to 7 do
     begin
-        // is canceled?
-        if (Assigned(hIsCanceled) and hIsCanceled) then
-            Exit;
+        // get the corner coordinates
+        if ((i and 1) = 0) then
+            x := pRoot.m_Box.Min.X
+        else
+            x := pRoot.m_Box.Max.X;
 
-        // calculate bounding box
-        AddPolygonToBoundingBox(polygon, pNode.m_pBox, boxEmpty);
+        if ((i and 2) = 0) then
+            y := pRoot.m_Box.Min.Y
+        else
+            y := pRoot.m_Box.Max.Y;
+
+        if ((i and 4) = 0) then
+            z := pRoot.m_Box.Min.Z
+        else
+            z := pRoot.m_Box.Max.Z;
+
+        // transform the corner to the scene coordinates, and add it to the scene box
+        corner        := pItem.m_Matrix.Transform(TQRVector3D.Create(x, y, z));
+        cornerBox.Min := @corner;
+        cornerBox.Max := @corner;
+        AddBoxToBoundingBox(cornerBox, @pItem.m_Box, boxEmpty);
     end;
 
-    pLeftBox  := nil;
-    pRightBox := nil;
+    pItem.m_Enabled := True;
+end;
+//--------------------------------------------------------------------------------------------------
+procedure TQRAABBSceneTree.Populate(nodeIndex: Integer; start, count, depth: NativeUInt);
+var
+    pNode:                 PQRAABBNode;
+    centerBox, pointBox:   TQRBox;
+    extent:                TQRVector3D;
+    i, axis, middle:       NativeUInt;
+    swapIndex:             Cardinal;
+    splitPos, value:       Single;
+    leftIndex, rightIndex: Integer;
+    boxEmpty, centerEmpty: Boolean;
+begin
+    pNode         := @m_Nodes[nodeIndex];
+    pNode.m_Box   := Default(TQRBox);
+    pNode.m_Left  := -1;
+    pNode.m_Right := -1;
+    pNode.m_Start := start;
+    pNode.m_Count := count;
+    centerBox     := Default(TQRBox);
+    boxEmpty      := True;
+    centerEmpty   := True;
 
-    try
-        // create left and right boxes
-        New(pLeftBox);
-        New(pRightBox);
+    // calculate the node box, and the box surrounding the item box centers
+    for i := start to start + count - 1 do
+    begin
+        AddBoxToBoundingBox(m_Items[m_Indices[i]].m_Box, @pNode.m_Box, boxEmpty);
 
-        // divide box in 2 sub-boxes
-        pNode.m_pBox.Cut(pLeftBox^, pRightBox^);
+        pointBox.Min := @m_Centers[m_Indices[i]];
+        pointBox.Max := @m_Centers[m_Indices[i]];
+        AddBoxToBoundingBox(pointBox, @centerBox, centerEmpty);
+    end;
 
-        // iterate again through polygons to divide
-        for polygon in polygons do
-            for i := 0 to 2 do
-            begin
-                // is canceled?
-                if (Assigned(hIsCanceled) and hIsCanceled) then
-                    Exit;
+    // is leaf? NOTE the depth is limited, in order to allow the tree to be traversed using a fixed
+    // size stack
+    if ((count <= 1) or (depth >= QR_AABB_Max_Depth)) then
+        Exit;
 
-                // check if first polygon vertice belongs to left or right sub-box
-                if (VectorIsBetween(polygon.GetVertex(i),
-                                    pLeftBox.Min^,
-                                    pLeftBox.Max^,
-                                    QR_Epsilon))
-                then
-                begin
-                    // get current left polygon index
-                    leftPolygonIndex := Length(leftPolygons);
+    // search for the longest axis of the center box
+    extent := centerBox.Max.Sub(centerBox.Min^);
 
-                    // add polygon to left list
-                    SetLength(leftPolygons, leftPolygonIndex + 1);
+    if ((extent.X >= extent.Y) and (extent.X >= extent.Z)) then
+    begin
+        axis     := 0;
+        splitPos := (centerBox.Min.X + centerBox.Max.X) * 0.5;
+    end
+    else
+    if (extent.Y >= extent.Z) then
+    begin
+        axis     := 1;
+        splitPos := (centerBox.Min.Y + centerBox.Max.Y) * 0.5;
+    end
+    else
+    begin
+        axis     := 2;
+        splitPos := (centerBox.Min.Z + centerBox.Max.Z) * 0.5;
+    end;
 
-                    // copy polygon
-                    for j := 0 to 2 do
-                        leftPolygons[leftPolygonIndex].SetVertex(j, polygon.GetVertex(j));
+    middle := start;
 
-                    break;
-                end
-                else
-                if (VectorIsBetween(polygon.GetVertex(i),
-                                    pRightBox.Min^,
-                                    pRightBox.Max^,
-                                    QR_Epsilon))
-                then
-                begin
-                    // get current right polygon index
-                    rightPolygonIndex := Length(rightPolygons);
+    // move the items whose center is below the split position at the beginning of the range
+    for i := start to start + count - 1 do
+    begin
+        case axis of
+            0: value := m_Centers[m_Indices[i]].X;
+            1: value := m_Centers[m_Indices[i]].Y;
+        else
+            value := m_Centers[m_Indices[i]].Z;
+        end;
 
-                    // add polygon to right list
-                    SetLength(rightPolygons, rightPolygonIndex + 1);
+        if (value < splitPos) then
+        begin
+            swapIndex         := m_Indices[i];
+            m_Indices[i]      := m_Indices[middle];
+            m_Indices[middle] := swapIndex;
+            Inc(middle);
+        end;
+    end;
 
-                    // copy polygon
-                    for j := 0 to 2 do
-                        rightPolygons[rightPolygonIndex].SetVertex(j, polygon.GetVertex(j));
+    // all the centers are on the same side, e.g. because they are equal? Split the range in half
+    if ((middle = start) or (middle = start + count)) then
+        middle := start + (count div 2);
 
-                    break;
-                end;
-            end;
-    finally
-        if (Assigned(pLeftBox)) then
-            Dispose(pLeftBox);
+    // create the children. NOTE the node array was allocated to contain the whole tree, so the
+    // node pointer remains valid
+    leftIndex  := m_NodeCount;
+    rightIndex := m_NodeCount + 1;
+    Inc(m_NodeCount, 2);
 
-        if (Assigned(pRightBox)) then
-            Dispose(pRightBox);
-    end;
+    pNode.m_Left  := leftIndex;
+    pNode.m_Right := rightIndex;
 
-    polygonCount      := Length(polygons);
-    leftPolygonCount  := Length(leftPolygons);
-    rightPolygonCount := Length(rightPolygons);
-    canResolveLeft    := ((leftPolygonCount  > 0) and (leftPolygonCount  < polygonCount));
-    canResolveRight   := ((rightPolygonCount > 0) and (rightPolygonCount < polygonCount));
+    // populate the children
+    Populate(leftIndex,  start,  middle - start,           depth + 1);
+    Populate(rightIndex, middle, (start + count) - middle, depth + 1);
+end;
+//--------------------------------------------------------------------------------------------------
+procedure TQRAABBSceneTree.Rebuild;
+var
+    itemCount, enabledCount, i: NativeUInt;
+begin
+    itemCount    := Length(m_Items);
+    enabledCount := 0;
+    m_NodeCount  := 0;
 
-    // leaf reached?
-    if ((not canResolveLeft) and (not canResolveRight)) then
-    begin
-        // iterate through polygons to copy
-        for polygon in polygons do
+    SetLength(m_Nodes,   0);
+    SetLength(m_Indices, itemCount);
+    SetLength(m_Centers, itemCount);
+
+    // iterate through items, and keep the enabled ones
+    if (itemCount > 0) then
+        for i := 0 to itemCount - 1 do
         begin
-            // get current polygon index
-            polygonIndex := Length(pNode.m_Polygons);
+            if (not m_Items[i].m_Enabled) then
+                continue;
+
+            m_Indices[enabledCount] := i;
+            m_Centers[i]            := m_Items[i].m_Box.Min.Add(m_Items[i].m_Box.Max^).Mul(0.5);
+            Inc(enabledCount);
+        end;
+
+    SetLength(m_Indices, enabledCount);
+
+    // something to build?
+    if (enabledCount > 0) then
+    begin
+        // a tree in which each node owns 0 or 2 children contains at most 2n - 1 nodes
+        SetLength(m_Nodes, (enabledCount * 2) - 1);
+
+        // create root node and populate tree
+        m_NodeCount := 1;
+        Populate(0, 0, enabledCount, 0);
+
+        // release the unused nodes
+        SetLength(m_Nodes, m_NodeCount);
+    end;
+
+    // centers are no longer needed
+    SetLength(m_Centers, 0);
+end;
+//--------------------------------------------------------------------------------------------------
+procedure TQRAABBSceneTree.Refit;
+var
+    nodeIndex: NativeInt;
+    i:         NativeUInt;
+    pNode:     PQRAABBNode;
+    boxEmpty:  Boolean;
+begin
+    // iterate through nodes, from the last to the first. As a child index is always higher than
+    // his parent index, each child box is updated before his parent box
+    for nodeIndex := NativeInt(m_NodeCount) - 1 downto 0 do
+    begin
+        pNode       := @m_Nodes[nodeIndex];
+        pNode.m_Box := Default(TQRBox);
+        boxEmpty    := True;
 
-            // add polygon to leaf
-            SetLength(pNode.m_Polygons, polygonIndex + 1);
+        // is leaf?
+        if ((pNode.m_Left < 0) and (pNode.m_Right < 0)) then
+        begin
+            // calculate the leaf box from his item boxes
+            if (pNode.m_Count > 0) then
+                for i := pNode.m_Start to pNode.m_Start + pNode.m_Count - 1 do
+                    AddBoxToBoundingBox(m_Items[m_Indices[i]].m_Box, @pNode.m_Box, boxEmpty);
 
-            // copy polygon content
-            for i := 0 to 2 do
-                pNode.m_Polygons[polygonIndex].SetVertex(i, polygon.GetVertex(i));
+            continue;
         end;
 
-        // delete left and right lists, as they will no more be used
-        SetLength(leftPolygons,  0);
-        SetLength(rightPolygons, 0);
+        // calculate the node box from his children boxes
+        if (pNode.m_Left >= 0) then
+            AddBoxToBoundingBox(m_Nodes[pNode.m_Left].m_Box, @pNode.m_Box, boxEmpty);
 
-        Exit(True);
+        if (pNode.m_Right >= 0) then
+            AddBoxToBoundingBox(m_Nodes[pNode.m_Right].m_Box, @pNode.m_Box, boxEmpty);
+    end;
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRAABBSceneTree.GetItem(index: NativeUInt): PQRAABBSceneItem;
+begin
+    if (index >= NativeUInt(Length(m_Items))) then
+        Exit(nil);
+
+    Result := @m_Items[index];
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRAABBSceneTree.GetCount: NativeUInt;
+begin
+    Result := Length(m_Items);
+end;
+//--------------------------------------------------------------------------------------------------
+procedure TQRAABBSceneTree.Clear;
+begin
+    SetLength(m_Items,   0);
+    SetLength(m_Nodes,   0);
+    SetLength(m_Indices, 0);
+    SetLength(m_Centers, 0);
+
+    m_NodeCount := 0;
+    m_Rebuild   := False;
+    m_Refit     := False;
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRAABBSceneTree.Add(pTree: TQRAABBTree;
+                     const matrix: TQRMatrix4x4;
+                            pData: Pointer): NativeUInt;
+begin
+    Result := Length(m_Items);
+    SetLength(m_Items, Result + 1);
+
+    // populate the new item
+    m_Items[Result].m_pTree  := pTree;
+    m_Items[Result].m_Matrix := matrix;
+    m_Items[Result].m_pData  := pData;
+    UpdateItem(@m_Items[Result]);
+
+    // the hierarchy should be rebuilt to contain the new item
+    m_Rebuild := True;
+end;
+//--------------------------------------------------------------------------------------------------
+procedure TQRAABBSceneTree.Delete(index: NativeUInt);
+var
+    itemCount, i: NativeUInt;
+begin
+    itemCount := Length(m_Items);
+
+    // is index out of bounds?
+    if (index >= itemCount) then
+        Exit;
+
+    // move the next items
+    if (index < itemCount - 1) then
+        for i := index to itemCount - 2 do
+            m_Items[i] := m_Items[i + 1];
+
+    SetLength(m_Items, itemCount - 1);
+
+    // the hierarchy should be rebuilt, because the item indices changed
+    m_Rebuild := True;
+end;
+//--------------------------------------------------------------------------------------------------
+procedure TQRAABBSceneTree.SetMatrix(index: NativeUInt; const matrix: TQRMatrix4x4);
+var
+    pItem:   PQRAABBSceneItem;
+    enabled: Boolean;
+begin
+    pItem := GetItem(index);
+
+    if (not Assigned(pItem)) then
+        Exit;
+
+    enabled        := pItem.m_Enabled;
+    pItem.m_Matrix := matrix;
+    UpdateItem(pItem);
+
+    // the item was enabled or disabled? In this case the hierarchy should be rebuilt, otherwise
+    // refitting the node boxes is enough
+    if (pItem.m_Enabled <> enabled) then
+        m_Rebuild := True
+    else
+        m_Refit := True;
+end;
+//--------------------------------------------------------------------------------------------------
+procedure TQRAABBSceneTree.SetTree(index: NativeUInt; pTree: TQRAABBTree);
+var
+    pItem:   PQRAABBSceneItem;
+    enabled: Boolean;
+begin
+    pItem := GetItem(index);
+
+    if (not Assigned(pItem)) then
+        Exit;
+
+    enabled       := pItem.m_Enabled;
+    pItem.m_pTree := pTree;
+    UpdateItem(pItem);
+
+    // the item was enabled or disabled? In this case the hierarchy should be rebuilt, otherwise
+    // refitting the node boxes is enough
+    if (pItem.m_Enabled <> enabled) then
+        m_Rebuild := True
+    else
+        m_Refit := True;
+end;
+//--------------------------------------------------------------------------------------------------
+procedure TQRAABBSceneTree.Update;
+begin
+    // do rebuild the hierarchy? NOTE the boxes are also calculated while the tree is rebuilt
+    if (m_Rebuild) then
+    begin
+        Rebuild;
+        m_Rebuild := False;
+        m_Refit   := False;
+        Exit;
     end;
 
-    // do create left node?
-    if (canResolveLeft) then
+    // do refit the boxes?
+    if (m_Refit) then
     begin
-        // create and populate left node
-        New(pNode.m_pLeft);
-        pNode.m_pLeft.m_pParent := pNode;
+        Refit;
+        m_Refit := False;
+    end;
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRAABBSceneTree.RaycastClosest(const pRay: TQRRay; out hit: TQRAABBSceneRayHit): Boolean;
+begin
+    Result := RaycastClosest(pRay, Infinity, hit);
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRAABBSceneTree.RaycastClosest(const pRay: TQRRay;
+                                  const maxDistance: Single;
+                                            out hit: TQRAABBSceneRayHit): Boolean;
+type
+    IQRStackEntry = record
+        m_NodeIndex: Integer;
+        m_Near:      Single;
+    end;
+var
+    stack:                                  array [0..QR_AABB_Max_Depth + 1] of IQRStackEntry;
+    stackSize:                              NativeInt;
+    nearIndex, farIndex:                    Integer;
+    i:                                      NativeUInt;
+    pNode:                                  PQRAABBNode;
+    pItem:                                  PQRAABBSceneItem;
+    pModelRay:                              TQRRay;
+    modelPos, modelDir:                     TQRVector3D;
+    modelHit:                               TQRRayHit;
+    leftHit, rightHit:                      Boolean;
+    tNear, tFar, leftNear, rightNear, best: Single;
+    nearDist, farDist:                      Single;
+begin
+    hit.m_Hit.m_Distance     := maxDistance;
+    hit.m_Hit.m_PolygonIndex := -1;
+    hit.m_Hit.m_U            := 0.0;
+    hit.m_Hit.m_V            := 0.0;
+    hit.m_ItemIndex          := -1;
+    hit.m_pData              := nil;
+
+    // no ray?
+    if (not Assigned(pRay)) then
+        Exit(False);
+
+    // apply the pending changes, if any
+    Update;
+
+    // empty tree?
+    if (m_NodeCount = 0) then
+        Exit(False);
+
+    // check if ray intersects the root box, and if this box isn't behind the ray
+    if ((not TQRCollisionHelper.GetRayBoxCollision(pRay, @m_Nodes[0].m_Box, tNear, tFar)) or
+        (tFar < 0.0) or (tNear > maxDistance))
+    then
+        Exit(False);
+
+    best := maxDistance;
+
+    // push the root node on the stack
+    stack[0].m_NodeIndex := 0;
+    stack[0].m_Near      := Max(tNear, 0.0);
+    stackSize            := 1;
+
+    pModelRay := TQRRay.Create;
 
-        Result := Populate(pNode.m_pLeft, leftPolygons, hIsCanceled) or Result;
+    try
+        // iterate through nodes to visit, from the nearest to the farthest
+        while (stackSize > 0) do
+        begin
+            // pop the next node to visit
+            Dec(stackSize);
 
-        // delete current list, as it will no more be used
-        SetLength(leftPolygons, 0);
-    end;
+            // a closer hit was found since this node was pushed?
+            if (stack[stackSize].m_Near > best) then
+                continue;
 
-    // do create right node?
-    if (canResolveRight) then
-    begin
-        // create and populate right node
-        New(pNode.m_pRight);
-        pNode.m_pRight.m_pParent := pNode;
+            pNode := @m_Nodes[stack[stackSize].m_NodeIndex];
 
-        Result := Populate(pNode.m_pRight, rightPolygons, hIsCanceled) or Result;
+            // is leaf?
+            if ((pNode.m_Left < 0) and (pNode.m_Right < 0)) then
+            begin
+                // iterate through leaf items
+                for i := pNode.m_Start to pNode.m_Start + pNode.m_Count - 1 do
+                begin
+                    pItem := @m_Items[m_Indices[i]];
 
-        // delete current list, as it will no more be used
-        SetLength(rightPolygons, 0);
-    end;
-end;
-//--------------------------------------------------------------------------------------------------
-function TQRAABBTree.Resolve(const pRay: TQRRay;
-                            const pNode: PQRAABBNode;
-                           var polygons: TQRPolygons): Boolean;
-var
-    i:                           Byte;
-    index:                       NativeUInt;
-    polygon:                     TQRPolygon;
-    leftResolved, rightResolved: Boolean;
-begin
-    // no node to resolve? (this should never happen, but...)
-    if (not Assigned(pNode)) then
-        Exit(False);
+                    // transform the ray to the model coordinates. NOTE the direction isn't
+                    // normalized, thus the hit distances found in the model trees are expressed in
+                    // scene ray direction length units, and can be compared between models
+                    modelPos      := pItem.m_InvMatrix.Transform(pRay.Pos^);
+                    modelDir      := pItem.m_InvMatrix.TransformNormal(pRay.Dir^);
+                    pModelRay.Pos := @modelPos;
+                    pModelRay.Dir := @modelDir;
 
-    leftResolved  := False;
-    rightResolved := False;
+                    // search for a closer hit in the model tree
+                    if (pItem.m_pTree.RaycastClosest(pModelRay, best, modelHit)) then
+                    begin
+                        best            := modelHit.m_Distance;
+                        hit.m_Hit       := modelHit;
+                        hit.m_ItemIndex := m_Indices[i];
+                        hit.m_pData     := pItem.m_pData;
+                    end;
+                end;
 
-    // is leaf?
-    if ((not Assigned(pNode.m_pLeft)) and (not Assigned(pNode.m_pRight))) then
-    begin
-        // iterate through polygons
-        for polygon in pNode.m_Polygons do
-        begin
-            // get current output list index
-            index := Length(polygons);
+                continue;
+            end;
 
-            // add new polygon to output list
-            SetLength(polygons, index + 1);
+            // check if ray intersects the child boxes, ignoring the boxes behind the ray or
+            // farther than the best hit
+            leftHit  := (pNode.m_Left >= 0) and
+                        TQRCollisionHelper.GetRayBoxCollision(pRay, @m_Nodes[pNode.m_Left].m_Box, tNear, tFar) and
+                        (tFar >= 0.0) and (tNear <= best);
+            leftNear := Max(tNear, 0.0);
 
-            // copy polygon content
-            for i := 0 to 2 do
-                polygons[index].SetVertex(i, polygon.GetVertex(i));
-        end;
+            rightHit  := (pNode.m_Right >= 0) and
+                         TQRCollisionHelper.GetRayBoxCollision(pRay, @m_Nodes[pNode.m_Right].m_Box, tNear, tFar) and
+                         (tFar >= 0.0) and (tNear <= best);
+            rightNear := Max(tNear, 0.0);
 
-        Exit(True);
-    end;
+            // only one child to visit?
+            if (leftHit and not rightHit) then
+            begin
+                stack[stackSize].m_NodeIndex := pNode.m_Left;
+                stack[stackSize].m_Near      := leftNear;
+                Inc(stackSize);
+                continue;
+            end;
 
-    // check if ray intersects the left box
-    if (Assigned(pNode.m_pLeft) and TQRCollisionHelper.GetRayBoxCollision(pRay, pNode.m_pLeft.m_pBox)) then
-        // resolve left node
-        leftResolved := Resolve(pRay, pNode.m_pLeft, polygons);
+            if (rightHit and not leftHit) then
+            begin
+                stack[stackSize].m_NodeIndex := pNode.m_Right;
+                stack[stackSize].m_Near      := rightNear;
+                Inc(stackSize);
+                continue;
+            end;
 
-    // check if ray intersects the right box
-    if (Assigned(pNode.m_pRight) and TQRCollisionHelper.GetRayBoxCollision(pRay, pNode.m_pRight.m_pBox)) then
-        // resolve right node
-        rightResolved := Resolve(pRay, pNode.m_pRight, polygons);
+            // no child to visit?
+            if (not leftHit) then
+                continue;
 
-    Result := (leftResolved or rightResolved);
-end;
-//--------------------------------------------------------------------------------------------------
-function TQRAABBTree.Populate(const polygons: TQRPolygons;
-                                 hIsCanceled: TQRIsCanceledEvent): Boolean;
-begin
-    // tree was already populated?
-    if (Assigned(m_pRoot)) then
-        // clear it first
-        Release(m_pRoot);
+            // sort the children by distance
+            if (leftNear <= rightNear) then
+            begin
+                nearIndex := pNode.m_Left;
+                nearDist  := leftNear;
+                farIndex  := pNode.m_Right;
+                farDist   := rightNear;
+            end
+            else
+            begin
+                nearIndex := pNode.m_Right;
+                nearDist  := rightNear;
+                farIndex  := pNode.m_Left;
+                farDist   := leftNear;
+            end;
 
-    // create root node
-    New(m_pRoot);
-    m_pRoot.m_pParent := nil;
+            // push the farthest child first, so the nearest is visited first
+            stack[stackSize].m_NodeIndex     := farIndex;
+            stack[stackSize].m_Near          := farDist;
+            stack[stackSize + 1].m_NodeIndex := nearIndex;
+            stack[stackSize + 1].m_Near      := nearDist;
+            Inc(stackSize, 2);
+        end;
+    finally
+        pModelRay.Free;
+    end;
 
-    // populate tree
-    Result := Populate(m_pRoot, polygons, hIsCanceled);
-end;
-//--------------------------------------------------------------------------------------------------
-function TQRAABBTree.Resolve(const pRay: TQRRay; var polygons: TQRPolygons): Boolean;
-begin
-    Result := Resolve(pRay, m_pRoot, polygons);
+    Result := (hit.m_ItemIndex >= 0);
 end;
 //--------------------------------------------------------------------------------------------------
 // TQRCollisionHelper
@@ -632,18 +4570,133 @@ end;
 class function TQRCollisionHelper.GetRayPolygonCollision(const pRay: TQRRay;
                                                       const polygon: TQRPolygon): Boolean;
 var
-    polygonPlane: TQRPlane;
-    pointOnPlane: TQRVector3D;
+    distance, u, v: Single;
+begin
+    Result := GetRayTriangleCollision(pRay, polygon, distance, u, v);
+end;
+//--------------------------------------------------------------------------------------------------
+class function TQRCollisionHelper.GetRayTriangleCollision(const pRay: TQRRay;
+                                                       const polygon: TQRPolygon;
+                                                   out distance, u, v: Single): Boolean;
+begin
+    // no ray to check?
+    if (not Assigned(pRay)) then
+    begin
+        distance := 0.0;
+        u        := 0.0;
+        v        := 0.0;
+        Exit(False);
+    end;
+
+    Result := GetRayTriangleCollision(pRay.Pos^, pRay.Dir^, polygon, distance, u, v);
+end;
+//--------------------------------------------------------------------------------------------------
+class function TQRCollisionHelper.GetRayTriangleCollision(const rayPos, rayDir: TQRVector3D;
+                                                               const polygon: TQRPolygon;
+                                                           out distance, u, v: Single): Boolean;
+var
+    edge1, edge2, pVec, tVec, qVec: TQRVector3D;
+    det, invDet:                    Single;
+begin
+    distance := 0.0;
+    u        := 0.0;
+    v        := 0.0;
+
+    // calculate the polygon edges sharing the first vertex
+    edge1 := polygon.Vertex2.Sub(polygon.Vertex1^);
+    edge2 := polygon.Vertex3.Sub(polygon.Vertex1^);
+
+    // calculate the determinant, if near zero the ray is parallel to the polygon plane
+    pVec := rayDir.Cross(edge2);
+    det  := edge1.Dot(pVec);
+
+    if (Abs(det) < QR_Ray_Triangle_Epsilon) then
+        Exit(False);
+
+    invDet := 1.0 / det;
+
+    // calculate the u barycentric coordinate and check if it's inside the polygon
+    tVec := rayPos.Sub(polygon.Vertex1^);
+    u    := tVec.Dot(pVec) * invDet;
+
+    if ((u < 0.0) or (u > 1.0)) then
+        Exit(False);
+
+    // calculate the v barycentric coordinate and check if it's inside the polygon
+    qVec := tVec.Cross(edge1);
+    v    := rayDir.Dot(qVec) * invDet;
+
+    if ((v < 0.0) or ((u + v) > 1.0)) then
+        Exit(False);
+
+    // calculate the distance between the ray position and the hit point
+    distance := edge2.Dot(qVec) * invDet;
+    Result   := True;
+end;
+//--------------------------------------------------------------------------------------------------
+class function TQRCollisionHelper.GetRayTriangleCollision(const pRay: TQRRay;
+                                                     const pPolygons: PQRPolygon;
+                                                               count: NativeUInt;
+                                                             var hit: TQRRayHit): Boolean;
+begin
+    // no ray to check?
+    if (not Assigned(pRay)) then
+        Exit(False);
+
+    Result := GetRayTriangleCollision(pRay.Pos^, pRay.Dir^, pPolygons, count, hit);
+end;
+//--------------------------------------------------------------------------------------------------
+class function TQRCollisionHelper.GetRayTriangleCollision(const rayPos, rayDir: TQRVector3D;
+                                                             const pPolygons: PQRPolygon;
+                                                                       count: NativeUInt;
+                                                                     var hit: TQRRayHit): Boolean;
+var
+    i:              NativeUInt;
+    pPolygon:       PQRPolygon;
+    distance, u, v: Single;
+begin
+    Result := False;
+
+    // nothing to check?
+    if ((not Assigned(pPolygons)) or (count = 0)) then
+        Exit;
+
+    pPolygon := pPolygons;
+
+    // iterate through polygons to check
+    for i := 0 to count - 1 do
+    begin
+        // check if ray intersects polygon in front of his position, and closer than the best hit
+        if (GetRayTriangleCollision(rayPos, rayDir, pPolygon^, distance, u, v) and (distance >= 0.0) and
+           (distance <= hit.m_Distance))
+        then
+        begin
+            hit.m_Distance     := distance;
+            hit.m_PolygonIndex := i;
+            hit.m_U            := u;
+            hit.m_V            := v;
+            hit.m_Polygon      := pPolygon^;
+            Result             := True;
+        end;
+
+        Inc(pPolygon);
+    end;
+end;
+//--------------------------------------------------------------------------------------------------
+class function TQRCollisionHelper.GetRayTriangleCollision(const pRay: TQRRay;
+                                                    const polygons: TQRPolygons;
+                                                           out hit: TQRRayHit): Boolean;
 begin
-    // create a plane using the 3 vertices of the polygon
-    polygonPlane := polygon.GetPlane;
+    hit.m_Distance     := Infinity;
+    hit.m_PolygonIndex := -1;
+    hit.m_U            := 0.0;
+    hit.m_V            := 0.0;
 
-    // calculate the intersection point
-    if (not polygonPlane.IntersectRay(pRay.Pos^, pRay.Dir^, pointOnPlane)) then
+    // nothing to check?
+    if (Length(polygons) = 0) then
         Exit(False);
 
-    // check if calculated point is inside the polygon
-    Result := polygon.Inside(pointOnPlane);
+    Result := GetRayTriangleCollision(pRay, @polygons[0], Length(polygons), hit);
 end;
 //--------------------------------------------------------------------------------------------------
 class function TQRCollisionHelper.GetRayBoxCollision(const pRay: TQRRay; const pBox: PQRBox): Boolean;
@@ -730,11 +4783,418 @@ begin
     Result := (tfar >= tnear);
 end;
 //--------------------------------------------------------------------------------------------------
+class function TQRCollisionHelper.GetRaySlabCollision(const boxMin, boxMax, rayPos, rayInvDir: Single;
+                                                                       out tNear, tFar: Single): Boolean;
+var
+    t1, t2: Single;
+begin
+    // is ray parallel to the slab? In this case it crosses the slab only if its position is inside
+    if (IsInfinite(rayInvDir)) then
+    begin
+        tNear  := NegInfinity;
+        tFar   := Infinity;
+        Result := ((rayPos >= boxMin) and (rayPos <= boxMax));
+        Exit;
+    end;
+
+    // calculate the distances where the ray crosses the slab edges
+    t1 := (boxMin - rayPos) * rayInvDir;
+    t2 := (boxMax - rayPos) * rayInvDir;
+
+    tNear  := Min(t1, t2);
+    tFar   := Max(t1, t2);
+    Result := True;
+end;
+//--------------------------------------------------------------------------------------------------
+class function TQRCollisionHelper.GetRayBoxCollision(const pRay: TQRRay;
+                                                     const pBox: PQRBox;
+                                                out tNear, tFar: Single): Boolean;
+var
+    tyNear, tyFar, tzNear, tzFar: Single;
+begin
+    tNear := 0.0;
+    tFar  := 0.0;
+
+    // no ray or box to check?
+    if ((not Assigned(pRay)) or (not Assigned(pBox))) then
+        Exit(False);
+
+    // calculate the near and far intersections on each axis
+    if (not GetRaySlabCollision(pBox.Min.X, pBox.Max.X, pRay.Pos.X, pRay.InvDir.X, tNear, tFar)) then
+        Exit(False);
+
+    if (not GetRaySlabCollision(pBox.Min.Y, pBox.Max.Y, pRay.Pos.Y, pRay.InvDir.Y, tyNear, tyFar)) then
+        Exit(False);
+
+    if (not GetRaySlabCollision(pBox.Min.Z, pBox.Max.Z, pRay.Pos.Z, pRay.InvDir.Z, tzNear, tzFar)) then
+        Exit(False);
+
+    // calculate final near/far intersection distances
+    tNear := Max(tNear, Max(tyNear, tzNear));
+    tFar  := Min(tFar,  Min(tyFar,  tzFar));
+
+    // check if ray intersects box
+    Result := (tFar >= tNear);
+end;
+//--------------------------------------------------------------------------------------------------
+class function TQRCollisionHelper.GetPacketInvDir(const value: Single): Single;
+begin
+    // is direction empty? In this case use a huge finite value instead of an infinite one
+    if (value = 0.0) then
+        Exit(QR_Ray_Packet_Max_Inv_Dir);
+
+    Result := (1.0 / value);
+end;
+//--------------------------------------------------------------------------------------------------
+class function TQRCollisionHelper.GetRayPacketBoxCollision(const packet: TQRRayPacket;
+                                                                  const box: TQRBox;
+                                                                       mask: Byte;
+                                                                   out tMin: Single): Byte;
+var
+    lane:                               NativeUInt;
+    minX, minY, minZ, maxX, maxY, maxZ: Single;
+    t1, t2, tNear, tFar:                Single;
+begin
+    Result := 0;
+    tMin   := Infinity;
+
+    // get the box edges once for all the rays
+    minX := box.Min.X;
+    minY := box.Min.Y;
+    minZ := box.Min.Z;
+    maxX := box.Max.X;
+    maxY := box.Max.Y;
+    maxZ := box.Max.Z;
+
+    // iterate through packet rays. NOTE as the packet inverse directions are always finite, the
+    // slabs are tested without any check on the direction
+    for lane := 0 to QR_Ray_Packet_Size - 1 do
+    begin
+        // ray isn't tested?
+        if ((mask and (1 shl lane)) = 0) then
+            continue;
+
+        // calculate the distances where the ray crosses the x slab
+        t1    := (minX - packet.m_PosX[lane]) * packet.m_InvDirX[lane];
+        t2    := (maxX - packet.m_PosX[lane]) * packet.m_InvDirX[lane];
+        tNear := Min(t1, t2);
+        tFar  := Max(t1, t2);
+
+        // calculate the distances where the ray crosses the y slab
+        t1    := (minY - packet.m_PosY[lane]) * packet.m_InvDirY[lane];
+        t2    := (maxY - packet.m_PosY[lane]) * packet.m_InvDirY[lane];
+        tNear := Max(tNear, Min(t1, t2));
+        tFar  := Min(tFar,  Max(t1, t2));
+
+        // calculate the distances where the ray crosses the z slab
+        t1    := (minZ - packet.m_PosZ[lane]) * packet.m_InvDirZ[lane];
+        t2    := (maxZ - packet.m_PosZ[lane]) * packet.m_InvDirZ[lane];
+        tNear := Max(tNear, Min(t1, t2));
+        tFar  := Min(tFar,  Max(t1, t2));
+
+        // check if ray intersects box in front of his position, and not farther than his best hit
+        if ((tFar < tNear) or (tFar < 0.0) or (tNear > packet.m_Best[lane])) then
+            continue;
+
+        Result := Result or Byte(1 shl lane);
+        tMin   := Min(tMin, Max(tNear, 0.0));
+    end;
+end;
+//--------------------------------------------------------------------------------------------------
+class function TQRCollisionHelper.GetClosestPointOnTriangle(const point: TQRVector3D;
+                                                          const polygon: TQRPolygon): TQRVector3D;
+var
+    a, b, c, ab, ac, ap, bp, cp: TQRVector3D;
+    d1, d2, d3, d4, d5, d6:      Single;
+    va, vb, vc, v, w, denom:     Single;
+begin
+    a := polygon.Vertex1^;
+    b := polygon.Vertex2^;
+    c := polygon.Vertex3^;
+
+    ab := b.Sub(a);
+    ac := c.Sub(a);
+    ap := point.Sub(a);
+
+    // is point in the vertex a region?
+    d1 := ab.Dot(ap);
+    d2 := ac.Dot(ap);
+
+    if ((d1 <= 0.0) and (d2 <= 0.0)) then
+        Exit(a);
+
+    // is point in the vertex b region?
+    bp := point.Sub(b);
+    d3 := ab.Dot(bp);
+    d4 := ac.Dot(bp);
+
+    if ((d3 >= 0.0) and (d4 <= d3)) then
+        Exit(b);
+
+    // is point in the ab edge region?
+    vc := d1 * d4 - d3 * d2;
+
+    if ((vc <= 0.0) and (d1 >= 0.0) and (d3 <= 0.0)) then
+    begin
+        v := d1 / (d1 - d3);
+        Exit(a.Add(ab.Mul(v)));
+    end;
+
+    // is point in the vertex c region?
+    cp := point.Sub(c);
+    d5 := ab.Dot(cp);
+    d6 := ac.Dot(cp);
+
+    if ((d6 >= 0.0) and (d5 <= d6)) then
+        Exit(c);
+
+    // is point in the ac edge region?
+    vb := d5 * d2 - d1 * d6;
+
+    if ((vb <= 0.0) and (d2 >= 0.0) and (d6 <= 0.0)) then
+    begin
+        w := d2 / (d2 - d6);
+        Exit(a.Add(ac.Mul(w)));
+    end;
+
+    // is point in the bc edge region?
+    va := d3 * d6 - d5 * d4;
+
+    if ((va <= 0.0) and ((d4 - d3) >= 0.0) and ((d5 - d6) >= 0.0)) then
+    begin
+        w := (d4 - d3) / ((d4 - d3) + (d5 - d6));
+        Exit(b.Add(c.Sub(b).Mul(w)));
+    end;
+
+    // point is inside the face region, calculate his projection using his barycentric coordinates
+    denom := 1.0 / (va + vb + vc);
+    v     := vb * denom;
+    w     := vc * denom;
+    Result := a.Add(ab.Mul(v)).Add(ac.Mul(w));
+end;
+//--------------------------------------------------------------------------------------------------
+class function TQRCollisionHelper.GetSphereBoxCollision(const sphere: TQRSphere;
+                                                           const box: TQRBox): Boolean;
+var
+    d, dist: Single;
+begin
+    dist := 0.0;
+
+    // calculate the squared distance between the sphere center and the box on the x axis
+    if (sphere.Pos.X < box.Min.X) then
+    begin
+        d    := box.Min.X - sphere.Pos.X;
+        dist := dist + (d * d);
+    end
+    else
+    if (sphere.Pos.X > box.Max.X) then
+    begin
+        d    := sphere.Pos.X - box.Max.X;
+        dist := dist + (d * d);
+    end;
+
+    // same on the y axis
+    if (sphere.Pos.Y < box.Min.Y) then
+    begin
+        d    := box.Min.Y - sphere.Pos.Y;
+        dist := dist + (d * d);
+    end
+    else
+    if (sphere.Pos.Y > box.Max.Y) then
+    begin
+        d    := sphere.Pos.Y - box.Max.Y;
+        dist := dist + (d * d);
+    end;
+
+    // same on the z axis
+    if (sphere.Pos.Z < box.Min.Z) then
+    begin
+        d    := box.Min.Z - sphere.Pos.Z;
+        dist := dist + (d * d);
+    end
+    else
+    if (sphere.Pos.Z > box.Max.Z) then
+    begin
+        d    := sphere.Pos.Z - box.Max.Z;
+        dist := dist + (d * d);
+    end;
+
+    Result := (dist <= (sphere.Radius * sphere.Radius));
+end;
+//--------------------------------------------------------------------------------------------------
+class function TQRCollisionHelper.GetBoxBoxCollision(const box1, box2: TQRBox): Boolean;
+begin
+    Result := not ((box1.Min.X > box2.Max.X) or (box1.Max.X < box2.Min.X) or
+                   (box1.Min.Y > box2.Max.Y) or (box1.Max.Y < box2.Min.Y) or
+                   (box1.Min.Z > box2.Max.Z) or (box1.Max.Z < box2.Min.Z));
+end;
+//--------------------------------------------------------------------------------------------------
+class function TQRCollisionHelper.GetFrustumBoxCollision(const frustum: TQRFrustum;
+                                                             const box: TQRBox): Boolean;
+var
+    i:      NativeUInt;
+    vertex: TQRVector3D;
+begin
+    // iterate through frustum planes
+    for i := 0 to 5 do
+    begin
+        // get the box vertex the most advanced in the plane normal direction
+        if (frustum[i].A >= 0.0) then
+            vertex.X := box.Max.X
+        else
+            vertex.X := box.Min.X;
+
+        if (frustum[i].B >= 0.0) then
+            vertex.Y := box.Max.Y
+        else
+            vertex.Y := box.Min.Y;
+
+        if (frustum[i].C >= 0.0) then
+            vertex.Z := box.Max.Z
+        else
+            vertex.Z := box.Min.Z;
+
+        // if even this vertex is behind the plane, the whole box is outside the frustum
+        if (frustum[i].DistanceTo(vertex) < 0.0) then
+            Exit(False);
+    end;
+
+    Result := True;
+end;
+//--------------------------------------------------------------------------------------------------
+class function TQRCollisionHelper.GetSphereTriangleCollision(const sphere: TQRSphere;
+                                                            const polygon: TQRPolygon): Boolean;
+var
+    delta: TQRVector3D;
+begin
+    // get the distance between the sphere center and the polygon closest point
+    delta := GetClosestPointOnTriangle(sphere.Pos^, polygon).Sub(sphere.Pos^);
+
+    Result := (delta.Dot(delta) <= (sphere.Radius * sphere.Radius));
+end;
+//--------------------------------------------------------------------------------------------------
+class function TQRCollisionHelper.IsSeparatingAxis(const axis, v1, v2, v3, extents: TQRVector3D): Boolean;
+var
+    p1, p2, p3, r: Single;
+begin
+    // project the triangle vertices on the axis
+    p1 := axis.Dot(v1);
+    p2 := axis.Dot(v2);
+    p3 := axis.Dot(v3);
+
+    // project the box (which is centered on the origin) on the axis
+    r := extents.X * Abs(axis.X) + extents.Y * Abs(axis.Y) + extents.Z * Abs(axis.Z);
+
+    // axis is separating if the projections don't overlap
+    Result := (Max(-Max(Max(p1, p2), p3), Min(Min(p1, p2), p3)) > r);
+end;
+//--------------------------------------------------------------------------------------------------
+class function TQRCollisionHelper.GetBoxTriangleCollision(const box: TQRBox;
+                                                      const polygon: TQRPolygon): Boolean;
+var
+    center, extents, v1, v2, v3, normal: TQRVector3D;
+    edges:                               array [0..2] of TQRVector3D;
+    i:                                   NativeUInt;
+begin
+    // calculate the box center and half size
+    center  := box.Min.Add(box.Max^).Mul(0.5);
+    extents := box.Max.Sub(box.Min^).Mul(0.5);
+
+    // move the triangle in the box space, in which the box is centered on the origin
+    v1 := polygon.Vertex1.Sub(center);
+    v2 := polygon.Vertex2.Sub(center);
+    v3 := polygon.Vertex3.Sub(center);
+
+    // test the box axes, i.e. the triangle bounding box against the box
+    if ((Max(Max(v1.X, v2.X), v3.X) < -extents.X) or (Min(Min(v1.X, v2.X), v3.X) > extents.X) or
+        (Max(Max(v1.Y, v2.Y), v3.Y) < -extents.Y) or (Min(Min(v1.Y, v2.Y), v3.Y) > extents.Y) or
+        (Max(Max(v1.Z, v2.Z), v3.Z) < -extents.Z) or (Min(Min(v1.Z, v2.Z), v3.Z) > extents.Z))
+    then
+        Exit(False);
+
+    // calculate the triangle edges
+    edges[0] := v2.Sub(v1);
+    edges[1] := v3.Sub(v2);
+    edges[2] := v1.Sub(v3);
+
+    // test the triangle plane
+    normal := edges[0].Cross(edges[1]);
+
+    if (IsSeparatingAxis(normal, v1, v2, v3, extents)) then
+        Exit(False);
+
+    // test the 9 axes resulting from the cross product between the box axes and triangle edges
+    for i := 0 to 2 do
+    begin
+        if (IsSeparatingAxis(TQRVector3D.Create(0.0, -edges[i].Z, edges[i].Y), v1, v2, v3, extents)) then
+            Exit(False);
+
+        if (IsSeparatingAxis(TQRVector3D.Create(edges[i].Z, 0.0, -edges[i].X), v1, v2, v3, extents)) then
+            Exit(False);
+
+        if (IsSeparatingAxis(TQRVector3D.Create(-edges[i].Y, edges[i].X, 0.0), v1, v2, v3, extents)) then
+            Exit(False);
+    end;
+
+    Result := True;
+end;
+//--------------------------------------------------------------------------------------------------
+class function TQRCollisionHelper.GetFrustumTriangleCollision(const frustum: TQRFrustum;
+                                                              const polygon: TQRPolygon): Boolean;
+var
+    i: NativeUInt;
+begin
+    // iterate through frustum planes
+    for i := 0 to 5 do
+        // are all the polygon vertices behind the plane?
+        if ((frustum[i].DistanceTo(polygon.Vertex1^) < 0.0) and
+            (frustum[i].DistanceTo(polygon.Vertex2^) < 0.0) and
+            (frustum[i].DistanceTo(polygon.Vertex3^) < 0.0))
+        then
+            Exit(False);
+
+    Result := True;
+end;
+//--------------------------------------------------------------------------------------------------
+class function TQRCollisionHelper.GetFrustum(const matrix: TQRMatrix4x4): TQRFrustum;
+var
+    i, column: NativeInt;
+    sign, len: Single;
+begin
+    // iterate through frustum planes. NOTE as the vectors are multiplied by the matrix rows, each
+    // plane is the sum (or the difference) between the w column and the x, y or z column
+    for i := 0 to 5 do
+    begin
+        column := i div 2;
+
+        if ((i mod 2) = 0) then
+            sign := 1.0
+        else
+            sign := -1.0;
+
+        Result[i].A := matrix.Table[0, 3] + sign * matrix.Table[0, column];
+        Result[i].B := matrix.Table[1, 3] + sign * matrix.Table[1, column];
+        Result[i].C := matrix.Table[2, 3] + sign * matrix.Table[2, column];
+        Result[i].D := matrix.Table[3, 3] + sign * matrix.Table[3, column];
+
+        // normalize the plane, in order to get real distances from it
+        len := Sqrt(Result[i].A * Result[i].A + Result[i].B * Result[i].B + Result[i].C * Result[i].C);
+
+        if (len = 0.0) then
+            continue;
+
+        Result[i].A := Result[i].A / len;
+        Result[i].B := Result[i].B / len;
+        Result[i].C := Result[i].C / len;
+        Result[i].D := Result[i].D / len;
+    end;
+end;
+//--------------------------------------------------------------------------------------------------
 class function TQRCollisionHelper.GetPolygons(const vertex: TQRVertex;
                                               var polygons: TQRPolygons;
                                                hIsCanceled: TQRIsCanceledEvent): Boolean;
 var
-    i, index, vbLength, stripLength, fanLength, step, v1, v2, v3, v4: NativeUInt;
+    i, index, vbLength, ibLength, stripLength, fanLength, step, v1, v2, v3, v4: NativeUInt;
 begin
     vbLength := Length(vertex.m_Buffer);
 
@@ -742,6 +5202,32 @@ begin
     if (vbLength = 0) then
         Exit(True);
 
+    ibLength := Length(vertex.m_Indices);
+
+    // is vertex indexed? In this case the indices always describe a triangle list
+    if (ibLength > 0) then
+    begin
+        i := 0;
+
+        // iterate through source indices
+        while ((i + 2) < ibLength) do
+        begin
+            // is canceled?
+            if (Assigned(hIsCanceled) and hIsCanceled) then
+                Exit(False);
+
+            AddPolygon(vertex.m_Buffer,
+                       vertex.m_Indices[i]     * vertex.m_Stride,
+                       vertex.m_Indices[i + 1] * vertex.m_Stride,
+                       vertex.m_Indices[i + 2] * vertex.m_Stride,
+                       polygons);
+
+            Inc(i, 3);
+        end;
+
+        Exit(True);
+    end;
+
     // search for vertex type
     case vertex.m_Type of
         EQR_VT_Triangles:
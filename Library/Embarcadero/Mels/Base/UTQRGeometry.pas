@@ -1641,6 +1641,8 @@ type
             property Vertex3: PQRVector3D read GetVertex3 write SetVertex3;
     end;
 
+    PQRPolygon = ^TQRPolygon;
+
     {$REGION 'Documentation'}
     {**
      Polygon list
@@ -68,6 +68,20 @@ const
     {$ELSE}
         {$MESSAGE FATAL 'Unknown platform type'}
     {$IFEND}
+
+    {$REGION 'Documentation'}
+    {**
+     Initial value of a FNV-1a hash
+    }
+    {$ENDREGION}
+    CQR_Hash_Seed = $811C9DC5;
+
+    {$REGION 'Documentation'}
+    {**
+     Prime by which a FNV-1a hash is multiplied for each hashed byte
+    }
+    {$ENDREGION}
+    CQR_Hash_Prime = 16777619;
 type
     {$REGION 'Documentation'}
     {**
@@ -258,6 +272,32 @@ type
         {$ENDREGION}
         class function AppendDelimiter(const dirName: UnicodeString;
                                            delimiter: Char = CQR_Dir_Delimiter): UnicodeString; static;
+
+        {$REGION 'Documentation'}
+        {**
+         Calculates the FNV-1a hash of a buffer
+         @param(pBuffer Buffer to hash)
+         @param(size Buffer size, in bytes)
+         @param(seed Initial hash value. A previous hash may be used here to hash several buffers
+                     in a row)
+         @return(Hash)
+        }
+        {$ENDREGION}
+        class function GetHash(const pBuffer: Pointer;
+                                        size: NativeUInt;
+                                        seed: TQRUInt32 = CQR_Hash_Seed): TQRUInt32; overload; static;
+
+        {$REGION 'Documentation'}
+        {**
+         Calculates the FNV-1a hash of a stream content, from the current position to the end
+         @param(pStream Stream to hash)
+         @param(seed Initial hash value. A previous hash may be used here to hash several sources
+                     in a row)
+         @return(Hash)
+        }
+        {$ENDREGION}
+        class function GetHash(pStream: TStream;
+                                  seed: TQRUInt32 = CQR_Hash_Seed): TQRUInt32; overload; static;
     end;
 
     PQRFileHelper = ^TQRFileHelper;
@@ -499,6 +539,56 @@ begin
     Result := dirName + delimiter;
 end;
 //--------------------------------------------------------------------------------------------------
+class function TQRFileHelper.GetHash(const pBuffer: Pointer;
+                                              size: NativeUInt;
+                                              seed: TQRUInt32): TQRUInt32;
+var
+    pData: PByte;
+    i:     NativeUInt;
+begin
+    Result := seed;
+
+    // nothing to hash?
+    if ((not Assigned(pBuffer)) or (size = 0)) then
+        Exit;
+
+    pData := pBuffer;
+
+    // iterate through bytes to hash
+    for i := 0 to size - 1 do
+    begin
+        // the product is calculated on 64 bit and truncated, in order to never raise an overflow
+        // error, even if the overflow checking is enabled
+        Result := TQRUInt32((UInt64(Result xor pData^) * CQR_Hash_Prime) and $FFFFFFFF);
+        Inc(pData);
+    end;
+end;
+//--------------------------------------------------------------------------------------------------
+class function TQRFileHelper.GetHash(pStream: TStream; seed: TQRUInt32): TQRUInt32;
+const
+    bufferSize = 65536;
+var
+    buffer:    TQRByteArray;
+    readCount: Integer;
+begin
+    Result := seed;
+
+    // no stream to hash?
+    if (not Assigned(pStream)) then
+        Exit;
+
+    SetLength(buffer, bufferSize);
+
+    // read and hash the stream content, block by block
+    readCount := pStream.Read(buffer[0], bufferSize);
+
+    while (readCount > 0) do
+    begin
+        Result    := GetHash(@buffer[0], readCount, Result);
+        readCount := pStream.Read(buffer[0], bufferSize);
+    end;
+end;
+//--------------------------------------------------------------------------------------------------
 // TQRMathsHelper
 //--------------------------------------------------------------------------------------------------
 class function TQRMathsHelper.IsPowerOfTwo(value: NativeUInt): Boolean;
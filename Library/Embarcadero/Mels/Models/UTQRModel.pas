@@ -31,6 +31,7 @@ interface
 
 uses System.Classes,
      System.SysUtils,
+     System.SyncObjs,
      System.Math,
      UTQRCommon,
      UTQRCache,
@@ -61,6 +62,19 @@ type
                                        lengthToRead: NativeUInt;
                                        out errorMsg: UnicodeString): Boolean; static;
 
+            {$REGION 'Documentation'}
+            {**
+             Gets the collision polygons of a mesh
+             @param(mesh Source mesh from which polygons should be get)
+             @param(polygons @bold([in, out]) Polygon list to populate)
+             @param(hIsCanceled Is canceled callback function to use, ignored if @nil)
+             @return(@true on success, otherwise @false)
+            }
+            {$ENDREGION}
+            class function GetPolygons(const mesh: TQRMesh;
+                                     var polygons: TQRPolygons;
+                                      hIsCanceled: TQRIsCanceledEvent = nil): Boolean; static;
+
             {$REGION 'Documentation'}
             {**
              Populate aligned-axis bounding box tree
@@ -74,6 +88,21 @@ type
                                              pAABBTree: TQRAABBTree;
                                            hIsCanceled: TQRIsCanceledEvent = nil): Boolean; static;
 
+            {$REGION 'Documentation'}
+            {**
+             Refits an already populated aligned-axis bounding box tree on a mesh sharing the same
+             topology as the mesh used to populate it, e.g. another frame of the same model, or a
+             mesh interpolated between 2 frames
+             @param(mesh Mesh on which the tree should be refitted)
+             @param(pAABBTree Aligned-axis bounding box tree to refit, ignored if @nil)
+             @param(hIsCanceled Is canceled callback function to use, ignored if @nil)
+             @return(@true on success, otherwise @false)
+            }
+            {$ENDREGION}
+            class function RefitAABBTree(const mesh: TQRMesh;
+                                          pAABBTree: TQRAABBTree;
+                                        hIsCanceled: TQRIsCanceledEvent = nil): Boolean; static;
+
             {$REGION 'Documentation'}
             {**
              Interpolates mesh
@@ -89,6 +118,26 @@ type
             class function Interpolate(const position: Single;
                                    const mesh1, mesh2: TQRMesh;
                                              out mesh: TQRMesh): Boolean; static;
+
+            {$REGION 'Documentation'}
+            {**
+             Interpolates mesh in a caller-owned mesh, whose vertices and buffers are reused between
+             calls
+             @param(position Interpolation position, in percent (between 0.0 and 1.0))
+             @param(mesh1 First mesh to interpolate)
+             @param(mesh2 Second mesh to interpolate)
+             @param(mesh @bold([in, out]) Resulting interpolated mesh, resized only if its layout
+                                          differs from the source meshes)
+             @return(@true on success, otherwise @false)
+             @br @bold(NOTE) The mesh buffers are overwritten in place, so the mesh should never
+                             share its buffers with another mesh, as e.g. a cached frame
+             @br @bold(NOTE) This function should only be used for compatibility with old OpenGL 1.x
+                             versions, as normally interpolation should be done in vertex shader
+            }
+            {$ENDREGION}
+            class function InterpolateTo(const position: Single;
+                                     const mesh1, mesh2: TQRMesh;
+                                               var mesh: TQRMesh): Boolean; static;
     end;
 
     {$REGION 'Documentation'}
@@ -267,6 +316,49 @@ type
                                  length: NativeUInt): Boolean; overload; virtual; abstract;
     end;
 
+    {$REGION 'Documentation'}
+    {**
+     Directional light prepared to be applied on many vertices, e.g. to pre-calculate the
+     lightning of a whole frame without creating a color object for each vertex
+    }
+    {$ENDREGION}
+    TQRVertexLight = record
+        private
+            m_Direction: TQRVector3D;
+            m_Color:     array[0..3] of Single;
+            m_Ambient:   array[0..3] of Single;
+
+        public
+            {$REGION 'Documentation'}
+            {**
+             Constructor
+             @param(pLight Light model to apply)
+            }
+            {$ENDREGION}
+            constructor Create(const pLight: TQRDirectionalLight);
+
+            {$REGION 'Documentation'}
+            {**
+             Calculates the vertex color based on the light model, and writes it in a vertex buffer
+             @param(normal Vertex normal)
+             @param(buffer @bold([in, out]) Vertex buffer in which the color should be written)
+             @param(offset Offset of the color in the vertex buffer)
+            }
+            {$ENDREGION}
+            procedure Apply(const normal: TQRVector3D;
+                             var buffer: TQRVertexBuffer;
+                                 offset: NativeInt); inline;
+
+            {$REGION 'Documentation'}
+            {**
+             Writes the light ambient color in a vertex buffer, e.g. if the vertex normal is unknown
+             @param(buffer @bold([in, out]) Vertex buffer in which the color should be written)
+             @param(offset Offset of the color in the vertex buffer)
+            }
+            {$ENDREGION}
+            procedure ApplyAmbient(var buffer: TQRVertexBuffer; offset: NativeInt); inline;
+    end;
+
     {$REGION 'Documentation'}
     {**
      Basic 3D model
@@ -389,6 +481,13 @@ type
                           hIsCanceled: TQRIsCanceledEvent): Boolean; virtual; abstract;
     end;
 
+    {$REGION 'Documentation'}
+    {**
+     Frame bounding boxes, one per frame of a framed model
+    }
+    {$ENDREGION}
+    TQRFrameBoxes = array of TQRBox;
+
     {$REGION 'Documentation'}
     {**
      Basic 3D framed model. A framed model is a model in which the animation is done frame by frame,
@@ -449,6 +548,50 @@ type
             }
             {$ENDREGION}
             function GetMeshCount: NativeUInt; virtual; abstract;
+
+            {$REGION 'Documentation'}
+            {**
+             Gets the aligned-axis bounding box enclosing a frame, without generating its mesh
+             @param(index Frame index)
+             @param(box @bold([out]) Frame bounding box)
+             @return(@true on success, otherwise @false)
+             @br @bold(NOTE) The default implementation returns @false, models supporting it
+                             calculate the frame boxes once, while the model is loaded
+            }
+            {$ENDREGION}
+            function GetFrameBox(index: NativeUInt; out box: TQRBox): Boolean; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Gets the bounding volumes enclosing a frame, without generating its mesh
+             @param(index Frame index)
+             @param(box @bold([out]) Frame aligned-axis bounding box)
+             @param(sphere @bold([out]) Frame bounding sphere)
+             @return(@true on success, otherwise @false)
+            }
+            {$ENDREGION}
+            function GetFrameBounds(index: NativeUInt;
+                                  out box: TQRBox;
+                               out sphere: TQRSphere): Boolean; overload; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Gets the bounding volumes enclosing a frame interpolated with another, without
+             generating its mesh
+             @param(index Frame index)
+             @param(nextIndex Frame index to interpolate with)
+             @param(interpolationFactor Interpolation factor to apply)
+             @param(box @bold([out]) Interpolated frame aligned-axis bounding box)
+             @param(sphere @bold([out]) Interpolated frame bounding sphere)
+             @return(@true on success, otherwise @false)
+             @br @bold(NOTE) The volumes enclose all the vertices of the interpolated frame mesh, so
+                             they can be used for culling or as a coarse picking test
+            }
+            {$ENDREGION}
+            function GetFrameBounds(index, nextIndex: NativeUInt;
+                                 interpolationFactor: Double;
+                                             out box: TQRBox;
+                                          out sphere: TQRSphere): Boolean; overload; virtual;
     end;
 
     {$REGION 'Documentation'}
@@ -474,6 +617,220 @@ type
             destructor Destroy; override;
     end;
 
+    {$REGION 'Documentation'}
+    {**
+     Called by a frame mesh build worker to process the pending frames
+     @param(hIsCanceled Callback function that allows to break the operation, can be @nil)
+    }
+    {$ENDREGION}
+    TQRFrameMeshBuildProcessEvent = procedure(hIsCanceled: TQRIsCanceledEvent) of object;
+
+    {$REGION 'Documentation'}
+    {**
+     Frame mesh build worker, processes pending frames on a separate thread
+    }
+    {$ENDREGION}
+    TQRFrameMeshBuildWorker = class(TThread)
+        private
+            m_fOnProcess:  TQRFrameMeshBuildProcessEvent;
+            m_hIsCanceled: TQRIsCanceledEvent;
+
+        protected
+            {$REGION 'Documentation'}
+            {**
+             Executes the thread
+            }
+            {$ENDREGION}
+            procedure Execute; override;
+
+        public
+            {$REGION 'Documentation'}
+            {**
+             Constructor
+             @param(fOnProcess Function processing the pending frames)
+             @param(hIsCanceled Callback function that allows to break the operation, can be @nil)
+             @br @bold(NOTE) The thread starts immediately
+            }
+            {$ENDREGION}
+            constructor Create(fOnProcess: TQRFrameMeshBuildProcessEvent;
+                              hIsCanceled: TQRIsCanceledEvent); reintroduce; virtual;
+    end;
+
+    {$REGION 'Documentation'}
+    {**
+     Called when a frame mesh was built by a frame mesh builder
+     @param(index Frame index)
+     @param(builtCount Frame count already built, including this one)
+     @param(totalCount Total frame count to build)
+     @br @bold(NOTE) This function is called from the build threads, but never concurrently
+    }
+    {$ENDREGION}
+    TQRFrameMeshBuiltEvent = procedure(index, builtCount, totalCount: NativeUInt) of object;
+
+    {$REGION 'Documentation'}
+    {**
+     Frame mesh build item
+    }
+    {$ENDREGION}
+    TQRFrameMeshBuildItem = record
+        {$REGION 'Documentation'}
+        {**
+         Frame mesh, @nil if not kept or extracted
+        }
+        {$ENDREGION}
+        m_pMesh: PQRMesh;
+
+        {$REGION 'Documentation'}
+        {**
+         Frame mesh collision polygons, empty if not collected
+        }
+        {$ENDREGION}
+        m_Polygons: TQRPolygons;
+
+        {$REGION 'Documentation'}
+        {**
+         If @true, the frame was successfully built
+        }
+        {$ENDREGION}
+        m_Success: Boolean;
+    end;
+
+    PQRFrameMeshBuildItem = ^TQRFrameMeshBuildItem;
+
+    {$REGION 'Documentation'}
+    {**
+     Frame mesh builder, generates the frame meshes of a framed model concurrently, e.g. to cache
+     them
+     @br @bold(NOTE) The model should support that several frames are generated concurrently, which
+                     is the case for the md2, mdl and md3 models
+    }
+    {$ENDREGION}
+    TQRFrameMeshBuilder = class
+        private
+            m_pModel:       TQRFramedModel;
+            m_Items:        array of TQRFrameMeshBuildItem;
+            m_pLock:        TCriticalSection;
+            m_FirstIndex:   NativeUInt;
+            m_NextItem:     NativeUInt;
+            m_BuiltCount:   NativeUInt;
+            m_MaxThreads:   NativeUInt;
+            m_KeepMeshes:   Boolean;
+            m_KeepPolygons: Boolean;
+            m_fOnMeshBuilt: TQRFrameMeshBuiltEvent;
+
+            {$REGION 'Documentation'}
+            {**
+             Releases the built frames
+            }
+            {$ENDREGION}
+            procedure Clear;
+
+        protected
+            {$REGION 'Documentation'}
+            {**
+             Builds the pending frames, until no frame remains
+             @param(hIsCanceled Callback function that allows to break the operation, can be @nil)
+             @br @bold(NOTE) This function is called by each build thread, including the calling
+                             thread
+            }
+            {$ENDREGION}
+            procedure ProcessItems(hIsCanceled: TQRIsCanceledEvent); virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Gets the frame count
+             @return(The frame count)
+            }
+            {$ENDREGION}
+            function GetCount: NativeUInt; virtual;
+
+        public
+            {$REGION 'Documentation'}
+            {**
+             Constructor
+             @param(pModel Model from which the frames are built)
+            }
+            {$ENDREGION}
+            constructor Create(pModel: TQRFramedModel); virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Destructor
+             @br @bold(NOTE) The meshes that were not extracted are deleted
+            }
+            {$ENDREGION}
+            destructor Destroy; override;
+
+            {$REGION 'Documentation'}
+            {**
+             Builds the model frames, on several threads
+             @param(firstIndex Index of the first frame to build)
+             @param(count Frame count to build)
+             @param(hIsCanceled Callback function that allows to break the operation, can be @nil)
+             @return(@true if all the frames were built, otherwise @false)
+            }
+            {$ENDREGION}
+            function Build(firstIndex, count: NativeUInt;
+                                 hIsCanceled: TQRIsCanceledEvent = nil): Boolean; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Extracts a frame mesh from the builder, the builder no longer takes care of it
+             @param(index Frame index in the builder, 0 for the first built frame)
+             @return(Mesh, @nil if not found, not kept or already extracted)
+            }
+            {$ENDREGION}
+            function Extract(index: NativeUInt): PQRMesh; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Extracts the collision polygons of a frame from the builder
+             @param(index Frame index in the builder, 0 for the first built frame)
+             @param(polygons @bold([out]) Frame collision polygons, empty if not found, not kept or
+                                          already extracted)
+            }
+            {$ENDREGION}
+            procedure ExtractPolygons(index: NativeUInt; out polygons: TQRPolygons); virtual;
+
+        // Properties
+        public
+            {$REGION 'Documentation'}
+            {**
+             Gets the frame count
+            }
+            {$ENDREGION}
+            property Count: NativeUInt read GetCount;
+
+            {$REGION 'Documentation'}
+            {**
+             Gets or sets the maximum thread count to use, 0 to use one thread per processor
+            }
+            {$ENDREGION}
+            property MaxThreads: NativeUInt read m_MaxThreads write m_MaxThreads;
+
+            {$REGION 'Documentation'}
+            {**
+             Gets or sets if the frame meshes should be kept. If @false, the meshes are deleted as
+             soon as their collision polygons are got
+            }
+            {$ENDREGION}
+            property KeepMeshes: Boolean read m_KeepMeshes write m_KeepMeshes;
+
+            {$REGION 'Documentation'}
+            {**
+             Gets or sets if the frame collision polygons should be kept, e.g. to build their trees
+            }
+            {$ENDREGION}
+            property KeepPolygons: Boolean read m_KeepPolygons write m_KeepPolygons;
+
+            {$REGION 'Documentation'}
+            {**
+             Gets or sets the OnMeshBuilt event
+            }
+            {$ENDREGION}
+            property OnMeshBuilt: TQRFrameMeshBuiltEvent read m_fOnMeshBuilt write m_fOnMeshBuilt;
+    end;
+
 implementation
 //--------------------------------------------------------------------------------------------------
 // TQRModelHelper
@@ -494,11 +851,25 @@ begin
     Result := False;
 end;
 //--------------------------------------------------------------------------------------------------
+class function TQRModelHelper.GetPolygons(const mesh: TQRMesh;
+                                        var polygons: TQRPolygons;
+                                         hIsCanceled: TQRIsCanceledEvent): Boolean;
+var
+    vertex: TQRVertex;
+begin
+    // iterate through meshes
+    for vertex in mesh do
+        // get collide polygons
+        if (not TQRCollisionHelper.GetPolygons(vertex, polygons, hIsCanceled)) then
+            Exit(False);
+
+    Result := True;
+end;
+//--------------------------------------------------------------------------------------------------
 class function TQRModelHelper.PopulateAABBTree(const mesh: TQRMesh;
                                                 pAABBTree: TQRAABBTree;
                                               hIsCanceled: TQRIsCanceledEvent): Boolean;
 var
-    vertex:   TQRVertex;
     polygons: TQRPolygons;
 begin
     // no destination tree?
@@ -506,23 +877,48 @@ begin
         // it's not an error so return true
         Exit(True);
 
-    // iterate through meshes
-    for vertex in mesh do
-        // get collide polygons
-        if (not TQRCollisionHelper.GetPolygons(vertex, polygons, hIsCanceled)) then
-            Exit(False);
+    // get collide polygons
+    if (not GetPolygons(mesh, polygons, hIsCanceled)) then
+        Exit(False);
 
     // populate aligned-axis bounding box tree
     Result := pAABBTree.Populate(polygons, hIsCanceled);
 end;
 //--------------------------------------------------------------------------------------------------
+class function TQRModelHelper.RefitAABBTree(const mesh: TQRMesh;
+                                             pAABBTree: TQRAABBTree;
+                                           hIsCanceled: TQRIsCanceledEvent): Boolean;
+var
+    polygons: TQRPolygons;
+begin
+    // no destination tree?
+    if (not Assigned(pAABBTree)) then
+        // it's not an error so return true
+        Exit(True);
+
+    // get collide polygons
+    if (not GetPolygons(mesh, polygons, hIsCanceled)) then
+        Exit(False);
+
+    // refit aligned-axis bounding box tree
+    Result := pAABBTree.Refit(polygons);
+end;
+//--------------------------------------------------------------------------------------------------
 class function TQRModelHelper.Interpolate(const position: Single;
                                       const mesh1, mesh2: TQRMesh;
                                                 out mesh: TQRMesh): Boolean;
+begin
+    Result := InterpolateTo(position, mesh1, mesh2, mesh);
+end;
+//--------------------------------------------------------------------------------------------------
+class function TQRModelHelper.InterpolateTo(const position: Single;
+                                        const mesh1, mesh2: TQRMesh;
+                                                  var mesh: TQRMesh): Boolean;
 var
-    count, bufferCount, i, j, index:                   NativeInt;
-    vertex:                                            TQRVertex;
-    srcVec, dstVec, vec, srcNormal, dstNormal, normal: TQRVector3D;
+    count, bufferCount, stride, lerpCount, i, j, k: NativeInt;
+    srcBuffer, dstBuffer, buffer:                   TQRVertexBuffer;
+    factor, x, y, z, len:                           Single;
+    hasNormals:                                     Boolean;
 begin
     // get vertice count
     count := Length(mesh1);
@@ -535,6 +931,19 @@ begin
     if (count = 0) then
         Exit(False);
 
+    // is position out of bounds? Limit to min or max values in this case
+    if (position < 0.0) then
+        factor := 0.0
+    else
+    if (position > 1.0) then
+        factor := 1.0
+    else
+        factor := position;
+
+    // resize the output mesh only if needed, in order to reuse its vertices between calls
+    if (Length(mesh) <> count) then
+        SetLength(mesh, count);
+
     // iterate through mesh to interpolate
     for i := 0 to count - 1 do
     begin
@@ -546,91 +955,76 @@ begin
         if (mesh1[i].m_CoordType <> EQR_VC_XYZ) then
             Exit(False);
 
-        vertex.m_Name      := mesh1[i].m_Name;
-        vertex.m_Stride    := mesh1[i].m_Stride;
-        vertex.m_Type      := mesh1[i].m_Type;
-        vertex.m_Format    := mesh1[i].m_Format;
-        vertex.m_CoordType := mesh1[i].m_CoordType;
-
         // get vertex buffer data count
         bufferCount := Length(mesh1[i].m_Buffer);
 
+        // are buffers compatible?
+        if (bufferCount <> Length(mesh2[i].m_Buffer)) then
+            Exit(False);
+
+        stride     := mesh1[i].m_Stride;
+        hasNormals := (EQR_VF_Normals in mesh1[i].m_Format);
+
+        // get the value count to interpolate, i.e. the position and the normal, if any. The
+        // remaining values (texture coordinates and colors) are copied from the source
+        if (hasNormals) then
+            lerpCount := 6
+        else
+            lerpCount := 3;
+
+        // is stride invalid?
+        if (stride < lerpCount) then
+            Exit(False);
+
+        mesh[i].m_Name      := mesh1[i].m_Name;
+        mesh[i].m_Stride    := stride;
+        mesh[i].m_Type      := mesh1[i].m_Type;
+        mesh[i].m_Format    := mesh1[i].m_Format;
+        mesh[i].m_CoordType := mesh1[i].m_CoordType;
+
+        // the index buffer, if any, is the same for both meshes, so it can be shared
+        mesh[i].m_Indices := mesh1[i].m_Indices;
+
+        // resize the output buffer only if needed, otherwise it's reused as is
+        if (Length(mesh[i].m_Buffer) <> bufferCount) then
+            SetLength(mesh[i].m_Buffer, bufferCount);
+
+        srcBuffer := mesh1[i].m_Buffer;
+        dstBuffer := mesh2[i].m_Buffer;
+        buffer    := mesh[i].m_Buffer;
+
         j := 0;
 
-        // iterate through vertex buffer content
-        while (j < bufferCount) do
+        // iterate through vertices, the whole buffer is processed in a single pass
+        while (j + stride <= bufferCount) do
         begin
-            index := 3;
-
-            // get positions
-            srcVec.X := mesh1[i].m_Buffer[j];
-            srcVec.Y := mesh1[i].m_Buffer[j + 1];
-            srcVec.Z := mesh1[i].m_Buffer[j + 2];
-            dstVec.X := mesh2[i].m_Buffer[j];
-            dstVec.Y := mesh2[i].m_Buffer[j + 1];
-            dstVec.Z := mesh2[i].m_Buffer[j + 2];
-
-            // interpolate positions
-            vec := srcVec.Interpolate(dstVec, position);
-
-            // set interpolated positions in destination buffer
-            SetLength(vertex.m_Buffer, Length(vertex.m_Buffer) + 3);
-            vertex.m_Buffer[j]     := vec.X;
-            vertex.m_Buffer[j + 1] := vec.Y;
-            vertex.m_Buffer[j + 2] := vec.Z;
-
-            // do include normals?
-            if (EQR_VF_Normals in mesh1[i].m_Format) then
-            begin
-                // get normals
-                srcNormal.X := mesh1[i].m_Buffer[j + index];
-                srcNormal.Y := mesh1[i].m_Buffer[j + index + 1];
-                srcNormal.Z := mesh1[i].m_Buffer[j + index + 2];
-                dstNormal.X := mesh2[i].m_Buffer[j + index];
-                dstNormal.Y := mesh2[i].m_Buffer[j + index + 1];
-                dstNormal.Z := mesh2[i].m_Buffer[j + index + 2];
-
-                // interpolate normals
-                normal := srcNormal.Interpolate(dstNormal, position);
-
-                // set interpolated normals in destination buffer
-                SetLength(vertex.m_Buffer, Length(vertex.m_Buffer) + 3);
-                vertex.m_Buffer[j + index]     := normal.X;
-                vertex.m_Buffer[j + index + 1] := normal.Y;
-                vertex.m_Buffer[j + index + 2] := normal.Z;
-                Inc(index, 3);
-            end;
+            // interpolate the position and the normal
+            for k := j to j + lerpCount - 1 do
+                buffer[k] := srcBuffer[k] + ((dstBuffer[k] - srcBuffer[k]) * factor);
 
-            // do include texture coordinates?
-            if (EQR_VF_TexCoords in mesh1[i].m_Format) then
-            begin
-                // copy texture coordinates from source
-                SetLength(vertex.m_Buffer, Length(vertex.m_Buffer) + 2);
-                vertex.m_Buffer[j + index]     := mesh1[i].m_Buffer[j + index];
-                vertex.m_Buffer[j + index + 1] := mesh1[i].m_Buffer[j + index + 1];
-                Inc(index, 2);
-            end;
+            // copy the texture coordinates and the colors from source
+            for k := j + lerpCount to j + stride - 1 do
+                buffer[k] := srcBuffer[k];
 
-            // do include colors?
-            if (EQR_VF_Colors in mesh1[i].m_Format) then
+            // renormalize the interpolated normal, that is shortened by the linear interpolation
+            if (hasNormals) then
             begin
-                // copy color from source
-                SetLength(vertex.m_Buffer, Length(vertex.m_Buffer) + 4);
-                vertex.m_Buffer[j + index]     := mesh1[i].m_Buffer[j + index];
-                vertex.m_Buffer[j + index + 1] := mesh1[i].m_Buffer[j + index + 1];
-                vertex.m_Buffer[j + index + 2] := mesh1[i].m_Buffer[j + index + 2];
-                vertex.m_Buffer[j + index + 3] := mesh1[i].m_Buffer[j + index + 3];
+                x   := buffer[j + 3];
+                y   := buffer[j + 4];
+                z   := buffer[j + 5];
+                len := Sqrt((x * x) + (y * y) + (z * z));
+
+                if (len <> 0.0) then
+                begin
+                    len           := 1.0 / len;
+                    buffer[j + 3] := x * len;
+                    buffer[j + 4] := y * len;
+                    buffer[j + 5] := z * len;
+                end;
             end;
 
-            Inc(j, mesh1[i].m_Stride);
+            Inc(j, stride);
         end;
-
-        // add interpolated mesh to output list
-        SetLength(mesh, Length(mesh) + 1);
-        mesh[Length(mesh) - 1] := vertex;
-
-        // delete vertex
-        SetLength(vertex.m_Buffer, 0);
     end;
 
     Result := True;
@@ -746,6 +1140,53 @@ begin
     end;
 end;
 //--------------------------------------------------------------------------------------------------
+// TQRVertexLight
+//--------------------------------------------------------------------------------------------------
+constructor TQRVertexLight.Create(const pLight: TQRDirectionalLight);
+begin
+    m_Direction := pLight.Direction^;
+
+    // keep the color components in the [0, 255] range, to calculate the light as the model does
+    m_Color[0]   := pLight.Color.GetRed;
+    m_Color[1]   := pLight.Color.GetGreen;
+    m_Color[2]   := pLight.Color.GetBlue;
+    m_Color[3]   := pLight.Color.GetAlpha;
+    m_Ambient[0] := pLight.Ambient.GetRed;
+    m_Ambient[1] := pLight.Ambient.GetGreen;
+    m_Ambient[2] := pLight.Ambient.GetBlue;
+    m_Ambient[3] := pLight.Ambient.GetAlpha;
+end;
+//--------------------------------------------------------------------------------------------------
+procedure TQRVertexLight.Apply(const normal: TQRVector3D;
+                                var buffer: TQRVertexBuffer;
+                                    offset: NativeInt);
+var
+    lightAngle: Single;
+begin
+    // calculate light angle
+    lightAngle := normal.Dot(m_Direction);
+
+    // is light angle out of bounds? (necessary to ensure that the light is not calculated on the 2
+    // sides of the vertex, and thus give the impression that the light comes from two opposite
+    // sides at once)
+    if (lightAngle < 0.0) then
+        lightAngle := 0.0;
+
+    // calculate light color, rounded as a byte color component would be
+    buffer[offset]     := Floor(Max(0.0, Min(255.0, (m_Color[0] * lightAngle) + m_Ambient[0]))) / 255.0;
+    buffer[offset + 1] := Floor(Max(0.0, Min(255.0, (m_Color[1] * lightAngle) + m_Ambient[1]))) / 255.0;
+    buffer[offset + 2] := Floor(Max(0.0, Min(255.0, (m_Color[2] * lightAngle) + m_Ambient[2]))) / 255.0;
+    buffer[offset + 3] := Floor(Max(0.0, Min(255.0, (m_Color[3] * lightAngle) + m_Ambient[3]))) / 255.0;
+end;
+//--------------------------------------------------------------------------------------------------
+procedure TQRVertexLight.ApplyAmbient(var buffer: TQRVertexBuffer; offset: NativeInt);
+begin
+    buffer[offset]     := m_Ambient[0] / 255.0;
+    buffer[offset + 1] := m_Ambient[1] / 255.0;
+    buffer[offset + 2] := m_Ambient[2] / 255.0;
+    buffer[offset + 3] := m_Ambient[3] / 255.0;
+end;
+//--------------------------------------------------------------------------------------------------
 // TQRModel
 //--------------------------------------------------------------------------------------------------
 constructor TQRModel.Create;
@@ -830,6 +1271,41 @@ begin
     inherited Destroy;
 end;
 //--------------------------------------------------------------------------------------------------
+function TQRFramedModel.GetFrameBox(index: NativeUInt; out box: TQRBox): Boolean;
+begin
+    Result := False;
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRFramedModel.GetFrameBounds(index: NativeUInt;
+                                     out box: TQRBox;
+                                  out sphere: TQRSphere): Boolean;
+begin
+    Result := GetFrameBounds(index, index, 0.0, box, sphere);
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRFramedModel.GetFrameBounds(index, nextIndex: NativeUInt;
+                                    interpolationFactor: Double;
+                                                out box: TQRBox;
+                                             out sphere: TQRSphere): Boolean;
+var
+    srcBox, intBox: TQRBox;
+begin
+    // get the frame boxes
+    if ((not GetFrameBox(index, srcBox)) or (not GetFrameBox(nextIndex, intBox))) then
+        Exit(False);
+
+    // interpolate the boxes. NOTE each interpolated vertex lies between its position in both
+    // frames, so it also lies in the interpolated box
+    box.Min.Assign(srcBox.Min.Interpolate(intBox.Min^, interpolationFactor));
+    box.Max.Assign(srcBox.Max.Interpolate(intBox.Max^, interpolationFactor));
+
+    // calculate the sphere enclosing the box
+    sphere.Pos.Assign(box.Min.Interpolate(box.Max^, 0.5));
+    sphere.Radius := box.Max.Sub(box.Min^).Length * 0.5;
+
+    Result := True;
+end;
+//--------------------------------------------------------------------------------------------------
 // TQRArticulatedModel
 //--------------------------------------------------------------------------------------------------
 constructor TQRArticulatedModel.Create;
@@ -842,5 +1318,232 @@ begin
     inherited Destroy;
 end;
 //--------------------------------------------------------------------------------------------------
+// TQRFrameMeshBuildWorker
+//--------------------------------------------------------------------------------------------------
+constructor TQRFrameMeshBuildWorker.Create(fOnProcess: TQRFrameMeshBuildProcessEvent;
+                                          hIsCanceled: TQRIsCanceledEvent);
+begin
+    inherited Create(False);
+
+    m_fOnProcess  := fOnProcess;
+    m_hIsCanceled := hIsCanceled;
+end;
+//--------------------------------------------------------------------------------------------------
+procedure TQRFrameMeshBuildWorker.Execute;
+begin
+    m_fOnProcess(m_hIsCanceled);
+end;
+//--------------------------------------------------------------------------------------------------
+// TQRFrameMeshBuilder
+//--------------------------------------------------------------------------------------------------
+constructor TQRFrameMeshBuilder.Create(pModel: TQRFramedModel);
+begin
+    inherited Create;
+
+    m_pModel       := pModel;
+    m_pLock        := nil;
+    m_FirstIndex   := 0;
+    m_NextItem     := 0;
+    m_BuiltCount   := 0;
+    m_MaxThreads   := 0;
+    m_KeepMeshes   := True;
+    m_KeepPolygons := False;
+    m_fOnMeshBuilt := nil;
+end;
+//--------------------------------------------------------------------------------------------------
+destructor TQRFrameMeshBuilder.Destroy;
+begin
+    // delete the meshes that were not extracted
+    Clear;
+
+    inherited Destroy;
+end;
+//--------------------------------------------------------------------------------------------------
+procedure TQRFrameMeshBuilder.Clear;
+var
+    i: NativeInt;
+begin
+    for i := 0 to Length(m_Items) - 1 do
+        if (Assigned(m_Items[i].m_pMesh)) then
+            Dispose(m_Items[i].m_pMesh);
+
+    SetLength(m_Items, 0);
+end;
+//--------------------------------------------------------------------------------------------------
+procedure TQRFrameMeshBuilder.ProcessItems(hIsCanceled: TQRIsCanceledEvent);
+var
+    itemIndex, builtCount: NativeUInt;
+    pItem:                 PQRFrameMeshBuildItem;
+    pMesh:                 PQRMesh;
+begin
+    while (True) do
+    begin
+        // get the next pending item, if any
+        m_pLock.Enter;
+
+        try
+            itemIndex := m_NextItem;
+            Inc(m_NextItem);
+        finally
+            m_pLock.Leave;
+        end;
+
+        // no more item to process?
+        if (itemIndex >= NativeUInt(Length(m_Items))) then
+            Exit;
+
+        pItem := @m_Items[itemIndex];
+
+        New(pMesh);
+
+        try
+            // get the frame mesh, and its collision polygons if required
+            pItem.m_Success := m_pModel.GetMesh(m_FirstIndex + itemIndex,
+                                                pMesh^,
+                                                nil,
+                                                hIsCanceled);
+
+            if (pItem.m_Success and m_KeepPolygons) then
+                pItem.m_Success := TQRModelHelper.GetPolygons(pMesh^,
+                                                              pItem.m_Polygons,
+                                                              hIsCanceled);
+
+            // keep the mesh? The builder takes care of it from now
+            if (pItem.m_Success and m_KeepMeshes) then
+            begin
+                pItem.m_pMesh := pMesh;
+                pMesh         := nil;
+            end;
+        finally
+            if (Assigned(pMesh)) then
+                Dispose(pMesh);
+        end;
+
+        m_pLock.Enter;
+
+        try
+            // failed or canceled? Stop the other threads as soon as possible
+            if (not pItem.m_Success) then
+            begin
+                m_NextItem := Length(m_Items);
+                Exit;
+            end;
+
+            Inc(m_BuiltCount);
+            builtCount := m_BuiltCount;
+
+            // notify that a frame was built. NOTE the notification is sent while the lock is kept,
+            // so it is never called concurrently
+            if (Assigned(m_fOnMeshBuilt)) then
+                m_fOnMeshBuilt(m_FirstIndex + itemIndex, builtCount, Length(m_Items));
+        finally
+            m_pLock.Leave;
+        end;
+    end;
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRFrameMeshBuilder.GetCount: NativeUInt;
+begin
+    Result := Length(m_Items);
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRFrameMeshBuilder.Build(firstIndex, count: NativeUInt;
+                                        hIsCanceled: TQRIsCanceledEvent): Boolean;
+var
+    workers:                     array of TQRFrameMeshBuildWorker;
+    threadCount, workerCount, i: NativeInt;
+begin
+    // no model?
+    if (not Assigned(m_pModel)) then
+        Exit(False);
+
+    // release the previously built frames
+    Clear;
+
+    // nothing to build?
+    if (count = 0) then
+        Exit(True);
+
+    // are frames out of bounds?
+    if (firstIndex + count > m_pModel.GetMeshCount) then
+        Exit(False);
+
+    SetLength(m_Items, count);
+
+    for i := 0 to Length(m_Items) - 1 do
+    begin
+        m_Items[i].m_pMesh   := nil;
+        m_Items[i].m_Success := False;
+    end;
+
+    m_FirstIndex := firstIndex;
+    m_NextItem   := 0;
+    m_BuiltCount := 0;
+
+    // use one thread per processor, if not limited by the user
+    if (m_MaxThreads = 0) then
+        threadCount := TThread.ProcessorCount
+    else
+        threadCount := m_MaxThreads;
+
+    // the calling thread also builds frames, so one thread less should be created. Also don't
+    // create more threads than frames
+    workerCount := Min(Max(threadCount, 1), Length(m_Items)) - 1;
+
+    m_pLock := TCriticalSection.Create;
+
+    try
+        SetLength(workers, workerCount);
+
+        try
+            // start the build threads
+            for i := 0 to workerCount - 1 do
+                workers[i] := TQRFrameMeshBuildWorker.Create(ProcessItems, hIsCanceled);
+
+            // build frames on the calling thread too
+            ProcessItems(hIsCanceled);
+        finally
+            // wait until all the build threads are done
+            for i := 0 to Length(workers) - 1 do
+                if (Assigned(workers[i])) then
+                begin
+                    workers[i].WaitFor;
+                    workers[i].Free;
+                end;
+        end;
+    finally
+        m_pLock.Free;
+        m_pLock := nil;
+    end;
+
+    // check if all frames were built
+    for i := 0 to Length(m_Items) - 1 do
+        if (not m_Items[i].m_Success) then
+            Exit(False);
+
+    Result := True;
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRFrameMeshBuilder.Extract(index: NativeUInt): PQRMesh;
+begin
+    if (index >= NativeUInt(Length(m_Items))) then
+        Exit(nil);
+
+    Result                 := m_Items[index].m_pMesh;
+    m_Items[index].m_pMesh := nil;
+end;
+//--------------------------------------------------------------------------------------------------
+procedure TQRFrameMeshBuilder.ExtractPolygons(index: NativeUInt; out polygons: TQRPolygons);
+begin
+    if (index >= NativeUInt(Length(m_Items))) then
+    begin
+        SetLength(polygons, 0);
+        Exit;
+    end;
+
+    polygons := m_Items[index].m_Polygons;
+    SetLength(m_Items[index].m_Polygons, 0);
+end;
+//--------------------------------------------------------------------------------------------------
 
 end.
@@ -39,6 +39,7 @@ uses System.Classes,
      UTQRHelpers,
      UTQRFiles,
      UTQRGraphics,
+     UTQRGeometry,
      UTQR3D,
      UTQRLight,
      UTQRCollision,
@@ -168,6 +169,7 @@ type
             m_TextureLoaded:      Boolean;
             m_IsCanceled:         Boolean;
             m_FramedModelOptions: TQRFramedModelOptions;
+            m_pDecodedTexture:    Vcl.Graphics.TBitmap;
             m_fOnLoadTexture:     TQRLoadMeshTextureEvent;
 
         protected
@@ -236,6 +238,15 @@ type
             {$ENDREGION}
             procedure SetFramedModelOptions(options: TQRFramedModelOptions); virtual;
 
+            {$REGION 'Documentation'}
+            {**
+             Decodes the model texture
+             @br @bold(NOTE) This function is executed on the job thread side, before the
+                             OnLoadTexture() function is called
+            }
+            {$ENDREGION}
+            procedure DecodeTextures; virtual;
+
             {$REGION 'Documentation'}
             {**
              Called when model texture should be loaded
@@ -647,6 +658,7 @@ type
             m_LoopFrame:        NativeUInt;              // current gesture frame loop index
             m_FPS:              NativeUInt;              // current gesture frame per seconds
             m_EndNotified:      Boolean;                 // if true, current animation reached end
+            m_InterpolatedMesh: TQRMesh;                 // interpolated mesh, reused between draws
 
         protected
             {$REGION 'Documentation'}
@@ -716,6 +728,14 @@ type
             {$ENDREGION}
             procedure DrawCachedModel; virtual;
 
+            {$REGION 'Documentation'}
+            {**
+             Draws the model from a compressed cache, i.e. decompresses the frames to draw from the
+             model, and gets their collision trees from the cache
+            }
+            {$ENDREGION}
+            procedure DrawCompressedModel; virtual;
+
             {$REGION 'Documentation'}
             {**
              Gets the memory dir containing model files
@@ -1005,11 +1025,12 @@ begin
     inherited Create(pGroup, modelOptions);
 
     // create local variables
-    m_pModel        := TQRMD2Model.Create;
-    m_pAnimations   := TQRMD2AnimCfgFile.Create;
-    m_MaxTexture    := 100;
-    m_TextureLoaded := False;
-    m_IsCanceled    := False;
+    m_pModel          := TQRMD2Model.Create;
+    m_pAnimations     := TQRMD2AnimCfgFile.Create;
+    m_MaxTexture      := 100;
+    m_TextureLoaded   := False;
+    m_IsCanceled      := False;
+    m_pDecodedTexture := nil;
     New(m_pDefaultMesh);
 
     // copy values needed to load the model
@@ -1039,6 +1060,7 @@ begin
         m_pColor.Free;
         m_pAnimations.Free;
         m_pLight.Free;
+        m_pDecodedTexture.Free;
 
         // delete default mesh
         if (Assigned(m_pDefaultMesh)) then
@@ -1111,6 +1133,34 @@ begin
     m_pLock.Unlock;
 end;
 //--------------------------------------------------------------------------------------------------
+procedure TQRMD2Job.DecodeTextures;
+var
+    pTexture: TQRTexture;
+    pBitmap:  Vcl.Graphics.TBitmap;
+begin
+    pTexture := TQRTexture.Create;
+
+    try
+        // notify that a texture is about to be decoded
+        BeforeLoadTexture(pTexture, False);
+
+        // decode texture
+        pBitmap := DecodeTexture(pTexture);
+    finally
+        pTexture.Free;
+    end;
+
+    m_pLock.Lock;
+
+    try
+        // keep the decoded texture until the OnLoadTexture() function receives it
+        m_pDecodedTexture.Free;
+        m_pDecodedTexture := pBitmap;
+    finally
+        m_pLock.Unlock;
+    end;
+end;
+//--------------------------------------------------------------------------------------------------
 procedure TQRMD2Job.OnLoadTexture;
 var
     textureIndex:        NativeInt;
@@ -1150,11 +1200,13 @@ begin
             // are user defined textures)
             if (loadFirst) then
             begin
-                pTexture := Vcl.Graphics.TBitmap.Create;
+                // get the texture decoded on the job thread, and take its ownership
+                pTexture          := m_pDecodedTexture;
+                m_pDecodedTexture := nil;
 
                 try
-                    // load texture
-                    if (LoadTexture(m_Textures[textureIndex], pTexture)) then
+                    // was texture decoded?
+                    if (Assigned(pTexture)) then
                     begin
                         // notify that a texture is loading
                         if (Assigned(m_fOnLoadTexture)) then
@@ -1204,6 +1256,9 @@ begin
 
         m_TextureLoaded := True;
     finally
+        // delete the decoded texture if it was not received, e.g. if the job was canceled
+        FreeAndNil(m_pDecodedTexture);
+
         m_pLock.Unlock;
     end;
 end;
@@ -1339,13 +1394,17 @@ end;
 function TQRLoadMD2FileJob.Process: Boolean;
 var
     modelName, normalsName, animCfgName: TFileName;
-    frameCount, i:                       NativeUInt;
+    frameCount:                          NativeUInt;
     normalsLoaded, textureLoaded:        Boolean;
     vertexFormat:                        TQRVertexFormat;
-    pMesh:                               PQRMesh;
-    pTree:                               TQRAABBTree;
-    progressStep, totalStep:             Single;
+    pTreeBuilder:                        TQRAABBTreeBuilder;
+    progressStep, totalStep, meshStep:   Single;
     doCreateCache:                       Boolean;
+    doCacheTrees, treesLoaded:           Boolean;
+    treeCacheName:                       TFileName;
+    treeCacheKey:                        TQRUInt32;
+    doShareCache:                        Boolean;
+    sharedCacheKey:                      UnicodeString;
 begin
     // if job was still loaded, don't reload it
     if (IsLoaded) then
@@ -1405,8 +1464,9 @@ begin
         Progress := Progress + progressStep;
 
         // populate model options
-        m_pModel.Color  := m_pColor;
-        m_pModel.RHToLH := m_RhToLh;
+        m_pModel.Color   := m_pColor;
+        m_pModel.RHToLH  := m_RhToLh;
+        m_pModel.Indexed := (EQR_MO_Indexed_Meshes in ModelOptions);
 
         // set pre-calculated light, if needed
         if (Assigned(m_pLight)) then
@@ -1426,6 +1486,9 @@ begin
         // normals are loaded, add one step to progress
         Progress := Progress + progressStep;
 
+        // decode texture on the job thread, thus only its upload is left to the main thread
+        DecodeTextures;
+
         // notify main interface that texture should be loaded, wait until function returns
         TThread.Synchronize(nil, OnLoadTexture);
 
@@ -1490,62 +1553,110 @@ begin
             Exit(True);
         end;
 
+        // search for frames another job already built from the same model with the same options,
+        // and share them instead of building them again
+        doShareCache := GetSharedCacheKey(modelName,
+                                          normalsName,
+                                          m_pColor,
+                                          m_pLight,
+                                          m_RhToLh,
+                                          vertexFormat,
+                                          sharedCacheKey);
+
+        if (doShareCache and AcquireSharedCache(sharedCacheKey)) then
+        begin
+            Progress := 100.0;
+            IsLoaded := True;
+            Exit(True);
+        end;
+
         // animations are loaded, add one step to progress
         Progress := Progress + progressStep;
 
-        // something to cache?
-        if (frameCount > 0) then
-            // iterate through frames to cache
-            for i := 0 to frameCount - 1 do
-            begin
-                // create mesh
-                New(pMesh);
+        // do cache the collision trees in a file? If yes, try to load them from this file, in which
+        // case they don't need to be built again
+        doCacheTrees := ((EQR_MO_Cache_Collisions in ModelOptions) and
+                     not (EQR_MO_No_Collision     in ModelOptions));
+        treesLoaded  := False;
 
-                // do ignore collisions?
-                if (not(EQR_MO_No_Collision in ModelOptions)) then
-                    // create AABB tree
-                    pTree := TQRAABBTree.Create
-                else
-                    pTree := nil;
+        if (doCacheTrees) then
+        begin
+            treeCacheName := modelName + QR_AABB_Cache_File_Ext;
+            doCacheTrees  := GetTreeCacheKey(modelName, m_RhToLh, treeCacheKey);
+            treesLoaded   := (doCacheTrees and LoadTrees(treeCacheName, treeCacheKey, 0, frameCount));
+        end;
+
+        // do ignore collisions or were the trees loaded? If not, each frame step is shared between
+        // the mesh and the tree
+        if ((EQR_MO_No_Collision in ModelOptions) or treesLoaded) then
+            meshStep := progressStep
+        else
+            meshStep := (progressStep / 2.0);
 
-                // get current mesh
-                if (not m_pModel.GetMesh(i, pMesh^, pTree, IsCanceled)) then
+        pTreeBuilder := TQRAABBTreeBuilder.Create;
+
+        try
+            // do refit the frame trees from the first one?
+            pTreeBuilder.Refit := (EQR_MO_Refit_Collisions in ModelOptions);
+
+            // something to cache? NOTE a compressed cache only contains the trees, so in this case the
+            // frames are generated only if their trees should be built
+            if ((frameCount > 0) and
+                ((not(EQR_MO_Compress_Cache in ModelOptions)) or
+                 ((not(EQR_MO_No_Collision in ModelOptions)) and (not treesLoaded))))
+            then
+                // generate the frames to cache, several at once, and build their aligned-axis
+                // bounding box trees meanwhile. If the cache is compressed, the frames are
+                // decompressed from the model while drawn, and the meshes are only required to
+                // build the trees
+                if (not CacheFrames(m_pModel,
+                                    frameCount,
+                                    0,
+                                    not(EQR_MO_Compress_Cache in ModelOptions),
+                                    ((not(EQR_MO_No_Collision in ModelOptions)) and
+                                     (not treesLoaded)),
+                                    pTreeBuilder,
+                                    meshStep,
+                                    progressStep - meshStep,
+                                    IsCanceled))
+                then
                 begin
                     {$ifdef DEBUG}
                         TQRLogHelper.LogToCompiler('MD2 model frame creation failed or was canceled - name - ' +
                                                    m_Name                                                      +
-                                                   ' - index - '                                               +
-                                                   IntToStr(Int64(i))                                          +
                                                    ' - class name - '                                          +
                                                    ClassName);
                     {$endif}
 
-                    // failed or canceled?
-                    Dispose(pMesh);
-                    pTree.Free;
                     Exit(False);
                 end;
 
-                // add mesh to cache, note that from now cache will take care of the pointer
-                try
-                    SetMesh(i, pMesh);
-                except
-                    Dispose(pMesh);
-                end;
-
-                // do ignore collisions?
-                if (not(EQR_MO_No_Collision in ModelOptions)) then
-                    // add tree to cache, note that from now cache will take care of the pointer
-                    try
-                        SetTree(i, pTree);
-                    except
-                        pTree.Free;
-                    end;
+            // add the aligned-axis bounding box trees to cache
+            if (not BuildTrees(pTreeBuilder, 0, progressStep - meshStep, IsCanceled)) then
+            begin
+                {$ifdef DEBUG}
+                    TQRLogHelper.LogToCompiler('MD2 model trees creation failed or was canceled - name - ' +
+                                               m_Name                                                      +
+                                               ' - class name - '                                          +
+                                               ClassName);
+                {$endif}
 
-                // a new frame was cached, add one step to progress
-                Progress := Progress + progressStep;
+                Exit(False);
             end;
 
+            // save the newly built trees in the cache file, in order to skip their build on the next
+            // opening. NOTE failing to save them isn't an error, e.g. if the model dir is read-only
+            if (doCacheTrees and (not treesLoaded)) then
+                SaveTrees(treeCacheName, treeCacheKey, 0, frameCount);
+        finally
+            pTreeBuilder.Free;
+        end;
+
+        // publish the newly built frames, in order to share them with the next jobs loading the
+        // same model with the same options
+        if (doShareCache) then
+            PublishSharedCache(sharedCacheKey);
+
         Progress := 100.0;
         IsLoaded := True;
         Result   := True;
@@ -1664,12 +1775,11 @@ function TQRLoadMD2MemoryDirJob.Process: Boolean;
 var
     modelName, normalsName, animCfgName:          TFileName;
     pModelStream, pNormalsStream, pAnimCfgStream: TStream;
-    frameCount, i:                                NativeUInt;
+    frameCount:                                   NativeUInt;
     normalsLoaded, textureLoaded:                 Boolean;
     vertexFormat:                                 TQRVertexFormat;
-    pMesh:                                        PQRMesh;
-    pTree:                                        TQRAABBTree;
-    progressStep, totalStep:                      Single;
+    pTreeBuilder:                                 TQRAABBTreeBuilder;
+    progressStep, totalStep, meshStep:            Single;
     doCreateCache:                                Boolean;
 begin
     // if job was still loaded, don't reload it
@@ -1746,8 +1856,9 @@ begin
         Progress := Progress + progressStep;
 
         // populate model options
-        m_pModel.Color  := m_pColor;
-        m_pModel.RHToLH := m_RhToLh;
+        m_pModel.Color   := m_pColor;
+        m_pModel.RHToLH  := m_RhToLh;
+        m_pModel.Indexed := (EQR_MO_Indexed_Meshes in ModelOptions);
 
         // set pre-calculated light, if needed
         if (Assigned(m_pLight)) then
@@ -1774,6 +1885,9 @@ begin
         // normals are loaded, add one step to progress
         Progress := Progress + progressStep;
 
+        // decode texture on the job thread, thus only its upload is left to the main thread
+        DecodeTextures;
+
         // notify main interface that texture should be loaded, wait until function returns
         TThread.Synchronize(nil, OnLoadTexture);
 
@@ -1848,57 +1962,64 @@ begin
         // animations are loaded, add one step to progress
         Progress := Progress + progressStep;
 
-        // something to cache?
-        if (frameCount > 0) then
-            // iterate through frames to cache
-            for i := 0 to frameCount - 1 do
-            begin
-                // create mesh
-                New(pMesh);
+        // do ignore collisions? If not, each frame step is shared between the mesh and the tree
+        if (EQR_MO_No_Collision in ModelOptions) then
+            meshStep := progressStep
+        else
+            meshStep := (progressStep / 2.0);
 
-                // do ignore collisions?
-                if (not(EQR_MO_No_Collision in ModelOptions)) then
-                    // create AABB tree
-                    pTree := TQRAABBTree.Create
-                else
-                    pTree := nil;
+        pTreeBuilder := TQRAABBTreeBuilder.Create;
 
-                // get current mesh
-                if (not m_pModel.GetMesh(i, pMesh^, pTree, IsCanceled)) then
+        try
+            // do refit the frame trees from the first one?
+            pTreeBuilder.Refit := (EQR_MO_Refit_Collisions in ModelOptions);
+
+            // something to cache? NOTE a compressed cache only contains the trees, so in this case the
+            // frames are generated only if their trees should be built
+            if ((frameCount > 0) and
+                ((not(EQR_MO_Compress_Cache in ModelOptions)) or
+                 (not(EQR_MO_No_Collision   in ModelOptions))))
+            then
+                // generate the frames to cache, several at once, and build their aligned-axis
+                // bounding box trees meanwhile. If the cache is compressed, the frames are
+                // decompressed from the model while drawn, and the meshes are only required to
+                // build the trees
+                if (not CacheFrames(m_pModel,
+                                    frameCount,
+                                    0,
+                                    not(EQR_MO_Compress_Cache in ModelOptions),
+                                    not(EQR_MO_No_Collision in ModelOptions),
+                                    pTreeBuilder,
+                                    meshStep,
+                                    progressStep - meshStep,
+                                    IsCanceled))
+                then
                 begin
                     {$ifdef DEBUG}
                         TQRLogHelper.LogToCompiler('MD2 model frame creation failed or was canceled - name - ' +
                                                    m_Name                                                      +
-                                                   ' - index - '                                               +
-                                                   ' - class name - ' + ClassName                              +
-                                                   IntToStr(Int64(i)));
+                                                   ' - class name - '                                          +
+                                                   ClassName);
                     {$endif}
 
-                    // failed or canceled?
-                    Dispose(pMesh);
-                    pTree.Free;
                     Exit(False);
                 end;
 
-                // add mesh to cache, note that from now cache will take care of the pointer
-                try
-                    SetMesh(i, pMesh);
-                except
-                    Dispose(pMesh);
-                end;
-
-                // do ignore collisions?
-                if (not(EQR_MO_No_Collision in ModelOptions)) then
-                    // add tree to cache, note that from now cache will take care of the pointer
-                    try
-                        SetTree(i, pTree);
-                    except
-                        pTree.Free;
-                    end;
+            // add the aligned-axis bounding box trees to cache
+            if (not BuildTrees(pTreeBuilder, 0, progressStep - meshStep, IsCanceled)) then
+            begin
+                {$ifdef DEBUG}
+                    TQRLogHelper.LogToCompiler('MD2 model trees creation failed or was canceled - name - ' +
+                                               m_Name                                                      +
+                                               ' - class name - '                                          +
+                                               ClassName);
+                {$endif}
 
-                // a new frame was cached, add one step to progress
-                Progress := Progress + progressStep;
+                Exit(False);
             end;
+        finally
+            pTreeBuilder.Free;
+        end;
 
         Progress := 100.0;
         IsLoaded := True;
@@ -2133,6 +2254,9 @@ end;
 //--------------------------------------------------------------------------------------------------
 destructor TQRMD2Group.Destroy;
 begin
+    // cancel the frame prefetches, they use the job
+    CancelPrefetch;
+
     // delete model and his associated job, don't forget to unregister it from worker
     if (Assigned(m_pJob)) then
     begin
@@ -2174,6 +2298,9 @@ begin
     if (m_Gesture = gesture) then
         Exit;
 
+    // the running frame prefetch targets the previous gesture
+    CancelPrefetch;
+
     // reset gesture
     m_Gesture     := -1;
     m_StartFrame  :=  0;
@@ -2414,12 +2541,12 @@ begin
     useCollisions := not (EQR_MO_No_Collision in m_pJob.ModelOptions);
 
     // get mesh from cache
-    pMesh := m_pJob.Mesh[m_pAnimation.FrameIndex];
+    pMesh := m_pJob.Mesh[index];
 
     // do create collision buffers?
     if (useCollisions) then
         // get AABB tree from cache
-        pTree := m_pJob.AABBTree[m_pAnimation.FrameIndex];
+        pTree := m_pJob.AABBTree[index];
 
     // found in cache?
     if (Assigned(pMesh) and ((not useCollisions) or Assigned(pTree))) then
@@ -2434,7 +2561,7 @@ begin
         pTree := TQRAABBTree.Create;
 
     // get mesh and calculate AABB tree, if needed
-    if (not m_pJob.Model.GetMesh(m_pAnimation.FrameIndex,
+    if (not m_pJob.Model.GetMesh(index,
                                  pMesh^,
                                  pTree,
                                  TQRIsCanceledEvent(nil)))
@@ -2442,7 +2569,7 @@ begin
     begin
         {$ifdef DEBUG}
             TQRLogHelper.LogToCompiler('MD2 model frame creation failed - index - ' +
-                                       IntToStr(m_pAnimation.FrameIndex)            +
+                                       IntToStr(index)                              +
                                        ' - class name - '                           +
                                        ClassName);
         {$endif}
@@ -2450,30 +2577,26 @@ begin
         // failed?
         Dispose(pMesh);
         pTree.Free;
+        pMesh := nil;
+        pTree := nil;
         Exit;
     end;
 
-    // add meshes to cache, note that from now cache will take care of the pointer
-    try
-        m_pJob.Mesh[index] := pMesh;
-    except
-        Dispose(pMesh);
-    end;
+    // add mesh and tree to cache, note that from now cache will take care of the pointers
+    if (m_pJob.TryAddFrame(index, pMesh, pTree)) then
+        Exit;
 
-    // do create collision buffers?
-    if (useCollisions) then
-        // add tree to cache, note that from now cache will take care of the pointer
-        try
-            m_pJob.AABBTree[index] := pTree;
-        except
-            pTree.Free;
-        end;
+    // the frame was prefetched meanwhile, use the cached one
+    Dispose(pMesh);
+    pTree.Free;
+
+    pMesh := m_pJob.Mesh[index];
+    pTree := m_pJob.AABBTree[index];
 end;
 //--------------------------------------------------------------------------------------------------
 procedure TQRMD2Group.DrawDynamicModel;
 var
     pMesh, pNextMesh: PQRMesh;
-    interpolatedMesh: TQRMesh;
     pTree, pNextTree: TQRAABBTree;
 begin
     // nothing to draw?
@@ -2490,7 +2613,7 @@ begin
             m_pJob.Model.GetMesh(m_pAnimation.FrameIndex,
                                  m_pAnimation.InterpolationFrameIndex,
                                  m_pAnimation.InterpolationFactor,
-                                 interpolatedMesh,
+                                 m_InterpolatedMesh,
                                  TQRIsCanceledEvent(nil));
 
             // draw mesh
@@ -2501,7 +2624,7 @@ begin
                        m_pAnimation.FrameIndex,
                        m_pAnimation.InterpolationFrameIndex,
                        m_pAnimation.InterpolationFactor,
-                       @interpolatedMesh,
+                       @m_InterpolatedMesh,
                        nil,
                        nil,
                        nil);
@@ -2537,6 +2660,16 @@ begin
         Exit;
     end;
 
+    // start to generate the next frames of the running gesture in background, in order that they
+    // are already cached when drawn
+    PrefetchFrames(m_pJob,
+                   m_pJob.Model,
+                   0,
+                   m_pAnimation.FrameIndex,
+                   m_StartFrame,
+                   m_EndFrame,
+                   Boolean(m_LoopFrame));
+
     // get meshes and AABB trees from cache, create them if still not exist
     GetDynamicMeshUseCache(m_pAnimation.FrameIndex,              pMesh,     pTree);
     GetDynamicMeshUseCache(m_pAnimation.InterpolationFrameIndex, pNextMesh, pNextTree);
@@ -2545,10 +2678,10 @@ begin
     if (EQR_FO_Interpolate in m_pJob.FramedModelOptions) then
     begin
         // interpolate meshes
-        TQRModelHelper.Interpolate(m_pAnimation.InterpolationFactor,
-                                   pMesh^,
-                                   pNextMesh^,
-                                   interpolatedMesh);
+        TQRModelHelper.InterpolateTo(m_pAnimation.InterpolationFactor,
+                                     pMesh^,
+                                     pNextMesh^,
+                                     m_InterpolatedMesh);
 
         // draw mesh
         OnDrawItem(Self,
@@ -2558,7 +2691,7 @@ begin
                    m_pAnimation.FrameIndex,
                    m_pAnimation.InterpolationFrameIndex,
                    m_pAnimation.InterpolationFactor,
-                   @interpolatedMesh,
+                   @m_InterpolatedMesh,
                    nil,
                    pTree,
                    pNextTree);
@@ -2579,8 +2712,6 @@ begin
 end;
 //--------------------------------------------------------------------------------------------------
 procedure TQRMD2Group.DrawCachedModel;
-var
-    interpolatedMesh: TQRMesh;
 begin
     // nothing to draw?
     if (not Assigned(OnDrawItem)) then
@@ -2599,10 +2730,10 @@ begin
         if (EQR_FO_Interpolate in m_pJob.FramedModelOptions) then
         begin
             // interpolate meshes
-            TQRModelHelper.Interpolate(m_pAnimation.InterpolationFactor,
-                                       m_pJob.Mesh[m_pAnimation.FrameIndex]^,
-                                       m_pJob.Mesh[m_pAnimation.InterpolationFrameIndex]^,
-                                       interpolatedMesh);
+            TQRModelHelper.InterpolateTo(m_pAnimation.InterpolationFactor,
+                                         m_pJob.Mesh[m_pAnimation.FrameIndex]^,
+                                         m_pJob.Mesh[m_pAnimation.InterpolationFrameIndex]^,
+                                         m_InterpolatedMesh);
 
             // draw mesh
             OnDrawItem(Self,
@@ -2612,7 +2743,7 @@ begin
                        m_pAnimation.FrameIndex,
                        m_pAnimation.InterpolationFrameIndex,
                        m_pAnimation.InterpolationFactor,
-                       @interpolatedMesh,
+                       @m_InterpolatedMesh,
                        nil,
                        nil,
                        nil);
@@ -2636,10 +2767,10 @@ begin
     if (EQR_FO_Interpolate in m_pJob.FramedModelOptions) then
     begin
         // interpolate meshes
-        TQRModelHelper.Interpolate(m_pAnimation.InterpolationFactor,
-                                   m_pJob.Mesh[m_pAnimation.FrameIndex]^,
-                                   m_pJob.Mesh[m_pAnimation.InterpolationFrameIndex]^,
-                                   interpolatedMesh);
+        TQRModelHelper.InterpolateTo(m_pAnimation.InterpolationFactor,
+                                     m_pJob.Mesh[m_pAnimation.FrameIndex]^,
+                                     m_pJob.Mesh[m_pAnimation.InterpolationFrameIndex]^,
+                                     m_InterpolatedMesh);
 
         // draw mesh
         OnDrawItem(Self,
@@ -2649,7 +2780,7 @@ begin
                    m_pAnimation.FrameIndex,
                    m_pAnimation.InterpolationFrameIndex,
                    m_pAnimation.InterpolationFactor,
-                   @interpolatedMesh,
+                   @m_InterpolatedMesh,
                    nil,
                    m_pJob.AABBTree[m_pAnimation.FrameIndex],
                    m_pJob.AABBTree[m_pAnimation.InterpolationFrameIndex])
@@ -2669,6 +2800,82 @@ begin
                    m_pJob.AABBTree[m_pAnimation.InterpolationFrameIndex]);
 end;
 //--------------------------------------------------------------------------------------------------
+procedure TQRMD2Group.DrawCompressedModel;
+var
+    mesh, nextMesh:   TQRMesh;
+    pTree, pNextTree: TQRAABBTree;
+    frameCount:       NativeUInt;
+begin
+    // nothing to draw?
+    if (not Assigned(OnDrawItem)) then
+        Exit;
+
+    frameCount := m_pJob.Model.GetMeshCount;
+
+    // are indexes out of bounds?
+    if ((m_pAnimation.FrameIndex              >= frameCount) or
+        (m_pAnimation.InterpolationFrameIndex >= frameCount))
+    then
+        Exit;
+
+    // get the collision trees from cache, if any
+    if (EQR_MO_No_Collision in m_pJob.ModelOptions) then
+    begin
+        pTree     := nil;
+        pNextTree := nil;
+    end
+    else
+    begin
+        pTree     := m_pJob.AABBTree[m_pAnimation.FrameIndex];
+        pNextTree := m_pJob.AABBTree[m_pAnimation.InterpolationFrameIndex];
+    end;
+
+    // do interpolate?
+    if (EQR_FO_Interpolate in m_pJob.FramedModelOptions) then
+    begin
+        // decompress and interpolate the frames in a single pass
+        if (not m_pJob.Model.GetMesh(m_pAnimation.FrameIndex,
+                                     m_pAnimation.InterpolationFrameIndex,
+                                     m_pAnimation.InterpolationFactor,
+                                     mesh,
+                                     TQRIsCanceledEvent(nil)))
+        then
+            Exit;
+
+        // draw mesh
+        OnDrawItem(Self,
+                   m_pJob.Model,
+                   m_pJob.m_Textures,
+                   GetMatrix,
+                   m_pAnimation.FrameIndex,
+                   m_pAnimation.InterpolationFrameIndex,
+                   m_pAnimation.InterpolationFactor,
+                   @mesh,
+                   nil,
+                   pTree,
+                   pNextTree);
+
+        Exit;
+    end;
+
+    // decompress the frames
+    GetDynamicMesh(m_pAnimation.FrameIndex,              mesh);
+    GetDynamicMesh(m_pAnimation.InterpolationFrameIndex, nextMesh);
+
+    // draw mesh
+    OnDrawItem(Self,
+               m_pJob.Model,
+               m_pJob.m_Textures,
+               GetMatrix,
+               m_pAnimation.FrameIndex,
+               m_pAnimation.InterpolationFrameIndex,
+               m_pAnimation.InterpolationFactor,
+               @mesh,
+               @nextMesh,
+               pTree,
+               pNextTree);
+end;
+//--------------------------------------------------------------------------------------------------
 function TQRMD2Group.GetMemoryDir: TQRMemoryDir;
 begin
     // model not created?
@@ -2689,6 +2896,9 @@ end;
 //--------------------------------------------------------------------------------------------------
 procedure TQRMD2Group.Clear;
 begin
+    // cancel the frame prefetches, they use the job
+    CancelPrefetch;
+
     // previous job was created?
     if (Assigned(m_pJob)) then
     begin
@@ -2905,7 +3115,8 @@ begin
     if (m_pJob.GetStatus <> EQR_JS_Done) then
     begin
         // do run animation immediately when current gesture is loaded?
-        if ((EQR_MO_Create_Cache                     in m_pJob.ModelOptions) and
+        if ((EQR_MO_Create_Cache                     in m_pJob.ModelOptions)  and
+            (not(EQR_MO_Compress_Cache               in m_pJob.ModelOptions)) and
             (EQR_FO_Start_Anim_When_Gesture_Is_Ready in m_pJob.FramedModelOptions))
         then
         begin
@@ -2954,7 +3165,13 @@ begin
     // can draw model from a previously built cache, do generate frames dynamically, or let user
     // take care of frames creation?
     if (EQR_MO_Create_Cache in m_pJob.ModelOptions) then
-        DrawCachedModel
+    begin
+        // is cache compressed?
+        if (EQR_MO_Compress_Cache in m_pJob.ModelOptions) then
+            DrawCompressedModel
+        else
+            DrawCachedModel;
+    end
     else
     if ((EQR_MO_Dynamic_Frames          in m_pJob.ModelOptions) or
         (EQR_MO_Dynamic_Frames_No_Cache in m_pJob.ModelOptions))
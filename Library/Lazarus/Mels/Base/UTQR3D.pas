@@ -109,6 +109,13 @@ type
 
     TQRVertexBuffer = array of Single;
 
+    {$REGION 'Documentation'}
+    {**
+     Index buffer, each index is a vertex position in a vertex buffer (i.e. in stride units)
+    }
+    {$ENDREGION}
+    TQRIndexBuffer = array of Cardinal;
+
     {$REGION 'Documentation'}
     {**
      Vertex descriptor, contains global enumeration and types
@@ -158,6 +165,17 @@ type
             {$ENDREGION}
             m_Buffer: TQRVertexBuffer;
 
+            {$REGION 'Documentation'}
+            {**
+             Index buffer, if empty the vertex buffer is read sequentially, otherwise the indices
+             describe a triangle list whose vertices are read from the vertex buffer
+             @br @bold(NOTE) The index buffer may be shared between several vertex descriptors
+                             (e.g. between all the frames of a model), so it should never be
+                             modified in place
+            }
+            {$ENDREGION}
+            m_Indices: TQRIndexBuffer;
+
         public
             {$REGION 'Documentation'}
             {**
@@ -717,6 +735,7 @@ begin
     m_Format    := [];
 
     SetLength(m_Buffer, 0);
+    SetLength(m_Indices, 0);
 end;
 //--------------------------------------------------------------------------------------------------
 function TQRVertex.Clone: TQRVertex;
@@ -603,6 +603,68 @@ type
 
     TQRMD2Normals = array of TQRVector3D;
 
+    {$REGION 'Documentation'}
+    {**
+     MD2 indexed vertex, i.e. an unique combination of frame vertex and texture coordinates used by
+     the OpenGL commands
+    }
+    {$ENDREGION}
+    TQRMD2IndexedVertex = record
+        {$REGION 'Documentation'}
+        {**
+         Vertex index in the frame vertices
+        }
+        {$ENDREGION}
+        m_VertexIndex: Cardinal;
+
+        {$REGION 'Documentation'}
+        {**
+         Vertex texture u coordinate
+        }
+        {$ENDREGION}
+        m_TU: Single;
+
+        {$REGION 'Documentation'}
+        {**
+         Vertex texture v coordinate
+        }
+        {$ENDREGION}
+        m_TV: Single;
+    end;
+
+    TQRMD2IndexedVertices = array of TQRMD2IndexedVertex;
+
+    {$REGION 'Documentation'}
+    {**
+     MD2 command, i.e. a triangle strip or fan declared in the OpenGL command list, whose vertices
+     are read in the command vertex list
+    }
+    {$ENDREGION}
+    TQRMD2Command = record
+        {$REGION 'Documentation'}
+        {**
+         Command vertex type, triangle strip or triangle fan
+        }
+        {$ENDREGION}
+        m_Type: EQRVertexType;
+
+        {$REGION 'Documentation'}
+        {**
+         Index of the first command vertex in the command vertex list
+        }
+        {$ENDREGION}
+        m_First: NativeUInt;
+
+        {$REGION 'Documentation'}
+        {**
+         Command vertex count
+        }
+        {$ENDREGION}
+        m_Count: NativeUInt;
+    end;
+
+    TQRMD2Commands = array of TQRMD2Command;
+
     {$REGION 'Documentation'}
     {**
      MD2 model
@@ -612,7 +674,13 @@ type
         private
             m_pParser:             TQRMD2Parser;
             m_Normals:             TQRMD2Normals;
+            m_IndexedVertices:     TQRMD2IndexedVertices;
+            m_Indices:             TQRIndexBuffer;
+            m_CmdVertices:         TQRMD2IndexedVertices;
+            m_Commands:            TQRMD2Commands;
+            m_FrameBoxes:          TQRFrameBoxes;
             m_RHToLH:              Boolean;
+            m_Indexed:             Boolean;
             m_pPreCalculatedLight: TQRDirectionalLight;
 
             {$REGION 'Documentation'}
@@ -622,6 +690,26 @@ type
             {$ENDREGION}
             procedure PopulateNormals;
 
+            {$REGION 'Documentation'}
+            {**
+             Populates the topology, i.e. the OpenGL command list and their vertices, the unique
+             vertices used by the OpenGL commands and the triangle list indices referencing them
+             @br @bold(NOTE) The topology is the same for all the frames, so it is populated once
+                             while the model is loaded
+            }
+            {$ENDREGION}
+            procedure PopulateTopology;
+
+            {$REGION 'Documentation'}
+            {**
+             Populates the frame bounding boxes
+             @br @bold(NOTE) The boxes are calculated once while the model is loaded, from the
+                             compressed frame vertices, so they are available without generating
+                             the frame meshes
+            }
+            {$ENDREGION}
+            procedure PopulateFrameBoxes;
+
         protected
             {$REGION 'Documentation'}
             {**
@@ -634,6 +722,68 @@ type
             function UncompressVertex(const frame: TQRMD2Frame;
                                      const vertex: TQRMD2Vertex): TQRVector3D; virtual;
 
+            {$REGION 'Documentation'}
+            {**
+             Populates a vertex buffer from a vertex list
+             @param(vertices Vertex list to read)
+             @param(first Index of the first vertex to read in the list)
+             @param(count Vertex count to read)
+             @param(srcFrame Frame from which the vertices are extracted)
+             @param(intFrame Frame to interpolate with)
+             @param(interpolationFactor Interpolation factor to apply)
+             @param(stride Vertex buffer stride)
+             @param(buffer @bold([in, out]) Vertex buffer to populate, should already contain count
+                                            vertices)
+             @return(@true on success, otherwise @false)
+             @br @bold(NOTE) The vertex format, the coordinate system conversion and the light mode
+                             are resolved once per call, and each vertex attribute is written by its
+                             own loop, so the per-vertex code never tests them
+             @br @bold(NOTE) To get a frame without interpolation, pass the same frame as source
+                             and as frame to interpolate with, in which case it's returned unchanged
+            }
+            {$ENDREGION}
+            function PopulateVertexBuffer(const vertices: TQRMD2IndexedVertices;
+                                             first, count: NativeUInt;
+                                 const srcFrame, intFrame: TQRMD2Frame;
+                                      interpolationFactor: Single;
+                                                   stride: NativeInt;
+                                               var buffer: TQRVertexBuffer): Boolean; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Gets the model frame mesh as a triangle strip and fan list, as declared in the OpenGL
+             command list
+             @param(index Frame mesh index to get)
+             @param(nextIndex Frame mesh index to interpolate with, no interpolation is done if
+                              equal to index)
+             @param(interpolationFactor Interpolation factor to apply)
+             @param(mesh @bold([out]) Frame mesh)
+             @param(hIsCanceled Callback function that allows to break the operation, can be @nil)
+             @return(@true on success, otherwise @false)
+            }
+            {$ENDREGION}
+            function GetCmdMesh(index, nextIndex: NativeUInt;
+                             interpolationFactor: Double;
+                                        out mesh: TQRMesh;
+                                     hIsCanceled: TQRIsCanceledEvent): Boolean; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Gets the model frame mesh as a single indexed triangle list
+             @param(index Frame mesh index to get)
+             @param(nextIndex Frame mesh index to interpolate with, no interpolation is done if
+                              equal to index)
+             @param(interpolationFactor Interpolation factor to apply)
+             @param(mesh @bold([out]) Frame mesh)
+             @param(hIsCanceled Callback function that allows to break the operation, can be @nil)
+             @return(@true on success, otherwise @false)
+            }
+            {$ENDREGION}
+            function GetIndexedMesh(index, nextIndex: NativeUInt;
+                                 interpolationFactor: Double;
+                                            out mesh: TQRMesh;
+                                         hIsCanceled: TQRIsCanceledEvent): Boolean; virtual;
+
             {$REGION 'Documentation'}
             {**
              Gets pre-calculated light
@@ -666,6 +816,22 @@ type
             {$ENDREGION}
             procedure SetRHToLH(value: Boolean); virtual;
 
+            {$REGION 'Documentation'}
+            {**
+             Gets indexed mesh mode flag status
+             @return(Indexed mesh mode flag status)
+            }
+            {$ENDREGION}
+            function GetIndexed: Boolean; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Sets indexed mesh mode flag status
+             @param(value Indexed mesh mode flag status to set)
+            }
+            {$ENDREGION}
+            procedure SetIndexed(value: Boolean); virtual;
+
             {$REGION 'Documentation'}
             {**
              Gets MD2 parser
@@ -785,6 +951,16 @@ type
             {$ENDREGION}
             function GetMeshCount: NativeUInt; override;
 
+            {$REGION 'Documentation'}
+            {**
+             Gets the aligned-axis bounding box enclosing a frame, without generating its mesh
+             @param(index Frame index)
+             @param(box @bold([out]) Frame bounding box)
+             @return(@true on success, otherwise @false)
+            }
+            {$ENDREGION}
+            function GetFrameBox(index: NativeUInt; out box: TQRBox): Boolean; override;
+
         // Properties
         public
             {$REGION 'Documentation'}
@@ -801,6 +977,15 @@ type
             {$ENDREGION}
             property RHToLH: Boolean read GetRHToLH write SetRHToLH;
 
+            {$REGION 'Documentation'}
+            {**
+             Gets or sets the indexed mesh mode. If enabled, each frame mesh is a single indexed
+             triangle list, whose vertices are deduplicated, instead of a triangle strip or fan per
+             OpenGL command. The index buffer is shared by all the frames
+            }
+            {$ENDREGION}
+            property Indexed: Boolean read GetIndexed write SetIndexed;
+
             {$REGION 'Documentation'}
             {**
              Gets the MD2 parser
@@ -1172,6 +1357,7 @@ begin
     m_pParser             := TQRMD2Parser.Create;
     m_pPreCalculatedLight := TQRDirectionalLight.Create;
     m_RHToLH              := False;
+    m_Indexed             := False;
 
     Populatenormals;
 end;
@@ -1180,6 +1366,11 @@ destructor TQRMD2Model.Destroy;
 begin
     // clear memory
     SetLength(m_Normals, 0);
+    SetLength(m_IndexedVertices, 0);
+    SetLength(m_Indices, 0);
+    SetLength(m_CmdVertices, 0);
+    SetLength(m_Commands, 0);
+    SetLength(m_FrameBoxes, 0);
     m_pPreCalculatedLight.Free;
     m_pParser.Free;
 
@@ -1383,6 +1574,250 @@ begin
     end;
 end;
 //--------------------------------------------------------------------------------------------------
+procedure TQRMD2Model.PopulateTopology;
+type
+    TQRSingleArray = array of Single;
+var
+    glCmdsSingle:                                        TQRSingleArray;
+    heads, links:                                        array of Integer;
+    cmdIndices:                                          array of Cardinal;
+    i, j, glCmd, cmdLength, maxCmdLength, uniqueIndex:   NativeInt;
+    vertexCount, totalVertices, indexCount, uniqueCount: NativeUInt;
+    cmdCount, cmdIndex, cmdVertexIndex:                  NativeUInt;
+    vertexIndex:                                         Cardinal;
+    tu, tv:                                              Single;
+    isFan:                                               Boolean;
+begin
+    // clear the previous topology
+    SetLength(m_IndexedVertices, 0);
+    SetLength(m_Indices,         0);
+    SetLength(m_CmdVertices,     0);
+    SetLength(m_Commands,        0);
+
+    vertexCount := m_pParser.m_Header.m_VertexCount;
+
+    // no vertex or no OpenGL command?
+    if ((vertexCount = 0) or (Length(m_pParser.m_GLCmds) = 0)) then
+        Exit;
+
+    totalVertices := 0;
+    indexCount    := 0;
+    cmdCount      := 0;
+    maxCmdLength  := 0;
+    i             := 0;
+    glCmd         := m_pParser.m_GLCmds[i];
+
+    // measure the OpenGL commands, to allocate the topology once
+    while (glCmd <> 0) do
+    begin
+        cmdLength := Abs(glCmd);
+
+        Inc(totalVertices, cmdLength);
+        Inc(cmdCount);
+
+        if (cmdLength > 2) then
+            Inc(indexCount, (cmdLength - 2) * 3);
+
+        if (cmdLength > maxCmdLength) then
+            maxCmdLength := cmdLength;
+
+        Inc(i, (cmdLength * 3) + 1);
+        glCmd := m_pParser.m_GLCmds[i];
+    end;
+
+    // reinterpret OpenGL commands array as an array of single, to read the texture coordinates
+    glCmdsSingle := TQRSingleArray(m_pParser.m_GLCmds);
+
+    // each frame vertex is the head of a linked list containing the unique vertices using it
+    SetLength(heads, vertexCount);
+
+    for i := 0 to vertexCount - 1 do
+        heads[i] := -1;
+
+    SetLength(m_IndexedVertices, totalVertices);
+    SetLength(links,             totalVertices);
+    SetLength(m_Indices,         indexCount);
+    SetLength(cmdIndices,        maxCmdLength);
+    SetLength(m_CmdVertices,     totalVertices);
+    SetLength(m_Commands,        cmdCount);
+
+    uniqueCount    := 0;
+    indexCount     := 0;
+    cmdIndex       := 0;
+    cmdVertexIndex := 0;
+    i              := 0;
+    glCmd          := m_pParser.m_GLCmds[i];
+
+    // iterate through OpenGL commands (negative value is for triangle fan,
+    // positive value is for triangle strip, 0 means list end)
+    while (glCmd <> 0) do
+    begin
+        isFan     := (glCmd < 0);
+        cmdLength := Abs(glCmd);
+
+        // add the command, its vertices are added to the command vertex list
+        if (isFan) then
+            m_Commands[cmdIndex].m_Type := EQR_VT_TriangleFan
+        else
+            m_Commands[cmdIndex].m_Type := EQR_VT_TriangleStrip;
+
+        m_Commands[cmdIndex].m_First := cmdVertexIndex;
+        m_Commands[cmdIndex].m_Count := cmdLength;
+        Inc(cmdIndex);
+
+        // the first command is the number of vertices to process, already read, so skip it
+        Inc(i);
+
+        // iterate through command vertices
+        for j := 0 to cmdLength - 1 do
+        begin
+            vertexIndex := m_pParser.m_GLCmds[i + 2];
+            tu          := glCmdsSingle[i];
+            tv          := glCmdsSingle[i + 1];
+
+            // is vertex index out of bounds?
+            if (vertexIndex >= vertexCount) then
+            begin
+                SetLength(m_IndexedVertices, 0);
+                SetLength(m_Indices,         0);
+                SetLength(m_CmdVertices,     0);
+                SetLength(m_Commands,        0);
+                Exit;
+            end;
+
+            // add the vertex to the command vertex list
+            m_CmdVertices[cmdVertexIndex].m_VertexIndex := vertexIndex;
+            m_CmdVertices[cmdVertexIndex].m_TU          := tu;
+            m_CmdVertices[cmdVertexIndex].m_TV          := tv;
+            Inc(cmdVertexIndex);
+
+            uniqueIndex := heads[vertexIndex];
+
+            // search for an identical vertex already added
+            while ((uniqueIndex >= 0) and ((m_IndexedVertices[uniqueIndex].m_TU <> tu) or
+                                           (m_IndexedVertices[uniqueIndex].m_TV <> tv)))
+            do
+                uniqueIndex := links[uniqueIndex];
+
+            // not found? Add a new unique vertex
+            if (uniqueIndex < 0) then
+            begin
+                uniqueIndex                                  := uniqueCount;
+                m_IndexedVertices[uniqueIndex].m_VertexIndex := vertexIndex;
+                m_IndexedVertices[uniqueIndex].m_TU          := tu;
+                m_IndexedVertices[uniqueIndex].m_TV          := tv;
+                links[uniqueIndex]                           := heads[vertexIndex];
+                heads[vertexIndex]                           := uniqueIndex;
+                Inc(uniqueCount);
+            end;
+
+            cmdIndices[j] := uniqueIndex;
+            Inc(i, 3);
+        end;
+
+        // convert the command to triangles. NOTE the odd triangles of a strip are swapped to keep
+        // the same winding as the even ones
+        for j := 0 to cmdLength - 3 do
+        begin
+            if (isFan) then
+            begin
+                m_Indices[indexCount]     := cmdIndices[0];
+                m_Indices[indexCount + 1] := cmdIndices[j + 1];
+            end
+            else
+            if ((j mod 2) = 0) then
+            begin
+                m_Indices[indexCount]     := cmdIndices[j];
+                m_Indices[indexCount + 1] := cmdIndices[j + 1];
+            end
+            else
+            begin
+                m_Indices[indexCount]     := cmdIndices[j + 1];
+                m_Indices[indexCount + 1] := cmdIndices[j];
+            end;
+
+            m_Indices[indexCount + 2] := cmdIndices[j + 2];
+            Inc(indexCount, 3);
+        end;
+
+        // go to next OpenGL command
+        glCmd := m_pParser.m_GLCmds[i];
+    end;
+
+    // shrink the vertex list to the unique vertices
+    SetLength(m_IndexedVertices, uniqueCount);
+end;
+//--------------------------------------------------------------------------------------------------
+procedure TQRMD2Model.PopulateFrameBoxes;
+var
+    frameCount, vertexCount, i, j: NativeUInt;
+    k:                             Byte;
+    value:                         TQRUInt8;
+    minVertex, maxVertex:          array[0..2] of TQRUInt8;
+    minEdge, maxEdge:              array[0..2] of Single;
+    edge:                          Single;
+begin
+    // clear the previous boxes
+    SetLength(m_FrameBoxes, 0);
+
+    frameCount := Length(m_pParser.m_Frames);
+
+    // no frame?
+    if (frameCount = 0) then
+        Exit;
+
+    SetLength(m_FrameBoxes, frameCount);
+
+    // iterate through frames
+    for i := 0 to frameCount - 1 do
+    begin
+        vertexCount := Length(m_pParser.m_Frames[i].m_Vertex);
+
+        // no vertex?
+        if (vertexCount = 0) then
+            continue;
+
+        // search for the compressed box edges, compressed values are all in the same range
+        for k := 0 to 2 do
+        begin
+            minVertex[k] := m_pParser.m_Frames[i].m_Vertex[0].m_Vertex[k];
+            maxVertex[k] := minVertex[k];
+        end;
+
+        for j := 1 to vertexCount - 1 do
+            for k := 0 to 2 do
+            begin
+                value := m_pParser.m_Frames[i].m_Vertex[j].m_Vertex[k];
+
+                if (value < minVertex[k]) then
+                    minVertex[k] := value;
+
+                if (value > maxVertex[k]) then
+                    maxVertex[k] := value;
+            end;
+
+        // uncompress the box edges using frame scale and translate values
+        for k := 0 to 2 do
+        begin
+            minEdge[k] := (m_pParser.m_Frames[i].m_Scale[k] * minVertex[k]) +
+                    m_pParser.m_Frames[i].m_Translate[k];
+            maxEdge[k] := (m_pParser.m_Frames[i].m_Scale[k] * maxVertex[k]) +
+                    m_pParser.m_Frames[i].m_Translate[k];
+
+            // a negative scale swaps the edges
+            if (minEdge[k] > maxEdge[k]) then
+            begin
+                edge       := minEdge[k];
+                minEdge[k] := maxEdge[k];
+                maxEdge[k] := edge;
+            end;
+        end;
+
+        m_FrameBoxes[i].Min.Assign(TQRVector3D.Create(minEdge[0], minEdge[1], minEdge[2]));
+        m_FrameBoxes[i].Max.Assign(TQRVector3D.Create(maxEdge[0], maxEdge[1], maxEdge[2]));
+    end;
+end;
+//--------------------------------------------------------------------------------------------------
 function TQRMD2Model.UncompressVertex(const frame: TQRMD2Frame;
                                      const vertex: TQRMD2Vertex): TQRVector3D;
 var
@@ -1397,6 +1832,329 @@ begin
     Result := TQRVector3D.Create(vertArray[0], vertArray[1], vertArray[2]);
 end;
 //--------------------------------------------------------------------------------------------------
+function TQRMD2Model.PopulateVertexBuffer(const vertices: TQRMD2IndexedVertices;
+                                             first, count: NativeUInt;
+                                 const srcFrame, intFrame: TQRMD2Frame;
+                                      interpolationFactor: Single;
+                                                   stride: NativeInt;
+                                               var buffer: TQRVertexBuffer): Boolean;
+var
+    i, last:                            NativeUInt;
+    normalCount, offset, attribOffset:  NativeInt;
+    srcVertex, intVertex:               TQRMD2Vertex;
+    x, y, z, factor, xSign, r, g, b, a: Single;
+    normal, intNormal:                  TQRVector3D;
+    light:                              TQRVertexLight;
+begin
+    // nothing to populate?
+    if (count = 0) then
+        Exit(True);
+
+    // is buffer too small?
+    if (NativeUInt(Length(buffer)) < (count * NativeUInt(stride))) then
+        Exit(False);
+
+    normalCount := Length(m_Normals);
+    last        := first + count - 1;
+
+    // is interpolation factor out of bounds? Limit to min or max values in this case
+    if (interpolationFactor < 0.0) then
+        factor := 0.0
+    else
+    if (interpolationFactor > 1.0) then
+        factor := 1.0
+    else
+        factor := interpolationFactor;
+
+    // do convert right hand <-> left hand coordinate system? If yes, the x axis is inverted
+    if (m_RHToLH) then
+        xSign := -1.0
+    else
+        xSign := 1.0;
+
+    offset := 0;
+
+    // populate the vertex positions
+    for i := first to last do
+    begin
+        srcVertex := srcFrame.m_Vertex[vertices[i].m_VertexIndex];
+        intVertex := intFrame.m_Vertex[vertices[i].m_VertexIndex];
+
+        // uncompress the source vertex
+        x := (srcFrame.m_Scale[0] * srcVertex.m_Vertex[0]) + srcFrame.m_Translate[0];
+        y := (srcFrame.m_Scale[1] * srcVertex.m_Vertex[1]) + srcFrame.m_Translate[1];
+        z := (srcFrame.m_Scale[2] * srcVertex.m_Vertex[2]) + srcFrame.m_Translate[2];
+
+        // uncompress the vertex to interpolate with, and interpolate them
+        buffer[offset]     := xSign * (x + ((((intFrame.m_Scale[0] * intVertex.m_Vertex[0]) +
+                                 intFrame.m_Translate[0]) - x) * factor));
+        buffer[offset + 1] := y + ((((intFrame.m_Scale[1] * intVertex.m_Vertex[1]) +
+                                 intFrame.m_Translate[1]) - y) * factor);
+        buffer[offset + 2] := z + ((((intFrame.m_Scale[2] * intVertex.m_Vertex[2]) +
+                                 intFrame.m_Translate[2]) - z) * factor);
+
+        Inc(offset, stride);
+    end;
+
+    attribOffset := 3;
+
+    // do include normals?
+    if (EQR_VF_Normals in VertexFormat) then
+    begin
+        offset := attribOffset;
+
+        // populate the vertex normals
+        for i := first to last do
+        begin
+            srcVertex := srcFrame.m_Vertex[vertices[i].m_VertexIndex];
+            intVertex := intFrame.m_Vertex[vertices[i].m_VertexIndex];
+
+            // is normal index out of bounds?
+            if (srcVertex.m_NormalIndex >= normalCount) then
+                Exit(False);
+
+            normal := m_Normals[srcVertex.m_NormalIndex];
+
+            // get the normal to interpolate with, keep the source normal if not available
+            if (intVertex.m_NormalIndex < normalCount) then
+                intNormal := m_Normals[intVertex.m_NormalIndex]
+            else
+                intNormal := normal;
+
+            buffer[offset]     := xSign * (normal.X + ((intNormal.X - normal.X) * factor));
+            buffer[offset + 1] := normal.Y + ((intNormal.Y - normal.Y) * factor);
+            buffer[offset + 2] := normal.Z + ((intNormal.Z - normal.Z) * factor);
+
+            Inc(offset, stride);
+        end;
+
+        Inc(attribOffset, 3);
+    end;
+
+    // do include texture coordinates?
+    if (EQR_VF_TexCoords in VertexFormat) then
+    begin
+        offset := attribOffset;
+
+        // populate the vertex texture coordinates
+        for i := first to last do
+        begin
+            buffer[offset]     := vertices[i].m_TU;
+            buffer[offset + 1] := vertices[i].m_TV;
+
+            Inc(offset, stride);
+        end;
+
+        Inc(attribOffset, 2);
+    end;
+
+    // don't include colors?
+    if (not(EQR_VF_Colors in VertexFormat)) then
+        Exit(True);
+
+    offset := attribOffset;
+
+    // don't pre-calculate lightning? In this case all the vertices use the material color
+    if (not m_pPreCalculatedLight.Enabled) then
+    begin
+        r := Color.GetRedF;
+        g := Color.GetGreenF;
+        b := Color.GetBlueF;
+        a := Color.GetAlphaF;
+
+        // populate the vertex colors
+        for i := first to last do
+        begin
+            buffer[offset]     := r;
+            buffer[offset + 1] := g;
+            buffer[offset + 2] := b;
+            buffer[offset + 3] := a;
+
+            Inc(offset, stride);
+        end;
+
+        Exit(True);
+    end;
+
+    // prepare the pre-calculated light once for the whole frame
+    light := TQRVertexLight.Create(m_pPreCalculatedLight);
+
+    // populate the vertex colors, calculated from the pre-calculated light
+    for i := first to last do
+    begin
+        srcVertex := srcFrame.m_Vertex[vertices[i].m_VertexIndex];
+        intVertex := intFrame.m_Vertex[vertices[i].m_VertexIndex];
+
+        // is normal index out of bounds?
+        if (srcVertex.m_NormalIndex >= normalCount) then
+            // unfortunately normal isn't available, so use the ambient color (not the best
+            // solution, but for lack of better...)
+            light.ApplyAmbient(buffer, offset)
+        else
+        begin
+            normal := m_Normals[srcVertex.m_NormalIndex];
+
+            // get the normal to interpolate with, keep the source normal if not available
+            if (intVertex.m_NormalIndex < normalCount) then
+                intNormal := m_Normals[intVertex.m_NormalIndex]
+            else
+                intNormal := normal;
+
+            // calculate the final vertex normal
+            normal := TQRVector3D.Create(xSign * (normal.X + ((intNormal.X - normal.X) * factor)),
+                                         normal.Y + ((intNormal.Y - normal.Y) * factor),
+                                         normal.Z + ((intNormal.Z - normal.Z) * factor));
+
+            // calculate lightning from pre-calculated light
+            light.Apply(normal, buffer, offset);
+        end;
+
+        Inc(offset, stride);
+    end;
+
+    Result := True;
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRMD2Model.GetCmdMesh(index, nextIndex: NativeUInt;
+                             interpolationFactor: Double;
+                                        out mesh: TQRMesh;
+                                     hIsCanceled: TQRIsCanceledEvent): Boolean;
+var
+    stride:    NativeInt;
+    cmdCount:  NativeUInt;
+    i:         NativeUInt;
+begin
+    // is frame index out of bounds?
+    if ((index >= GetMeshCount) or (nextIndex >= GetMeshCount)) then
+        Exit(False);
+
+    // do use normals and pre-calculated normals table wasn't populated?
+    if ((EQR_VF_Normals in VertexFormat) and (Length(m_Normals) = 0)) then
+        Exit(False);
+
+    cmdCount := Length(m_Commands);
+
+    // topology wasn't populated?
+    if (cmdCount = 0) then
+        Exit(False);
+
+    // basically stride is the coordinates values size
+    stride := 3;
+
+    // do include m_Normals?
+    if (EQR_VF_Normals in VertexFormat) then
+        Inc(stride, 3);
+
+    // do include texture coordinates?
+    if (EQR_VF_TexCoords in VertexFormat) then
+        Inc(stride, 2);
+
+    // do include colors?
+    if (EQR_VF_Colors in VertexFormat) then
+        Inc(stride, 4);
+
+    // allocate the output meshes once, one mesh per OpenGL command
+    SetLength(mesh, cmdCount);
+
+    // iterate through OpenGL commands
+    for i := 0 to cmdCount - 1 do
+    begin
+        // is canceled?
+        if (Assigned(hIsCanceled) and hIsCanceled) then
+            Exit(False);
+
+        // create and populate new vertex for the current command
+        mesh[i].m_Name      := 'qr_md2';
+        mesh[i].m_Stride    := stride;
+        mesh[i].m_Format    := VertexFormat;
+        mesh[i].m_CoordType := EQR_VC_XYZ;
+        mesh[i].m_Type      := m_Commands[i].m_Type;
+
+        // allocate the whole vertex buffer once, the vertex count is known from the command
+        SetLength(mesh[i].m_Buffer, m_Commands[i].m_Count * NativeUInt(stride));
+
+        // populate the vertex buffer from the command vertices
+        if (not PopulateVertexBuffer(m_CmdVertices,
+                                     m_Commands[i].m_First,
+                                     m_Commands[i].m_Count,
+                                     m_pParser.m_Frames[index],
+                                     m_pParser.m_Frames[nextIndex],
+                                     interpolationFactor,
+                                     stride,
+                                     mesh[i].m_Buffer))
+        then
+            Exit(False);
+    end;
+
+    Result := True;
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRMD2Model.GetIndexedMesh(index, nextIndex: NativeUInt;
+                                 interpolationFactor: Double;
+                                            out mesh: TQRMesh;
+                                         hIsCanceled: TQRIsCanceledEvent): Boolean;
+var
+    stride:      NativeInt;
+    vertexCount: NativeUInt;
+begin
+    // is frame index out of bounds?
+    if ((index >= GetMeshCount) or (nextIndex >= GetMeshCount)) then
+        Exit(False);
+
+    // do use normals and pre-calculated normals table wasn't populated?
+    if ((EQR_VF_Normals in VertexFormat) and (Length(m_Normals) = 0)) then
+        Exit(False);
+
+    vertexCount := Length(m_IndexedVertices);
+
+    // topology wasn't populated?
+    if (vertexCount = 0) then
+        Exit(False);
+
+    // basically stride is the coordinates values size
+    stride := 3;
+
+    // do include m_Normals?
+    if (EQR_VF_Normals in VertexFormat) then
+        Inc(stride, 3);
+
+    // do include texture coordinates?
+    if (EQR_VF_TexCoords in VertexFormat) then
+        Inc(stride, 2);
+
+    // do include colors?
+    if (EQR_VF_Colors in VertexFormat) then
+        Inc(stride, 4);
+
+    // the whole frame is a single triangle list
+    SetLength(mesh, 1);
+
+    mesh[0].m_Name      := 'qr_md2';
+    mesh[0].m_Stride    := stride;
+    mesh[0].m_Format    := VertexFormat;
+    mesh[0].m_CoordType := EQR_VC_XYZ;
+    mesh[0].m_Type      := EQR_VT_Triangles;
+
+    // the index buffer is shared by all the frames, only the vertex buffer is generated
+    mesh[0].m_Indices := m_Indices;
+    SetLength(mesh[0].m_Buffer, vertexCount * NativeUInt(stride));
+
+    // is canceled?
+    if (Assigned(hIsCanceled) and hIsCanceled) then
+        Exit(False);
+
+    // populate the vertex buffer from the unique vertices. NOTE if nextIndex is equal to index,
+    // the frame is interpolated with itself, which returns it unchanged
+    Result := PopulateVertexBuffer(m_IndexedVertices,
+                                   0,
+                                   vertexCount,
+                                   m_pParser.m_Frames[index],
+                                   m_pParser.m_Frames[nextIndex],
+                                   interpolationFactor,
+                                   stride,
+                                   mesh[0].m_Buffer);
+end;
+//--------------------------------------------------------------------------------------------------
 function TQRMD2Model.GetPreCalculatedLight: TQRDirectionalLight;
 begin
     Result := m_pPreCalculatedLight;
@@ -1417,6 +2175,16 @@ begin
     m_RHToLH := value;
 end;
 //--------------------------------------------------------------------------------------------------
+function TQRMD2Model.GetIndexed: Boolean;
+begin
+    Result := m_Indexed;
+end;
+//--------------------------------------------------------------------------------------------------
+procedure TQRMD2Model.SetIndexed(value: Boolean);
+begin
+    m_Indexed := value;
+end;
+//--------------------------------------------------------------------------------------------------
 function TQRMD2Model.GetParser: TQRMD2Parser;
 begin
     Result := m_pParser;
@@ -1425,11 +2193,25 @@ end;
 function TQRMD2Model.Load(const fileName: TFileName): Boolean;
 begin
     Result := m_pParser.Load(fileName);
+
+    // populate the indexed topology, shared by all the frames, and the frame boxes
+    if (Result) then
+    begin
+        PopulateTopology;
+        PopulateFrameBoxes;
+    end;
 end;
 //--------------------------------------------------------------------------------------------------
 function TQRMD2Model.Load(const pBuffer: TStream; readLength: NativeUInt): Boolean;
 begin
     Result := m_pParser.Load(pBuffer, readLength);
+
+    // populate the indexed topology, shared by all the frames, and the frame boxes
+    if (Result) then
+    begin
+        PopulateTopology;
+        PopulateFrameBoxes;
+    end;
 end;
 //--------------------------------------------------------------------------------------------------
 function TQRMD2Model.LoadNormals(const fileName: TFileName): Boolean;
@@ -1509,212 +2291,20 @@ function TQRMD2Model.GetMesh(index: NativeUInt;
                           out mesh: TQRMesh;
                          pAABBTree: TQRAABBTree;
                        hIsCanceled: TQRIsCanceledEvent): Boolean;
-type
-    TQRSingleArray = array of Single;
-var
-    srcFrame:                                    TQRMD2Frame;
-    stride, normalCount, i, j, meshIndex, glCmd: NativeInt;
-    srcVertex:                                   TQRMD2Vertex;
-    ucpVertex, normal:                           TQRVector3D;
-    tu, tv:                                      Single;
-    pMeshColor:                                  TQRColor;
-    foundNormal, doFreeColor:                    Boolean;
-    glCmdsSingle:                                TQRSingleArray;
 begin
     // is frame index out of bounds?
     if (index >= GetMeshCount) then
         Exit(False);
 
-    // get normal count
-    normalCount := Length(m_Normals);
-
-    // do use normals and pre-calculated normals table wasn't populated?
-    if ((EQR_VF_Normals in VertexFormat) and (normalCount = 0)) then
-        Exit(False);
-
-    // get source frame from which mesh should be extracted
-    srcFrame := m_pParser.m_Frames[index];
-
-    // basically stride is the coordinates values size
-    stride := 3;
-
-    // do include m_Normals?
-    if (EQR_VF_Normals in VertexFormat) then
-        Inc(stride, 3);
-
-    // do include texture coordinates?
-    if (EQR_VF_TexCoords in VertexFormat) then
-        Inc(stride, 2);
-
-    // do include colors?
-    if (EQR_VF_Colors in VertexFormat) then
-        Inc(stride, 4);
-
-    i      := 0;
-    glCmd  := m_pParser.m_GLCmds[i];
-
-    // iterate through OpenGL commands (negative value is for triangle fan,
-    // positive value is for triangle strip, 0 means list end)
-    while (glCmd <> 0) do
+    // do generate a single indexed triangle list?
+    if (m_Indexed) then
     begin
-        // is canceled?
-        if (Assigned(hIsCanceled) and hIsCanceled) then
+        if (not GetIndexedMesh(index, index, 0.0, mesh, hIsCanceled)) then
             Exit(False);
-
-        // the first command is the number of vertices to process, already read, so skip it
-        Inc(i);
-
-        // add mesh to output
-        SetLength(mesh, Length(mesh) + 1);
-        meshIndex := Length(mesh) - 1;
-
-        // create and populate new vertex for the current command
-        mesh[meshIndex].m_Name      := 'qr_md2';
-        mesh[meshIndex].m_Stride    := stride;
-        mesh[meshIndex].m_Format    := VertexFormat;
-        mesh[meshIndex].m_CoordType := EQR_VC_XYZ;
-
-        // search for OpenGL command type
-        if (glCmd < 0) then
-        begin
-            mesh[meshIndex].m_Type := EQR_VT_TriangleFan;
-            glCmd                  := -glCmd;
-        end
-        else
-            mesh[meshIndex].m_Type := EQR_VT_TriangleStrip;
-
-        j := 0;
-
-        // iterate through OpenGL commands to process
-        while (glCmd > 0) do
-        begin
-            // is canceled?
-            if (Assigned(hIsCanceled) and hIsCanceled) then
-                Exit(False);
-
-            // get source vertex
-            srcVertex := srcFrame.m_Vertex[m_pParser.m_GLCmds[i + 2]];
-
-            // uncompress vertex
-            ucpVertex := UncompressVertex(srcFrame, srcVertex);
-
-            // do convert right hand <-> left hand coordinate system?
-            if (m_RHToLH) then
-                // apply conversion
-                ucpVertex.X := -ucpVertex.X;
-
-            // populate vertex buffer
-            SetLength(mesh[meshIndex].m_Buffer, Length(mesh[meshIndex].m_Buffer) + 3);
-            mesh[meshIndex].m_Buffer[j]     := ucpVertex.X;
-            mesh[meshIndex].m_Buffer[j + 1] := ucpVertex.Y;
-            mesh[meshIndex].m_Buffer[j + 2] := ucpVertex.Z;
-            Inc(j, 3);
-
-            // do include m_Normals?
-            if (EQR_VF_Normals in VertexFormat) then
-            begin
-                // is normal index out of bounds?
-                if (srcVertex.m_NormalIndex >= normalCount) then
-                    Exit(False);
-
-                // get vertex normal
-                normal := m_Normals[srcVertex.m_NormalIndex];
-
-                // do convert right hand <-> left hand coordinate system?
-                if (m_RHToLH) then
-                    // apply conversion
-                    normal.X := -normal.X;
-
-                SetLength(mesh[meshIndex].m_Buffer, Length(mesh[meshIndex].m_Buffer) + 3);
-                mesh[meshIndex].m_Buffer[j]     := normal.X;
-                mesh[meshIndex].m_Buffer[j + 1] := normal.Y;
-                mesh[meshIndex].m_Buffer[j + 2] := normal.Z;
-                Inc(j, 3);
-            end;
-
-            // do include texture coordinates?
-            if (EQR_VF_TexCoords in VertexFormat) then
-            begin
-                // reinterpret OpenGL commands array as an array of single
-                glCmdsSingle := TQRSingleArray(m_pParser.m_GLCmds);
-
-                // get vertex texture coordinates
-                tu := glCmdsSingle[i];
-                tv := glCmdsSingle[i + 1];
-
-                SetLength(mesh[meshIndex].m_Buffer, Length(mesh[meshIndex].m_Buffer) + 2);
-                mesh[meshIndex].m_Buffer[j]     := tu;
-                mesh[meshIndex].m_Buffer[j + 1] := tv;
-                Inc(j, 2);
-            end;
-
-            // do include colors?
-            if (EQR_VF_Colors in VertexFormat) then
-            begin
-                doFreeColor := False;
-
-                // do pre-calculate lightining or use the material color?
-                if (m_pPreCalculatedLight.Enabled) then
-                begin
-                    // by default, normal exists
-                    foundNormal := True;
-
-                    // are normals also included?
-                    if (not(EQR_VF_Normals in VertexFormat)) then
-                    begin
-                        // is normal index out of bounds?
-                        if (srcVertex.m_NormalIndex >= normalCount) then
-                        begin
-                            // normal isn't available
-                            foundNormal := False;
-                        end
-                        else
-                        begin
-                            // get vertex normal
-                            normal := m_Normals[srcVertex.m_NormalIndex];
-
-                            // do convert right hand <-> left hand coordinate system?
-                            if (m_RHToLH) then
-                                // apply conversion
-                                normal.X := -normal.X;
-                        end;
-                    end;
-
-                    // calculate lightning from pre-calculated light
-                    if (foundNormal) then
-                    begin
-                        doFreeColor := True;
-                        pMeshColor  := CalculateLight(normal, m_pPreCalculatedLight);
-                    end
-                    else
-                        // unfortunately normal isn't available, so use the ambient color (not the
-                        // best solution, but for lack of better...)
-                        pMeshColor := m_pPreCalculatedLight.Ambient;
-                end
-                else
-                begin
-                    // use default color
-                    pMeshColor := Color;
-                end;
-
-                SetLength(mesh[meshIndex].m_Buffer, Length(mesh[meshIndex].m_Buffer) + 4);
-                mesh[meshIndex].m_Buffer[j]     := pMeshColor.GetRedF;
-                mesh[meshIndex].m_Buffer[j + 1] := pMeshColor.GetGreenF;
-                mesh[meshIndex].m_Buffer[j + 2] := pMeshColor.GetBlueF;
-                mesh[meshIndex].m_Buffer[j + 3] := pMeshColor.GetAlphaF;
-                Inc(j, 4);
-
-                if (doFreeColor) then
-                    pMeshColor.Free;
-            end;
-
-            Dec(glCmd);
-            Inc(i, 3);
-        end;
-
-        // go to next OpenGL command
-        glCmd := m_pParser.m_GLCmds[i];
-    end;
+    end
+    else
+    if (not GetCmdMesh(index, index, 0.0, mesh, hIsCanceled)) then
+        Exit(False);
 
     // canceled?
     if (Assigned(hIsCanceled) and hIsCanceled) then
@@ -1732,243 +2322,41 @@ function TQRMD2Model.GetMesh(index, nextIndex: NativeUInt;
                           interpolationFactor: Double;
                                      out mesh: TQRMesh;
                                   hIsCanceled: TQRIsCanceledEvent): Boolean;
-type
-    TQRSingleArray = array of Single;
-var
-    srcFrame, intFrame:                                                   TQRMD2Frame;
-    stride, normalCount, i, j, meshIndex, glCmd:                          NativeInt;
-    srcVertex, intVertex:                                                 TQRMD2Vertex;
-    ucpVertex, ucpIntVertex, finalVertex, normal, intNormal, finalNormal: TQRVector3D;
-    tu, tv:                                                               Single;
-    pMeshColor:                                                           TQRColor;
-    foundNormal, doFreeColor:                                             Boolean;
-    glCmdsSingle:                                                         TQRSingleArray;
 begin
     // is frame index out of bounds?
     if ((index >= GetMeshCount) or (nextIndex >= GetMeshCount)) then
         Exit(False);
 
-    // get normal count
-    normalCount := Length(m_Normals);
+    // do generate a single indexed triangle list?
+    if (m_Indexed) then
+        Exit(GetIndexedMesh(index, nextIndex, interpolationFactor, mesh, hIsCanceled));
 
-    // do use normals and pre-calculated normals table wasn't populated?
-    if ((EQR_VF_Normals in VertexFormat) and (normalCount = 0)) then
+    // generate a triangle strip and fan list, as declared in the OpenGL command list
+    Result := GetCmdMesh(index, nextIndex, interpolationFactor, mesh, hIsCanceled);
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRMD2Model.GetMeshCount: NativeUInt;
+begin
+    Result := m_pParser.m_Header.m_FrameCount;
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRMD2Model.GetFrameBox(index: NativeUInt; out box: TQRBox): Boolean;
+begin
+    // is frame index out of bounds?
+    if (index >= NativeUInt(Length(m_FrameBoxes))) then
         Exit(False);
 
-    // get source frame from which mesh should be extracted, and frame to interpolate with
-    srcFrame := m_pParser.m_Frames[index];
-    intFrame := m_pParser.m_Frames[nextIndex];
-
-    // basically stride is the coordinates values size
-    stride := 3;
-
-    // do include m_Normals?
-    if (EQR_VF_Normals in VertexFormat) then
-        Inc(stride, 3);
-
-    // do include texture coordinates?
-    if (EQR_VF_TexCoords in VertexFormat) then
-        Inc(stride, 2);
+    box := m_FrameBoxes[index];
 
-    // do include colors?
-    if (EQR_VF_Colors in VertexFormat) then
-        Inc(stride, 4);
-
-    i      := 0;
-    glCmd  := m_pParser.m_GLCmds[i];
-
-    // iterate through OpenGL commands (negative value is for triangle fan,
-    // positive value is for triangle strip, 0 means list end)
-    while (glCmd <> 0) do
+    // convert the box to left hand coordinate system if required, the x axis is mirrored
+    if (m_RHToLH) then
     begin
-        // is canceled?
-        if (Assigned(hIsCanceled) and hIsCanceled) then
-            Exit(False);
-
-        // the first command is the number of vertices to process, already read, so skip it
-        Inc(i);
-
-        // add mesh to output
-        SetLength(mesh, Length(mesh) + 1);
-        meshIndex := Length(mesh) - 1;
-
-        // create and populate new vertex for the current command
-        mesh[meshIndex].m_Name      := 'qr_md2';
-        mesh[meshIndex].m_Stride    := stride;
-        mesh[meshIndex].m_Format    := VertexFormat;
-        mesh[meshIndex].m_CoordType := EQR_VC_XYZ;
-
-        // search for OpenGL command type
-        if (glCmd < 0) then
-        begin
-            mesh[meshIndex].m_Type := EQR_VT_TriangleFan;
-            glCmd                  := -glCmd;
-        end
-        else
-            mesh[meshIndex].m_Type := EQR_VT_TriangleStrip;
-
-        j := 0;
-
-        // iterate through OpenGL commands to process
-        while (glCmd > 0) do
-        begin
-            // is canceled?
-            if (Assigned(hIsCanceled) and hIsCanceled) then
-                Exit(False);
-
-            // get source vertex, and vertex to interpolate with
-            srcVertex := srcFrame.m_Vertex[m_pParser.m_GLCmds[i + 2]];
-            intVertex := intFrame.m_Vertex[m_pParser.m_GLCmds[i + 2]];
-
-            // uncompress vertices
-            ucpVertex    := UncompressVertex(srcFrame, srcVertex);
-            ucpIntVertex := UncompressVertex(intFrame, intVertex);
-
-            // do convert right hand <-> left hand coordinate system?
-            if (m_RHToLH) then
-            begin
-                // apply conversion
-                ucpVertex.X    := -ucpVertex.X;
-                ucpIntVertex.X := -ucpIntVertex.X;
-            end;
-
-            // calculate final mesh vertex
-            finalVertex := ucpVertex.Interpolate(ucpIntVertex, interpolationFactor);
-
-            // populate vertex buffer
-            SetLength(mesh[meshIndex].m_Buffer, Length(mesh[meshIndex].m_Buffer) + 3);
-            mesh[meshIndex].m_Buffer[j]     := finalVertex.X;
-            mesh[meshIndex].m_Buffer[j + 1] := finalVertex.Y;
-            mesh[meshIndex].m_Buffer[j + 2] := finalVertex.Z;
-            Inc(j, 3);
-
-            // do include m_Normals?
-            if (EQR_VF_Normals in VertexFormat) then
-            begin
-                // is normal index out of bounds?
-                if (srcVertex.m_NormalIndex >= normalCount) then
-                    Exit(False);
-
-                // get vertex normal, and normal to interpolate with
-                normal    := m_Normals[srcVertex.m_NormalIndex];
-                intNormal := m_Normals[intVertex.m_NormalIndex];
-
-                // do convert right hand <-> left hand coordinate system?
-                if (m_RHToLH) then
-                begin
-                    // apply conversion
-                    normal.X    := -normal.X;
-                    intNormal.X := -intNormal.X;
-                end;
-
-                // calculate final vertex normal
-                finalNormal := normal.Interpolate(intNormal, interpolationFactor);
-
-                SetLength(mesh[meshIndex].m_Buffer, Length(mesh[meshIndex].m_Buffer) + 3);
-                mesh[meshIndex].m_Buffer[j]     := finalNormal.X;
-                mesh[meshIndex].m_Buffer[j + 1] := finalNormal.Y;
-                mesh[meshIndex].m_Buffer[j + 2] := finalNormal.Z;
-                Inc(j, 3);
-            end;
-
-            // do include texture coordinates?
-            if (EQR_VF_TexCoords in VertexFormat) then
-            begin
-                // reinterpret OpenGL commands array as an array of single
-                glCmdsSingle := TQRSingleArray(m_pParser.m_GLCmds);
-
-                // get vertex texture coordinates
-                tu := glCmdsSingle[i];
-                tv := glCmdsSingle[i + 1];
-
-                SetLength(mesh[meshIndex].m_Buffer, Length(mesh[meshIndex].m_Buffer) + 2);
-                mesh[meshIndex].m_Buffer[j]     := tu;
-                mesh[meshIndex].m_Buffer[j + 1] := tv;
-                Inc(j, 2);
-            end;
-
-            // do include colors?
-            if (EQR_VF_Colors in VertexFormat) then
-            begin
-                doFreeColor := False;
-
-                // do pre-calculate lightining or use the material color?
-                if (m_pPreCalculatedLight.Enabled) then
-                begin
-                    // by default, normal exists
-                    foundNormal := True;
-
-                    // are normals also included?
-                    if (not(EQR_VF_Normals in VertexFormat)) then
-                    begin
-                        // is normal index out of bounds?
-                        if (srcVertex.m_NormalIndex >= normalCount) then
-                        begin
-                            // normal isn't available
-                            foundNormal := False;
-                        end
-                        else
-                        begin
-                            // get vertex normal, and normal to interpolate with
-                            normal    := m_Normals[srcVertex.m_NormalIndex];
-                            intNormal := m_Normals[intVertex.m_NormalIndex];
-
-                            // do convert right hand <-> left hand coordinate system?
-                            if (m_RHToLH) then
-                            begin
-                                // apply conversion
-                                normal.X    := -normal.X;
-                                intNormal.X := -intNormal.X;
-                            end;
-
-                            // calculate final vertex normal
-                            finalNormal := normal.Interpolate(intNormal, interpolationFactor);
-                        end;
-                    end;
-
-                    // calculate lightning from pre-calculated light
-                    if (foundNormal) then
-                    begin
-                        doFreeColor := True;
-                        pMeshColor   := CalculateLight(finalNormal, m_pPreCalculatedLight);
-                    end
-                    else
-                        // unfortunately normal isn't available, so use the ambient color (not the
-                        // best solution, but for lack of better...)
-                        pMeshColor := m_pPreCalculatedLight.Ambient;
-                end
-                else
-                begin
-                    // use default color
-                    pMeshColor := Color;
-                end;
-
-                SetLength(mesh[meshIndex].m_Buffer, Length(mesh[meshIndex].m_Buffer) + 4);
-                mesh[meshIndex].m_Buffer[j]     := pMeshColor.GetRedF;
-                mesh[meshIndex].m_Buffer[j + 1] := pMeshColor.GetGreenF;
-                mesh[meshIndex].m_Buffer[j + 2] := pMeshColor.GetBlueF;
-                mesh[meshIndex].m_Buffer[j + 3] := pMeshColor.GetAlphaF;
-                Inc(j, 4);
-
-                if (doFreeColor) then
-                    pMeshColor.Free;
-            end;
-
-            Dec(glCmd);
-            Inc(i, 3);
-        end;
-
-        // go to next OpenGL command
-        glCmd := m_pParser.m_GLCmds[i];
+        box.Min.X := -m_FrameBoxes[index].Max.X;
+        box.Max.X := -m_FrameBoxes[index].Min.X;
     end;
 
     Result := True;
 end;
 //--------------------------------------------------------------------------------------------------
-function TQRMD2Model.GetMeshCount: NativeUInt;
-begin
-    Result := m_pParser.m_Header.m_FrameCount;
-end;
-//--------------------------------------------------------------------------------------------------
 
 end.
@@ -34,6 +34,7 @@ interface
 uses Classes,
      SysUtils,
      Generics.Collections,
+     SyncObjs,
      UTQRCommon,
      UTQRGraphics,
      UTQR3D,
@@ -737,12 +738,23 @@ type
             property MeshCount: NativeInt read GetMeshCount;
     end;
 
-    TQRMD3Vertices           = array of TQRVector3D;
-    TQRMD3Normals            = array of TQRVector3D;
-    TQRMD3TexCoords          = array of TQRTexCoord;
-    TQRMD3VerticesDictionary = TDictionary<NativeUInt, TQRMD3Vertices>;
-    TQRMD3NormalDictionary   = TDictionary<NativeUInt, TQRMD3Normals>;
-    TQRMD3TextureDictionary  = TDictionary<NativeUInt, TQRMD3TexCoords>;
+    TQRMD3Vertices          = array of TQRVector3D;
+    TQRMD3Normals           = array of TQRVector3D;
+    TQRMD3TexCoords         = array of TQRTexCoord;
+    TQRMD3TextureDictionary = TDictionary<NativeUInt, TQRMD3TexCoords>;
+
+    {$REGION 'Documentation'}
+    {**
+     MD3 mesh frame, i.e. the uncompressed vertices and normals of a mesh in an animation frame
+    }
+    {$ENDREGION}
+    TQRMD3MeshFrame = record
+        m_Vertices: TQRMD3Vertices;
+        m_Normals:  TQRMD3Normals;
+    end;
+
+    TQRMD3MeshFrameDictionary = TDictionary<UInt64, TQRMD3MeshFrame>;
+    TQRMD3MeshFrameQueue      = TQueue<UInt64>;
 
     {$REGION 'Documentation'}
     {**
@@ -751,63 +763,95 @@ type
     {$ENDREGION}
     TQRMD3Model = class(TQRFramedModel)
         private
-            m_pParser:    TQRMD3Parser;
-            m_pVertices:  TQRMD3VerticesDictionary;
-            m_pNormals:   TQRMD3NormalDictionary;
-            m_pTexCoords: TQRMD3TextureDictionary;
+            m_pParser:          TQRMD3Parser;
+            m_pTexCoords:       TQRMD3TextureDictionary;
+            m_pFrames:          TQRMD3MeshFrameDictionary;
+            m_pFrameQueue:      TQRMD3MeshFrameQueue;
+            m_FrameBoxes:       TQRFrameBoxes;
+            m_pLock:            TCriticalSection;
+            m_FrameCacheSize:   NativeUInt;
+            m_FrameCacheBudget: NativeUInt;
+
+            {$REGION 'Documentation'}
+            {**
+             Releases the oldest uncompressed frames until the frame cache fits in its budget
+             @br @bold(NOTE) The caller should own the lock
+            }
+            {$ENDREGION}
+            procedure TrimFrameCache;
+
+            {$REGION 'Documentation'}
+            {**
+             Populates the frame bounding boxes
+             @br @bold(NOTE) The boxes are calculated once while the model is loaded, from the
+                             compressed frame vertices, so they are available without uncompressing
+                             the frames. The box of a frame encloses all the md3 meshes composing it
+            }
+            {$ENDREGION}
+            procedure PopulateFrameBoxes;
 
         protected
             {$REGION 'Documentation'}
             {**
              Prepares mesh to be used by mesh generator
+             @br @bold(NOTE) Only the texture coordinates are prepared here, the frame vertices and
+                             normals are uncompressed on first access, see GetMeshFrame
             }
             {$ENDREGION}
             procedure PrepareMesh; virtual;
 
             {$REGION 'Documentation'}
             {**
-             Adds vertex to vertex buffer
-             @param(index Mesh index to get)
-             @param(indice Vertex indice as read from md3 file)
-             @param(vertexFormat Vertex format to apply)
-             @param(vertices Vertices list read from md3 file)
-             @param(normals Normals list read from md3 file)
-             @param(texCoords Texture coordinate list read from md3 file)
-             @param(color Vertex color to apply)
-             @param(vertex Vertex containing buffer to add to)
+             Gets a mesh frame, uncompresses it if not already done
+             @param(meshIndex Index of the md3 mesh to get)
+             @param(frameIndex Index of the animation frame to get)
+             @param(frame @bold([out]) Mesh frame)
+             @return(@true on success, otherwise @false)
+             @br @bold(NOTE) The uncompressed frames are kept in a cache, whose size is limited by
+                             the FrameCacheBudget property
+            }
+            {$ENDREGION}
+            function GetMeshFrame(meshIndex, frameIndex: NativeUInt;
+                                              out frame: TQRMD3MeshFrame): Boolean; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Gets the frame cache budget
+             @return(The frame cache budget, in bytes, 0 if unlimited)
             }
             {$ENDREGION}
-            procedure AddVertex(index, indice: NativeInt;
-                                 vertexFormat: TQRVertexFormat;
-                               const vertices: TQRMD3Vertices;
-                                const normals: TQRMD3Normals;
-                              const texCoords: TQRMD3TexCoords;
-                                 const pColor: TQRColor;
-                                   var vertex: TQRVertex); overload; virtual;
+            function GetFrameCacheBudget: NativeUInt; virtual;
 
             {$REGION 'Documentation'}
             {**
-             Adds vertex to vertex buffer, interpolate current and next vertex
-             @param(index Mesh index to get)
-             @param(nextIndex Next mesh index to interpolate with)
-             @param(indice Vertex indice as read from md3 file)
+             Sets the frame cache budget
+             @param(value The frame cache budget, in bytes, 0 if unlimited)
+            }
+            {$ENDREGION}
+            procedure SetFrameCacheBudget(value: NativeUInt); virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Populates a mesh vertex buffer from the mesh faces
+             @param(meshIndex Index of the md3 mesh to read)
+             @param(srcFrame Mesh frame from which the vertices are extracted)
+             @param(intFrame Mesh frame to interpolate with)
              @param(interpolationFactor Interpolation factor to apply)
-             @param(vertexFormat Vertex format to apply)
-             @param(vertices Vertices list read from md3 file)
-             @param(normals Normals list read from md3 file)
-             @param(texCoords Texture coordinate list read from md3 file)
-             @param(color Vertex color to apply)
-             @param(vertex Vertex containing buffer to add to)
+             @param(stride Vertex buffer stride)
+             @param(buffer @bold([in, out]) Vertex buffer to populate, should already contain 3
+                                            vertices per face)
+             @return(@true on success, otherwise @false)
+             @br @bold(NOTE) The vertex format is resolved once per call, and each vertex attribute
+                             is written by its own loop, so the per-vertex code never tests it
+             @br @bold(NOTE) To get a frame without interpolation, pass the same frame twice, in
+                             which case the frame is returned unchanged
             }
             {$ENDREGION}
-            procedure AddVertex(index, nextIndex, indice: NativeInt;
-                                     interpolationFactor: Single;
-                                            vertexFormat: TQRVertexFormat;
-                                          const vertices: TQRMD3Vertices;
-                                           const normals: TQRMD3Normals;
-                                         const texCoords: TQRMD3TexCoords;
-                                            const pColor: TQRColor;
-                                              var vertex: TQRVertex); overload; virtual;
+            function PopulateVertexBuffer(meshIndex: NativeUInt;
+                           const srcFrame, intFrame: TQRMD3MeshFrame;
+                                interpolationFactor: Single;
+                                             stride: NativeInt;
+                                         var buffer: TQRVertexBuffer): Boolean; virtual;
 
             {$REGION 'Documentation'}
             {**
@@ -815,6 +859,8 @@ type
              @param(latitude Normal latitude as written if md3 file)
              @param(longitude Normal longitude as written if md3 file)
              @return(Uncompressed normal)
+             @br @bold(NOTE) The normal is read in a pre-calculated sine table, no trigonometric
+                             function is evaluated
             }
             {$ENDREGION}
             function UncompressNormal(latitude, longitude: Byte): TQRVector3D; virtual;
@@ -918,6 +964,16 @@ type
             {$ENDREGION}
             function GetMeshCount: NativeUInt; override;
 
+            {$REGION 'Documentation'}
+            {**
+             Gets the aligned-axis bounding box enclosing a frame, without generating its mesh
+             @param(index Frame index)
+             @param(box @bold([out]) Frame bounding box)
+             @return(@true on success, otherwise @false)
+            }
+            {$ENDREGION}
+            function GetFrameBox(index: NativeUInt; out box: TQRBox): Boolean; override;
+
         // Properties
         public
             {$REGION 'Documentation'}
@@ -926,6 +982,16 @@ type
             }
             {$ENDREGION}
             property Parser: TQRMD3Parser read GetParser;
+
+            {$REGION 'Documentation'}
+            {**
+             Gets or sets the maximum memory, in bytes, the uncompressed frames may use, 0 (the
+             default) means unlimited
+             @br @bold(NOTE) The frames are uncompressed on first access, when the budget is
+                             exceeded the oldest uncompressed frames are released first
+            }
+            {$ENDREGION}
+            property FrameCacheBudget: NativeUInt read GetFrameCacheBudget write SetFrameCacheBudget;
     end;
 
 implementation
@@ -1287,79 +1353,141 @@ constructor TQRMD3Model.Create;
 begin
     inherited Create;
 
-    m_pParser    := TQRMD3Parser.Create;
-    m_pVertices  := TQRMD3VerticesDictionary.Create;
-    m_pNormals   := TQRMD3NormalDictionary.Create;
-    m_pTexCoords := TQRMD3TextureDictionary.Create;
+    m_pParser          := TQRMD3Parser.Create;
+    m_pTexCoords       := TQRMD3TextureDictionary.Create;
+    m_pFrames          := TQRMD3MeshFrameDictionary.Create;
+    m_pFrameQueue      := TQRMD3MeshFrameQueue.Create;
+    m_pLock            := TCriticalSection.Create;
+    m_FrameCacheSize   := 0;
+    m_FrameCacheBudget := 0;
 end;
 //--------------------------------------------------------------------------------------------------
 destructor TQRMD3Model.Destroy;
 begin
     // clear memory
     m_pParser.Free;
-    m_pVertices.Free;
-    m_pNormals.Free;
     m_pTexCoords.Free;
+    m_pFrames.Free;
+    m_pFrameQueue.Free;
+    m_pLock.Free;
+    SetLength(m_FrameBoxes, 0);
 
     inherited Destroy;
 end;
 //--------------------------------------------------------------------------------------------------
-procedure TQRMD3Model.PrepareMesh;
+procedure TQRMD3Model.PopulateFrameBoxes;
 var
-    vertexCount, texCoordCount, i, j: NativeUInt;
-    vertices:                         TQRMD3Vertices;
-    normals:                          TQRMD3Normals;
-    texCoords:                        TQRMD3TexCoords;
+    frameCount, meshCount, vertexCount, offset, i, j, l: NativeUInt;
+    k:                                                   Byte;
+    value:                                               TQRInt16;
+    minVertex, maxVertex:                                array[0..2] of TQRInt16;
+    empty:                                               Boolean;
 begin
-    m_pVertices.Clear;
-    m_pNormals.Clear;
-    m_pTexCoords.Clear;
+    // clear the previous boxes
+    SetLength(m_FrameBoxes, 0);
 
-    // no meshes to get?
-    if (m_pParser.m_Header.m_MeshCount = 0) then
+    frameCount := m_pParser.m_Header.m_FrameCount;
+    meshCount  := Length(m_pParser.m_Meshes);
+
+    // no frame or no mesh?
+    if ((frameCount = 0) or (meshCount = 0)) then
         Exit;
 
-    // iterate through meshes to get
-    for i := 0 to m_pParser.m_Header.m_MeshCount - 1 do
+    SetLength(m_FrameBoxes, frameCount);
+
+    // iterate through frames
+    for i := 0 to frameCount - 1 do
     begin
-        // get mesh vertex count
-        vertexCount :=
-                m_pParser.m_Meshes[i].m_Info.m_VertexCount *
-                m_pParser.m_Meshes[i].m_Info.m_AnimationCount;
+        empty := True;
 
-        if (vertexCount = 0) then
-            continue;
+        // search for the compressed box edges of all the md3 meshes composing the frame,
+        // compressed values are all in the same range
+        for l := 0 to meshCount - 1 do
+        begin
+            // mesh has no such frame?
+            if (i >= m_pParser.m_Meshes[l].m_Info.m_AnimationCount) then
+                continue;
 
-        try
-            // reserve memory for temporary vertices to get from md3 file
-            SetLength(vertices, vertexCount);
+            vertexCount := m_pParser.m_Meshes[l].m_Info.m_VertexCount;
 
-            // reserve memory for temporary normals to get from md3 file
-            SetLength(normals, vertexCount);
+            // no vertex?
+            if (vertexCount = 0) then
+                continue;
 
-            // iterate through vertices to get
-            for j := 0 to vertexCount - 1 do
+            // get the frame offset in the mesh vertices read from md3 file
+            offset := i * vertexCount;
+
+            if (empty) then
             begin
-                // uncompress vertex and add it to temporary vertex list
-                vertices[j].X := m_pParser.m_Meshes[i].m_Vertices[j].m_Position[0] / CQR_MD3_XYZ_Scale;
-                vertices[j].Y := m_pParser.m_Meshes[i].m_Vertices[j].m_Position[1] / CQR_MD3_XYZ_Scale;
-                vertices[j].Z := m_pParser.m_Meshes[i].m_Vertices[j].m_Position[2] / CQR_MD3_XYZ_Scale;
-
-                // uncompress normal and add it to temporary normal list
-                normals[j] := UncompressNormal(m_pParser.m_Meshes[i].m_Vertices[j].m_Normal[0],
-                                               m_pParser.m_Meshes[i].m_Vertices[j].m_Normal[1]);
+                for k := 0 to 2 do
+                begin
+                    minVertex[k] := m_pParser.m_Meshes[l].m_Vertices[offset].m_Position[k];
+                    maxVertex[k] := minVertex[k];
+                end;
+
+                empty := False;
             end;
 
-            m_pVertices.Add(i, vertices);
-            m_pNormals.Add(i, normals);
-        finally
-            SetLength(vertices, 0);
-            SetLength(normals, 0);
+            for j := 0 to vertexCount - 1 do
+                for k := 0 to 2 do
+                begin
+                    value := m_pParser.m_Meshes[l].m_Vertices[offset + j].m_Position[k];
+
+                    if (value < minVertex[k]) then
+                        minVertex[k] := value;
+
+                    if (value > maxVertex[k]) then
+                        maxVertex[k] := value;
+                end;
         end;
 
+        // no vertex in frame?
+        if (empty) then
+            continue;
+
+        // uncompress the box edges
+        m_FrameBoxes[i].Min.Assign(TQRVector3D.Create(minVertex[0] / CQR_MD3_XYZ_Scale,
+                                                      minVertex[1] / CQR_MD3_XYZ_Scale,
+                                                      minVertex[2] / CQR_MD3_XYZ_Scale));
+        m_FrameBoxes[i].Max.Assign(TQRVector3D.Create(maxVertex[0] / CQR_MD3_XYZ_Scale,
+                                                      maxVertex[1] / CQR_MD3_XYZ_Scale,
+                                                      maxVertex[2] / CQR_MD3_XYZ_Scale));
+    end;
+end;
+//--------------------------------------------------------------------------------------------------
+procedure TQRMD3Model.PrepareMesh;
+var
+    texCoordCount, i, j: NativeUInt;
+    texCoords:           TQRMD3TexCoords;
+begin
+    m_pLock.Enter;
+
+    try
+        // release the frames uncompressed from the previous model
+        m_pFrames.Clear;
+        m_pFrameQueue.Clear;
+        m_FrameCacheSize := 0;
+    finally
+        m_pLock.Leave;
+    end;
+
+    m_pTexCoords.Clear;
+
+    // no meshes to get?
+    if (m_pParser.m_Header.m_MeshCount = 0) then
+        Exit;
+
+    // iterate through meshes to get. NOTE the frame vertices and normals aren't uncompressed here,
+    // but on first access, thus the frames that are never shown cost nothing
+    for i := 0 to m_pParser.m_Header.m_MeshCount - 1 do
+    begin
         // get texture coordinates count
         texCoordCount := m_pParser.m_Meshes[i].m_Info.m_VertexCount;
 
+        // no vertex?
+        if ((texCoordCount = 0) or (m_pParser.m_Meshes[i].m_Info.m_AnimationCount = 0)) then
+            continue;
+
         try
             // reserve memory for temporary texture coordinates to get from md3 file
             SetLength(texCoords, texCoordCount);
@@ -1379,188 +1507,314 @@ begin
     end;
 end;
 //--------------------------------------------------------------------------------------------------
-procedure TQRMD3Model.AddVertex(index, indice: NativeInt;
-                                 vertexFormat: TQRVertexFormat;
-                               const vertices: TQRMD3Vertices;
-                                const normals: TQRMD3Normals;
-                              const texCoords: TQRMD3TexCoords;
-                                 const pColor: TQRColor;
-                                   var vertex: TQRVertex);
+procedure TQRMD3Model.TrimFrameCache;
 var
-    frameIndex: NativeInt;
-    offset:     NativeUInt;
+    key:   UInt64;
+    frame: TQRMD3MeshFrame;
 begin
-    // calculate frame index
-    frameIndex := index + indice;
+    // no budget?
+    if (m_FrameCacheBudget = 0) then
+        Exit;
 
-    // is frame index out of bounds?
-    if (frameIndex >= Length(vertices)) then
-        raise Exception.Create('Vertice indice is out of bounds');
+    // release the oldest frames until the budget is respected. NOTE the last uncompressed frame is
+    // always kept, even if it exceeds the budget alone
+    while ((m_FrameCacheSize > m_FrameCacheBudget) and (m_pFrameQueue.Count > 1)) do
+    begin
+        key := m_pFrameQueue.Dequeue;
 
-    // get current vertex offset
-    offset := Length(vertex.m_Buffer);
+        if (not m_pFrames.TryGetValue(key, frame)) then
+            continue;
+
+        Dec(m_FrameCacheSize,
+            NativeUInt(Length(frame.m_Vertices) + Length(frame.m_Normals)) * SizeOf(TQRVector3D));
 
-    // add memory for vertex
-    SetLength(vertex.m_Buffer, offset + 3);
+        m_pFrames.Remove(key);
+    end;
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRMD3Model.GetMeshFrame(meshIndex, frameIndex: NativeUInt;
+                                              out frame: TQRMD3MeshFrame): Boolean;
+var
+    key:                    UInt64;
+    vertexCount, offset, j: NativeUInt;
+    cachedFrame:            TQRMD3MeshFrame;
+begin
+    // is mesh index out of bounds?
+    if (meshIndex >= m_pParser.m_Header.m_MeshCount) then
+        Exit(False);
 
-    // copy vertex
-    vertex.m_Buffer[offset]     := vertices[frameIndex].X;
-    vertex.m_Buffer[offset + 1] := vertices[frameIndex].Y;
-    vertex.m_Buffer[offset + 2] := vertices[frameIndex].Z;
+    // is frame index out of bounds?
+    if (frameIndex >= m_pParser.m_Meshes[meshIndex].m_Info.m_AnimationCount) then
+        Exit(False);
 
-    // increment offset
-    Inc(offset, 3);
+    vertexCount := m_pParser.m_Meshes[meshIndex].m_Info.m_VertexCount;
 
-    // do include normals?
-    if (EQR_VF_Normals in VertexFormat) then
-    begin
-        // is indice out of bounds?
-        if (frameIndex >= Length(normals)) then
-            raise Exception.Create('Vertice indice is out of bounds');
+    // no vertex?
+    if (vertexCount = 0) then
+        Exit(False);
 
-        // add memory for normal
-        SetLength(vertex.m_Buffer, offset + 3);
+    key := (UInt64(meshIndex) shl 32) or frameIndex;
 
-        // copy normal
-        vertex.m_Buffer[offset]     := normals[frameIndex].X;
-        vertex.m_Buffer[offset + 1] := normals[frameIndex].Y;
-        vertex.m_Buffer[offset + 2] := normals[frameIndex].Z;
+    m_pLock.Enter;
 
-        // increment offset
-        Inc(offset, 3);
+    try
+        // was frame already uncompressed?
+        if (m_pFrames.TryGetValue(key, frame)) then
+            Exit(True);
+    finally
+        m_pLock.Leave;
     end;
 
-    // do include texture coordinates?
-    if (EQR_VF_TexCoords in VertexFormat) then
-    begin
-        // is indice out of bounds?
-        if (indice >= Length(texCoords)) then
-            raise Exception.Create('Vertice indice is out of bounds');
-
-        // add memory for texture coordinates
-        SetLength(vertex.m_Buffer, offset + 2);
+    // reserve memory for the frame vertices and normals
+    SetLength(frame.m_Vertices, vertexCount);
+    SetLength(frame.m_Normals,  vertexCount);
 
-        vertex.m_Buffer[offset]     := texCoords[indice].U;
-        vertex.m_Buffer[offset + 1] := texCoords[indice].V;
+    // get the frame offset in the mesh vertices read from md3 file
+    offset := frameIndex * vertexCount;
 
-        // increment offset
-        Inc(offset, 2);
+    // iterate through frame vertices to get
+    for j := 0 to vertexCount - 1 do
+    begin
+        // uncompress vertex
+        frame.m_Vertices[j].X :=
+                m_pParser.m_Meshes[meshIndex].m_Vertices[offset + j].m_Position[0] / CQR_MD3_XYZ_Scale;
+        frame.m_Vertices[j].Y :=
+                m_pParser.m_Meshes[meshIndex].m_Vertices[offset + j].m_Position[1] / CQR_MD3_XYZ_Scale;
+        frame.m_Vertices[j].Z :=
+                m_pParser.m_Meshes[meshIndex].m_Vertices[offset + j].m_Position[2] / CQR_MD3_XYZ_Scale;
+
+        // uncompress normal
+        frame.m_Normals[j] :=
+                UncompressNormal(m_pParser.m_Meshes[meshIndex].m_Vertices[offset + j].m_Normal[0],
+                                 m_pParser.m_Meshes[meshIndex].m_Vertices[offset + j].m_Normal[1]);
     end;
 
-    // do include colors?
-    if (EQR_VF_Colors in VertexFormat) then
-    begin
-        // add memory for texture coordinates
-        SetLength(vertex.m_Buffer, offset + 4);
+    m_pLock.Enter;
+
+    try
+        // was the same frame uncompressed meanwhile by another thread? Use the cached one
+        if (m_pFrames.TryGetValue(key, cachedFrame)) then
+        begin
+            frame := cachedFrame;
+            Exit(True);
+        end;
 
-        vertex.m_Buffer[offset]     := color.GetRedF;
-        vertex.m_Buffer[offset + 1] := color.GetGreenF;
-        vertex.m_Buffer[offset + 2] := color.GetBlueF;
-        vertex.m_Buffer[offset + 3] := color.GetAlphaF;
+        // add the frame to the cache
+        m_pFrames.Add(key, frame);
+        m_pFrameQueue.Enqueue(key);
+        Inc(m_FrameCacheSize, (vertexCount * 2) * SizeOf(TQRVector3D));
+
+        // release the oldest frames if the budget is exceeded
+        TrimFrameCache;
+    finally
+        m_pLock.Leave;
     end;
+
+    Result := True;
 end;
 //--------------------------------------------------------------------------------------------------
-procedure TQRMD3Model.AddVertex(index, nextIndex, indice: NativeInt;
-                                     interpolationFactor: Single;
-                                            vertexFormat: TQRVertexFormat;
-                                          const vertices: TQRMD3Vertices;
-                                           const normals: TQRMD3Normals;
-                                         const texCoords: TQRMD3TexCoords;
-                                            const pColor: TQRColor;
-                                              var vertex: TQRVertex);
+function TQRMD3Model.PopulateVertexBuffer(meshIndex: NativeUInt;
+                           const srcFrame, intFrame: TQRMD3MeshFrame;
+                                interpolationFactor: Single;
+                                             stride: NativeInt;
+                                         var buffer: TQRVertexBuffer): Boolean;
 var
-    frameIndex, nextFrameIndex: NativeInt;
-    offset:                     NativeUInt;
-    finalVertex:                TQRVector3D;
-    finalNormal:                TQRVector3D;
+    texCoords:                         TQRMD3TexCoords;
+    faceCount, vertexCount, j, indice: NativeUInt;
+    k:                                 Byte;
+    offset, attribOffset:              NativeInt;
+    factor, r, g, b, a:                Single;
+    vertex, intVertex:                 TQRVector3D;
 begin
-    // calculate frame indexes
-    frameIndex     := index     + indice;
-    nextFrameIndex := nextIndex + indice;
+    faceCount := m_pParser.m_Meshes[meshIndex].m_Info.m_FaceCount;
 
-    // is frame index out of bounds?
-    if ((frameIndex >= Length(vertices)) or (nextFrameIndex >= Length(vertices))) then
-        raise Exception.Create('Vertice indice is out of bounds');
+    // nothing to populate?
+    if (faceCount = 0) then
+        Exit(True);
 
-    // get current vertex offset
-    offset := Length(vertex.m_Buffer);
+    // is buffer too small? NOTE each face contains 3 vertices
+    if (NativeUInt(Length(buffer)) < (faceCount * 3 * NativeUInt(stride))) then
+        Exit(False);
+
+    vertexCount := Length(srcFrame.m_Vertices);
+
+    // are frames incomplete?
+    if ((NativeUInt(Length(srcFrame.m_Normals)) <> vertexCount) or
+        (NativeUInt(Length(intFrame.m_Vertices)) <> vertexCount) or
+        (NativeUInt(Length(intFrame.m_Normals)) <> vertexCount))
+    then
+        Exit(False);
+
+    // is interpolation factor out of bounds? Limit to min or max values in this case
+    if (interpolationFactor < 0.0) then
+        factor := 0.0
+    else
+    if (interpolationFactor > 1.0) then
+        factor := 1.0
+    else
+        factor := interpolationFactor;
+
+    offset := 0;
 
-    // add memory for vertex
-    SetLength(vertex.m_Buffer, offset + 3);
+    // populate the vertex positions
+    for j := 0 to faceCount - 1 do
+        for k := 0 to 2 do
+        begin
+            indice := m_pParser.m_Meshes[meshIndex].m_Faces[j].m_Indices[k];
 
-    // calculate final mesh vertex
-    finalVertex := vertices[frameIndex].Interpolate(vertices[nextFrameIndex], interpolationFactor);
+            // is indice out of bounds?
+            if (indice >= vertexCount) then
+                Exit(False);
 
-    // copy vertex
-    vertex.m_Buffer[offset]     := finalVertex.X;
-    vertex.m_Buffer[offset + 1] := finalVertex.Y;
-    vertex.m_Buffer[offset + 2] := finalVertex.Z;
+            vertex    := srcFrame.m_Vertices[indice];
+            intVertex := intFrame.m_Vertices[indice];
 
-    // increment offset
-    Inc(offset, 3);
+            buffer[offset]     := vertex.X + ((intVertex.X - vertex.X) * factor);
+            buffer[offset + 1] := vertex.Y + ((intVertex.Y - vertex.Y) * factor);
+            buffer[offset + 2] := vertex.Z + ((intVertex.Z - vertex.Z) * factor);
+
+            Inc(offset, stride);
+        end;
+
+    attribOffset := 3;
 
     // do include normals?
     if (EQR_VF_Normals in VertexFormat) then
     begin
-        // is indice out of bounds?
-        if ((frameIndex >= Length(normals))  or (nextFrameIndex >= Length(normals))) then
-            raise Exception.Create('Vertice indice is out of bounds');
+        offset := attribOffset;
 
-        // add memory for normal
-        SetLength(vertex.m_Buffer, offset + 3);
+        // populate the vertex normals. NOTE the indices were already checked against the vertices
+        for j := 0 to faceCount - 1 do
+            for k := 0 to 2 do
+            begin
+                indice    := m_pParser.m_Meshes[meshIndex].m_Faces[j].m_Indices[k];
+                vertex    := srcFrame.m_Normals[indice];
+                intVertex := intFrame.m_Normals[indice];
 
-        // calculate final mesh normal
-        finalNormal := normals[frameIndex].Interpolate(normals[nextFrameIndex], interpolationFactor);
+                buffer[offset]     := vertex.X + ((intVertex.X - vertex.X) * factor);
+                buffer[offset + 1] := vertex.Y + ((intVertex.Y - vertex.Y) * factor);
+                buffer[offset + 2] := vertex.Z + ((intVertex.Z - vertex.Z) * factor);
 
-        // copy normal
-        vertex.m_Buffer[offset]     := finalNormal.X;
-        vertex.m_Buffer[offset + 1] := finalNormal.Y;
-        vertex.m_Buffer[offset + 2] := finalNormal.Z;
+                Inc(offset, stride);
+            end;
 
-        // increment offset
-        Inc(offset, 3);
+        Inc(attribOffset, 3);
     end;
 
     // do include texture coordinates?
     if (EQR_VF_TexCoords in VertexFormat) then
     begin
-        // is indice out of bounds?
-        if (indice >= Length(texCoords)) then
-            raise Exception.Create('Vertice indice is out of bounds');
+        // get the mesh texture coordinates, prepared while the model was loaded
+        if (not m_pTexCoords.TryGetValue(meshIndex, texCoords)) then
+            Exit(False);
+
+        offset := attribOffset;
+
+        // populate the vertex texture coordinates
+        for j := 0 to faceCount - 1 do
+            for k := 0 to 2 do
+            begin
+                indice := m_pParser.m_Meshes[meshIndex].m_Faces[j].m_Indices[k];
 
-        // add memory for texture coordinates
-        SetLength(vertex.m_Buffer, offset + 2);
+                // is indice out of bounds?
+                if (indice >= NativeUInt(Length(texCoords))) then
+                    Exit(False);
 
-        vertex.m_Buffer[offset]     := texCoords[indice].U;
-        vertex.m_Buffer[offset + 1] := texCoords[indice].V;
+                buffer[offset]     := texCoords[indice].U;
+                buffer[offset + 1] := texCoords[indice].V;
 
-        // increment offset
-        Inc(offset, 2);
+                Inc(offset, stride);
+            end;
+
+        Inc(attribOffset, 2);
     end;
 
     // do include colors?
     if (EQR_VF_Colors in VertexFormat) then
     begin
-        vertex.m_Buffer[offset]     := color.GetRedF;
-        vertex.m_Buffer[offset + 1] := color.GetGreenF;
-        vertex.m_Buffer[offset + 2] := color.GetBlueF;
-        vertex.m_Buffer[offset + 3] := color.GetAlphaF;
+        offset := attribOffset;
+        r      := Color.GetRedF;
+        g      := Color.GetGreenF;
+        b      := Color.GetBlueF;
+        a      := Color.GetAlphaF;
+
+        // populate the vertex colors, all the vertices use the material color
+        for j := 0 to (faceCount * 3) - 1 do
+        begin
+            buffer[offset]     := r;
+            buffer[offset + 1] := g;
+            buffer[offset + 2] := b;
+            buffer[offset + 3] := a;
+
+            Inc(offset, stride);
+        end;
     end;
+
+    Result := True;
 end;
 //--------------------------------------------------------------------------------------------------
 function TQRMD3Model.UncompressNormal(latitude, longitude: Byte): TQRVector3D;
+const
+    {**
+     Sine of the 256 angles a md3 latitude or longitude can take, i.e. Sin(i * (PI / 128.0)). The
+     cosine is read in the same table, a quarter turn (64 entries) later
+    }
+    sinTable: array[0..255] of Single =
+    (
+         0.00000000,  0.02454123,  0.04906767,  0.07356456,  0.09801714,  0.12241068,
+         0.14673047,  0.17096189,  0.19509032,  0.21910124,  0.24298018,  0.26671276,
+         0.29028468,  0.31368174,  0.33688985,  0.35989504,  0.38268343,  0.40524131,
+         0.42755509,  0.44961133,  0.47139674,  0.49289819,  0.51410274,  0.53499762,
+         0.55557023,  0.57580819,  0.59569930,  0.61523159,  0.63439328,  0.65317284,
+         0.67155895,  0.68954054,  0.70710678,  0.72424708,  0.74095113,  0.75720885,
+         0.77301045,  0.78834643,  0.80320753,  0.81758481,  0.83146961,  0.84485357,
+         0.85772861,  0.87008699,  0.88192126,  0.89322430,  0.90398929,  0.91420976,
+         0.92387953,  0.93299280,  0.94154407,  0.94952818,  0.95694034,  0.96377607,
+         0.97003125,  0.97570213,  0.98078528,  0.98527764,  0.98917651,  0.99247953,
+         0.99518473,  0.99729046,  0.99879546,  0.99969882,  1.00000000,  0.99969882,
+         0.99879546,  0.99729046,  0.99518473,  0.99247953,  0.98917651,  0.98527764,
+         0.98078528,  0.97570213,  0.97003125,  0.96377607,  0.95694034,  0.94952818,
+         0.94154407,  0.93299280,  0.92387953,  0.91420976,  0.90398929,  0.89322430,
+         0.88192126,  0.87008699,  0.85772861,  0.84485357,  0.83146961,  0.81758481,
+         0.80320753,  0.78834643,  0.77301045,  0.75720885,  0.74095113,  0.72424708,
+         0.70710678,  0.68954054,  0.67155895,  0.65317284,  0.63439328,  0.61523159,
+         0.59569930,  0.57580819,  0.55557023,  0.53499762,  0.51410274,  0.49289819,
+         0.47139674,  0.44961133,  0.42755509,  0.40524131,  0.38268343,  0.35989504,
+         0.33688985,  0.31368174,  0.29028468,  0.26671276,  0.24298018,  0.21910124,
+         0.19509032,  0.17096189,  0.14673047,  0.12241068,  0.09801714,  0.07356456,
+         0.04906767,  0.02454123,  0.00000000, -0.02454123, -0.04906767, -0.07356456,
+        -0.09801714, -0.12241068, -0.14673047, -0.17096189, -0.19509032, -0.21910124,
+        -0.24298018, -0.26671276, -0.29028468, -0.31368174, -0.33688985, -0.35989504,
+        -0.38268343, -0.40524131, -0.42755509, -0.44961133, -0.47139674, -0.49289819,
+        -0.51410274, -0.53499762, -0.55557023, -0.57580819, -0.59569930, -0.61523159,
+        -0.63439328, -0.65317284, -0.67155895, -0.68954054, -0.70710678, -0.72424708,
+        -0.74095113, -0.75720885, -0.77301045, -0.78834643, -0.80320753, -0.81758481,
+        -0.83146961, -0.84485357, -0.85772861, -0.87008699, -0.88192126, -0.89322430,
+        -0.90398929, -0.91420976, -0.92387953, -0.93299280, -0.94154407, -0.94952818,
+        -0.95694034, -0.96377607, -0.97003125, -0.97570213, -0.98078528, -0.98527764,
+        -0.98917651, -0.99247953, -0.99518473, -0.99729046, -0.99879546, -0.99969882,
+        -1.00000000, -0.99969882, -0.99879546, -0.99729046, -0.99518473, -0.99247953,
+        -0.98917651, -0.98527764, -0.98078528, -0.97570213, -0.97003125, -0.96377607,
+        -0.95694034, -0.94952818, -0.94154407, -0.93299280, -0.92387953, -0.91420976,
+        -0.90398929, -0.89322430, -0.88192126, -0.87008699, -0.85772861, -0.84485357,
+        -0.83146961, -0.81758481, -0.80320753, -0.78834643, -0.77301045, -0.75720885,
+        -0.74095113, -0.72424708, -0.70710678, -0.68954054, -0.67155895, -0.65317284,
+        -0.63439328, -0.61523159, -0.59569930, -0.57580819, -0.55557023, -0.53499762,
+        -0.51410274, -0.49289819, -0.47139674, -0.44961133, -0.42755509, -0.40524131,
+        -0.38268343, -0.35989504, -0.33688985, -0.31368174, -0.29028468, -0.26671276,
+        -0.24298018, -0.21910124, -0.19509032, -0.17096189, -0.14673047, -0.12241068,
+        -0.09801714, -0.07356456, -0.04906767, -0.02454123
+    );
 var
-    ratio, lng, lat: Single;
+    sinLng: Single;
 begin
-    // calculate uncompression ratio
-    ratio := (PI / 128.0);
-
-    // apply ratio to latitude and longitude
-    lat := latitude  * ratio;
-    lng := longitude * ratio;
+    sinLng := sinTable[longitude];
 
-    // calculate and return normal
-    Result := TQRVector3D.Create(Cos(lat) * Sin(lng), Sin(lat) * Sin(lng), Cos(lng));
+    // read the normal in the pre-calculated table, the normal is
+    // Cos(lat) * Sin(lng), Sin(lat) * Sin(lng), Cos(lng)
+    Result := TQRVector3D.Create(sinTable[(latitude + 64) and $FF] * sinLng,
+                                 sinTable[latitude] * sinLng,
+                                 sinTable[(longitude + 64) and $FF]);
 end;
 //--------------------------------------------------------------------------------------------------
 function TQRMD3Model.GetParser: TQRMD3Parser;
@@ -1568,12 +1822,34 @@ begin
     Result := m_pParser;
 end;
 //--------------------------------------------------------------------------------------------------
+function TQRMD3Model.GetFrameCacheBudget: NativeUInt;
+begin
+    Result := m_FrameCacheBudget;
+end;
+//--------------------------------------------------------------------------------------------------
+procedure TQRMD3Model.SetFrameCacheBudget(value: NativeUInt);
+begin
+    m_pLock.Enter;
+
+    try
+        m_FrameCacheBudget := value;
+
+        // release the frames exceeding the new budget
+        TrimFrameCache;
+    finally
+        m_pLock.Leave;
+    end;
+end;
+//--------------------------------------------------------------------------------------------------
 function TQRMD3Model.Load(const fileName: TFileName): Boolean;
 begin
     Result := m_pParser.Load(fileName);
 
     if (Result) then
+    begin
         PrepareMesh;
+        PopulateFrameBoxes;
+    end;
 end;
 //--------------------------------------------------------------------------------------------------
 function TQRMD3Model.Load(const pBuffer: TStream; readLength: NativeUInt): Boolean;
@@ -1581,7 +1857,10 @@ begin
     Result := m_pParser.Load(pBuffer, readLength);
 
     if (Result) then
+    begin
         PrepareMesh;
+        PopulateFrameBoxes;
+    end;
 end;
 //--------------------------------------------------------------------------------------------------
 function TQRMD3Model.GetMesh(index: NativeUInt;
@@ -1589,8 +1868,8 @@ function TQRMD3Model.GetMesh(index: NativeUInt;
                          pAABBTree: TQRAABBTree;
                        hIsCanceled: TQRIsCanceledEvent): Boolean;
 var
-    stride, meshIndex, i, j, indiceCount: NativeUInt;
-    k:                                    Byte;
+    stride, meshIndex, i, indiceCount: NativeUInt;
+    srcFrame:                          TQRMD3MeshFrame;
 begin
     // no mesh count?
     if (m_pParser.m_Header.m_MeshCount = 0) then
@@ -1622,20 +1901,8 @@ begin
         if (Assigned(hIsCanceled) and hIsCanceled) then
             Exit(False);
 
-        // check if cache contains vertices to get
-        if (not m_pVertices.ContainsKey(i)) then
-            Exit(False);
-
-        // no vertex?
-        if (Length(m_pVertices.Items[i]) = 0) then
-            Exit(False);
-
-        // check if cache contains normals to get
-        if (not m_pNormals.ContainsKey(i)) then
-            Exit(False);
-
-        // no normals?
-        if (Length(m_pNormals.Items[i]) = 0) then
+        // get the mesh frame, uncompressed on first access
+        if (not GetMeshFrame(i, index, srcFrame)) then
             Exit(False);
 
         // check if cache contains textures coordinates to get
@@ -1663,20 +1930,19 @@ begin
         if (indiceCount = 0) then
             Exit(False);
 
-        // add memory for vertex buffer
+        // allocate the whole vertex buffer once, each face contains 3 vertices
         SetLength(mesh[meshIndex].m_Buffer, indiceCount * 3 * mesh[meshIndex].m_Stride);
 
-        // iterate through vertex indices and create final vertex buffer
-        for j := 0 to indiceCount - 1 do
-            for k := 0 to 2 do
-                AddVertex((index * m_pParser.m_Meshes[i].m_Info.m_VertexCount),
-                          m_pParser.m_Meshes[i].m_Faces[j].m_Indices[k],
-                          VertexFormat,
-                          m_pVertices.Items[i],
-                          m_pNormals.Items[i],
-                          m_pTexCoords.Items[i],
-                          Color,
-                          mesh[meshIndex]);
+        // populate the vertex buffer. NOTE the frame is interpolated with itself, which returns it
+        // unchanged
+        if (not PopulateVertexBuffer(i,
+                                     srcFrame,
+                                     srcFrame,
+                                     0.0,
+                                     stride,
+                                     mesh[meshIndex].m_Buffer))
+        then
+            Exit(False);
     end;
 
     // populate aligned-axis bounding box tree
@@ -1688,15 +1954,15 @@ function TQRMD3Model.GetMesh(index, nextIndex: NativeUInt;
                          out mesh: TQRMesh;
                       hIsCanceled: TQRIsCanceledEvent): Boolean;
 var
-    stride, meshIndex, i, j, indiceCount: NativeUInt;
-    k:                                    Byte;
+    stride, meshIndex, i, indiceCount: NativeUInt;
+    srcFrame, intFrame:                TQRMD3MeshFrame;
 begin
     // no mesh count?
     if (m_pParser.m_Header.m_MeshCount = 0) then
         Exit(False);
 
     // is frame index out of bounds?
-    if (index >= GetMeshCount) then
+    if ((index >= GetMeshCount) or (nextIndex >= GetMeshCount)) then
         Exit(False);
 
     // basically stride is the coordinates values size
@@ -1721,20 +1987,8 @@ begin
         if (Assigned(hIsCanceled) and hIsCanceled) then
             Exit(False);
 
-        // check if cache contains vertices to get
-        if (not m_pVertices.ContainsKey(i)) then
-            Exit(False);
-
-        // no vertex?
-        if (Length(m_pVertices.Items[i]) = 0) then
-            Exit(False);
-
-        // check if cache contains normals to get
-        if (not m_pNormals.ContainsKey(i)) then
-            Exit(False);
-
-        // no normals?
-        if (Length(m_pNormals.Items[i]) = 0) then
+        // get the mesh frame, and frame to interpolate with, uncompressed on first access
+        if ((not GetMeshFrame(i, index, srcFrame)) or (not GetMeshFrame(i, nextIndex, intFrame))) then
             Exit(False);
 
         // check if cache contains textures coordinates to get
@@ -1762,22 +2016,18 @@ begin
         if (indiceCount = 0) then
             Exit(False);
 
-        // add memory for vertex buffer
+        // allocate the whole vertex buffer once, each face contains 3 vertices
         SetLength(mesh[meshIndex].m_Buffer, indiceCount * 3 * mesh[meshIndex].m_Stride);
 
-        // iterate through vertex indices and create final vertex buffer
-        for j := 0 to indiceCount - 1 do
-            for k := 0 to 2 do
-                AddVertex((index     * m_pParser.m_Meshes[i].m_Info.m_VertexCount),
-                          (nextIndex * m_pParser.m_Meshes[i].m_Info.m_VertexCount),
-                          m_pParser.m_Meshes[i].m_Faces[j].m_Indices[k],
-                          interpolationFactor,
-                          VertexFormat,
-                          m_pVertices.Items[i],
-                          m_pNormals.Items[i],
-                          m_pTexCoords.Items[i],
-                          Color,
-                          mesh[meshIndex]);
+        // populate the vertex buffer
+        if (not PopulateVertexBuffer(i,
+                                     srcFrame,
+                                     intFrame,
+                                     interpolationFactor,
+                                     stride,
+                                     mesh[meshIndex].m_Buffer))
+        then
+            Exit(False);
     end;
 
     Result := True;
@@ -1788,5 +2038,15 @@ begin
     Result := m_pParser.m_Header.m_FrameCount;
 end;
 //--------------------------------------------------------------------------------------------------
+function TQRMD3Model.GetFrameBox(index: NativeUInt; out box: TQRBox): Boolean;
+begin
+    // is frame index out of bounds?
+    if (index >= NativeUInt(Length(m_FrameBoxes))) then
+        Exit(False);
+
+    box    := m_FrameBoxes[index];
+    Result := True;
+end;
+//--------------------------------------------------------------------------------------------------
 
 end.
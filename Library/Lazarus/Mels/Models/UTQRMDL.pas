@@ -616,6 +616,7 @@ type
         private
             m_pParser:             TQRMDLParser;
             m_Normals:             TQRMDLNormals;
+            m_FrameBoxes:          TQRFrameBoxes;
             m_RHToLH:              Boolean;
             m_pPreCalculatedLight: TQRDirectionalLight;
 
@@ -626,6 +627,16 @@ type
             {$ENDREGION}
             procedure PopulateNormals;
 
+            {$REGION 'Documentation'}
+            {**
+             Populates the frame bounding boxes
+             @br @bold(NOTE) The boxes are calculated once while the model is loaded, from the
+                             compressed frame vertices, so they are available without generating
+                             the frame meshes. The box of a frame group encloses all its frames
+            }
+            {$ENDREGION}
+            procedure PopulateFrameBoxes;
+
         protected
             {$REGION 'Documentation'}
             {**
@@ -638,6 +649,28 @@ type
             function UncompressVertex(const header: TQRMDLHeader;
                                       const vertex: TQRMDLVertex): TQRVector3D; virtual;
 
+            {$REGION 'Documentation'}
+            {**
+             Populates a vertex buffer from the model polygons
+             @param(srcFrame Frame from which the vertices are extracted)
+             @param(intFrame Frame to interpolate with)
+             @param(interpolationFactor Interpolation factor to apply)
+             @param(stride Vertex buffer stride)
+             @param(buffer @bold([in, out]) Vertex buffer to populate, should already contain 3
+                                            vertices per polygon)
+             @return(@true on success, otherwise @false)
+             @br @bold(NOTE) The vertex format, the coordinate system conversion and the light mode
+                             are resolved once per call, and each vertex attribute is written by its
+                             own loop, so the per-vertex code never tests them
+             @br @bold(NOTE) To get a frame without interpolation, pass the same frame as source
+                             and as frame to interpolate with, in which case it's returned unchanged
+            }
+            {$ENDREGION}
+            function PopulateVertexBuffer(const srcFrame, intFrame: TQRMDLFrame;
+                                             interpolationFactor: Single;
+                                                          stride: NativeInt;
+                                                      var buffer: TQRVertexBuffer): Boolean; virtual;
+
             {$REGION 'Documentation'}
             {**
              Gets pre-calculated light
@@ -769,6 +802,16 @@ type
             {$ENDREGION}
             function GetMeshCount: NativeUInt; override;
 
+            {$REGION 'Documentation'}
+            {**
+             Gets the aligned-axis bounding box enclosing a frame, without generating its mesh
+             @param(index Frame index)
+             @param(box @bold([out]) Frame bounding box)
+             @return(@true on success, otherwise @false)
+            }
+            {$ENDREGION}
+            function GetFrameBox(index: NativeUInt; out box: TQRBox): Boolean; override;
+
         // Properties
         public
             {$REGION 'Documentation'}
@@ -1191,6 +1234,7 @@ destructor TQRMDLModel.Destroy;
 begin
     // clear memory
     SetLength(m_Normals, 0);
+    SetLength(m_FrameBoxes, 0);
     m_pPreCalculatedLight.Free;
     m_pParser.Free;
 
@@ -1394,6 +1438,98 @@ begin
     end;
 end;
 //--------------------------------------------------------------------------------------------------
+procedure TQRMDLModel.PopulateFrameBoxes;
+var
+    groupCount, frameCount, vertexCount, i, j, l: NativeUInt;
+    k:                                            Byte;
+    value:                                        TQRUInt8;
+    minVertex, maxVertex:                         array[0..2] of TQRUInt8;
+    minEdge, maxEdge:                             array[0..2] of Single;
+    edge:                                         Single;
+    empty:                                        Boolean;
+begin
+    // clear the previous boxes
+    SetLength(m_FrameBoxes, 0);
+
+    groupCount := Length(m_pParser.m_Frames);
+
+    // no frame?
+    if (groupCount = 0) then
+        Exit;
+
+    SetLength(m_FrameBoxes, groupCount);
+
+    // iterate through frame groups
+    for i := 0 to groupCount - 1 do
+    begin
+        frameCount := Length(m_pParser.m_Frames[i].m_Frames);
+
+        // no frame in group?
+        if (frameCount = 0) then
+            continue;
+
+        empty := True;
+
+        // search for the compressed box edges of all the frames composing the group, compressed
+        // values are all in the same range
+        for l := 0 to frameCount - 1 do
+        begin
+            vertexCount := Length(m_pParser.m_Frames[i].m_Frames[l].m_Vertices);
+
+            // no vertex?
+            if (vertexCount = 0) then
+                continue;
+
+            if (empty) then
+            begin
+                for k := 0 to 2 do
+                begin
+                    minVertex[k] := m_pParser.m_Frames[i].m_Frames[l].m_Vertices[0].m_Vertex[k];
+                    maxVertex[k] := minVertex[k];
+                end;
+
+                empty := False;
+            end;
+
+            for j := 0 to vertexCount - 1 do
+                for k := 0 to 2 do
+                begin
+                    value := m_pParser.m_Frames[i].m_Frames[l].m_Vertices[j].m_Vertex[k];
+
+                    if (value < minVertex[k]) then
+                        minVertex[k] := value;
+
+                    if (value > maxVertex[k]) then
+                        maxVertex[k] := value;
+                end;
+        end;
+
+        // no vertex in group?
+        if (empty) then
+            continue;
+
+        // uncompress the box edges using header scale and translate values
+        for k := 0 to 2 do
+        begin
+            minEdge[k] := (m_pParser.m_Header.m_Scale[k] * minVertex[k]) +
+                    m_pParser.m_Header.m_Translate[k];
+            maxEdge[k] := (m_pParser.m_Header.m_Scale[k] * maxVertex[k]) +
+                    m_pParser.m_Header.m_Translate[k];
+
+            // a negative scale swaps the edges
+            if (minEdge[k] > maxEdge[k]) then
+            begin
+                edge       := minEdge[k];
+                minEdge[k] := maxEdge[k];
+                maxEdge[k] := edge;
+            end;
+        end;
+
+        m_FrameBoxes[i].Min.Assign(TQRVector3D.Create(minEdge[0], minEdge[1], minEdge[2]));
+        m_FrameBoxes[i].Max.Assign(TQRVector3D.Create(maxEdge[0], maxEdge[1], maxEdge[2]));
+    end;
+end;
+//--------------------------------------------------------------------------------------------------
 function TQRMDLModel.UncompressVertex(const header: TQRMDLHeader;
                                       const vertex: TQRMDLVertex): TQRVector3D;
 var
@@ -1408,6 +1544,221 @@ begin
     Result := TQRVector3D.Create(vertArray[0], vertArray[1], vertArray[2]);
 end;
 //--------------------------------------------------------------------------------------------------
+function TQRMDLModel.PopulateVertexBuffer(const srcFrame, intFrame: TQRMDLFrame;
+                                             interpolationFactor: Single;
+                                                          stride: NativeInt;
+                                                      var buffer: TQRVertexBuffer): Boolean;
+var
+    polygonCount, normalCount, j, offset, attribOffset: NativeInt;
+    k:                                                  TQRUInt8;
+    vertexIndex:                                        TQRUInt32;
+    srcVertex, intVertex:                               TQRMDLVertex;
+    scale, translate:                                   array[0..2] of Single;
+    factor, xSign, tu, tv, skinWidth, skinHeight:       Single;
+    r, g, b, a:                                         Single;
+    normal, intNormal:                                  TQRVector3D;
+    light:                                              TQRVertexLight;
+begin
+    polygonCount := m_pParser.m_Header.m_PolygonCount;
+
+    // nothing to populate?
+    if (polygonCount = 0) then
+        Exit(True);
+
+    // is buffer too small? NOTE each polygon contains 3 vertices
+    if (Length(buffer) < (polygonCount * 3 * stride)) then
+        Exit(False);
+
+    normalCount := Length(m_Normals);
+
+    // is interpolation factor out of bounds? Limit to min or max values in this case
+    if (interpolationFactor < 0.0) then
+        factor := 0.0
+    else
+    if (interpolationFactor > 1.0) then
+        factor := 1.0
+    else
+        factor := interpolationFactor;
+
+    // do convert right hand <-> left hand coordinate system? If yes, the x axis is inverted
+    if (m_RHToLH) then
+        xSign := -1.0
+    else
+        xSign := 1.0;
+
+    // get the uncompression values, they are the same for all the frames
+    for k := 0 to 2 do
+    begin
+        scale[k]     := m_pParser.m_Header.m_Scale[k];
+        translate[k] := m_pParser.m_Header.m_Translate[k];
+    end;
+
+    offset := 0;
+
+    // populate the vertex positions
+    for j := 0 to polygonCount - 1 do
+        for k := 0 to 2 do
+        begin
+            // get source vertex, and vertex to interpolate with
+            vertexIndex := m_pParser.m_Polygons[j].m_VertexIndex[k];
+            srcVertex   := srcFrame.m_Vertices[vertexIndex];
+            intVertex   := intFrame.m_Vertices[vertexIndex];
+
+            // interpolate and uncompress the vertex
+            buffer[offset]     := xSign * ((scale[0] * (srcVertex.m_Vertex[0] +
+                                  ((intVertex.m_Vertex[0] - srcVertex.m_Vertex[0]) * factor))) +
+                                  translate[0]);
+            buffer[offset + 1] := (scale[1] * (srcVertex.m_Vertex[1] +
+                                  ((intVertex.m_Vertex[1] - srcVertex.m_Vertex[1]) * factor))) +
+                                  translate[1];
+            buffer[offset + 2] := (scale[2] * (srcVertex.m_Vertex[2] +
+                                  ((intVertex.m_Vertex[2] - srcVertex.m_Vertex[2]) * factor))) +
+                                  translate[2];
+
+            Inc(offset, stride);
+        end;
+
+    attribOffset := 3;
+
+    // do include normals?
+    if (EQR_VF_Normals in VertexFormat) then
+    begin
+        offset := attribOffset;
+
+        // populate the vertex normals
+        for j := 0 to polygonCount - 1 do
+            for k := 0 to 2 do
+            begin
+                vertexIndex := m_pParser.m_Polygons[j].m_VertexIndex[k];
+                srcVertex   := srcFrame.m_Vertices[vertexIndex];
+                intVertex   := intFrame.m_Vertices[vertexIndex];
+
+                // is normal index out of bounds?
+                if (srcVertex.m_NormalIndex >= normalCount) then
+                    Exit(False);
+
+                normal := m_Normals[srcVertex.m_NormalIndex];
+
+                // get the normal to interpolate with, keep the source normal if not available
+                if (intVertex.m_NormalIndex < normalCount) then
+                    intNormal := m_Normals[intVertex.m_NormalIndex]
+                else
+                    intNormal := normal;
+
+                buffer[offset]     := xSign * (normal.X + ((intNormal.X - normal.X) * factor));
+                buffer[offset + 1] := normal.Y + ((intNormal.Y - normal.Y) * factor);
+                buffer[offset + 2] := normal.Z + ((intNormal.Z - normal.Z) * factor);
+
+                Inc(offset, stride);
+            end;
+
+        Inc(attribOffset, 3);
+    end;
+
+    // do include texture coordinates?
+    if (EQR_VF_TexCoords in VertexFormat) then
+    begin
+        offset     := attribOffset;
+        skinWidth  := m_pParser.m_Header.m_SkinWidth;
+        skinHeight := m_pParser.m_Header.m_SkinHeight;
+
+        // populate the vertex texture coordinates
+        for j := 0 to polygonCount - 1 do
+            for k := 0 to 2 do
+            begin
+                vertexIndex := m_pParser.m_Polygons[j].m_VertexIndex[k];
+
+                // get vertex texture coordinates. Be careful, here a pointer of type float should
+                // be read from memory, for that the conversion cannot be done from M_Precision
+                tu := m_pParser.m_TexCoords[vertexIndex].m_U;
+                tv := m_pParser.m_TexCoords[vertexIndex].m_V;
+
+                // is texture coordinate on the back face?
+                if ((m_pParser.m_Polygons[j].m_FacesFront = 0) and
+                    (m_pParser.m_TexCoords[vertexIndex].m_OnSeam <> 0))
+                then
+                    // correct the texture coordinate to put it on the back face
+                    tu := tu + skinWidth * 0.5;
+
+                // scale s and t to range from 0.0 to 1.0
+                buffer[offset]     := (tu + 0.5) / skinWidth;
+                buffer[offset + 1] := (tv + 0.5) / skinHeight;
+
+                Inc(offset, stride);
+            end;
+
+        Inc(attribOffset, 2);
+    end;
+
+    // don't include colors?
+    if (not(EQR_VF_Colors in VertexFormat)) then
+        Exit(True);
+
+    offset := attribOffset;
+
+    // don't pre-calculate lightning? In this case all the vertices use the material color
+    if (not m_pPreCalculatedLight.Enabled) then
+    begin
+        r := Color.GetRedF;
+        g := Color.GetGreenF;
+        b := Color.GetBlueF;
+        a := Color.GetAlphaF;
+
+        // populate the vertex colors
+        for j := 0 to (polygonCount * 3) - 1 do
+        begin
+            buffer[offset]     := r;
+            buffer[offset + 1] := g;
+            buffer[offset + 2] := b;
+            buffer[offset + 3] := a;
+
+            Inc(offset, stride);
+        end;
+
+        Exit(True);
+    end;
+
+    // prepare the pre-calculated light once for the whole frame
+    light := TQRVertexLight.Create(m_pPreCalculatedLight);
+
+    // populate the vertex colors, calculated from the pre-calculated light
+    for j := 0 to polygonCount - 1 do
+        for k := 0 to 2 do
+        begin
+            vertexIndex := m_pParser.m_Polygons[j].m_VertexIndex[k];
+            srcVertex   := srcFrame.m_Vertices[vertexIndex];
+            intVertex   := intFrame.m_Vertices[vertexIndex];
+
+            // is normal index out of bounds?
+            if (srcVertex.m_NormalIndex >= normalCount) then
+                // unfortunately normal isn't available, so use the ambient color (not the best
+                // solution, but for lack of better...)
+                light.ApplyAmbient(buffer, offset)
+            else
+            begin
+                normal := m_Normals[srcVertex.m_NormalIndex];
+
+                // get the normal to interpolate with, keep the source normal if not available
+                if (intVertex.m_NormalIndex < normalCount) then
+                    intNormal := m_Normals[intVertex.m_NormalIndex]
+                else
+                    intNormal := normal;
+
+                // calculate the final vertex normal
+                normal := TQRVector3D.Create(xSign * (normal.X + ((intNormal.X - normal.X) * factor)),
+                                             normal.Y + ((intNormal.Y - normal.Y) * factor),
+                                             normal.Z + ((intNormal.Z - normal.Z) * factor));
+
+                // calculate lightning from pre-calculated light
+                light.Apply(normal, buffer, offset);
+            end;
+
+            Inc(offset, stride);
+        end;
+
+    Result := True;
+end;
+//--------------------------------------------------------------------------------------------------
 function TQRMDLModel.GetPreCalculatedLight: TQRDirectionalLight;
 begin
     Result := m_pPreCalculatedLight;
@@ -1436,213 +1787,30 @@ end;
 function TQRMDLModel.Load(const fileName: TFileName): Boolean;
 begin
     Result := m_pParser.Load(fileName);
+
+    // populate the frame boxes
+    if (Result) then
+        PopulateFrameBoxes;
 end;
 //--------------------------------------------------------------------------------------------------
 function TQRMDLModel.Load(const pBuffer: TStream; readLength: NativeUInt): Boolean;
 begin
     Result := m_pParser.Load(pBuffer, readLength);
+
+    // populate the frame boxes
+    if (Result) then
+        PopulateFrameBoxes;
 end;
 //--------------------------------------------------------------------------------------------------
 function TQRMDLModel.GetMesh(index: NativeUInt;
                           out mesh: TQRMesh;
                          pAABBTree: TQRAABBTree;
                        hIsCanceled: TQRIsCanceledEvent): Boolean;
-var
-    srcFrame:                             TQRMDLFrameGroup;
-    stride, normalCount, meshIndex, i, j: NativeInt;
-    offset:                               NativeUInt;
-    k:                                    TQRUInt8;
-    srcVertex:                            TQRMDLVertex;
-    ucpVertex, normal:                    TQRVector3D;
-    tu, tv:                               Single;
-    pMeshColor:                           TQRColor;
-    foundNormal, doFreeColor:             Boolean;
 begin
-    // is frame index out of bounds?
-    if (index >= GetMeshCount) then
-        Exit(False);
-
-    // get normal count
-    normalCount := Length(m_Normals);
-
-    // do use normals and pre-calculated normals table wasn't populated?
-    if ((EQR_VF_Normals in VertexFormat) and (normalCount = 0)) then
+    // get the frame mesh. NOTE the frame is interpolated with itself, which returns it unchanged
+    if (not GetMesh(index, index, 0.0, mesh, hIsCanceled)) then
         Exit(False);
 
-    // get source frame from which mesh should be extracted
-    srcFrame := m_pParser.m_Frames[index];
-
-    // basically stride is the coordinates values size
-    stride := 3;
-
-    // do include m_Normals?
-    if (EQR_VF_Normals in VertexFormat) then
-        Inc(stride, 3);
-
-    // do include texture coordinates?
-    if (EQR_VF_TexCoords in VertexFormat) then
-        Inc(stride, 2);
-
-    // do include colors?
-    if (EQR_VF_Colors in VertexFormat) then
-        Inc(stride, 4);
-
-    // iterate through meshes composing the frame
-    for i := 0 to srcFrame.m_Count - 1 do
-    begin
-        // is canceled?
-        if (Assigned(hIsCanceled) and hIsCanceled) then
-            Exit(False);
-
-        // add mesh to output
-        SetLength(mesh, Length(mesh) + 1);
-        meshIndex := Length(mesh) - 1;
-
-        // create and populate new vertex
-        mesh[meshIndex].m_Name      := 'qr_mdl';
-        mesh[meshIndex].m_Stride    := stride;
-        mesh[meshIndex].m_Format    := VertexFormat;
-        mesh[meshIndex].m_CoordType := EQR_VC_XYZ;
-        mesh[meshIndex].m_Type      := EQR_VT_Triangles;
-
-        offset := 0;
-
-        // iterate through polygons to process
-        for j := 0 to m_pParser.m_Header.m_PolygonCount - 1 do
-            for k := 0 to 2 do
-            begin
-                // is canceled?
-                if (Assigned(hIsCanceled) and hIsCanceled) then
-                    Exit(False);
-
-                // get source vertex
-                srcVertex := srcFrame.m_Frames[i].m_Vertices[m_pParser.m_Polygons[j].m_VertexIndex[k]];
-
-                // uncompress vertex
-                ucpVertex := UncompressVertex(m_pParser.m_Header, srcVertex);
-
-                // do convert right hand <-> left hand coordinate system?
-                if (m_RHToLH) then
-                    // apply conversion
-                    ucpVertex.X := -ucpVertex.X;
-
-                // populate vertex buffer
-                SetLength(mesh[meshIndex].m_Buffer, Length(mesh[meshIndex].m_Buffer) + 3);
-                mesh[meshIndex].m_Buffer[offset]     := ucpVertex.X;
-                mesh[meshIndex].m_Buffer[offset + 1] := ucpVertex.Y;
-                mesh[meshIndex].m_Buffer[offset + 2] := ucpVertex.Z;
-                Inc(offset, 3);
-
-                // do include m_Normals?
-                if (EQR_VF_Normals in VertexFormat) then
-                begin
-                    // is normal index out of bounds?
-                    if (srcVertex.m_NormalIndex >= normalCount) then
-                        Exit(False);
-
-                    // get vertex normal
-                    normal := m_Normals[srcVertex.m_NormalIndex];
-
-                    // do convert right hand <-> left hand coordinate system?
-                    if (m_RHToLH) then
-                        // apply conversion
-                        normal.X := -normal.X;
-
-                    SetLength(mesh[meshIndex].m_Buffer, Length(mesh[meshIndex].m_Buffer) + 3);
-                    mesh[meshIndex].m_Buffer[offset]     := normal.X;
-                    mesh[meshIndex].m_Buffer[offset + 1] := normal.Y;
-                    mesh[meshIndex].m_Buffer[offset + 2] := normal.Z;
-                    Inc(offset, 3);
-                end;
-
-                // do include texture coordinates?
-                if (EQR_VF_TexCoords in VertexFormat) then
-                begin
-                    // get vertex texture coordinates. Be careful, here a pointer of
-                    // type float should be read from memory, for that the conversion
-                    // cannot be done from M_Precision
-                    tu := m_pParser.m_TexCoords[m_pParser.m_Polygons[j].m_VertexIndex[k]].m_U;
-                    tv := m_pParser.m_TexCoords[m_pParser.m_Polygons[j].m_VertexIndex[k]].m_V;
-
-                    // is texture coordinate on the back face?
-                    if ((m_pParser.m_Polygons[j].m_FacesFront = 0) and
-                        (m_pParser.m_TexCoords[m_pParser.m_Polygons[j].m_VertexIndex[k]].m_OnSeam <> 0))
-                    then
-                        // correct the texture coordinate to put it on the back face
-                        tu := tu + m_pParser.m_Header.m_SkinWidth * 0.5;
-
-                    // scale s and t to range from 0.0 to 1.0
-                    tu := (tu + 0.5) / m_pParser.m_Header.m_SkinWidth;
-                    tv := (tv + 0.5) / m_pParser.m_Header.m_SkinHeight;
-
-                    SetLength(mesh[meshIndex].m_Buffer, Length(mesh[meshIndex].m_Buffer) + 2);
-                    mesh[meshIndex].m_Buffer[offset]     := tu;
-                    mesh[meshIndex].m_Buffer[offset + 1] := tv;
-                    Inc(offset, 2);
-                end;
-
-                // do include colors?
-                if (EQR_VF_Colors in VertexFormat) then
-                begin
-                    doFreeColor := False;
-
-                    // do pre-calculate lightining or use the material color?
-                    if (m_pPreCalculatedLight.Enabled) then
-                    begin
-                        // by default, normal exists
-                        foundNormal := True;
-
-                        // are normals also included?
-                        if (not(EQR_VF_Normals in VertexFormat)) then
-                        begin
-                            // is normal index out of bounds?
-                            if (srcVertex.m_NormalIndex >= normalCount) then
-                            begin
-                                // normal isn't available
-                                foundNormal := False;
-                            end
-                            else
-                            begin
-                                // get vertex normal
-                                normal := m_Normals[srcVertex.m_NormalIndex];
-
-                                // do convert right hand <-> left hand coordinate system?
-                                if (m_RHToLH) then
-                                    // apply conversion
-                                    normal.X := -normal.X;
-                            end;
-                        end;
-
-                        // calculate lightning from pre-calculated light
-                        if (foundNormal) then
-                        begin
-                            doFreeColor := True;
-                            pMeshColor  := CalculateLight(normal, m_pPreCalculatedLight);
-                        end
-                        else
-                            // unfortunately normal isn't available, so use the ambient color (not the
-                            // best solution, but for lack of better...)
-                            pMeshColor := m_pPreCalculatedLight.Ambient;
-                    end
-                    else
-                    begin
-                        // use default color
-                        pMeshColor := Color;
-                    end;
-
-                    SetLength(mesh[meshIndex].m_Buffer, Length(mesh[meshIndex].m_Buffer) + 4);
-                    mesh[meshIndex].m_Buffer[offset]     := pMeshColor.GetRedF;
-                    mesh[meshIndex].m_Buffer[offset + 1] := pMeshColor.GetGreenF;
-                    mesh[meshIndex].m_Buffer[offset + 2] := pMeshColor.GetBlueF;
-                    mesh[meshIndex].m_Buffer[offset + 3] := pMeshColor.GetAlphaF;
-                    Inc(offset, 4);
-
-                    if (doFreeColor) then
-                        pMeshColor.Free;
-                end;
-            end;
-    end;
-
     // canceled?
     if (Assigned(hIsCanceled) and hIsCanceled) then
         Exit(True);
@@ -1660,25 +1828,15 @@ function TQRMDLModel.GetMesh(index, nextIndex: NativeUInt;
                                      out mesh: TQRMesh;
                                   hIsCanceled: TQRIsCanceledEvent): Boolean;
 var
-    srcFrame, intFrame:                                                   TQRMDLFrameGroup;
-    stride, normalCount, i, j, meshIndex:                                 NativeInt;
-    offset:                                                               NativeUInt;
-    k:                                                                    Byte;
-    srcVertex, intVertex:                                                 TQRMDLVertex;
-    ucpVertex, ucpIntVertex, finalVertex, normal, intNormal, finalNormal: TQRVector3D;
-    tu, tv:                                                               Single;
-    pMeshColor:                                                           TQRColor;
-    foundNormal, doFreeColor:                                             Boolean;
+    srcFrame, intFrame: TQRMDLFrameGroup;
+    stride, i:          NativeInt;
 begin
     // is frame index out of bounds?
-    if (index >= GetMeshCount) then
+    if ((index >= GetMeshCount) or (nextIndex >= GetMeshCount)) then
         Exit(False);
 
-    // get normal count
-    normalCount := Length(m_Normals);
-
     // do use normals and pre-calculated normals table wasn't populated?
-    if ((EQR_VF_Normals in VertexFormat) and (normalCount = 0)) then
+    if ((EQR_VF_Normals in VertexFormat) and (Length(m_Normals) = 0)) then
         Exit(False);
 
     // get source frame from which mesh should be extracted, and frame to interpolate with
@@ -1700,6 +1858,9 @@ begin
     if (EQR_VF_Colors in VertexFormat) then
         Inc(stride, 4);
 
+    // allocate the output meshes once, one mesh per frame of the group
+    SetLength(mesh, srcFrame.m_Count);
+
     // iterate through meshes composing the frame
     for i := 0 to srcFrame.m_Count - 1 do
     begin
@@ -1707,175 +1868,24 @@ begin
         if (Assigned(hIsCanceled) and hIsCanceled) then
             Exit(False);
 
-        // add mesh to output
-        SetLength(mesh, Length(mesh) + 1);
-        meshIndex := Length(mesh) - 1;
-
         // create and populate new vertex
-        mesh[meshIndex].m_Name      := 'qr_mdl';
-        mesh[meshIndex].m_Stride    := stride;
-        mesh[meshIndex].m_Format    := VertexFormat;
-        mesh[meshIndex].m_CoordType := EQR_VC_XYZ;
-        mesh[meshIndex].m_Type      := EQR_VT_Triangles;
-
-        offset := 0;
-
-        // iterate through polygons to process
-        for j := 0 to m_pParser.m_Header.m_PolygonCount - 1 do
-            for k := 0 to 2 do
-            begin
-                // is canceled?
-                if (Assigned(hIsCanceled) and hIsCanceled) then
-                    Exit(False);
-
-                // get source vertex, and vertex to interpolate with
-                srcVertex := srcFrame.m_Frames[i].m_Vertices[m_pParser.m_Polygons[j].m_VertexIndex[k]];
-                intVertex := intFrame.m_Frames[i].m_Vertices[m_pParser.m_Polygons[j].m_VertexIndex[k]];
-
-                // uncompress vertices
-                ucpVertex    := UncompressVertex(m_pParser.m_Header, srcVertex);
-                ucpIntVertex := UncompressVertex(m_pParser.m_Header, intVertex);
-
-                // do convert right hand <-> left hand coordinate system?
-                if (m_RHToLH) then
-                begin
-                    // apply conversion
-                    ucpVertex.X    := -ucpVertex.X;
-                    ucpIntVertex.X := -ucpIntVertex.X;
-                end;
-
-                // calculate final mesh vertex
-                finalVertex := ucpVertex.Interpolate(ucpIntVertex, interpolationFactor);
-
-                // populate vertex buffer
-                SetLength(mesh[meshIndex].m_Buffer, Length(mesh[meshIndex].m_Buffer) + 3);
-                mesh[meshIndex].m_Buffer[offset]     := finalVertex.X;
-                mesh[meshIndex].m_Buffer[offset + 1] := finalVertex.Y;
-                mesh[meshIndex].m_Buffer[offset + 2] := finalVertex.Z;
-                Inc(offset, 3);
-
-                // do include m_Normals?
-                if (EQR_VF_Normals in VertexFormat) then
-                begin
-                    // is normal index out of bounds?
-                    if (srcVertex.m_NormalIndex >= normalCount) then
-                        Exit(False);
-
-                    // get vertex normal, and normal to interpolate with
-                    normal    := m_Normals[srcVertex.m_NormalIndex];
-                    intNormal := m_Normals[intVertex.m_NormalIndex];
-
-                    // do convert right hand <-> left hand coordinate system?
-                    if (m_RHToLH) then
-                    begin
-                        // apply conversion
-                        normal.X    := -normal.X;
-                        intNormal.X := -intNormal.X;
-                    end;
-
-                    // calculate final vertex normal
-                    finalNormal := normal.Interpolate(intNormal, interpolationFactor);
-
-                    SetLength(mesh[meshIndex].m_Buffer, Length(mesh[meshIndex].m_Buffer) + 3);
-                    mesh[meshIndex].m_Buffer[offset]     := finalNormal.X;
-                    mesh[meshIndex].m_Buffer[offset + 1] := finalNormal.Y;
-                    mesh[meshIndex].m_Buffer[offset + 2] := finalNormal.Z;
-                    Inc(offset, 3);
-                end;
-
-                // do include texture coordinates?
-                if (EQR_VF_TexCoords in VertexFormat) then
-                begin
-                    // get vertex texture coordinates. Be careful, here a pointer of
-                    // type float should be read from memory, for that the conversion
-                    // cannot be done from M_Precision
-                    tu := m_pParser.m_TexCoords[m_pParser.m_Polygons[j].m_VertexIndex[k]].m_U;
-                    tv := m_pParser.m_TexCoords[m_pParser.m_Polygons[j].m_VertexIndex[k]].m_V;
-
-                    // is texture coordinate on the back face?
-                    if ((m_pParser.m_Polygons[j].m_FacesFront = 0) and
-                        (m_pParser.m_TexCoords[m_pParser.m_Polygons[j].m_VertexIndex[k]].m_OnSeam <> 0))
-                    then
-                        // correct the texture coordinate to put it on the back face
-                        tu := tu + m_pParser.m_Header.m_SkinWidth * 0.5;
-
-                    // scale s and t to range from 0.0 to 1.0
-                    tu := (tu + 0.5) / m_pParser.m_Header.m_SkinWidth;
-                    tv := (tv + 0.5) / m_pParser.m_Header.m_SkinHeight;
-
-                    SetLength(mesh[meshIndex].m_Buffer, Length(mesh[meshIndex].m_Buffer) + 2);
-                    mesh[meshIndex].m_Buffer[offset]     := tu;
-                    mesh[meshIndex].m_Buffer[offset + 1] := tv;
-                    Inc(offset, 2);
-                end;
-
-                // do include colors?
-                if (EQR_VF_Colors in VertexFormat) then
-                begin
-                    doFreeColor := False;
-
-                    // do pre-calculate lightining or use the material color?
-                    if (m_pPreCalculatedLight.Enabled) then
-                    begin
-                        // by default, normal exists
-                        foundNormal := True;
-
-                        // are normals also included?
-                        if (not(EQR_VF_Normals in VertexFormat)) then
-                        begin
-                            // is normal index out of bounds?
-                            if (srcVertex.m_NormalIndex >= normalCount) then
-                            begin
-                                // normal isn't available
-                                foundNormal := False;
-                            end
-                            else
-                            begin
-                                // get vertex normal, and normal to interpolate with
-                                normal    := m_Normals[srcVertex.m_NormalIndex];
-                                intNormal := m_Normals[intVertex.m_NormalIndex];
-
-                                // do convert right hand <-> left hand coordinate system?
-                                if (m_RHToLH) then
-                                begin
-                                    // apply conversion
-                                    normal.X    := -normal.X;
-                                    intNormal.X := -intNormal.X;
-                                end;
-
-                                // calculate final vertex normal
-                                finalNormal := normal.Interpolate(intNormal, interpolationFactor);
-                            end;
-                        end;
-
-                        // calculate lightning from pre-calculated light
-                        if (foundNormal) then
-                        begin
-                            doFreeColor := True;
-                            pMeshColor  := CalculateLight(finalNormal, m_pPreCalculatedLight);
-                        end
-                        else
-                            // unfortunately normal isn't available, so use the ambient color (not the
-                            // best solution, but for lack of better...)
-                            pMeshColor := m_pPreCalculatedLight.Ambient;
-                    end
-                    else
-                    begin
-                        // use default color
-                        pMeshColor := Color;
-                    end;
-
-                    SetLength(mesh[meshIndex].m_Buffer, Length(mesh[meshIndex].m_Buffer) + 4);
-                    mesh[meshIndex].m_Buffer[offset]     := pMeshColor.GetRedF;
-                    mesh[meshIndex].m_Buffer[offset + 1] := pMeshColor.GetGreenF;
-                    mesh[meshIndex].m_Buffer[offset + 2] := pMeshColor.GetBlueF;
-                    mesh[meshIndex].m_Buffer[offset + 3] := pMeshColor.GetAlphaF;
-                    Inc(offset, 4);
-
-                    if (doFreeColor) then
-                        pMeshColor.Free;
-                end;
-            end;
+        mesh[i].m_Name      := 'qr_mdl';
+        mesh[i].m_Stride    := stride;
+        mesh[i].m_Format    := VertexFormat;
+        mesh[i].m_CoordType := EQR_VC_XYZ;
+        mesh[i].m_Type      := EQR_VT_Triangles;
+
+        // allocate the whole vertex buffer once, each polygon contains 3 vertices
+        SetLength(mesh[i].m_Buffer, m_pParser.m_Header.m_PolygonCount * 3 * stride);
+
+        // populate the vertex buffer
+        if (not PopulateVertexBuffer(srcFrame.m_Frames[i],
+                                     intFrame.m_Frames[i],
+                                     interpolationFactor,
+                                     stride,
+                                     mesh[i].m_Buffer))
+        then
+            Exit(False);
     end;
 
     Result := True;
@@ -1886,5 +1896,23 @@ begin
     Result := m_pParser.m_Header.m_FrameCount;
 end;
 //--------------------------------------------------------------------------------------------------
+function TQRMDLModel.GetFrameBox(index: NativeUInt; out box: TQRBox): Boolean;
+begin
+    // is frame index out of bounds?
+    if (index >= NativeUInt(Length(m_FrameBoxes))) then
+        Exit(False);
+
+    box := m_FrameBoxes[index];
+
+    // convert the box to left hand coordinate system if required, the x axis is mirrored
+    if (m_RHToLH) then
+    begin
+        box.Min.X := -m_FrameBoxes[index].Max.X;
+        box.Max.X := -m_FrameBoxes[index].Min.X;
+    end;
+
+    Result := True;
+end;
+//--------------------------------------------------------------------------------------------------
 
 end.
@@ -72,6 +72,7 @@ type
             m_ModelOptions:        TQRModelOptions;
             m_FramedModelOptions:  TQRFramedModelOptions;
             m_hSceneDC:            THandle;
+            m_InterpolatedMesh:    TQRMesh;
 
         protected
             {$REGION 'Documentation'}
@@ -1117,8 +1118,6 @@ procedure TQRVCLMD2ModelGL.OnDrawModelItem(const pGroup: TQRModelGroup;
                               const interpolationFactor: Double;
                                  const pMesh, pNextMesh: PQRMesh;
                          const pAABBTree, pNextAABBTree: TQRAABBTree);
-var
-    mesh: TQRMesh;
 begin
     // notify user that model item is about to be drawn on the scene, stop drawing if user already
     // processed it
@@ -1215,10 +1214,10 @@ begin
     end;
 
     // get next frame to draw
-    TQRModelHelper.Interpolate(interpolationFactor, pMesh^, pNextMesh^, mesh);
+    TQRModelHelper.InterpolateTo(interpolationFactor, pMesh^, pNextMesh^, m_InterpolatedMesh);
 
     // draw mesh
-    Renderer.Draw(mesh, matrix, textures);
+    Renderer.Draw(m_InterpolatedMesh, matrix, textures);
 
     // notify user that collisions may be detected
     if (Assigned(OnDetectCollisions) and not(EQR_MO_No_Collision in m_ModelOptions)) then
@@ -680,16 +680,23 @@ begin
                            @vertex.m_Buffer[offset]);
         end;
 
-        // draw mesh
-        case (vertex.m_Type) of
-            EQR_VT_Triangles:     glDrawArrays(GL_TRIANGLES,      0, NativeUInt(Length(vertex.m_Buffer)) div stride);
-            EQR_VT_TriangleStrip: glDrawArrays(GL_TRIANGLE_STRIP, 0, NativeUInt(Length(vertex.m_Buffer)) div stride);
-            EQR_VT_TriangleFan:   glDrawArrays(GL_TRIANGLE_FAN,   0, NativeUInt(Length(vertex.m_Buffer)) div stride);
-            EQR_VT_Quads:         glDrawArrays(GL_QUADS,          0, NativeUInt(Length(vertex.m_Buffer)) div stride);
-            EQR_VT_QuadStrip:     glDrawArrays(GL_QUAD_STRIP,     0, NativeUInt(Length(vertex.m_Buffer)) div stride);
+        // is mesh indexed? In this case the indices always describe a triangle list
+        if (Length(vertex.m_Indices) > 0) then
+            glDrawElements(GL_TRIANGLES,
+                           Length(vertex.m_Indices),
+                           GL_UNSIGNED_INT,
+                           @vertex.m_Indices[0])
         else
-            raise Exception.Create('Unknown vertex type');
-        end;
+            // draw mesh
+            case (vertex.m_Type) of
+                EQR_VT_Triangles:     glDrawArrays(GL_TRIANGLES,      0, NativeUInt(Length(vertex.m_Buffer)) div stride);
+                EQR_VT_TriangleStrip: glDrawArrays(GL_TRIANGLE_STRIP, 0, NativeUInt(Length(vertex.m_Buffer)) div stride);
+                EQR_VT_TriangleFan:   glDrawArrays(GL_TRIANGLE_FAN,   0, NativeUInt(Length(vertex.m_Buffer)) div stride);
+                EQR_VT_Quads:         glDrawArrays(GL_QUADS,          0, NativeUInt(Length(vertex.m_Buffer)) div stride);
+                EQR_VT_QuadStrip:     glDrawArrays(GL_QUAD_STRIP,     0, NativeUInt(Length(vertex.m_Buffer)) div stride);
+            else
+                raise Exception.Create('Unknown vertex type');
+            end;
 
         // unbind vertex array
         glDisableClientState(GL_VERTEX_ARRAY);
@@ -796,16 +803,23 @@ begin
                            @vertex.m_Buffer[offset]);
         end;
 
-        // draw mesh
-        case (vertex.m_Type) of
-            EQR_VT_Triangles:     glDrawArrays(GL_TRIANGLES,      0, NativeUInt(Length(vertex.m_Buffer)) div stride);
-            EQR_VT_TriangleStrip: glDrawArrays(GL_TRIANGLE_STRIP, 0, NativeUInt(Length(vertex.m_Buffer)) div stride);
-            EQR_VT_TriangleFan:   glDrawArrays(GL_TRIANGLE_FAN,   0, NativeUInt(Length(vertex.m_Buffer)) div stride);
-            EQR_VT_Quads:         glDrawArrays(GL_QUADS,          0, NativeUInt(Length(vertex.m_Buffer)) div stride);
-            EQR_VT_QuadStrip:     glDrawArrays(GL_QUAD_STRIP,     0, NativeUInt(Length(vertex.m_Buffer)) div stride);
+        // is mesh indexed? In this case the indices always describe a triangle list
+        if (Length(vertex.m_Indices) > 0) then
+            glDrawElements(GL_TRIANGLES,
+                           Length(vertex.m_Indices),
+                           GL_UNSIGNED_INT,
+                           @vertex.m_Indices[0])
         else
-            raise Exception.Create('Unknown vertex type');
-        end;
+            // draw mesh
+            case (vertex.m_Type) of
+                EQR_VT_Triangles:     glDrawArrays(GL_TRIANGLES,      0, NativeUInt(Length(vertex.m_Buffer)) div stride);
+                EQR_VT_TriangleStrip: glDrawArrays(GL_TRIANGLE_STRIP, 0, NativeUInt(Length(vertex.m_Buffer)) div stride);
+                EQR_VT_TriangleFan:   glDrawArrays(GL_TRIANGLE_FAN,   0, NativeUInt(Length(vertex.m_Buffer)) div stride);
+                EQR_VT_Quads:         glDrawArrays(GL_QUADS,          0, NativeUInt(Length(vertex.m_Buffer)) div stride);
+                EQR_VT_QuadStrip:     glDrawArrays(GL_QUAD_STRIP,     0, NativeUInt(Length(vertex.m_Buffer)) div stride);
+            else
+                raise Exception.Create('Unknown vertex type');
+            end;
 
         // unbind vertex array
         glDisableClientState(GL_VERTEX_ARRAY);
@@ -986,16 +1000,23 @@ begin
                                       @vertex.m_Buffer[offset]);
             end;
 
-            // draw mesh
-            case (vertex.m_Type) of
-                EQR_VT_Triangles:     glDrawArrays(GL_TRIANGLES,      0, NativeUInt(Length(vertex.m_Buffer)) div stride);
-                EQR_VT_TriangleStrip: glDrawArrays(GL_TRIANGLE_STRIP, 0, NativeUInt(Length(vertex.m_Buffer)) div stride);
-                EQR_VT_TriangleFan:   glDrawArrays(GL_TRIANGLE_FAN,   0, NativeUInt(Length(vertex.m_Buffer)) div stride);
-                EQR_VT_Quads:         glDrawArrays(GL_QUADS,          0, NativeUInt(Length(vertex.m_Buffer)) div stride);
-                EQR_VT_QuadStrip:     glDrawArrays(GL_QUAD_STRIP,     0, NativeUInt(Length(vertex.m_Buffer)) div stride);
+            // is mesh indexed? In this case the indices always describe a triangle list
+            if (Length(vertex.m_Indices) > 0) then
+                glDrawElements(GL_TRIANGLES,
+                               Length(vertex.m_Indices),
+                               GL_UNSIGNED_INT,
+                               @vertex.m_Indices[0])
             else
-                raise Exception.Create('Unknown vertex type');
-            end;
+                // draw mesh
+                case (vertex.m_Type) of
+                    EQR_VT_Triangles:     glDrawArrays(GL_TRIANGLES,      0, NativeUInt(Length(vertex.m_Buffer)) div stride);
+                    EQR_VT_TriangleStrip: glDrawArrays(GL_TRIANGLE_STRIP, 0, NativeUInt(Length(vertex.m_Buffer)) div stride);
+                    EQR_VT_TriangleFan:   glDrawArrays(GL_TRIANGLE_FAN,   0, NativeUInt(Length(vertex.m_Buffer)) div stride);
+                    EQR_VT_Quads:         glDrawArrays(GL_QUADS,          0, NativeUInt(Length(vertex.m_Buffer)) div stride);
+                    EQR_VT_QuadStrip:     glDrawArrays(GL_QUAD_STRIP,     0, NativeUInt(Length(vertex.m_Buffer)) div stride);
+                else
+                    raise Exception.Create('Unknown vertex type');
+                end;
         end;
     finally
         // unbind shader program
@@ -1224,16 +1245,23 @@ begin
                                       @mesh[i].m_Buffer[offset]);
             end;
 
-            // draw mesh
-            case (mesh[i].m_Type) of
-                EQR_VT_Triangles:     glDrawArrays(GL_TRIANGLES,      0, NativeUInt(Length(mesh[i].m_Buffer)) div stride);
-                EQR_VT_TriangleStrip: glDrawArrays(GL_TRIANGLE_STRIP, 0, NativeUInt(Length(mesh[i].m_Buffer)) div stride);
-                EQR_VT_TriangleFan:   glDrawArrays(GL_TRIANGLE_FAN,   0, NativeUInt(Length(mesh[i].m_Buffer)) div stride);
-                EQR_VT_Quads:         glDrawArrays(GL_QUADS,          0, NativeUInt(Length(mesh[i].m_Buffer)) div stride);
-                EQR_VT_QuadStrip:     glDrawArrays(GL_QUAD_STRIP,     0, NativeUInt(Length(mesh[i].m_Buffer)) div stride);
+            // is mesh indexed? In this case the indices always describe a triangle list
+            if (Length(mesh[i].m_Indices) > 0) then
+                glDrawElements(GL_TRIANGLES,
+                               Length(mesh[i].m_Indices),
+                               GL_UNSIGNED_INT,
+                               @mesh[i].m_Indices[0])
             else
-                raise Exception.Create('Unknown vertex type');
-            end;
+                // draw mesh
+                case (mesh[i].m_Type) of
+                    EQR_VT_Triangles:     glDrawArrays(GL_TRIANGLES,      0, NativeUInt(Length(mesh[i].m_Buffer)) div stride);
+                    EQR_VT_TriangleStrip: glDrawArrays(GL_TRIANGLE_STRIP, 0, NativeUInt(Length(mesh[i].m_Buffer)) div stride);
+                    EQR_VT_TriangleFan:   glDrawArrays(GL_TRIANGLE_FAN,   0, NativeUInt(Length(mesh[i].m_Buffer)) div stride);
+                    EQR_VT_Quads:         glDrawArrays(GL_QUADS,          0, NativeUInt(Length(mesh[i].m_Buffer)) div stride);
+                    EQR_VT_QuadStrip:     glDrawArrays(GL_QUAD_STRIP,     0, NativeUInt(Length(mesh[i].m_Buffer)) div stride);
+                else
+                    raise Exception.Create('Unknown vertex type');
+                end;
         end;
     finally
         // unbind shader program
@@ -547,17 +547,18 @@ type
     {$ENDREGION}
     TQRMD3ModelItem = class
         private
-            m_Name:        UnicodeString;
-            m_pModel:      TQRMD3Model;
-            m_pSkin:       TQRMD3Skin;
-            m_Textures:    TQRTextures;
-            m_LinksFrom:   TQRMD3ModelLinks;
-            m_LinksTo:     TQRMD3ModelLinks;
-            m_pAnimations: TQRMD3AnimationDictionary;
-            m_pAnimation:  TQRFramedModelAnimation;
-            m_Gesture:     EQRMD3AnimationGesture;
-            m_CacheIndex:  NativeUInt;
-            m_RhToLh:      Boolean;
+            m_Name:             UnicodeString;
+            m_pModel:           TQRMD3Model;
+            m_pSkin:            TQRMD3Skin;
+            m_Textures:         TQRTextures;
+            m_LinksFrom:        TQRMD3ModelLinks;
+            m_LinksTo:          TQRMD3ModelLinks;
+            m_pAnimations:      TQRMD3AnimationDictionary;
+            m_pAnimation:       TQRFramedModelAnimation;
+            m_Gesture:          EQRMD3AnimationGesture;
+            m_CacheIndex:       NativeUInt;
+            m_RhToLh:           Boolean;
+            m_InterpolatedMesh: TQRMesh;
 
         protected
             {$REGION 'Documentation'}
@@ -907,6 +908,21 @@ type
 
     TQRMD3ItemDictionary = TDictionary<UnicodeString, TQRMD3ModelItem>;
 
+    {$REGION 'Documentation'}
+    {**
+     Cache containing the frames of a MD3 sub-model, that may be shared with the other jobs loading
+     the same sub-model with the same options
+    }
+    {$ENDREGION}
+    TQRMD3ItemCache = record
+        m_pCache:    TQRModelCache;
+        m_SharedKey: UnicodeString;
+        m_Start:     NativeUInt;
+        m_Count:     NativeUInt;
+    end;
+
+    PQRMD3ItemCache = ^TQRMD3ItemCache;
+
     {$REGION 'Documentation'}
     {**
      Generic MD3 job
@@ -918,6 +934,7 @@ type
     TQRMD3Job = class(TQRModelJob)
         private
             m_Items:              TQRMD3ModelItems;
+            m_ItemCaches:         array of TQRMD3ItemCache;
             m_pItemDictionary:    TQRMD3ItemDictionary;
             m_pInfo:              TQRMD3GroupInfo;
             m_pColor:             TQRColor;
@@ -928,8 +945,28 @@ type
             m_TextureLoaded:      Boolean;
             m_IsCanceled:         Boolean;
             m_FramedModelOptions: TQRFramedModelOptions;
+            m_pDecodedTexture:    Graphics.TBitmap;
             m_fOnLoadTexture:     TQRLoadMeshTextureEvent;
 
+            {$REGION 'Documentation'}
+            {**
+             Gets the sub-model cache containing a frame
+             @param(index Frame cache index)
+             @param(localIndex @bold([out]) Frame index in the sub-model cache)
+             @return(Sub-model cache, @nil if no sub-model cache contains the frame)
+             @br @bold(NOTE) The job should be locked while the returned cache is used
+            }
+            {$ENDREGION}
+            function GetItemCache(index: NativeUInt; out localIndex: NativeUInt): PQRMD3ItemCache;
+
+            {$REGION 'Documentation'}
+            {**
+             Releases a sub-model cache
+             @param(itemIndex Sub-model item index)
+            }
+            {$ENDREGION}
+            procedure ReleaseItemCache(itemIndex: NativeInt);
+
         protected
             {$REGION 'Documentation'}
             {**
@@ -994,6 +1031,15 @@ type
             function LinkAnimations(const pInfo: TQRMD3GroupInfo;
                               const pAnimations: TQRMD3AnimCfgFile): Boolean; virtual;
 
+            {$REGION 'Documentation'}
+            {**
+             Decodes the texture of the skin entry currently linked
+             @br @bold(NOTE) This function is executed on the job thread side, before the
+                             OnLoadTexture() function is called
+            }
+            {$ENDREGION}
+            procedure DecodeTextures; virtual;
+
             {$REGION 'Documentation'}
             {**
              Called when model texture should be loaded
@@ -1002,6 +1048,102 @@ type
             {$ENDREGION}
             procedure OnLoadTexture; virtual;
 
+            {$REGION 'Documentation'}
+            {**
+             Gets the cached mesh item count, in all the sub-model caches
+             @return(The cached mesh item count)
+            }
+            {$ENDREGION}
+            function GetMeshCount: NativeUInt; override;
+
+            {$REGION 'Documentation'}
+            {**
+             Gets the cached aligned-axis bounding box tree item count, in all the sub-model caches
+             @return(The cached aligned-axis bounding box tree item count)
+            }
+            {$ENDREGION}
+            function GetAABBTreeCount: NativeUInt; override;
+
+            {$REGION 'Documentation'}
+            {**
+             Gets mesh at index, from the sub-model cache containing it
+             @param(index Index)
+             @return(Mesh, @nil if not found or on error)
+            }
+            {$ENDREGION}
+            function GetMesh(index: NativeUInt): PQRMesh; override;
+
+            {$REGION 'Documentation'}
+            {**
+             Sets mesh at index, in the sub-model cache containing it
+             @param(index Index)
+             @param(pMesh Mesh)
+             @br @bold(NOTE) Be careful, the internal cache will take the mesh ownership, so don't
+                             try to delete it externally
+             @raises(Exception if the sub-model cache is shared with other jobs)
+            }
+            {$ENDREGION}
+            procedure SetMesh(index: NativeUInt; pMesh: PQRMesh); override;
+
+            {$REGION 'Documentation'}
+            {**
+             Gets aligned-axis bounding box tree at index, from the sub-model cache containing it
+             @param(index Index)
+             @return(Tree, @nil if not found or on error)
+            }
+            {$ENDREGION}
+            function GetTree(index: NativeUInt): TQRAABBTree; override;
+
+            {$REGION 'Documentation'}
+            {**
+             Sets aligned-axis bounding box tree at index, in the sub-model cache containing it
+             @param(index Index)
+             @param(pTree Tree)
+             @br @bold(NOTE) Be careful, the internal cache will take the tree ownership, so don't
+                             try to delete it externally
+             @raises(Exception if the sub-model cache is shared with other jobs)
+            }
+            {$ENDREGION}
+            procedure SetTree(index: NativeUInt; pTree: TQRAABBTree); override;
+
+            {$REGION 'Documentation'}
+            {**
+             Creates the cache the frames of a sub-model are added to
+             @param(itemIndex Sub-model item index)
+             @param(start Cache index of the first sub-model frame)
+             @param(count Sub-model frame count)
+             @br @bold(NOTE) Each sub-model owns a separate cache, in order that its frames can be
+                             shared with the other jobs loading the same sub-model, whatever the
+                             other sub-models they load
+            }
+            {$ENDREGION}
+            procedure CreateItemCache(itemIndex: NativeInt; start, count: NativeUInt); virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Replaces a sub-model cache by the cache another job already published in the model
+             cache registry with the same key, if any
+             @param(itemIndex Sub-model item index)
+             @param(key Shared cache key)
+             @return(@true if the sub-model cache is now shared, @false if no cache was published
+                     with this key)
+             @br @bold(NOTE) The sub-model cache should still be empty when this function is called
+            }
+            {$ENDREGION}
+            function AcquireSharedItemCache(itemIndex: NativeInt;
+                                            const key: UnicodeString): Boolean; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Publishes a fully built sub-model cache in the model cache registry, in order to share
+             it with the next jobs loading the same sub-model with the same options
+             @param(itemIndex Sub-model item index)
+             @param(key Shared cache key)
+            }
+            {$ENDREGION}
+            procedure PublishSharedItemCache(itemIndex: NativeInt;
+                                             const key: UnicodeString); virtual;
+
         public
             {$REGION 'Documentation'}
             {**
@@ -1044,6 +1186,21 @@ type
             {$ENDREGION}
             function IsCanceled: Boolean; virtual;
 
+            {$REGION 'Documentation'}
+            {**
+             Adds a frame mesh and his aligned-axis bounding box tree to the sub-model cache
+             containing it, if the frame is still not cached
+             @param(index Cache index)
+             @param(pMesh Frame mesh)
+             @param(pTree Frame aligned-axis bounding box tree, can be @nil)
+             @return(@true if the frame was added, in which case the cache takes care of the mesh
+                     and tree, @false if the frame was already cached or the cache is shared)
+            }
+            {$ENDREGION}
+            function TryAddFrame(index: NativeUInt;
+                                 pMesh: PQRMesh;
+                                 pTree: TQRAABBTree): Boolean; override;
+
         // Properties
         public
             {$REGION 'Documentation'}
@@ -2512,8 +2669,9 @@ begin
     inherited Create(pGroup, modelOptions);
 
     // create local variables
-    m_TextureLoaded := False;
-    m_IsCanceled    := False;
+    m_TextureLoaded   := False;
+    m_IsCanceled      := False;
+    m_pDecodedTexture := nil;
 
     // copy values needed to load the model
     m_pItemDictionary    :=  TQRMD3ItemDictionary.Create;
@@ -2528,6 +2686,7 @@ end;
 destructor TQRMD3Job.Destroy;
 var
     pItem: TQRMD3ModelItem;
+    i:     NativeInt;
 begin
     m_pLock.Lock;
 
@@ -2538,10 +2697,17 @@ begin
 
         SetLength(m_Items, 0);
 
+        // clear sub-model caches
+        for i := 0 to Length(m_ItemCaches) - 1 do
+            ReleaseItemCache(i);
+
+        SetLength(m_ItemCaches, 0);
+
         // clear memory
         m_pItemDictionary.Free;
         m_pInfo.Free;
         m_pColor.Free;
+        m_pDecodedTexture.Free;
     finally
         m_pLock.Unlock;
     end;
@@ -2591,6 +2757,273 @@ begin
     m_pLock.Unlock;
 end;
 //--------------------------------------------------------------------------------------------------
+function TQRMD3Job.GetItemCache(index: NativeUInt; out localIndex: NativeUInt): PQRMD3ItemCache;
+var
+    i: NativeInt;
+begin
+    localIndex := 0;
+
+    // search for the sub-model cache containing the frame
+    for i := 0 to Length(m_ItemCaches) - 1 do
+        if (Assigned(m_ItemCaches[i].m_pCache)                          and
+            (index >= m_ItemCaches[i].m_Start)                          and
+            (index <  (m_ItemCaches[i].m_Start + m_ItemCaches[i].m_Count)))
+        then
+        begin
+            localIndex := index - m_ItemCaches[i].m_Start;
+            Exit(@m_ItemCaches[i]);
+        end;
+
+    Result := nil;
+end;
+//--------------------------------------------------------------------------------------------------
+procedure TQRMD3Job.ReleaseItemCache(itemIndex: NativeInt);
+begin
+    // is cache shared with other jobs? If yes, just release the job reference on it
+    if (Length(m_ItemCaches[itemIndex].m_SharedKey) > 0) then
+        ReleaseSharedCache(m_ItemCaches[itemIndex].m_SharedKey)
+    else
+        m_ItemCaches[itemIndex].m_pCache.Free;
+
+    m_ItemCaches[itemIndex].m_pCache    := nil;
+    m_ItemCaches[itemIndex].m_SharedKey := '';
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRMD3Job.GetMeshCount: NativeUInt;
+var
+    i: NativeInt;
+begin
+    m_pLock.Lock;
+
+    try
+        Result := inherited GetMeshCount;
+
+        // add the meshes cached in each sub-model cache
+        for i := 0 to Length(m_ItemCaches) - 1 do
+            if (Assigned(m_ItemCaches[i].m_pCache)) then
+                Inc(Result, m_ItemCaches[i].m_pCache.MeshCount);
+    finally
+        m_pLock.Unlock;
+    end;
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRMD3Job.GetAABBTreeCount: NativeUInt;
+var
+    i: NativeInt;
+begin
+    m_pLock.Lock;
+
+    try
+        Result := inherited GetAABBTreeCount;
+
+        // add the trees cached in each sub-model cache
+        for i := 0 to Length(m_ItemCaches) - 1 do
+            if (Assigned(m_ItemCaches[i].m_pCache)) then
+                Inc(Result, m_ItemCaches[i].m_pCache.AABBTreeCount);
+    finally
+        m_pLock.Unlock;
+    end;
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRMD3Job.GetMesh(index: NativeUInt): PQRMesh;
+var
+    pItemCache: PQRMD3ItemCache;
+    localIndex: NativeUInt;
+begin
+    m_pLock.Lock;
+
+    try
+        pItemCache := GetItemCache(index, localIndex);
+
+        // mesh belongs to a sub-model?
+        if (Assigned(pItemCache)) then
+            Exit(pItemCache.m_pCache.Mesh[localIndex]);
+    finally
+        m_pLock.Unlock;
+    end;
+
+    Result := inherited GetMesh(index);
+end;
+//--------------------------------------------------------------------------------------------------
+procedure TQRMD3Job.SetMesh(index: NativeUInt; pMesh: PQRMesh);
+var
+    pItemCache: PQRMD3ItemCache;
+    localIndex: NativeUInt;
+begin
+    m_pLock.Lock;
+
+    try
+        pItemCache := GetItemCache(index, localIndex);
+
+        // mesh belongs to a sub-model?
+        if (Assigned(pItemCache)) then
+        begin
+            // a shared cache is immutable
+            if (Length(pItemCache.m_SharedKey) > 0) then
+                raise Exception.Create('Cannot modify a shared model cache');
+
+            pItemCache.m_pCache.Mesh[localIndex] := pMesh;
+            Exit;
+        end;
+    finally
+        m_pLock.Unlock;
+    end;
+
+    inherited SetMesh(index, pMesh);
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRMD3Job.GetTree(index: NativeUInt): TQRAABBTree;
+var
+    pItemCache: PQRMD3ItemCache;
+    localIndex: NativeUInt;
+begin
+    m_pLock.Lock;
+
+    try
+        pItemCache := GetItemCache(index, localIndex);
+
+        // tree belongs to a sub-model?
+        if (Assigned(pItemCache)) then
+            Exit(pItemCache.m_pCache.AABBTree[localIndex]);
+    finally
+        m_pLock.Unlock;
+    end;
+
+    Result := inherited GetTree(index);
+end;
+//--------------------------------------------------------------------------------------------------
+procedure TQRMD3Job.SetTree(index: NativeUInt; pTree: TQRAABBTree);
+var
+    pItemCache: PQRMD3ItemCache;
+    localIndex: NativeUInt;
+begin
+    m_pLock.Lock;
+
+    try
+        pItemCache := GetItemCache(index, localIndex);
+
+        // tree belongs to a sub-model?
+        if (Assigned(pItemCache)) then
+        begin
+            // a shared cache is immutable
+            if (Length(pItemCache.m_SharedKey) > 0) then
+                raise Exception.Create('Cannot modify a shared model cache');
+
+            pItemCache.m_pCache.AABBTree[localIndex] := pTree;
+            Exit;
+        end;
+    finally
+        m_pLock.Unlock;
+    end;
+
+    inherited SetTree(index, pTree);
+end;
+//--------------------------------------------------------------------------------------------------
+procedure TQRMD3Job.CreateItemCache(itemIndex: NativeInt; start, count: NativeUInt);
+begin
+    m_pLock.Lock;
+
+    try
+        // add the missing sub-model caches
+        if (itemIndex >= Length(m_ItemCaches)) then
+            SetLength(m_ItemCaches, itemIndex + 1);
+
+        // release the previous sub-model cache, if any
+        ReleaseItemCache(itemIndex);
+
+        m_ItemCaches[itemIndex].m_pCache := TQRModelCache.Create;
+        m_ItemCaches[itemIndex].m_Start  := start;
+        m_ItemCaches[itemIndex].m_Count  := count;
+    finally
+        m_pLock.Unlock;
+    end;
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRMD3Job.AcquireSharedItemCache(itemIndex: NativeInt;
+                                          const key: UnicodeString): Boolean;
+var
+    pSharedCache: TQRModelCache;
+begin
+    // search for a cache another job already published with the same key
+    pSharedCache := TQRModelCacheRegistry.GetInstance.Acquire(key);
+
+    // not found?
+    if (not Assigned(pSharedCache)) then
+        Exit(False);
+
+    m_pLock.Lock;
+
+    try
+        // replace the sub-model cache by the shared one
+        ReleaseItemCache(itemIndex);
+        m_ItemCaches[itemIndex].m_pCache    := pSharedCache;
+        m_ItemCaches[itemIndex].m_SharedKey := key;
+    finally
+        m_pLock.Unlock;
+    end;
+
+    Result := True;
+end;
+//--------------------------------------------------------------------------------------------------
+procedure TQRMD3Job.PublishSharedItemCache(itemIndex: NativeInt;
+                                           const key: UnicodeString);
+var
+    pCache: TQRModelCache;
+begin
+    m_pLock.Lock;
+
+    try
+        // cache is already shared?
+        if (Length(m_ItemCaches[itemIndex].m_SharedKey) > 0) then
+            Exit;
+
+        pCache := m_ItemCaches[itemIndex].m_pCache;
+
+        // publish the cache, from now the registry will take care of it
+        if (TQRModelCacheRegistry.GetInstance.Publish(key, pCache)) then
+            m_ItemCaches[itemIndex].m_SharedKey := key;
+    finally
+        m_pLock.Unlock;
+    end;
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRMD3Job.TryAddFrame(index: NativeUInt;
+                               pMesh: PQRMesh;
+                               pTree: TQRAABBTree): Boolean;
+var
+    pItemCache: PQRMD3ItemCache;
+    localIndex: NativeUInt;
+begin
+    m_pLock.Lock;
+
+    try
+        pItemCache := GetItemCache(index, localIndex);
+
+        // frame belongs to a sub-model?
+        if (Assigned(pItemCache)) then
+        begin
+            // a shared cache is immutable
+            if (Length(pItemCache.m_SharedKey) > 0) then
+                Exit(False);
+
+            // frame already cached? Never replace it, because it may be drawn
+            if (Assigned(pItemCache.m_pCache.Mesh[localIndex])) then
+                Exit(False);
+
+            pItemCache.m_pCache.Mesh[localIndex] := pMesh;
+
+            if (Assigned(pTree)) then
+                pItemCache.m_pCache.AABBTree[localIndex] := pTree;
+
+            Exit(True);
+        end;
+    finally
+        m_pLock.Unlock;
+    end;
+
+    Result := inherited TryAddFrame(index, pMesh, pTree);
+end;
+//--------------------------------------------------------------------------------------------------
 procedure TQRMD3Job.LinkModel;
 var
     itemCount, tagCount, targetTagCount, srcIndex, dstIndex, i, j, k, l, m: NativeUInt;
@@ -2756,6 +3189,9 @@ begin
                 m_pLock.Unlock;
             end;
 
+            // decode texture on the job thread, thus only its upload is left to the main thread
+            DecodeTextures;
+
             // notify main interface that texture should be loaded, wait until function returns
             TThread.Synchronize(nil, OnLoadTexture);
 
@@ -2812,6 +3248,9 @@ begin
                 m_pLock.Unlock;
             end;
 
+            // decode texture on the job thread, thus only its upload is left to the main thread
+            DecodeTextures;
+
             // notify main interface that texture should be loaded, wait until function returns
             TThread.Synchronize(nil, OnLoadTexture);
 
@@ -2937,6 +3376,40 @@ begin
     Result := True;
 end;
 //--------------------------------------------------------------------------------------------------
+procedure TQRMD3Job.DecodeTextures;
+var
+    pTexture: TQRTexture;
+    pBitmap:  Graphics.TBitmap;
+begin
+    pTexture := TQRTexture.Create;
+
+    try
+        m_pLock.Lock;
+
+        try
+            // notify that a texture is about to be decoded
+            BeforeLoadTexture(pTexture, False);
+        finally
+            m_pLock.Unlock;
+        end;
+
+        // decode texture
+        pBitmap := DecodeTexture(pTexture);
+    finally
+        pTexture.Free;
+    end;
+
+    m_pLock.Lock;
+
+    try
+        // keep the decoded texture until the OnLoadTexture() function receives it
+        m_pDecodedTexture.Free;
+        m_pDecodedTexture := pBitmap;
+    finally
+        m_pLock.Unlock;
+    end;
+end;
+//--------------------------------------------------------------------------------------------------
 procedure TQRMD3Job.OnLoadTexture;
 var
     max:                 NativeUInt;
@@ -2983,11 +3456,13 @@ begin
                 // others are user defined textures)
                 if (loadFirst) then
                 begin
-                    pTexture := Graphics.TBitmap.Create;
+                    // get the texture decoded on the job thread, and take its ownership
+                    pTexture          := m_pDecodedTexture;
+                    m_pDecodedTexture := nil;
 
                     try
-                        // load texture
-                        if (LoadTexture(pModelTexture, pTexture)) then
+                        // was texture decoded?
+                        if (Assigned(pTexture)) then
                         begin
                             // notify that a texture is loading
                             if (Assigned(m_fOnLoadTexture)) then
@@ -3044,6 +3519,9 @@ begin
 
         m_TextureLoaded := True;
     finally
+        // delete the decoded texture if it was not received, e.g. if the job was canceled
+        FreeAndNil(m_pDecodedTexture);
+
         m_pLock.Unlock;
     end;
 end;
@@ -3171,13 +3649,16 @@ end;
 function TQRLoadMD3FileJob.Process: Boolean;
 var
     vertexFormat:                                         TQRVertexFormat;
-    pMesh:                                                PQRMesh;
-    pTree:                                                TQRAABBTree;
+    pTreeBuilder:                                         TQRAABBTreeBuilder;
     modelName, modelFileName, skinFileName, animFileName: TFileName;
     subModelGroupCount:                                   NativeInt;
-    frameCount, cacheIndex, i, j:                         NativeUInt;
-    progressStep, totalItemStep, totalStep:               Single;
+    frameCount, cacheIndex, i:                            NativeUInt;
+    progressStep, totalItemStep, totalStep, meshStep:     Single;
     textureLoaded, doCreateCache:                         Boolean;
+    doCacheTrees, treesLoaded, doShareCache:              Boolean;
+    treeCacheName:                                        TFileName;
+    treeCacheKey:                                         TQRUInt32;
+    sharedCacheKey:                                       UnicodeString;
 begin
     // if job was still loaded, don't reload it
     if (IsLoaded) then
@@ -3263,6 +3744,9 @@ begin
             // get mesh count
             frameCount := m_Items[i].m_pModel.GetMeshCount;
 
+            // create the cache the sub-model frames will be added to
+            CreateItemCache(i, cacheIndex, frameCount);
+
             // do create cache?
             if (doCreateCache) then
                 // calculate step count
@@ -3362,59 +3846,115 @@ begin
                 // keep index from where item frames will be added in cache
                 m_Items[i].m_CacheIndex := cacheIndex;
 
-                // iterate through frames to cache
-                for j := 0 to frameCount - 1 do
+                // search for frames another job already built from the same sub-model with the
+                // same options, and share them instead of building them again
+                doShareCache := GetSharedCacheKey(modelFileName,
+                                                  '',
+                                                  m_pColor,
+                                                  nil,
+                                                  False,
+                                                  vertexFormat,
+                                                  sharedCacheKey);
+
+                if (doShareCache and AcquireSharedItemCache(i, sharedCacheKey)) then
                 begin
-                    // create mesh
-                    New(pMesh);
-
-                    // do ignore collisions?
-                    if (not(EQR_MO_No_Collision in ModelOptions)) then
-                        // create AABB tree
-                        pTree := TQRAABBTree.Create
-                    else
-                        pTree := nil;
-
-                    // get current mesh
-                    if (not m_Items[i].m_pModel.GetMesh(j, pMesh^, pTree, IsCanceled)) then
+                    // update next available cache index position
+                    Inc(cacheIndex, frameCount);
+
+                    // sub-model frames are shared, add their steps to progress
+                    Progress := Progress + (frameCount * progressStep);
+                    continue;
+                end;
+
+                // do cache the collision trees in a file? If yes, try to load them from this file,
+                // in which case they don't need to be built again
+                doCacheTrees := ((EQR_MO_Cache_Collisions in ModelOptions) and
+                             not (EQR_MO_No_Collision     in ModelOptions));
+                treesLoaded  := False;
+
+                if (doCacheTrees) then
+                begin
+                    treeCacheName := modelFileName + QR_AABB_Cache_File_Ext;
+                    doCacheTrees  := GetTreeCacheKey(modelFileName, False, treeCacheKey);
+                    treesLoaded   := (doCacheTrees and LoadTrees(treeCacheName,
+                                                                 treeCacheKey,
+                                                                 m_Items[i].m_CacheIndex,
+                                                                 frameCount));
+                end;
+
+                // do ignore collisions or were the trees loaded? If not, each frame step is shared
+                // between the mesh and the tree
+                if ((EQR_MO_No_Collision in ModelOptions) or treesLoaded) then
+                    meshStep := progressStep
+                else
+                    meshStep := (progressStep / 2.0);
+
+                pTreeBuilder := TQRAABBTreeBuilder.Create;
+
+                try
+                    // do refit the frame trees from the first one?
+                    pTreeBuilder.Refit := (EQR_MO_Refit_Collisions in ModelOptions);
+
+                    // generate the frames to cache, several at once, and build their
+                    // aligned-axis bounding box trees meanwhile
+                    if (not CacheFrames(m_Items[i].m_pModel,
+                                        frameCount,
+                                        m_Items[i].m_CacheIndex,
+                                        True,
+                                        ((not(EQR_MO_No_Collision in ModelOptions)) and
+                                         (not treesLoaded)),
+                                        pTreeBuilder,
+                                        meshStep,
+                                        progressStep - meshStep,
+                                        IsCanceled))
+                    then
                     begin
                         {$ifdef DEBUG}
                             TQRLogHelper.LogToCompiler('MD3 model frame creation failed or was canceled - name - ' +
                                                        modelFileName                                               +
-                                                       ' - index - '                                               +
-                                                       IntToStr(Int64(j))                                          +
                                                        ' - class name - '                                          +
                                                        ClassName);
                         {$endif}
 
-                        // failed or canceled?
-                        Dispose(pMesh);
-                        pTree.Free;
                         Exit(False);
                     end;
 
-                    // add mesh to cache, note that from now cache will take care of the pointer
-                    try
-                        SetMesh(m_Items[i].m_CacheIndex + j, pMesh);
-                    except
-                        Dispose(pMesh);
-                    end;
-
-                    // do ignore collisions?
-                    if (not(EQR_MO_No_Collision in ModelOptions)) then
-                        // add tree to cache, note that from now cache will take care of the pointer
-                        try
-                            SetTree(m_Items[i].m_CacheIndex + j, pTree);
-                        except
-                            pTree.Free;
-                        end;
-
                     // update next available cache index position
-                    Inc(cacheIndex);
+                    Inc(cacheIndex, frameCount);
+
+                    // add the aligned-axis bounding box trees to cache
+                    if (not BuildTrees(pTreeBuilder,
+                                       m_Items[i].m_CacheIndex,
+                                       progressStep - meshStep,
+                                       IsCanceled))
+                    then
+                    begin
+                        {$ifdef DEBUG}
+                            TQRLogHelper.LogToCompiler('MD3 model trees creation failed or was canceled - name - ' +
+                                                       modelFileName                                               +
+                                                       ' - class name - '                                          +
+                                                       ClassName);
+                        {$endif}
+
+                        Exit(False);
+                    end;
 
-                    // a new frame was cached, add one step to progress
-                    Progress := Progress + progressStep;
+                    // save the newly built trees in the cache file, in order to skip their build on
+                    // the next opening. NOTE failing to save them isn't an error, e.g. if the model
+                    // dir is read-only
+                    if (doCacheTrees and (not treesLoaded)) then
+                        SaveTrees(treeCacheName,
+                                  treeCacheKey,
+                                  m_Items[i].m_CacheIndex,
+                                  frameCount);
+                finally
+                    pTreeBuilder.Free;
                 end;
+
+                // publish the newly built sub-model frames, in order to share them with the next
+                // jobs loading the same sub-model with the same options
+                if (doShareCache) then
+                    PublishSharedItemCache(i, sharedCacheKey);
             end;
         end;
 
@@ -3572,12 +4112,11 @@ function TQRLoadMD3MemoryDirJob.Process: Boolean;
 var
     pModelStream, pSkinStream, pAnimCfgStream:            TStream;
     vertexFormat:                                         TQRVertexFormat;
-    pMesh:                                                PQRMesh;
-    pTree:                                                TQRAABBTree;
+    pTreeBuilder:                                         TQRAABBTreeBuilder;
     modelName, modelFileName, skinFileName, animFileName: TFileName;
     subModelGroupCount:                                   NativeInt;
-    frameCount, cacheIndex, i, j:                         NativeUInt;
-    progressStep, totalItemStep, totalStep:               Single;
+    frameCount, cacheIndex, i:                            NativeUInt;
+    progressStep, totalItemStep, totalStep, meshStep:     Single;
     textureLoaded, doCreateCache:                         Boolean;
 begin
     // if job was still loaded, don't reload it
@@ -3680,6 +4219,9 @@ begin
             // get mesh count
             frameCount := m_Items[i].m_pModel.GetMeshCount;
 
+            // create the cache the sub-model frames will be added to
+            CreateItemCache(i, cacheIndex, frameCount);
+
             // do create cache?
             if (doCreateCache) then
                 // calculate step count
@@ -3794,58 +4336,63 @@ begin
                 // keep index from where item frames will be added in cache
                 m_Items[i].m_CacheIndex := cacheIndex;
 
-                // iterate through frames to cache
-                for j := 0 to frameCount - 1 do
-                begin
-                    // create mesh
-                    New(pMesh);
-
-                    // do ignore collisions?
-                    if (not(EQR_MO_No_Collision in ModelOptions)) then
-                        // create AABB tree
-                        pTree := TQRAABBTree.Create
-                    else
-                        pTree := nil;
-
-                    // get current mesh
-                    if (not m_Items[i].m_pModel.GetMesh(j, pMesh^, pTree, IsCanceled)) then
+                // do ignore collisions? If not, each frame step is shared between the mesh and
+                // the tree
+                if (EQR_MO_No_Collision in ModelOptions) then
+                    meshStep := progressStep
+                else
+                    meshStep := (progressStep / 2.0);
+
+                pTreeBuilder := TQRAABBTreeBuilder.Create;
+
+                try
+                    // do refit the frame trees from the first one?
+                    pTreeBuilder.Refit := (EQR_MO_Refit_Collisions in ModelOptions);
+
+                    // generate the frames to cache, several at once, and build their
+                    // aligned-axis bounding box trees meanwhile
+                    if (not CacheFrames(m_Items[i].m_pModel,
+                                        frameCount,
+                                        m_Items[i].m_CacheIndex,
+                                        True,
+                                        not(EQR_MO_No_Collision in ModelOptions),
+                                        pTreeBuilder,
+                                        meshStep,
+                                        progressStep - meshStep,
+                                        IsCanceled))
+                    then
                     begin
                         {$ifdef DEBUG}
                             TQRLogHelper.LogToCompiler('MD3 model frame creation failed or was canceled - name - ' +
                                                        modelFileName                                               +
-                                                       ' - index - '                                               +
-                                                       IntToStr(Int64(j))                                          +
                                                        ' - class name - '                                          +
                                                        ClassName);
                         {$endif}
 
-                        // failed or canceled?
-                        Dispose(pMesh);
-                        pTree.Free;
                         Exit(False);
                     end;
 
-                    // add mesh to cache, note that from now cache will take care of the pointer
-                    try
-                        SetMesh(m_Items[i].m_CacheIndex + j, pMesh);
-                    except
-                        Dispose(pMesh);
-                    end;
-
-                    // do ignore collisions?
-                    if (not(EQR_MO_No_Collision in ModelOptions)) then
-                        // add tree to cache, note that from now cache will take care of the pointer
-                        try
-                            SetTree(m_Items[i].m_CacheIndex + j, pTree);
-                        except
-                            pTree.Free;
-                        end;
-
                     // update next available cache index position
-                    Inc(cacheIndex);
+                    Inc(cacheIndex, frameCount);
+
+                    // add the aligned-axis bounding box trees to cache
+                    if (not BuildTrees(pTreeBuilder,
+                                       m_Items[i].m_CacheIndex,
+                                       progressStep - meshStep,
+                                       IsCanceled))
+                    then
+                    begin
+                        {$ifdef DEBUG}
+                            TQRLogHelper.LogToCompiler('MD3 model trees creation failed or was canceled - name - ' +
+                                                       modelFileName                                               +
+                                                       ' - class name - '                                          +
+                                                       ClassName);
+                        {$endif}
 
-                    // a new frame was cached, add one step to progress
-                    Progress := Progress + progressStep;
+                        Exit(False);
+                    end;
+                finally
+                    pTreeBuilder.Free;
                 end;
             end;
         end;
@@ -4314,6 +4861,9 @@ end;
 //--------------------------------------------------------------------------------------------------
 destructor TQRMD3Group.Destroy;
 begin
+    // cancel the frame prefetches, they use the job
+    CancelPrefetch;
+
     // delete model and his associated job, don't forget to unregister it from worker
     if (Assigned(m_pJob)) then
     begin
@@ -4461,12 +5011,12 @@ begin
     useCollisions := not (EQR_MO_No_Collision in m_pJob.ModelOptions);
 
     // get mesh from cache
-    pMesh := m_pJob.Mesh[pItem.m_CacheIndex + pItem.m_pAnimation.FrameIndex];
+    pMesh := m_pJob.Mesh[pItem.m_CacheIndex + index];
 
     // do create collision buffers?
     if (useCollisions) then
         // get AABB tree from cache
-        pTree := m_pJob.AABBTree[pItem.m_CacheIndex + pItem.m_pAnimation.FrameIndex];
+        pTree := m_pJob.AABBTree[pItem.m_CacheIndex + index];
 
     // found in cache?
     if (Assigned(pMesh) and ((not useCollisions) or Assigned(pTree))) then
@@ -4481,7 +5031,7 @@ begin
         pTree := TQRAABBTree.Create;
 
     // get mesh and calculate AABB tree, if needed
-    if (not pItem.m_pModel.GetMesh(pItem.m_pAnimation.FrameIndex,
+    if (not pItem.m_pModel.GetMesh(index,
                                    pMesh^,
                                    pTree,
                                    TQRIsCanceledEvent(nil)))
@@ -4489,7 +5039,7 @@ begin
     begin
         {$ifdef DEBUG}
             TQRLogHelper.LogToCompiler('MD3 model frame creation failed - index - ' +
-                                       IntToStr(pItem.m_pAnimation.FrameIndex)      +
+                                       IntToStr(index)                              +
                                        ' - class name - '                           +
                                        ClassName);
         {$endif}
@@ -4497,31 +5047,28 @@ begin
         // failed?
         Dispose(pMesh);
         pTree.Free;
+        pMesh := nil;
+        pTree := nil;
         Exit;
     end;
 
-    // add meshes to cache, note that from now cache will take care of the pointer
-    try
-        m_pJob.Mesh[pItem.m_CacheIndex + index] := pMesh;
-    except
-        Dispose(pMesh);
-    end;
+    // add mesh and tree to cache, note that from now cache will take care of the pointers
+    if (m_pJob.TryAddFrame(pItem.m_CacheIndex + index, pMesh, pTree)) then
+        Exit;
 
-    // do create collision buffers?
-    if (useCollisions) then
-        // add tree to cache, note that from now cache will take care of the pointer
-        try
-            m_pJob.AABBTree[pItem.m_CacheIndex + index] := pTree;
-        except
-            pTree.Free;
-        end;
+    // the frame was prefetched meanwhile, use the cached one
+    Dispose(pMesh);
+    pTree.Free;
+
+    pMesh := m_pJob.Mesh[pItem.m_CacheIndex + index];
+    pTree := m_pJob.AABBTree[pItem.m_CacheIndex + index];
 end;
 //--------------------------------------------------------------------------------------------------
 procedure TQRMD3Group.DrawDynamicModel(const pItem: TQRMD3ModelItem; const matrix: TQRMatrix4x4);
 var
     pMesh, pNextMesh: PQRMesh;
-    interpolatedMesh: TQRMesh;
     pTree, pNextTree: TQRAABBTree;
+    pAnimItem:        TQRMD3AnimationItem;
 begin
     // nothing to draw?
     if (not Assigned(OnDrawItem)) then
@@ -4545,7 +5092,7 @@ begin
             pItem.m_pModel.GetMesh(pItem.m_pAnimation.FrameIndex,
                                    pItem.m_pAnimation.InterpolationFrameIndex,
                                    pItem.m_pAnimation.InterpolationFactor,
-                                   interpolatedMesh,
+                                   pItem.m_InterpolatedMesh,
                                    TQRIsCanceledEvent(nil));
 
             // draw mesh
@@ -4556,7 +5103,7 @@ begin
                        pItem.m_pAnimation.FrameIndex,
                        pItem.m_pAnimation.InterpolationFrameIndex,
                        pItem.m_pAnimation.InterpolationFactor,
-                       @interpolatedMesh,
+                       @pItem.m_InterpolatedMesh,
                        nil,
                        nil,
                        nil);
@@ -4592,6 +5139,20 @@ begin
         Exit;
     end;
 
+    // start to generate the next frames of the running gesture in background, in order that they
+    // are already cached when drawn
+    if ((pItem.m_Gesture < EQR_AG_MD3_Max_Animations) and
+        pItem.m_pAnimations.TryGetValue(pItem.m_Gesture, pAnimItem) and
+        Assigned(pAnimItem))
+    then
+        PrefetchFrames(m_pJob,
+                       pItem.m_pModel,
+                       pItem.m_CacheIndex,
+                       pItem.m_pAnimation.FrameIndex,
+                       pAnimItem.m_StartFrame,
+                       pAnimItem.m_EndFrame,
+                       pAnimItem.m_Loop);
+
     // get meshes and AABB trees from cache, create them if still not exist
     GetDynamicMeshUseCache(pItem, pItem.m_pAnimation.FrameIndex,              pMesh,     pTree);
     GetDynamicMeshUseCache(pItem, pItem.m_pAnimation.InterpolationFrameIndex, pNextMesh, pNextTree);
@@ -4600,10 +5161,10 @@ begin
     if (EQR_FO_Interpolate in m_pJob.FramedModelOptions) then
     begin
         // interpolate meshes
-        TQRModelHelper.Interpolate(pItem.m_pAnimation.InterpolationFactor,
-                                   pMesh^,
-                                   pNextMesh^,
-                                   interpolatedMesh);
+        TQRModelHelper.InterpolateTo(pItem.m_pAnimation.InterpolationFactor,
+                                     pMesh^,
+                                     pNextMesh^,
+                                     pItem.m_InterpolatedMesh);
 
         // draw mesh
         OnDrawItem(Self,
@@ -4613,7 +5174,7 @@ begin
                    pItem.m_pAnimation.FrameIndex,
                    pItem.m_pAnimation.InterpolationFrameIndex,
                    pItem.m_pAnimation.InterpolationFactor,
-                   @interpolatedMesh,
+                   @pItem.m_InterpolatedMesh,
                    nil,
                    pTree,
                    pNextTree);
@@ -4634,8 +5195,6 @@ begin
 end;
 //--------------------------------------------------------------------------------------------------
 procedure TQRMD3Group.DrawCachedModel(const pItem: TQRMD3ModelItem; const matrix: TQRMatrix4x4);
-var
-    interpolatedMesh: TQRMesh;
 begin
     // nothing to draw?
     if (not Assigned(OnDrawItem)) then
@@ -4656,10 +5215,10 @@ begin
         if (EQR_FO_Interpolate in m_pJob.FramedModelOptions) then
         begin
             // interpolate meshes
-            TQRModelHelper.Interpolate(pItem.m_pAnimation.InterpolationFactor,
-                                       m_pJob.Mesh[pItem.m_CacheIndex + pItem.m_pAnimation.FrameIndex]^,
-                                       m_pJob.Mesh[pItem.m_CacheIndex + pItem.m_pAnimation.InterpolationFrameIndex]^,
-                                       interpolatedMesh);
+            TQRModelHelper.InterpolateTo(pItem.m_pAnimation.InterpolationFactor,
+                                         m_pJob.Mesh[pItem.m_CacheIndex + pItem.m_pAnimation.FrameIndex]^,
+                                         m_pJob.Mesh[pItem.m_CacheIndex + pItem.m_pAnimation.InterpolationFrameIndex]^,
+                                         pItem.m_InterpolatedMesh);
 
             // draw mesh
             OnDrawItem(Self,
@@ -4669,7 +5228,7 @@ begin
                        pItem.m_pAnimation.FrameIndex,
                        pItem.m_pAnimation.InterpolationFrameIndex,
                        pItem.m_pAnimation.InterpolationFactor,
-                       @interpolatedMesh,
+                       @pItem.m_InterpolatedMesh,
                        nil,
                        nil,
                        nil);
@@ -4693,10 +5252,10 @@ begin
     if (EQR_FO_Interpolate in m_pJob.FramedModelOptions) then
     begin
         // interpolate meshes
-        TQRModelHelper.Interpolate(pItem.m_pAnimation.InterpolationFactor,
-                                   m_pJob.Mesh[pItem.m_CacheIndex + pItem.m_pAnimation.FrameIndex]^,
-                                   m_pJob.Mesh[pItem.m_CacheIndex + pItem.m_pAnimation.InterpolationFrameIndex]^,
-                                   interpolatedMesh);
+        TQRModelHelper.InterpolateTo(pItem.m_pAnimation.InterpolationFactor,
+                                     m_pJob.Mesh[pItem.m_CacheIndex + pItem.m_pAnimation.FrameIndex]^,
+                                     m_pJob.Mesh[pItem.m_CacheIndex + pItem.m_pAnimation.InterpolationFrameIndex]^,
+                                     pItem.m_InterpolatedMesh);
 
         // draw mesh
         OnDrawItem(Self,
@@ -4706,7 +5265,7 @@ begin
                    pItem.m_pAnimation.FrameIndex,
                    pItem.m_pAnimation.InterpolationFrameIndex,
                    pItem.m_pAnimation.InterpolationFactor,
-                   @interpolatedMesh,
+                   @pItem.m_InterpolatedMesh,
                    nil,
                    m_pJob.AABBTree[pItem.m_CacheIndex + pItem.m_pAnimation.FrameIndex],
                    m_pJob.AABBTree[pItem.m_CacheIndex + pItem.m_pAnimation.InterpolationFrameIndex])
@@ -4902,6 +5461,9 @@ end;
 //--------------------------------------------------------------------------------------------------
 procedure TQRMD3Group.Clear;
 begin
+    // cancel the frame prefetches, they use the job
+    CancelPrefetch;
+
     // delete model and his associated job, don't forget to unregister it from worker
     if (Assigned(m_pJob)) then
     begin
@@ -5086,6 +5648,10 @@ begin
         pItem.m_pAnimation.InterpolationFactor     := 0.0;
     end;
 
+    // the running frame prefetches may target the previous gesture
+    if (pItem.m_Gesture <> gesture) then
+        CancelPrefetch;
+
     // change sub-model gesture
     pItem.m_Gesture := gesture;
 
@@ -35,18 +35,31 @@ uses Classes,
      SysUtils,
      Generics.Collections,
      Math,
+     SyncObjs,
      Graphics,
      Windows,
      UTQRDesignPatterns,
+     UTQRCommon,
      UTQRFiles,
      UTQRGeometry,
      UTQR3D,
+     UTQRGraphics,
+     UTQRLight,
      UTQRCollision,
      UTQRHelpers,
      UTQRModel,
      UTQRThreading,
      UTQRVCLHelpers;
 
+const
+    {$REGION 'Documentation'}
+    {**
+     Frame count each thread generates in a batch, when the frames and their aligned-axis bounding
+     box trees are cached together
+    }
+    {$ENDREGION}
+    QR_Frames_Per_Thread_Batch = 4;
+
 type
     // TODO clear model parser when fully cached, also clear in-memory normals table
 
@@ -121,6 +134,36 @@ type
                                     be omitted while the vertex buffer is generated)
      @value(EQR_MO_Without_Colors If the model contains this option, the vertex colors will be
                                   omitted while the vertex buffer is generated)
+     @value(EQR_MO_Refit_Collisions If the model contains this option, only the collision tree of
+                                    the first cached frame is populated, and the trees of the other
+                                    frames are refitted from it. This reduces the opening time, but
+                                    the collision detection may be slower on frames that differ
+                                    much from the first one)
+     @value(EQR_MO_Cache_Collisions If the model contains this option, the collision trees are saved
+                                    in a cache file next to the model file once built, and loaded
+                                    from this file on the next openings instead of being built
+                                    again. The cache file is ignored and replaced if the model file
+                                    changed. @bold(NOTE) This option is only applied to the models
+                                    opened from a file)
+     @value(EQR_MO_Indexed_Meshes If the model contains this option, each frame is generated as a
+                                  single indexed triangle list, whose topology is built once and
+                                  shared by all the frames, instead of a vertex buffer per triangle
+                                  strip or fan. This reduces the draw call count and the frame size.
+                                  @bold(NOTE) This option is only applied to the MD2 models, the
+                                  other models are already generated as triangle lists)
+     @value(EQR_MO_Compress_Cache If the model contains this option in addition to the
+                                  EQR_MO_Create_Cache option, the frames aren't expanded in the
+                                  cache, but kept in the model native quantized form (i.e. the
+                                  compressed vertices and normal indices), and decompressed on the
+                                  fly while drawn. Only the collision trees are cached. This reduces
+                                  the memory used by each model instance a lot, but impacts on the
+                                  drawing time. @bold(NOTE) This option is only applied to the MD2
+                                  and MDL models. The EQR_FO_Start_Anim_When_Gesture_Is_Ready option
+                                  is ignored if this option is used)
+     @value(EQR_MO_Power_Of_2_Textures If the model contains this option, the textures belonging to
+                                       the model are resized to the closest power of 2 size while
+                                       they are decoded on the job thread, thus the bitmap received
+                                       by the OnLoadTexture event may be uploaded as is)
     }
     {$ENDREGION}
     EQRModelOptions =
@@ -131,7 +174,12 @@ type
         EQR_MO_Dynamic_Frames_No_Cache,
         EQR_MO_Without_Normals,
         EQR_MO_Without_Textures,
-        EQR_MO_Without_Colors
+        EQR_MO_Without_Colors,
+        EQR_MO_Refit_Collisions,
+        EQR_MO_Cache_Collisions,
+        EQR_MO_Indexed_Meshes,
+        EQR_MO_Compress_Cache,
+        EQR_MO_Power_Of_2_Textures
     );
 
     {$REGION 'Documentation'}
@@ -200,6 +248,10 @@ type
     // model job status class prototype
     TQRModelJobStatus = class;
 
+    // model job and frame prefetch job class prototypes
+    TQRModelJob         = class;
+    TQRFramePrefetchJob = class;
+
     {$REGION 'Documentation'}
     {**
      Model group helper, contains some common function used by models
@@ -248,6 +300,7 @@ type
             m_SwapYZ:                 Boolean;
             m_CombinationType:        EQRModelMatrixCombinationType;
             m_pInitialMatrix:         PQRMatrix4x4;
+            m_JobPriority:            NativeInt;
             m_fOnLoadTexture:         TQRLoadMeshTextureEvent;
             m_fOnAfterLoadModelEvent: TQRAfterLoadModelEvent;
 
@@ -494,6 +547,15 @@ type
             {$ENDREGION}
             property InitialMatrix: PQRMatrix4x4 read GetInitialMatrix write SetInitialMatrix default nil;
 
+            {$REGION 'Documentation'}
+            {**
+             Gets or sets the priority of the jobs started by the group. The model workers process
+             the jobs with the highest priority first, and the jobs with the same priority in the
+             order they were started
+            }
+            {$ENDREGION}
+            property JobPriority: NativeInt read m_JobPriority write m_JobPriority default 0;
+
             {$REGION 'Documentation'}
             {**
              Gets or sets the OnLoadMeshTexture event
@@ -875,11 +937,13 @@ type
     {$ENDREGION}
     TQRFramedModelGroup = class(TQRModelGroup)
         private
-            m_Paused:            Boolean;
-            m_ForceLoop:         Boolean;
-            m_fOnDrawItem:       TQRDrawFramedModelItemEvent;
-            m_fOnCustomDrawItem: TQRDrawCustomFramedModelItemEvent;
-            m_fOnAnimEnd:        TQRFramedModelAnimEndEvent;
+            m_Paused:             Boolean;
+            m_ForceLoop:          Boolean;
+            m_pPrefetchJobs:      TDictionary<NativeUInt, TQRFramePrefetchJob>;
+            m_PrefetchFrameCount: NativeUInt;
+            m_fOnDrawItem:        TQRDrawFramedModelItemEvent;
+            m_fOnCustomDrawItem:  TQRDrawCustomFramedModelItemEvent;
+            m_fOnAnimEnd:         TQRFramedModelAnimEndEvent;
 
         protected
             {$REGION 'Documentation'}
@@ -919,6 +983,36 @@ type
             {$ENDREGION}
             function ValidateIndex(index, startIndex, endIndex: NativeInt): NativeInt; virtual;
 
+            {$REGION 'Documentation'}
+            {**
+             Starts to generate in background the next frames the running animation will draw, in
+             order that they are already cached when drawn
+             @param(pJob Job containing the model cache)
+             @param(pModel Model or sub-model from which the frames are generated)
+             @param(cacheIndex Cache index of the model first frame)
+             @param(frameIndex Frame index currently drawn)
+             @param(startIndex Animation start index)
+             @param(endIndex Animation end index)
+             @param(loop If @true, animation loops at end)
+             @br @bold(NOTE) Nothing is done while a previous prefetch of the same model is still
+                             running, or if all the next frames are already cached
+            }
+            {$ENDREGION}
+            procedure PrefetchFrames(pJob: TQRModelJob;
+                                   pModel: TQRFramedModel;
+                               cacheIndex: NativeUInt;
+         frameIndex, startIndex, endIndex: NativeUInt;
+                                     loop: Boolean); virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Cancels the running frame prefetches
+             @br @bold(NOTE) This function should be called before the job containing the model
+                             cache is deleted
+            }
+            {$ENDREGION}
+            procedure CancelPrefetch; virtual;
+
         public
             {$REGION 'Documentation'}
             {**
@@ -950,6 +1044,15 @@ type
             {$ENDREGION}
             property ForceLoop: Boolean read m_ForceLoop write m_ForceLoop default True;
 
+            {$REGION 'Documentation'}
+            {**
+             Gets or sets the frame count to generate ahead of the running animation, when the
+             frames are created and cached while drawn (i.e. when the EQR_MO_Dynamic_Frames option
+             is set without the EQR_MO_Dynamic_Frames_No_Cache option). 0 disables the prefetch
+            }
+            {$ENDREGION}
+            property PrefetchFrameCount: NativeUInt read m_PrefetchFrameCount write m_PrefetchFrameCount default 8;
+
             {$REGION 'Documentation'}
             {**
              Gets or sets the OnDrawItem event
@@ -1032,8 +1135,11 @@ type
         private
             m_pGroup:                 TQRModelGroup;
             m_pCache:                 TQRModelCache;
+            m_SharedCacheKey:         UnicodeString;
             m_ModelOptions:           TQRModelOptions;
             m_Progress:               Single;
+            m_TreeProgressStep:       Single;
+            m_FrameProgressStep:      Single;
             m_IsLoaded:               Boolean;
             m_TextureExt:             array [0..6] of UnicodeString;
             m_fOnAfterLoadModelEvent: TQRAfterLoadModelEvent;
@@ -1088,6 +1194,7 @@ type
              @param(pMesh Mesh)
              @br @bold(NOTE) Be careful, the internal cache will take the mesh ownership, so don't
                              try to delete it externally
+             @raises(Exception if the cache is shared with other jobs)
             }
             {$ENDREGION}
             procedure SetMesh(index: NativeUInt; pMesh: PQRMesh); virtual;
@@ -1108,10 +1215,188 @@ type
              @param(pTree Tree)
              @br @bold(NOTE) Be careful, the internal cache will take the tree ownership, so don't
                              try to delete it externally
+             @raises(Exception if the cache is shared with other jobs)
             }
             {$ENDREGION}
             procedure SetTree(index: NativeUInt; pTree: TQRAABBTree); virtual;
 
+            {$REGION 'Documentation'}
+            {**
+             Builds the aligned-axis bounding box trees still pending in a builder, several at once,
+             and adds all the builder trees to the cache
+             @param(pBuilder Builder containing the trees to build)
+             @param(firstIndex Cache index of the first tree, the next trees are added to the
+                               following indices)
+             @param(progressStep Progress step to add each time a tree is built)
+             @param(hIsCanceled Callback function that allows to break the operation, can be @nil)
+             @return(@true on success, otherwise @false)
+            }
+            {$ENDREGION}
+            function BuildTrees(pBuilder: TQRAABBTreeBuilder;
+                              firstIndex: NativeUInt;
+                            progressStep: Single;
+                             hIsCanceled: TQRIsCanceledEvent): Boolean; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Called when an aligned-axis bounding box tree was built
+             @param(pTree Built tree)
+             @param(builtCount Tree count already built)
+             @param(totalCount Total tree count to build)
+            }
+            {$ENDREGION}
+            procedure OnTreeBuilt(pTree: TQRAABBTree; builtCount, totalCount: NativeUInt); virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Generates the frames of a model, several at once, and adds them to the cache
+             @param(pModel Model from which the frames are generated)
+             @param(frameCount Frame count to generate, starting from the model first frame)
+             @param(cacheIndex Cache index of the first frame, the next frames are added to the
+                               following indices)
+             @param(keepMeshes If @true, the frame meshes are added to the cache, otherwise they are
+                               only generated to get their collision polygons)
+             @param(addTrees If @true, an aligned-axis bounding box tree is added to the tree builder
+                             for each frame, from the frame collision polygons)
+             @param(pTreeBuilder Builder to add the frame trees to, ignored if addTrees is @false)
+             @param(progressStep Progress step to add each time a frame is generated)
+             @param(treeProgressStep Progress step to add each time a frame tree is built)
+             @param(hIsCanceled Callback function that allows to break the operation, can be @nil)
+             @return(@true on success, otherwise @false)
+             @br @bold(NOTE) If trees are added, the frames are generated by batches, and the trees
+                             of each batch are built before the next batch is generated. Thus only
+                             the collision polygons of a batch are kept in memory at once. The
+                             built trees remain in the builder, in the frame order, and should be
+                             added to the cache later by calling BuildTrees
+            }
+            {$ENDREGION}
+            function CacheFrames(pModel: TQRFramedModel;
+                             frameCount: NativeUInt;
+                             cacheIndex: NativeUInt;
+                   keepMeshes, addTrees: Boolean;
+                           pTreeBuilder: TQRAABBTreeBuilder;
+                           progressStep: Single;
+                       treeProgressStep: Single;
+                            hIsCanceled: TQRIsCanceledEvent): Boolean; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Called when a frame mesh was generated
+             @param(index Frame index)
+             @param(builtCount Frame count already generated)
+             @param(totalCount Total frame count to generate)
+            }
+            {$ENDREGION}
+            procedure OnFrameBuilt(index, builtCount, totalCount: NativeUInt); virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Gets the hash of a file content
+             @param(fileName File name)
+             @param(hash @bold([out]) File content hash)
+             @return(@true on success, otherwise @false)
+            }
+            {$ENDREGION}
+            function GetFileHash(const fileName: TFileName; out hash: TQRUInt32): Boolean; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Gets the key identifying the aligned-axis bounding box trees built from a model file
+             @param(modelFileName Model file name)
+             @param(rhToLh If @true, the model is converted from right hand to left hand coordinates)
+             @param(key @bold([out]) Key, calculated from the model file content and the options
+                                     modifying the trees)
+             @return(@true on success, otherwise @false)
+            }
+            {$ENDREGION}
+            function GetTreeCacheKey(const modelFileName: TFileName;
+                                                  rhToLh: Boolean;
+                                                 out key: TQRUInt32): Boolean; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Gets the key identifying the cache built from a model file in the model cache registry
+             @param(modelFileName Model file name)
+             @param(extraFileName Extra file modifying the frames, as e.g. a normals table, ignored if
+                                  empty or if the file doesn't exist)
+             @param(pColor Model color, can be @nil)
+             @param(pLight Pre-calculated light, can be @nil)
+             @param(rhToLh If @true, the model is converted from right hand to left hand coordinates)
+             @param(vertexFormat Frame vertex format)
+             @param(key @bold([out]) Key, built from the model file name and content, and from all
+                                     the options modifying the cached frames and trees)
+             @return(@true on success, otherwise @false)
+            }
+            {$ENDREGION}
+            function GetSharedCacheKey(const modelFileName, extraFileName: TFileName;
+                                                           const pColor: TQRColor;
+                                                           const pLight: TQRDirectionalLight;
+                                                                 rhToLh: Boolean;
+                                                           vertexFormat: TQRVertexFormat;
+                                                                out key: UnicodeString): Boolean; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Replaces the job cache by the cache another job already published in the model cache
+             registry with the same key, if any
+             @param(key Shared cache key)
+             @return(@true if the cache is now shared, @false if no cache was published with this key)
+             @br @bold(NOTE) The job cache should still be empty when this function is called
+            }
+            {$ENDREGION}
+            function AcquireSharedCache(const key: UnicodeString): Boolean; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Publishes the fully built job cache in the model cache registry, in order to share it
+             with the next jobs loading the same model with the same options
+             @param(key Shared cache key)
+             @br @bold(NOTE) The cache is immutable once published. Nothing is published if another
+                             job already published a cache with the same key meanwhile
+            }
+            {$ENDREGION}
+            procedure PublishSharedCache(const key: UnicodeString); virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Releases the job reference on a cache published in the model cache registry
+             @param(key Shared cache key)
+             @br @bold(NOTE) The cache is deleted with its last reference
+            }
+            {$ENDREGION}
+            procedure ReleaseSharedCache(const key: UnicodeString); virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Loads the aligned-axis bounding box trees from a cache file, and adds them to the cache
+             @param(fileName Cache file name)
+             @param(key Key the cache file should match with)
+             @param(firstIndex Cache index of the first tree, the next trees are added to the
+                               following indices)
+             @param(count Tree count the cache file should contain)
+             @return(@true on success, @false if the file doesn't exist, doesn't match with the key
+                     or the count, or is corrupted)
+             @br @bold(NOTE) Nothing is added to the cache if the function fails
+            }
+            {$ENDREGION}
+            function LoadTrees(const fileName: TFileName;
+                                          key: TQRUInt32;
+                            firstIndex, count: NativeUInt): Boolean; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Saves the cached aligned-axis bounding box trees to a cache file
+             @param(fileName Cache file name)
+             @param(key Key identifying the source the trees were built from)
+             @param(firstIndex Cache index of the first tree to save)
+             @param(count Tree count to save)
+             @return(@true on success, otherwise @false)
+            }
+            {$ENDREGION}
+            function SaveTrees(const fileName: TFileName;
+                                          key: TQRUInt32;
+                            firstIndex, count: NativeUInt): Boolean; virtual;
+
             {$REGION 'Documentation'}
             {**
              Gets job progress
@@ -1166,6 +1451,19 @@ type
             function LoadTexture(pTexture: TQRTexture;
                                   pBitmap: Graphics.TBitmap): Boolean; virtual; abstract;
 
+            {$REGION 'Documentation'}
+            {**
+             Decodes a known texture on the job thread
+             @param(pTexture Texture to decode)
+             @return(Decoded texture bitmap, @nil if the texture could not be decoded)
+             @br @bold(NOTE) The texture is loaded by the LoadTexture() function, then resized to
+                             the closest power of 2 size if the EQR_MO_Power_Of_2_Textures option is
+                             used
+             @br @bold(NOTE) The caller is responsible to delete the returned bitmap
+            }
+            {$ENDREGION}
+            function DecodeTexture(pTexture: TQRTexture): Graphics.TBitmap; virtual;
+
             {$REGION 'Documentation'}
             {**
              Called after model is loaded
@@ -1222,6 +1520,23 @@ type
             {$ENDREGION}
             function GetGroup: TQRModelGroup; virtual;
 
+            {$REGION 'Documentation'}
+            {**
+             Adds a frame mesh and his aligned-axis bounding box tree to the cache, if the frame is
+             still not cached
+             @param(index Cache index)
+             @param(pMesh Frame mesh)
+             @param(pTree Frame aligned-axis bounding box tree, can be @nil)
+             @return(@true if the frame was added, in which case the cache takes care of the mesh
+                     and tree, @false if the frame was already cached or the cache is shared)
+             @br @bold(NOTE) Unlike the Mesh and AABBTree properties, a cached frame is never
+                             replaced, so it can be safely added while the cache is drawn
+            }
+            {$ENDREGION}
+            function TryAddFrame(index: NativeUInt;
+                                 pMesh: PQRMesh;
+                                 pTree: TQRAABBTree): Boolean; virtual;
+
         // Properties
         public
             {$REGION 'Documentation'}
@@ -1281,17 +1596,94 @@ type
     {$ENDREGION}
     TQRModelJobs = TList<TQRModelJob>;
 
+    {$REGION 'Documentation'}
+    {**
+     Frame index list
+    }
+    {$ENDREGION}
+    TQRFrameIndexes = array of NativeUInt;
+
+    {$REGION 'Documentation'}
+    {**
+     Frame prefetch job, generates in background the frames a framed model animation will draw
+     next, and adds them to the model cache
+    }
+    {$ENDREGION}
+    TQRFramePrefetchJob = class(TQRVCLThreadWorkerJob)
+        private
+            m_pJob:          TQRModelJob;
+            m_pModel:        TQRFramedModel;
+            m_CacheIndex:    NativeUInt;
+            m_Frames:        TQRFrameIndexes;
+            m_UseCollisions: Boolean;
+            m_IsCanceled:    Boolean;
+
+        protected
+            {$REGION 'Documentation'}
+            {**
+             Checks if job was canceled
+             @return(@true if job was canceled, otherwise @false)
+            }
+            {$ENDREGION}
+            function IsCanceled: Boolean; virtual;
+
+        public
+            {$REGION 'Documentation'}
+            {**
+             Constructor
+             @param(pJob Job containing the model cache)
+             @param(pModel Model or sub-model from which the frames are generated)
+             @param(cacheIndex Cache index of the model first frame)
+             @param(frames Model frame indexes to generate, in the order they will be drawn)
+             @param(useCollisions If @true, the frame aligned-axis bounding box trees are also
+                                  built)
+             @br @bold(NOTE) The model job should not be deleted while this job is running
+            }
+            {$ENDREGION}
+            constructor Create(pJob: TQRModelJob;
+                             pModel: TQRFramedModel;
+                         cacheIndex: NativeUInt;
+                       const frames: TQRFrameIndexes;
+                      useCollisions: Boolean); reintroduce;
+
+            {$REGION 'Documentation'}
+            {**
+             Destructor
+            }
+            {$ENDREGION}
+            destructor Destroy; override;
+
+            {$REGION 'Documentation'}
+            {**
+             Processes the job
+             @return(@true on success, otherwise @false)
+            }
+            {$ENDREGION}
+            function Process: Boolean; override;
+
+            {$REGION 'Documentation'}
+            {**
+             Cancels the job
+            }
+            {$ENDREGION}
+            procedure Cancel; override;
+    end;
+
     {$REGION 'Documentation'}
     {**
      Model worker, it's a specialized class whose role is to carry out model jobs, as e.g. load a
      model in memory and prepare his cache
+     @br @bold(NOTE) The jobs are processed in parallel by a thread pool containing one worker per
+                     processor
     }
     {$ENDREGION}
     TQRModelWorker = class sealed (TObject)
         private
-            class var m_pInstance: TQRModelWorker;
-                      m_pWorker:   TQRVCLThreadWorker;
-                      m_pGarbage:  TList<TQRThreadJob>;
+            class var m_pInstance:       TQRModelWorker;
+                      m_pPool:           TQRVCLThreadPool;
+                      m_pGarbage:        TList<TQRThreadJob>;
+                      m_pThreadLock:     TCriticalSection;
+                      m_FreeThreadCount: NativeUInt;
 
             {$REGION 'Documentation'}
             {**
@@ -1301,6 +1693,25 @@ type
             {$ENDREGION}
             procedure OnThreadJobDone(pJob: TQRThreadJob);
 
+            {$REGION 'Documentation'}
+            {**
+             Checks if a canceled job is still used by a canceled frame prefetch job
+             @param(pJob Canceled job to check)
+             @return(@true if a frame prefetch job waiting in the garbage collector uses the job,
+                     otherwise @false)
+            }
+            {$ENDREGION}
+            function IsUsedByPrefetchJob(pJob: TQRThreadJob): Boolean;
+
+            {$REGION 'Documentation'}
+            {**
+             Releases all the canceled jobs that are no longer processed
+             @br @bold(NOTE) A canceled model job is kept as long as a canceled frame prefetch job
+                             using its cache remains in the garbage collector
+            }
+            {$ENDREGION}
+            procedure ReleaseGarbage;
+
         public
             {$REGION 'Documentation'}
             {**
@@ -1337,9 +1748,21 @@ type
              Starts the job
              @param(pJob Job to execute)
              @return(@true on success, otherwise @false)
+             @br @bold(NOTE) The job is started with the priority of the group it belongs to
+            }
+            {$ENDREGION}
+            function StartJob(pJob: TQRModelJob): Boolean; overload;
+
+            {$REGION 'Documentation'}
+            {**
+             Starts a frame prefetch job
+             @param(pJob Job to execute)
+             @return(@true on success, otherwise @false)
+             @br @bold(NOTE) The job is started with the priority of the group the model job belongs
+                             to
             }
             {$ENDREGION}
-            function StartJob(pJob: TQRModelJob): Boolean;
+            function StartJob(pJob: TQRFramePrefetchJob): Boolean; overload;
 
             {$REGION 'Documentation'}
             {**
@@ -1347,7 +1770,119 @@ type
              @param(pJob Job to cancel)
             }
             {$ENDREGION}
-            procedure CancelJob(pJob: TQRModelJob);
+            procedure CancelJob(pJob: TQRThreadJob);
+
+            {$REGION 'Documentation'}
+            {**
+             Reserves the additional threads a job may start while it is processed, as e.g. to
+             generate its frames or to build its trees on several threads
+             @param(count Additional thread count the job would like to start)
+             @return(Additional thread count the job is allowed to start, may be 0)
+             @br @bold(NOTE) All the jobs share one additional thread per processor, minus the
+                             thread processing the job itself. Thus a single job may use all the
+                             processors, whereas several jobs processed together don't start one
+                             thread per processor each, in addition to the pool workers
+             @br @bold(NOTE) This function may be called from any thread. The reserved threads
+                             should be released with ReleaseThreads() once no longer used
+            }
+            {$ENDREGION}
+            function ReserveThreads(count: NativeUInt): NativeUInt;
+
+            {$REGION 'Documentation'}
+            {**
+             Releases the additional threads a job reserved
+             @param(count Additional thread count to release, as returned by ReserveThreads())
+            }
+            {$ENDREGION}
+            procedure ReleaseThreads(count: NativeUInt);
+    end;
+
+    {$REGION 'Documentation'}
+    {**
+     Model cache shared between several jobs
+    }
+    {$ENDREGION}
+    TQRSharedModelCache = record
+        m_pCache:   TQRModelCache;
+        m_RefCount: NativeUInt;
+    end;
+
+    {$REGION 'Documentation'}
+    {**
+     Model cache registry, it's a process-wide registry in which the jobs publish their fully built
+     cache, in order that the other jobs loading the same model with the same options share it
+     instead of building their own copy of the same frames and trees
+     @br @bold(NOTE) A published cache is immutable, and is released with the last job using it
+    }
+    {$ENDREGION}
+    TQRModelCacheRegistry = class sealed (TObject)
+        private
+            class var m_pInstance: TQRModelCacheRegistry;
+                      m_pLock:     TCriticalSection;
+                      m_pCaches:   TDictionary<UnicodeString, TQRSharedModelCache>;
+
+        public
+            {$REGION 'Documentation'}
+            {**
+             Constructor
+            }
+            {$ENDREGION}
+            constructor Create;
+
+            {$REGION 'Documentation'}
+            {**
+             Destructor
+            }
+            {$ENDREGION}
+            destructor Destroy; override;
+
+            {$REGION 'Documentation'}
+            {**
+             Gets model cache registry instance, creates one if still not created
+             @return(Model cache registry instance)
+            }
+            {$ENDREGION}
+            class function GetInstance: TQRModelCacheRegistry; static;
+
+            {$REGION 'Documentation'}
+            {**
+             Deletes model cache registry instance
+             @br @bold(NOTE) This function is automatically called when unit is released
+            }
+            {$ENDREGION}
+            class procedure DeleteInstance; static;
+
+            {$REGION 'Documentation'}
+            {**
+             Acquires a reference on a published cache
+             @param(key Cache key)
+             @return(Cache, @nil if no cache was published with this key)
+             @br @bold(NOTE) Each acquired reference should be released by calling Release
+            }
+            {$ENDREGION}
+            function Acquire(const key: UnicodeString): TQRModelCache;
+
+            {$REGION 'Documentation'}
+            {**
+             Publishes a cache
+             @param(key Cache key)
+             @param(pCache Cache to publish)
+             @return(@true on success, @false if a cache was already published with this key)
+             @br @bold(NOTE) On success the registry takes the cache ownership, and the caller
+                             holds the first reference on it, that should be released by calling
+                             Release
+            }
+            {$ENDREGION}
+            function Publish(const key: UnicodeString; pCache: TQRModelCache): Boolean;
+
+            {$REGION 'Documentation'}
+            {**
+             Releases a reference on a published cache, deletes the cache when the last reference is
+             released
+             @param(key Cache key)
+            }
+            {$ENDREGION}
+            procedure Release(const key: UnicodeString);
     end;
 
 implementation
@@ -1499,25 +2034,35 @@ begin
         pPoweredBmp.SetSize(TQRMathsHelper.GetClosestPowerOf2(pSrcBitmap.Width),
                             TQRMathsHelper.GetClosestPowerOf2(pSrcBitmap.Height));
 
-        // set stretch mode to half tones (thus resizing will be smooth)
-        prevMode := SetStretchBltMode(pPoweredBmp.Canvas.Handle, HALFTONE);
+        // lock the canvases, otherwise the main thread may release their device contexts if the
+        // texture is resized on another thread
+        pPoweredBmp.Canvas.Lock;
+        pSrcBitmap.Canvas.Lock;
 
         try
-            // make texture size power of 2
-            StretchBlt(pPoweredBmp.Canvas.Handle,
-                       0,
-                       0,
-                       pPoweredBmp.Width,
-                       pPoweredBmp.Height,
-                       pSrcBitmap.Canvas.Handle,
-                       0,
-                       0,
-                       pSrcBitmap.Width,
-                       pSrcBitmap.Height,
-                       SRCCOPY);
+            // set stretch mode to half tones (thus resizing will be smooth)
+            prevMode := SetStretchBltMode(pPoweredBmp.Canvas.Handle, HALFTONE);
+
+            try
+                // make texture size power of 2
+                StretchBlt(pPoweredBmp.Canvas.Handle,
+                           0,
+                           0,
+                           pPoweredBmp.Width,
+                           pPoweredBmp.Height,
+                           pSrcBitmap.Canvas.Handle,
+                           0,
+                           0,
+                           pSrcBitmap.Width,
+                           pSrcBitmap.Height,
+                           SRCCOPY);
+            finally
+                // restore previous stretch blit mode
+                SetStretchBltMode(pPoweredBmp.Canvas.Handle, prevMode);
+            end;
         finally
-            // restore previous stretch blit mode
-            SetStretchBltMode(pPoweredBmp.Canvas.Handle, prevMode);
+            pSrcBitmap.Canvas.Unlock;
+            pPoweredBmp.Canvas.Unlock;
         end;
 
         // replace texture py the powered one
@@ -1545,6 +2090,7 @@ begin
     m_SwapYZ                 := False;
     m_CombinationType        := EQR_CT_Scale_Rotate_Translate;
     m_pInitialMatrix         := nil;
+    m_JobPriority            := 0;
     m_fOnLoadTexture         := nil;
     m_fOnAfterLoadModelEvent := nil;
 end;
@@ -1977,15 +2523,21 @@ constructor TQRFramedModelGroup.Create;
 begin
     inherited Create;
 
-    m_Paused            := False;
-    m_ForceLoop         := True;
-    m_fOnDrawItem       := nil;
-    m_fOnCustomDrawItem := nil;
-    m_fOnAnimEnd        := nil;
+    m_Paused             := False;
+    m_ForceLoop          := True;
+    m_pPrefetchJobs      := TDictionary<NativeUInt, TQRFramePrefetchJob>.Create;
+    m_PrefetchFrameCount := 8;
+    m_fOnDrawItem        := nil;
+    m_fOnCustomDrawItem  := nil;
+    m_fOnAnimEnd         := nil;
 end;
 //--------------------------------------------------------------------------------------------------
 destructor TQRFramedModelGroup.Destroy;
 begin
+    // cancel the remaining frame prefetches, if any
+    CancelPrefetch;
+    m_pPrefetchJobs.Free;
+
     inherited Destroy;
 end;
 //--------------------------------------------------------------------------------------------------
@@ -2092,29 +2644,125 @@ begin
     Result := (startIndex + (Abs(index - startIndex) mod range));
 end;
 //--------------------------------------------------------------------------------------------------
-// TQRModelJobStatus
-//--------------------------------------------------------------------------------------------------
-constructor TQRModelJobStatus.Create;
-begin
-    inherited Create;
-end;
-//--------------------------------------------------------------------------------------------------
-destructor TQRModelJobStatus.Destroy;
-begin
-    inherited Destroy;
-end;
-//--------------------------------------------------------------------------------------------------
-procedure TQRModelJobStatus.SetProgress(value: NativeUInt);
+procedure TQRFramedModelGroup.PrefetchFrames(pJob: TQRModelJob;
+                                           pModel: TQRFramedModel;
+                                       cacheIndex: NativeUInt;
+                 frameIndex, startIndex, endIndex: NativeUInt;
+                                             loop: Boolean);
+var
+    pPrefetchJob:     TQRFramePrefetchJob;
+    frames:           TQRFrameIndexes;
+    count, nextIndex: NativeUInt;
+    i:                NativeInt;
 begin
-    // set new progress, limit value between 0 and 100
-    if (value > 100) then
-        m_Progress := 100
-    else
-        m_Progress := value;
-end;
-//--------------------------------------------------------------------------------------------------
-// TQRModelJob
-//--------------------------------------------------------------------------------------------------
+    // is prefetch disabled, or nothing to prefetch?
+    if ((m_PrefetchFrameCount = 0) or (not Assigned(pJob)) or (not Assigned(pModel))) then
+        Exit;
+
+    // is animation range empty, or frame index out of bounds?
+    if ((endIndex <= startIndex) or (frameIndex < startIndex) or (frameIndex > endIndex)) then
+        Exit;
+
+    // was the model frames already prefetched?
+    if (m_pPrefetchJobs.TryGetValue(cacheIndex, pPrefetchJob)) then
+    begin
+        // is prefetch still running? Let it end, the next prefetch will start from the frame drawn
+        // at this time
+        if ((pPrefetchJob.GetStatus = EQR_JS_NotStarted) or
+            (pPrefetchJob.GetStatus = EQR_JS_Processing))
+        then
+            Exit;
+
+        // release the previous prefetch
+        m_pPrefetchJobs.Remove(cacheIndex);
+        TQRModelWorker.GetInstance.CancelJob(pPrefetchJob);
+    end;
+
+    // the frame currently drawn is never prefetched
+    SetLength(frames, Min(NativeInt(m_PrefetchFrameCount), NativeInt(endIndex - startIndex)));
+
+    count     := 0;
+    nextIndex := frameIndex;
+
+    // iterate through the next frames to draw
+    for i := 0 to Length(frames) - 1 do
+    begin
+        // last animation frame reached?
+        if (nextIndex >= endIndex) then
+        begin
+            // animation doesn't loop?
+            if ((not m_ForceLoop) and (not loop)) then
+                break;
+
+            nextIndex := startIndex;
+        end
+        else
+            Inc(nextIndex);
+
+        // frame already cached?
+        if (Assigned(pJob.Mesh[cacheIndex + nextIndex])) then
+            continue;
+
+        frames[count] := nextIndex;
+        Inc(count);
+    end;
+
+    // all the next frames are already cached?
+    if (count = 0) then
+        Exit;
+
+    SetLength(frames, count);
+
+    // generate the missing frames in background
+    pPrefetchJob := TQRFramePrefetchJob.Create(pJob,
+                                               pModel,
+                                               cacheIndex,
+                                               frames,
+                                               not(EQR_MO_No_Collision in pJob.ModelOptions));
+
+    m_pPrefetchJobs.Add(cacheIndex, pPrefetchJob);
+    TQRModelWorker.GetInstance.StartJob(pPrefetchJob);
+end;
+//--------------------------------------------------------------------------------------------------
+procedure TQRFramedModelGroup.CancelPrefetch;
+var
+    pPrefetchJob: TQRFramePrefetchJob;
+begin
+    // no running prefetch?
+    if (m_pPrefetchJobs.Count = 0) then
+        Exit;
+
+    // cancel and release the prefetch jobs. NOTE a job still processing is released later, but
+    // always before the model job it uses
+    for pPrefetchJob in m_pPrefetchJobs.Values do
+        TQRModelWorker.GetInstance.CancelJob(pPrefetchJob);
+
+    m_pPrefetchJobs.Clear;
+end;
+//--------------------------------------------------------------------------------------------------
+// TQRModelJobStatus
+//--------------------------------------------------------------------------------------------------
+constructor TQRModelJobStatus.Create;
+begin
+    inherited Create;
+end;
+//--------------------------------------------------------------------------------------------------
+destructor TQRModelJobStatus.Destroy;
+begin
+    inherited Destroy;
+end;
+//--------------------------------------------------------------------------------------------------
+procedure TQRModelJobStatus.SetProgress(value: NativeUInt);
+begin
+    // set new progress, limit value between 0 and 100
+    if (value > 100) then
+        m_Progress := 100
+    else
+        m_Progress := value;
+end;
+//--------------------------------------------------------------------------------------------------
+// TQRModelJob
+//--------------------------------------------------------------------------------------------------
 constructor TQRModelJob.Create(pGroup: TQRModelGroup; modelOptions: TQRModelOptions);
 begin
     inherited Create;
@@ -2125,8 +2773,11 @@ begin
 
     m_pGroup                 := pGroup;
     m_pCache                 := TQRModelCache.Create;
+    m_SharedCacheKey         := '';
     m_ModelOptions           := modelOptions;
     m_Progress               := 0.0;
+    m_TreeProgressStep       := 0.0;
+    m_FrameProgressStep      := 0.0;
     m_IsLoaded               := False;
     m_fOnAfterLoadModelEvent := nil;
 
@@ -2144,7 +2795,13 @@ destructor TQRModelJob.Destroy;
 begin
     // clear memory
     m_pLock.Lock;
-    m_pCache.Free;
+
+    // is cache shared with other jobs? If yes, just release the job reference on it
+    if (Length(m_SharedCacheKey) > 0) then
+        ReleaseSharedCache(m_SharedCacheKey)
+    else
+        m_pCache.Free;
+
     m_pLock.Unlock;
 
     inherited Destroy;
@@ -2186,8 +2843,16 @@ end;
 procedure TQRModelJob.SetMesh(index: NativeUInt; pMesh: PQRMesh);
 begin
     m_pLock.Lock;
-    m_pCache.Mesh[index] := pMesh;
-    m_pLock.Unlock;
+
+    try
+        // a shared cache is immutable
+        if (Length(m_SharedCacheKey) > 0) then
+            raise Exception.Create('Cannot modify a shared model cache');
+
+        m_pCache.Mesh[index] := pMesh;
+    finally
+        m_pLock.Unlock;
+    end;
 end;
 //--------------------------------------------------------------------------------------------------
 function TQRModelJob.GetTree(index: NativeUInt): TQRAABBTree;
@@ -2200,8 +2865,465 @@ end;
 procedure TQRModelJob.SetTree(index: NativeUInt; pTree: TQRAABBTree);
 begin
     m_pLock.Lock;
-    m_pCache.AABBTree[index] := pTree;
-    m_pLock.Unlock;
+
+    try
+        // a shared cache is immutable
+        if (Length(m_SharedCacheKey) > 0) then
+            raise Exception.Create('Cannot modify a shared model cache');
+
+        m_pCache.AABBTree[index] := pTree;
+    finally
+        m_pLock.Unlock;
+    end;
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRModelJob.BuildTrees(pBuilder: TQRAABBTreeBuilder;
+                              firstIndex: NativeUInt;
+                            progressStep: Single;
+                             hIsCanceled: TQRIsCanceledEvent): Boolean;
+var
+    i, extraThreads: NativeUInt;
+    pTree:           TQRAABBTree;
+begin
+    // nothing to build?
+    if (pBuilder.Count = 0) then
+        Exit(True);
+
+    m_TreeProgressStep   := progressStep;
+    pBuilder.OnTreeBuilt := OnTreeBuilt;
+
+    // reserve the additional threads the trees may be built on, the job thread also builds trees
+    extraThreads := TQRModelWorker.GetInstance.ReserveThreads(TThread.ProcessorCount - 1);
+
+    try
+        pBuilder.MaxThreads := extraThreads + 1;
+
+        // build the trees, several at once
+        if (not pBuilder.Build(hIsCanceled)) then
+            Exit(False);
+    finally
+        TQRModelWorker.GetInstance.ReleaseThreads(extraThreads);
+    end;
+
+    // iterate through built trees
+    for i := 0 to pBuilder.Count - 1 do
+    begin
+        pTree := pBuilder.Extract(i);
+
+        // add tree to cache, note that from now cache will take care of the pointer
+        try
+            SetTree(firstIndex + i, pTree);
+        except
+            pTree.Free;
+        end;
+    end;
+
+    Result := True;
+end;
+//--------------------------------------------------------------------------------------------------
+procedure TQRModelJob.OnTreeBuilt(pTree: TQRAABBTree; builtCount, totalCount: NativeUInt);
+begin
+    // a new tree was built, add one step to progress
+    Progress := Progress + m_TreeProgressStep;
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRModelJob.CacheFrames(pModel: TQRFramedModel;
+                             frameCount: NativeUInt;
+                             cacheIndex: NativeUInt;
+                   keepMeshes, addTrees: Boolean;
+                           pTreeBuilder: TQRAABBTreeBuilder;
+                           progressStep: Single;
+                       treeProgressStep: Single;
+                            hIsCanceled: TQRIsCanceledEvent): Boolean;
+var
+    pBuilder:                            TQRFrameMeshBuilder;
+    polygons:                            TQRPolygons;
+    pMesh:                               PQRMesh;
+    i, extraThreads:                     NativeUInt;
+    batchStart, batchCount, batchLength: NativeUInt;
+begin
+    // nothing to cache?
+    if (frameCount = 0) then
+        Exit(True);
+
+    // no tree builder to add the trees to?
+    if (addTrees and (not Assigned(pTreeBuilder))) then
+        Exit(False);
+
+    m_FrameProgressStep := progressStep;
+
+    pBuilder := TQRFrameMeshBuilder.Create(pModel);
+
+    try
+        pBuilder.KeepMeshes   := keepMeshes;
+        pBuilder.KeepPolygons := addTrees;
+        pBuilder.OnMeshBuilt  := OnFrameBuilt;
+
+        // reserve the additional threads the frames and their trees may be built on, the job
+        // thread also generates frames and builds trees
+        extraThreads := TQRModelWorker.GetInstance.ReserveThreads(frameCount - 1);
+
+        try
+            pBuilder.MaxThreads := extraThreads + 1;
+
+            // do build the trees? If yes, generate the frames by batches, and build the trees of
+            // each batch before generating the next one, otherwise the collision polygons of all
+            // the frames would be kept in memory until their trees are built
+            if (addTrees) then
+            begin
+                batchLength := (extraThreads + 1) * QR_Frames_Per_Thread_Batch;
+
+                m_TreeProgressStep       := treeProgressStep;
+                pTreeBuilder.MaxThreads  := extraThreads + 1;
+                pTreeBuilder.OnTreeBuilt := OnTreeBuilt;
+            end
+            else
+                batchLength := frameCount;
+
+            batchStart := 0;
+
+            // iterate through frame batches
+            while (batchStart < frameCount) do
+            begin
+                // calculate the frame count to generate in this batch
+                if ((frameCount - batchStart) < batchLength) then
+                    batchCount := frameCount - batchStart
+                else
+                    batchCount := batchLength;
+
+                // generate the batch frames, several at once
+                if (not pBuilder.Build(batchStart, batchCount, hIsCanceled)) then
+                    Exit(False);
+
+                // iterate through generated frames
+                for i := 0 to batchCount - 1 do
+                begin
+                    // do add a tree to build from the frame collision polygons?
+                    if (addTrees) then
+                    begin
+                        pBuilder.ExtractPolygons(i, polygons);
+                        pTreeBuilder.Add(polygons, TQRAABBTree.Create);
+                        SetLength(polygons, 0);
+                    end;
+
+                    // was the mesh only required to get the collision polygons?
+                    if (not keepMeshes) then
+                        continue;
+
+                    pMesh := pBuilder.Extract(i);
+
+                    // add mesh to cache, note that from now cache will take care of the pointer
+                    try
+                        SetMesh(cacheIndex + batchStart + i, pMesh);
+                    except
+                        Dispose(pMesh);
+                    end;
+                end;
+
+                // build the batch trees, several at once. NOTE the collision polygons are released
+                // as soon as each tree is built
+                if (addTrees and (not pTreeBuilder.Build(hIsCanceled))) then
+                    Exit(False);
+
+                Inc(batchStart, batchCount);
+            end;
+        finally
+            TQRModelWorker.GetInstance.ReleaseThreads(extraThreads);
+        end;
+    finally
+        pBuilder.Free;
+    end;
+
+    Result := True;
+end;
+//--------------------------------------------------------------------------------------------------
+procedure TQRModelJob.OnFrameBuilt(index, builtCount, totalCount: NativeUInt);
+begin
+    // a new frame mesh was generated, add one step to progress
+    Progress := Progress + m_FrameProgressStep;
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRModelJob.GetFileHash(const fileName: TFileName; out hash: TQRUInt32): Boolean;
+var
+    pFileStream: TFileStream;
+begin
+    hash        := 0;
+    pFileStream := nil;
+
+    try
+        try
+            // hash the file content
+            pFileStream := TFileStream.Create(fileName, fmOpenRead or fmShareDenyWrite);
+            hash        := TQRFileHelper.GetHash(pFileStream);
+        finally
+            pFileStream.Free;
+        end;
+    except
+        Exit(False);
+    end;
+
+    Result := True;
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRModelJob.GetTreeCacheKey(const modelFileName: TFileName;
+                                                  rhToLh: Boolean;
+                                                 out key: TQRUInt32): Boolean;
+var
+    options: array [0..2] of Byte;
+begin
+    // hash the model file content
+    if (not GetFileHash(modelFileName, key)) then
+        Exit(False);
+
+    // also hash the options modifying the trees, in order to never reuse trees built with other
+    // options
+    options[0] := Ord(rhToLh);
+    options[1] := Ord(EQR_MO_Refit_Collisions in ModelOptions);
+    options[2] := Ord(EQR_MO_Indexed_Meshes   in ModelOptions);
+    key        := TQRFileHelper.GetHash(@options[0], Length(options), key);
+
+    Result := True;
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRModelJob.GetSharedCacheKey(const modelFileName, extraFileName: TFileName;
+                                                           const pColor: TQRColor;
+                                                           const pLight: TQRDirectionalLight;
+                                                                 rhToLh: Boolean;
+                                                           vertexFormat: TQRVertexFormat;
+                                                                out key: UnicodeString): Boolean;
+var
+    modelHash, extraHash, optionBits, formatBits, colorARGB: TQRUInt32;
+    option:                                                  EQRModelOptions;
+    vertexItem:                                              EQRVertexFormats;
+    lightSettings:                                           UnicodeString;
+begin
+    key := '';
+
+    // hash the model file content, in order to never share the frames of a modified file
+    if (not GetFileHash(modelFileName, modelHash)) then
+        Exit(False);
+
+    extraHash := 0;
+
+    // hash the extra file content, if any
+    if ((Length(extraFileName) > 0) and FileExists(extraFileName)) then
+        if (not GetFileHash(extraFileName, extraHash)) then
+            Exit(False);
+
+    optionBits := 0;
+
+    // convert the model options to bits
+    for option in ModelOptions do
+        optionBits := optionBits or (1 shl Ord(option));
+
+    formatBits := 0;
+
+    // convert the vertex format to bits
+    for vertexItem in vertexFormat do
+        formatBits := formatBits or (1 shl Ord(vertexItem));
+
+    // get the model color, if any
+    if (Assigned(pColor)) then
+        colorARGB := pColor.GetARGB
+    else
+        colorARGB := 0;
+
+    // get the pre-calculated light settings, if any
+    if (Assigned(pLight)) then
+        lightSettings := IntToStr(Ord(pLight.Enabled))        + ',' +
+                         IntToHex(pLight.Ambient.GetARGB, 8) + ',' +
+                         IntToHex(pLight.Color.GetARGB,   8) + ',' +
+                         FloatToStr(pLight.Direction.X)      + ',' +
+                         FloatToStr(pLight.Direction.Y)      + ',' +
+                         FloatToStr(pLight.Direction.Z)
+    else
+        lightSettings := '';
+
+    // build the key from the model file, and from all the options modifying the cached frames and
+    // trees
+    key := ExpandFileName(modelFileName) + '|' +
+           IntToHex(modelHash,  8)       + '|' +
+           IntToHex(extraHash,  8)       + '|' +
+           IntToHex(optionBits, 8)       + '|' +
+           IntToHex(formatBits, 8)       + '|' +
+           IntToStr(Ord(rhToLh))         + '|' +
+           IntToHex(colorARGB,  8)       + '|' +
+           lightSettings;
+
+    Result := True;
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRModelJob.AcquireSharedCache(const key: UnicodeString): Boolean;
+var
+    pSharedCache: TQRModelCache;
+begin
+    // search for a cache another job already published with the same key
+    pSharedCache := TQRModelCacheRegistry.GetInstance.Acquire(key);
+
+    // not found?
+    if (not Assigned(pSharedCache)) then
+        Exit(False);
+
+    m_pLock.Lock;
+
+    try
+        // replace the job cache by the shared one
+        m_pCache.Free;
+        m_pCache         := pSharedCache;
+        m_SharedCacheKey := key;
+    finally
+        m_pLock.Unlock;
+    end;
+
+    Result := True;
+end;
+//--------------------------------------------------------------------------------------------------
+procedure TQRModelJob.PublishSharedCache(const key: UnicodeString);
+begin
+    m_pLock.Lock;
+
+    try
+        // cache is already shared?
+        if (Length(m_SharedCacheKey) > 0) then
+            Exit;
+
+        // publish the cache, from now the registry will take care of it
+        if (TQRModelCacheRegistry.GetInstance.Publish(key, m_pCache)) then
+            m_SharedCacheKey := key;
+    finally
+        m_pLock.Unlock;
+    end;
+end;
+//--------------------------------------------------------------------------------------------------
+procedure TQRModelJob.ReleaseSharedCache(const key: UnicodeString);
+begin
+    // registry was already deleted? (may happen if the job is deleted while the unit is released)
+    if (not Assigned(TQRModelCacheRegistry.m_pInstance)) then
+        Exit;
+
+    TQRModelCacheRegistry.m_pInstance.Release(key);
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRModelJob.LoadTrees(const fileName: TFileName;
+                                          key: TQRUInt32;
+                            firstIndex, count: NativeUInt): Boolean;
+var
+    pStream: TMemoryStream;
+    header:  TQRAABBCacheHeader;
+    trees:   array of TQRAABBTree;
+    pTree:   TQRAABBTree;
+    i:       NativeUInt;
+begin
+    // no cache file?
+    if (not FileExists(fileName)) then
+        Exit(False);
+
+    SetLength(trees, count);
+
+    pStream := TMemoryStream.Create;
+
+    try
+        try
+            // read the whole file at once, the trees are then loaded from memory
+            pStream.LoadFromFile(fileName);
+
+            // read the header
+            if (pStream.Read(header, SizeOf(TQRAABBCacheHeader)) <> SizeOf(TQRAABBCacheHeader)) then
+                Exit(False);
+
+            // check if the file matches with the expected format, and if the trees it contains
+            // were built from the same source
+            if ((header.m_Signature <> QR_AABB_Cache_Signature) or
+                (header.m_Version   <> QR_AABB_Cache_Version)   or
+                (header.m_Key       <> key)                     or
+                (header.m_TreeCount <> count))
+            then
+                Exit(False);
+
+            // load the trees
+            if (count > 0) then
+                for i := 0 to count - 1 do
+                begin
+                    trees[i] := TQRAABBTree.Create;
+
+                    if (not trees[i].LoadFromStream(pStream)) then
+                        Exit(False);
+                end;
+        except
+            Exit(False);
+        end;
+
+        // iterate through loaded trees
+        if (count > 0) then
+            for i := 0 to count - 1 do
+            begin
+                pTree    := trees[i];
+                trees[i] := nil;
+
+                // add tree to cache, note that from now cache will take care of the pointer
+                try
+                    SetTree(firstIndex + i, pTree);
+                except
+                    pTree.Free;
+                end;
+            end;
+    finally
+        pStream.Free;
+
+        // release the trees that were not added to cache, if any
+        if (count > 0) then
+            for i := 0 to count - 1 do
+                trees[i].Free;
+    end;
+
+    Result := True;
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRModelJob.SaveTrees(const fileName: TFileName;
+                                          key: TQRUInt32;
+                            firstIndex, count: NativeUInt): Boolean;
+var
+    pStream: TMemoryStream;
+    header:  TQRAABBCacheHeader;
+    pTree:   TQRAABBTree;
+    i:       NativeUInt;
+begin
+    // populate the header
+    header.m_Signature := QR_AABB_Cache_Signature;
+    header.m_Version   := QR_AABB_Cache_Version;
+    header.m_Key       := key;
+    header.m_TreeCount := count;
+
+    pStream := TMemoryStream.Create;
+
+    try
+        try
+            pStream.WriteBuffer(header, SizeOf(TQRAABBCacheHeader));
+
+            // iterate through trees to save
+            if (count > 0) then
+                for i := 0 to count - 1 do
+                begin
+                    pTree := GetTree(firstIndex + i);
+
+                    if (not Assigned(pTree)) then
+                        Exit(False);
+
+                    if (not pTree.SaveToStream(pStream)) then
+                        Exit(False);
+                end;
+
+            // write the whole file at once, in order to never leave a partially written file if a
+            // tree cannot be saved
+            pStream.SaveToFile(fileName);
+        except
+            Exit(False);
+        end;
+    finally
+        pStream.Free;
+    end;
+
+    Result := True;
 end;
 //--------------------------------------------------------------------------------------------------
 function TQRModelJob.GetGroup: TQRModelGroup;
@@ -2217,6 +3339,32 @@ begin
     m_pLock.Unlock;
 end;
 //--------------------------------------------------------------------------------------------------
+function TQRModelJob.TryAddFrame(index: NativeUInt;
+                                 pMesh: PQRMesh;
+                                 pTree: TQRAABBTree): Boolean;
+begin
+    m_pLock.Lock;
+
+    try
+        // a shared cache is immutable
+        if (Length(m_SharedCacheKey) > 0) then
+            Exit(False);
+
+        // frame already cached? Never replace it, because it may be drawn
+        if (Assigned(m_pCache.Mesh[index])) then
+            Exit(False);
+
+        m_pCache.Mesh[index] := pMesh;
+
+        if (Assigned(pTree)) then
+            m_pCache.AABBTree[index] := pTree;
+    finally
+        m_pLock.Unlock;
+    end;
+
+    Result := True;
+end;
+//--------------------------------------------------------------------------------------------------
 function TQRModelJob.GetProgress: Single;
 begin
     m_pLock.Lock;
@@ -2251,6 +3399,35 @@ begin
     m_pLock.Unlock;
 end;
 //--------------------------------------------------------------------------------------------------
+function TQRModelJob.DecodeTexture(pTexture: TQRTexture): Graphics.TBitmap;
+var
+    decoded: Boolean;
+begin
+    decoded := False;
+    Result  := Graphics.TBitmap.Create;
+
+    try
+        // lock the bitmap canvas, otherwise the main thread may release its device context while
+        // the texture is decoded
+        Result.Canvas.Lock;
+
+        try
+            // decode texture
+            decoded := LoadTexture(pTexture, Result);
+
+            // resize texture to the closest power of 2 size, if required
+            if (decoded and (EQR_MO_Power_Of_2_Textures in ModelOptions)) then
+                decoded := TQRModelGroupHelper.MakeTexturePowerOf2(Result, Result);
+        finally
+            Result.Canvas.Unlock;
+        end;
+    finally
+        // failed to decode texture?
+        if (not decoded) then
+            FreeAndNil(Result);
+    end;
+end;
+//--------------------------------------------------------------------------------------------------
 procedure TQRModelJob.OnAfterLoadModel;
 var
     msg: TQRMessage;
@@ -2275,6 +3452,93 @@ begin
     end;
 end;
 //--------------------------------------------------------------------------------------------------
+// TQRFramePrefetchJob
+//--------------------------------------------------------------------------------------------------
+constructor TQRFramePrefetchJob.Create(pJob: TQRModelJob;
+                                     pModel: TQRFramedModel;
+                                 cacheIndex: NativeUInt;
+                               const frames: TQRFrameIndexes;
+                              useCollisions: Boolean);
+begin
+    inherited Create;
+
+    m_pJob          := pJob;
+    m_pModel        := pModel;
+    m_CacheIndex    := cacheIndex;
+    m_Frames        := Copy(frames, 0, Length(frames));
+    m_UseCollisions := useCollisions;
+    m_IsCanceled    := False;
+end;
+//--------------------------------------------------------------------------------------------------
+destructor TQRFramePrefetchJob.Destroy;
+begin
+    inherited Destroy;
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRFramePrefetchJob.IsCanceled: Boolean;
+begin
+    m_pLock.Lock;
+    Result := m_IsCanceled;
+    m_pLock.Unlock;
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRFramePrefetchJob.Process: Boolean;
+var
+    i:          NativeInt;
+    cacheIndex: NativeUInt;
+    pMesh:      PQRMesh;
+    pTree:      TQRAABBTree;
+begin
+    // iterate through frames to prefetch
+    for i := 0 to Length(m_Frames) - 1 do
+    begin
+        // was job canceled?
+        if (IsCanceled) then
+            Exit(False);
+
+        cacheIndex := m_CacheIndex + m_Frames[i];
+
+        // frame was already cached meanwhile, e.g. because it was drawn?
+        if (Assigned(m_pJob.Mesh[cacheIndex])) then
+            continue;
+
+        // create new mesh
+        New(pMesh);
+
+        // do create collision buffers?
+        if (m_UseCollisions) then
+            pTree := TQRAABBTree.Create
+        else
+            pTree := nil;
+
+        // get mesh and calculate AABB tree, if needed
+        if (not m_pModel.GetMesh(m_Frames[i], pMesh^, pTree, IsCanceled)) then
+        begin
+            // failed or canceled?
+            Dispose(pMesh);
+            pTree.Free;
+            Exit(False);
+        end;
+
+        // add frame to cache, note that from now cache will take care of the pointers, unless the
+        // frame was cached meanwhile
+        if (not m_pJob.TryAddFrame(cacheIndex, pMesh, pTree)) then
+        begin
+            Dispose(pMesh);
+            pTree.Free;
+        end;
+    end;
+
+    Result := True;
+end;
+//--------------------------------------------------------------------------------------------------
+procedure TQRFramePrefetchJob.Cancel;
+begin
+    m_pLock.Lock;
+    m_IsCanceled := True;
+    m_pLock.Unlock;
+end;
+//--------------------------------------------------------------------------------------------------
 // TQRModelWorker
 //--------------------------------------------------------------------------------------------------
 constructor TQRModelWorker.Create;
@@ -2288,18 +3552,23 @@ begin
     // create the garbage collector
     m_pGarbage := TList<TQRThreadJob>.Create;
 
-    // create and configure threaded job worker
-    m_pWorker        := TQRVCLThreadWorker.Create;
-    m_pWorker.OnDone := OnThreadJobDone;
+    // one additional thread per processor may be started by the jobs, in addition to the worker
+    // processing them
+    m_pThreadLock     := TCriticalSection.Create;
+    m_FreeThreadCount := Max(TThread.ProcessorCount, 1) - 1;
+
+    // create and configure threaded job pool
+    m_pPool        := TQRVCLThreadPool.Create;
+    m_pPool.OnDone := OnThreadJobDone;
 end;
 //--------------------------------------------------------------------------------------------------
 destructor TQRModelWorker.Destroy;
 var
     pJob: TQRThreadJob;
 begin
-    // cancel all jobs and free the worker
-    m_pWorker.Cancel;
-    m_pWorker.Free;
+    // cancel all jobs and free the pool
+    m_pPool.Cancel;
+    m_pPool.Free;
 
     // clear eventual remaining jobs
     for pJob in m_pGarbage do
@@ -2308,6 +3577,9 @@ begin
     // clear garbage collector
     m_pGarbage.Free;
 
+    // the pool is freed, so no job uses the thread lock anymore
+    m_pThreadLock.Free;
+
     inherited Destroy;
 
     m_pInstance := nil;
@@ -2320,13 +3592,55 @@ begin
     // search for done job in garbage collector
     index := m_pGarbage.IndexOf(pJob);
 
-    // found it?
-    if (index >= 0) then
+    // found it, and no canceled prefetch job uses it anymore?
+    if ((index >= 0) and (not IsUsedByPrefetchJob(pJob))) then
     begin
         // clear done job
         m_pGarbage[index].Free;
         m_pGarbage.Delete(index);
     end;
+
+    // release the other canceled jobs that are no longer processed
+    ReleaseGarbage;
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRModelWorker.IsUsedByPrefetchJob(pJob: TQRThreadJob): Boolean;
+var
+    pItem: TQRThreadJob;
+begin
+    // search for a canceled prefetch job using the job
+    for pItem in m_pGarbage do
+        if ((pItem is TQRFramePrefetchJob) and (TQRFramePrefetchJob(pItem).m_pJob = pJob)) then
+            Exit(True);
+
+    Result := False;
+end;
+//--------------------------------------------------------------------------------------------------
+procedure TQRModelWorker.ReleaseGarbage;
+var
+    index: NativeInt;
+    pJob:  TQRThreadJob;
+begin
+    index := 0;
+
+    // iterate through all the canceled jobs. NOTE the prefetch jobs are canceled before the model
+    // job they use, thus they are released first, and the model job may be released on the same
+    // pass
+    while (index < m_pGarbage.Count) do
+    begin
+        pJob := m_pGarbage[index];
+
+        // job is still processed, or still used by a canceled prefetch job? Keep it
+        if (m_pPool.IsProcessing(pJob) or IsUsedByPrefetchJob(pJob)) then
+        begin
+            Inc(index);
+            continue;
+        end;
+
+        // clear job
+        pJob.Free;
+        m_pGarbage.Delete(index);
+    end;
 end;
 //--------------------------------------------------------------------------------------------------
 class function TQRModelWorker.GetInstance: TQRModelWorker;
@@ -2348,24 +3662,191 @@ end;
 //--------------------------------------------------------------------------------------------------
 function TQRModelWorker.StartJob(pJob: TQRModelJob): Boolean;
 begin
-    m_pWorker.AddJob(pJob);
+    // no job to start?
+    if (not Assigned(pJob)) then
+        Exit(False);
+
+    m_pPool.AddJob(pJob, pJob.m_pGroup.JobPriority);
     Result := True;
 end;
 //--------------------------------------------------------------------------------------------------
-procedure TQRModelWorker.CancelJob(pJob: TQRModelJob);
+function TQRModelWorker.StartJob(pJob: TQRFramePrefetchJob): Boolean;
+begin
+    // no job to start?
+    if (not Assigned(pJob)) then
+        Exit(False);
+
+    // release the canceled jobs that are no longer processed
+    ReleaseGarbage;
+
+    m_pPool.AddJob(pJob, pJob.m_pJob.m_pGroup.JobPriority);
+    Result := True;
+end;
+//--------------------------------------------------------------------------------------------------
+procedure TQRModelWorker.CancelJob(pJob: TQRThreadJob);
 begin
     // no job to cancel?
     if (not Assigned(pJob)) then
         Exit;
 
-    // delete job in worker
-    m_pWorker.DeleteJob(pJob, True);
+    // delete job in pool
+    m_pPool.DeleteJob(pJob, True);
 
-    // release job, postpone destruction if still processed in worker
-    if (pJob <> m_pWorker.ProcessingJob) then
+    // release job, postpone destruction if still processed by a worker, or if a canceled prefetch
+    // job still uses it
+    if ((not m_pPool.IsProcessing(pJob)) and (not IsUsedByPrefetchJob(pJob))) then
         pJob.Free
     else
         m_pGarbage.Add(pJob);
+
+    // release the canceled jobs that are no longer processed
+    ReleaseGarbage;
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRModelWorker.ReserveThreads(count: NativeUInt): NativeUInt;
+begin
+    m_pThreadLock.Enter;
+
+    try
+        // get as many threads as possible, without exceeding the free ones
+        if (count > m_FreeThreadCount) then
+            Result := m_FreeThreadCount
+        else
+            Result := count;
+
+        Dec(m_FreeThreadCount, Result);
+    finally
+        m_pThreadLock.Leave;
+    end;
+end;
+//--------------------------------------------------------------------------------------------------
+procedure TQRModelWorker.ReleaseThreads(count: NativeUInt);
+begin
+    m_pThreadLock.Enter;
+    Inc(m_FreeThreadCount, count);
+    m_pThreadLock.Leave;
+end;
+//--------------------------------------------------------------------------------------------------
+// TQRModelCacheRegistry
+//--------------------------------------------------------------------------------------------------
+constructor TQRModelCacheRegistry.Create;
+begin
+    // singleton was already initialized?
+    if (Assigned(m_pInstance)) then
+        raise Exception.Create('Cannot create many instances of a singleton class');
+
+    inherited Create;
+
+    m_pLock   := TCriticalSection.Create;
+    m_pCaches := TDictionary<UnicodeString, TQRSharedModelCache>.Create;
+end;
+//--------------------------------------------------------------------------------------------------
+destructor TQRModelCacheRegistry.Destroy;
+var
+    sharedCache: TQRSharedModelCache;
+begin
+    // clear eventual remaining caches
+    for sharedCache in m_pCaches.Values do
+        sharedCache.m_pCache.Free;
+
+    // clear memory
+    m_pCaches.Free;
+    m_pLock.Free;
+
+    inherited Destroy;
+
+    m_pInstance := nil;
+end;
+//--------------------------------------------------------------------------------------------------
+class function TQRModelCacheRegistry.GetInstance: TQRModelCacheRegistry;
+begin
+    // is singleton instance already initialized?
+    if (Assigned(m_pInstance)) then
+        // get it
+        Exit(m_pInstance);
+
+    // create new singleton instance
+    m_pInstance := TQRModelCacheRegistry.Create;
+    Result      := m_pInstance;
+end;
+//--------------------------------------------------------------------------------------------------
+class procedure TQRModelCacheRegistry.DeleteInstance;
+begin
+    m_pInstance.Free;
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRModelCacheRegistry.Acquire(const key: UnicodeString): TQRModelCache;
+var
+    sharedCache: TQRSharedModelCache;
+begin
+    m_pLock.Enter;
+
+    try
+        // no cache published with this key?
+        if (not m_pCaches.TryGetValue(key, sharedCache)) then
+            Exit(nil);
+
+        // add a reference on the cache
+        Inc(sharedCache.m_RefCount);
+        m_pCaches[key] := sharedCache;
+
+        Result := sharedCache.m_pCache;
+    finally
+        m_pLock.Leave;
+    end;
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRModelCacheRegistry.Publish(const key: UnicodeString; pCache: TQRModelCache): Boolean;
+var
+    sharedCache: TQRSharedModelCache;
+begin
+    // no cache to publish?
+    if (not Assigned(pCache)) then
+        Exit(False);
+
+    m_pLock.Enter;
+
+    try
+        // a cache was already published with this key?
+        if (m_pCaches.ContainsKey(key)) then
+            Exit(False);
+
+        // publish the cache, the caller holds the first reference on it
+        sharedCache.m_pCache   := pCache;
+        sharedCache.m_RefCount := 1;
+        m_pCaches.Add(key, sharedCache);
+    finally
+        m_pLock.Leave;
+    end;
+
+    Result := True;
+end;
+//--------------------------------------------------------------------------------------------------
+procedure TQRModelCacheRegistry.Release(const key: UnicodeString);
+var
+    sharedCache: TQRSharedModelCache;
+begin
+    m_pLock.Enter;
+
+    try
+        // no cache published with this key?
+        if (not m_pCaches.TryGetValue(key, sharedCache)) then
+            Exit;
+
+        // release the reference
+        Dec(sharedCache.m_RefCount);
+
+        // was the last reference? If yes, delete the cache
+        if (sharedCache.m_RefCount = 0) then
+        begin
+            sharedCache.m_pCache.Free;
+            m_pCaches.Remove(key);
+        end
+        else
+            m_pCaches[key] := sharedCache;
+    finally
+        m_pLock.Leave;
+    end;
 end;
 //--------------------------------------------------------------------------------------------------
 
@@ -2378,6 +3859,15 @@ begin
     TQRModelWorker.m_pInstance := nil;
 end;
 //--------------------------------------------------------------------------------------------------
+// TQRModelCacheRegistry
+//--------------------------------------------------------------------------------------------------
+begin
+    // create the registry instance when application opens, because it's accessed by several jobs
+    // running in other threads, that could otherwise create it at the same time
+    TQRModelCacheRegistry.m_pInstance := nil;
+    TQRModelCacheRegistry.GetInstance;
+end;
+//--------------------------------------------------------------------------------------------------
 
 finalization
 //--------------------------------------------------------------------------------------------------
@@ -2388,5 +3878,12 @@ begin
     TQRModelWorker.DeleteInstance;
 end;
 //--------------------------------------------------------------------------------------------------
+// TQRModelCacheRegistry
+//--------------------------------------------------------------------------------------------------
+begin
+    // free instance when application closes, after the worker released its remaining jobs
+    TQRModelCacheRegistry.DeleteInstance;
+end;
+//--------------------------------------------------------------------------------------------------
 
 end.
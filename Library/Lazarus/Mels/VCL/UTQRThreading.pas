@@ -33,7 +33,8 @@ interface
 
 uses Classes,
      SysUtils,
-     SyncObjs;
+     SyncObjs,
+     Generics.Collections;
 
 type
     {$REGION 'Documentation'}
@@ -280,15 +281,156 @@ type
     {$ENDREGION}
     TQRThreadJobIdleEvent = procedure of object;
 
+    {$REGION 'Documentation'}
+    {**
+     Thread job queue item
+    }
+    {$ENDREGION}
+    TQRVCLThreadJobQueueItem = record
+        {$REGION 'Documentation'}
+        {**
+         Queued job
+        }
+        {$ENDREGION}
+        m_pJob: TQRThreadJob;
+
+        {$REGION 'Documentation'}
+        {**
+         Ticket the job received when it was added, an item whose ticket no longer matches the job
+         one was removed from the queue, and is skipped
+        }
+        {$ENDREGION}
+        m_Ticket: NativeUInt;
+    end;
+
+    {$REGION 'Documentation'}
+    {**
+     Thread job queue level, contains the queued jobs having the same priority, in adding order
+    }
+    {$ENDREGION}
+    TQRVCLThreadJobQueueLevel = record
+        m_Priority: NativeInt;
+        m_pItems:   TQueue<TQRVCLThreadJobQueueItem>;
+    end;
+
+    {$REGION 'Documentation'}
+    {**
+     Thread job queue, contains the jobs waiting to be processed, sorted by priority. Jobs with the
+     same priority are processed in the order they were added
+     @br @bold(NOTE) A queue may be shared between several workers, in this case each job is
+                     processed by the first available worker
+     @br @bold(NOTE) Adding, getting and removing a job don't depend on the queued job count, so
+                     the lock is only held for a short time
+    }
+    {$ENDREGION}
+    TQRVCLThreadJobQueue = class
+        private
+            m_pLock:      TQRVCLThreadLock;
+            m_pEvent:     TEvent;
+            m_pLevels:    TList<TQRVCLThreadJobQueueLevel>;
+            m_pTickets:   TDictionary<TQRThreadJob, NativeUInt>;
+            m_LastTicket: NativeUInt;
+
+            {$REGION 'Documentation'}
+            {**
+             Clears the queue levels
+             @br @bold(NOTE) The caller should own the lock
+            }
+            {$ENDREGION}
+            procedure ClearLevels;
+
+        protected
+            {$REGION 'Documentation'}
+            {**
+             Gets the job count
+             @return(Job count)
+            }
+            {$ENDREGION}
+            function GetCount: NativeUInt; virtual;
+
+        public
+            {$REGION 'Documentation'}
+            {**
+             Constructor
+            }
+            {$ENDREGION}
+            constructor Create; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Destructor
+            }
+            {$ENDREGION}
+            destructor Destroy; override;
+
+            {$REGION 'Documentation'}
+            {**
+             Adds a job to the queue, and wakes up the workers waiting for it
+             @param(pJob Job to add)
+             @param(priority Job priority, jobs with the highest priority are processed first)
+             @return(@true if the job was added, @false if it was already in the queue)
+            }
+            {$ENDREGION}
+            function Push(pJob: TQRThreadJob; priority: NativeInt): Boolean; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Gets and removes the next job to process
+             @return(Next job to process, @nil if the queue is empty)
+            }
+            {$ENDREGION}
+            function Pop: TQRThreadJob; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Removes a job from the queue
+             @param(pJob Job to remove)
+             @return(@true if the job was removed, @false if it was not in the queue)
+            }
+            {$ENDREGION}
+            function Remove(pJob: TQRThreadJob): Boolean; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Waits until a job is added to the queue, or until the workers are woken up
+             @param(timeout Maximum time to wait, in milliseconds)
+             @return(@true if the queue was signaled, @false on timeout or error)
+             @br @bold(NOTE) Returns immediately while the queue isn't empty
+            }
+            {$ENDREGION}
+            function WaitFor(timeout: Cardinal = INFINITE): Boolean; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Wakes up the workers waiting for a job, e.g. to let them check they were canceled
+            }
+            {$ENDREGION}
+            procedure WakeUp; virtual;
+
+        // Properties
+        public
+            {$REGION 'Documentation'}
+            {**
+             Gets the job count
+            }
+            {$ENDREGION}
+            property Count: NativeUInt read GetCount;
+    end;
+
     {$REGION 'Documentation'}
     {**
      Windows thread worker, executes a list of jobs, one by one, until all jobs are processed
+     @br @bold(NOTE) Several workers may share the same job queue, see TQRVCLThreadPool
+     @br @bold(NOTE) A worker without job to process, or idle, sleeps until a job is added, it's
+                     resumed, canceled or destroyed
     }
     {$ENDREGION}
     TQRVCLThreadWorker = class(TThread)
         private
             m_pLock:          TQRVCLThreadLock;
-            m_pJobs:          TList;
+            m_pQueue:         TQRVCLThreadJobQueue;
+            m_pResumeEvent:   TEvent;
+            m_OwnsQueue:      Boolean;
             m_pProcessingJob: TQRThreadJob;
             m_Idle:           Boolean;
             m_IsIdle:         Boolean;
@@ -415,9 +557,11 @@ type
             {$REGION 'Documentation'}
             {**
              Constructor
+             @param(pQueue Job queue to share with other workers, if @nil the worker creates and owns
+                           its own queue)
             }
             {$ENDREGION}
-            constructor Create; virtual;
+            constructor Create(pQueue: TQRVCLThreadJobQueue = nil); virtual;
 
             {$REGION 'Documentation'}
             {**
@@ -430,9 +574,10 @@ type
             {**
              Adds job to process list
              @param(pJob Job to add)
+             @param(priority Job priority, jobs with the highest priority are processed first)
             }
             {$ENDREGION}
-            procedure AddJob(pJob: TQRThreadJob); virtual;
+            procedure AddJob(pJob: TQRThreadJob; priority: NativeInt = 0); virtual;
 
             {$REGION 'Documentation'}
             {**
@@ -511,6 +656,166 @@ type
             property Started: Boolean read m_Started;
     end;
 
+    {$REGION 'Documentation'}
+    {**
+     Thread worker list
+    }
+    {$ENDREGION}
+    TQRVCLThreadWorkers = array of TQRVCLThreadWorker;
+
+    {$REGION 'Documentation'}
+    {**
+     Thread pool, executes a list of jobs on several workers sharing the same job queue, so the
+     jobs are processed in parallel
+     @br @bold(NOTE) The events are raised on the calling thread side, as for a single worker
+    }
+    {$ENDREGION}
+    TQRVCLThreadPool = class
+        private
+            m_pQueue:      TQRVCLThreadJobQueue;
+            m_Workers:     TQRVCLThreadWorkers;
+            m_fOnProcess:  TQRThreadJobProcessEvent;
+            m_fOnDone:     TQRThreadJobDoneEvent;
+            m_fOnCanceled: TQRThreadJobCancelEvent;
+            m_fOnIdle:     TQRThreadJobIdleEvent;
+
+        protected
+            {$REGION 'Documentation'}
+            {**
+             Gets the worker count
+             @return(Worker count)
+            }
+            {$ENDREGION}
+            function GetWorkerCount: NativeUInt; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Sets the OnProcess callback
+             @param(fOnProcess OnProcess callback)
+            }
+            {$ENDREGION}
+            procedure SetOnProcess(fOnProcess: TQRThreadJobProcessEvent); virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Sets the OnDone callback
+             @param(fOnDone OnDone callback)
+            }
+            {$ENDREGION}
+            procedure SetOnDone(fOnDone: TQRThreadJobDoneEvent); virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Sets the OnCanceled callback
+             @param(OnCanceled OnCanceled callback)
+            }
+            {$ENDREGION}
+            procedure SetOnCanceled(fOnCanceled: TQRThreadJobCancelEvent); virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Sets the OnIdle callback
+             @param(OnIdle OnIdle callback)
+            }
+            {$ENDREGION}
+            procedure SetOnIdle(fOnIdle: TQRThreadJobIdleEvent); virtual;
+
+        public
+            {$REGION 'Documentation'}
+            {**
+             Constructor
+             @param(workerCount Worker count, if 0 one worker is created per processor)
+            }
+            {$ENDREGION}
+            constructor Create(workerCount: NativeUInt = 0); virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Destructor
+            }
+            {$ENDREGION}
+            destructor Destroy; override;
+
+            {$REGION 'Documentation'}
+            {**
+             Adds job to process list
+             @param(pJob Job to add)
+             @param(priority Job priority, jobs with the highest priority are processed first)
+            }
+            {$ENDREGION}
+            procedure AddJob(pJob: TQRThreadJob; priority: NativeInt = 0); virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Deletes job from process list
+             @param(pJob Job to delete)
+             @param(doCancel If @true, job will be canceled before deleted)
+            }
+            {$ENDREGION}
+            procedure DeleteJob(pJob: TQRThreadJob; doCancel: Boolean = True); virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Checks if a job is currently processed by a worker
+             @param(pJob Job to check)
+             @return(@true if the job is processed, otherwise @false)
+            }
+            {$ENDREGION}
+            function IsProcessing(pJob: TQRThreadJob): Boolean; virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Pauses or resumes all the workers activity
+             @param(value If @true, workers will become idle, otherwise resume from idle state)
+            }
+            {$ENDREGION}
+            procedure MakeIdle(value: Boolean); virtual;
+
+            {$REGION 'Documentation'}
+            {**
+             Cancels all the jobs
+            }
+            {$ENDREGION}
+            procedure Cancel; virtual;
+
+        // Properties
+        public
+            {$REGION 'Documentation'}
+            {**
+             Gets the worker count
+            }
+            {$ENDREGION}
+            property WorkerCount: NativeUInt read GetWorkerCount;
+
+            {$REGION 'Documentation'}
+            {**
+             Gets or sets the OnProcess event
+            }
+            {$ENDREGION}
+            property OnProcess: TQRThreadJobProcessEvent read m_fOnProcess write SetOnProcess;
+
+            {$REGION 'Documentation'}
+            {**
+             Gets or sets the OnDone event
+            }
+            {$ENDREGION}
+            property OnDone: TQRThreadJobDoneEvent read m_fOnDone write SetOnDone;
+
+            {$REGION 'Documentation'}
+            {**
+             Gets or sets the OnCanceled event
+            }
+            {$ENDREGION}
+            property OnCanceled: TQRThreadJobCancelEvent read m_fOnCanceled write SetOnCanceled;
+
+            {$REGION 'Documentation'}
+            {**
+             Gets or sets the OnIdle event
+            }
+            {$ENDREGION}
+            property OnIdle: TQRThreadJobIdleEvent read m_fOnIdle write SetOnIdle;
+    end;
+
 implementation
 //--------------------------------------------------------------------------------------------------
 // TQRThreadJobHelper
@@ -616,33 +921,211 @@ begin
     m_pLock.Unlock;
 end;
 //--------------------------------------------------------------------------------------------------
+// TQRVCLThreadJobQueue
+//--------------------------------------------------------------------------------------------------
+constructor TQRVCLThreadJobQueue.Create;
+begin
+    inherited Create;
+
+    m_pLock      := TQRVCLThreadLock.Create;
+    m_pEvent     := TEvent.Create(nil, True, False, '');
+    m_pLevels    := TList<TQRVCLThreadJobQueueLevel>.Create;
+    m_pTickets   := TDictionary<TQRThreadJob, NativeUInt>.Create;
+    m_LastTicket := 0;
+end;
+//--------------------------------------------------------------------------------------------------
+destructor TQRVCLThreadJobQueue.Destroy;
+begin
+    ClearLevels;
+
+    m_pTickets.Free;
+    m_pLevels.Free;
+    m_pEvent.Free;
+    m_pLock.Free;
+
+    inherited Destroy;
+end;
+//--------------------------------------------------------------------------------------------------
+procedure TQRVCLThreadJobQueue.ClearLevels;
+var
+    i: NativeInt;
+begin
+    // iterate through levels and free their items
+    for i := 0 to m_pLevels.Count - 1 do
+        m_pLevels[i].m_pItems.Free;
+
+    m_pLevels.Clear;
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRVCLThreadJobQueue.GetCount: NativeUInt;
+begin
+    m_pLock.Lock;
+    Result := m_pTickets.Count;
+    m_pLock.Unlock;
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRVCLThreadJobQueue.Push(pJob: TQRThreadJob; priority: NativeInt): Boolean;
+var
+    item:  TQRVCLThreadJobQueueItem;
+    level: TQRVCLThreadJobQueueLevel;
+    index: NativeInt;
+begin
+    m_pLock.Lock;
+
+    try
+        // is job already in the queue?
+        if (m_pTickets.ContainsKey(pJob)) then
+            Exit(False);
+
+        Inc(m_LastTicket);
+
+        item.m_pJob   := pJob;
+        item.m_Ticket := m_LastTicket;
+
+        index := 0;
+
+        // search for the job priority level, levels are sorted from the highest priority
+        while ((index < m_pLevels.Count) and (m_pLevels[index].m_Priority > priority)) do
+            Inc(index);
+
+        // level not found?
+        if ((index = m_pLevels.Count) or (m_pLevels[index].m_Priority <> priority)) then
+        begin
+            // create it
+            level.m_Priority := priority;
+            level.m_pItems   := TQueue<TQRVCLThreadJobQueueItem>.Create;
+            m_pLevels.Insert(index, level);
+        end;
+
+        // add the job at the end of its level
+        m_pLevels[index].m_pItems.Enqueue(item);
+        m_pTickets.Add(pJob, item.m_Ticket);
+
+        // wake up the workers waiting for a job
+        m_pEvent.SetEvent;
+    finally
+        m_pLock.Unlock;
+    end;
+
+    Result := True;
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRVCLThreadJobQueue.Pop: TQRThreadJob;
+var
+    item:   TQRVCLThreadJobQueueItem;
+    ticket: NativeUInt;
+    i:      NativeInt;
+begin
+    Result := nil;
+
+    m_pLock.Lock;
+
+    try
+        // iterate through levels, from the highest priority
+        for i := 0 to m_pLevels.Count - 1 do
+        begin
+            // iterate through level items, until a still queued job is found
+            while (m_pLevels[i].m_pItems.Count > 0) do
+            begin
+                item := m_pLevels[i].m_pItems.Dequeue;
+
+                // skip the items whose job was removed, or removed and added again
+                if ((not m_pTickets.TryGetValue(item.m_pJob, ticket)) or (ticket <> item.m_Ticket))
+                then
+                    continue;
+
+                m_pTickets.Remove(item.m_pJob);
+                Result := item.m_pJob;
+                break;
+            end;
+
+            // found a job?
+            if (Assigned(Result)) then
+                break;
+        end;
+
+        // queue is empty? Workers should wait for the next added job
+        if (m_pTickets.Count = 0) then
+        begin
+            ClearLevels;
+            m_pEvent.ResetEvent;
+        end;
+    finally
+        m_pLock.Unlock;
+    end;
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRVCLThreadJobQueue.Remove(pJob: TQRThreadJob): Boolean;
+begin
+    m_pLock.Lock;
+
+    try
+        // job not found?
+        if (not m_pTickets.ContainsKey(pJob)) then
+            Exit(False);
+
+        // remove the job ticket, its item will be skipped while the queue is read
+        m_pTickets.Remove(pJob);
+
+        // queue is empty? Release the skipped items
+        if (m_pTickets.Count = 0) then
+            ClearLevels;
+    finally
+        m_pLock.Unlock;
+    end;
+
+    Result := True;
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRVCLThreadJobQueue.WaitFor(timeout: Cardinal): Boolean;
+begin
+    Result := (m_pEvent.WaitFor(timeout) = wrSignaled);
+end;
+//--------------------------------------------------------------------------------------------------
+procedure TQRVCLThreadJobQueue.WakeUp;
+begin
+    m_pEvent.SetEvent;
+end;
+//--------------------------------------------------------------------------------------------------
 // TQRVCLThreadWorker
 //--------------------------------------------------------------------------------------------------
-constructor TQRVCLThreadWorker.Create;
+constructor TQRVCLThreadWorker.Create(pQueue: TQRVCLThreadJobQueue);
 begin
     inherited Create(False);
 
     m_pLock          := TQRVCLThreadLock.Create;
-    m_pJobs          := TList.Create;
+    m_pResumeEvent   := TEvent.Create(nil, True, True, '');
+    m_OwnsQueue      := not Assigned(pQueue);
     m_Idle           := False;
     m_Canceled       := False;
     m_pProcessingJob := nil;
     m_fOnProcess     := nil;
     m_fOnDone        := nil;
     m_fOnCanceled    := nil;
+
+    // create the job queue if not shared with other workers
+    if (m_OwnsQueue) then
+        m_pQueue := TQRVCLThreadJobQueue.Create
+    else
+        m_pQueue := pQueue;
     m_Started        := False;
 end;
 //--------------------------------------------------------------------------------------------------
 destructor TQRVCLThreadWorker.Destroy;
 begin
-    // break the thread execution
+    // break the thread execution, and wake it up if sleeping
     Terminate;
+    m_pResumeEvent.SetEvent;
+    m_pQueue.WakeUp;
 
     if (m_Started) then
         // wait until worker has really stopped to work
         WaitFor;
 
-    m_pJobs.Free;
+    if (m_OwnsQueue) then
+        m_pQueue.Free;
+
+    m_pResumeEvent.Free;
     m_pLock.Free;
 
     inherited Destroy;
@@ -714,7 +1197,6 @@ end;
 procedure TQRVCLThreadWorker.Execute;
 var
     pProcessingJob: TQRThreadJob;
-    count:          NativeUInt;
     idle, success:  Boolean;
     fOnIdle:        TQRThreadJobIdleEvent;
 begin
@@ -723,6 +1205,10 @@ begin
     // repeat thread execution until terminated
     while (not Terminated) do
     begin
+        // break the loop if worker was canceled
+        if (IsCanceled) then
+            break;
+
         m_pLock.Lock;
         m_IsIdle := False;
         idle     := m_Idle;
@@ -738,8 +1224,8 @@ begin
 
             // is idle event defined?
             if (not Assigned(fOnIdle)) then
-                // wait 10 ms to not overload the processor
-                Sleep(10)
+                // sleep until the worker is resumed, canceled or destroyed
+                m_pResumeEvent.WaitFor(INFINITE)
             else
                 // notify that job is idle
                 Synchronize(OnIdleNotify);
@@ -747,37 +1233,25 @@ begin
             continue;
         end;
 
-        // get job count
-        m_pLock.Lock;
-        count := m_pJobs.Count;
-        m_pLock.Unlock;
-
-        // no job to process for now?
-        if (count = 0) then
-        begin
-            // wait 10ms to not overload the processor
-            Sleep(10);
-            continue;
-        end;
-
-        // break the loop if worker was canceled
-        if (IsCanceled) then
-            break;
-
         m_pLock.Lock;
 
         try
-            // get job to process
-            m_pProcessingJob := m_pJobs[0];
-
-            // job is get and will be processed, can delete it from list
-            m_pJobs.Delete(0);
-
-            pProcessingJob := m_pProcessingJob;
+            // get job to process, the job is removed from the queue. NOTE the processing job is
+            // set while locked, so the job is always either in the queue or processing
+            m_pProcessingJob := m_pQueue.Pop;
+            pProcessingJob   := m_pProcessingJob;
         finally
             m_pLock.Unlock;
         end;
 
+        // no job to process for now?
+        if (not Assigned(pProcessingJob)) then
+        begin
+            // sleep until a job is added, or the worker is canceled or destroyed
+            m_pQueue.WaitFor(INFINITE);
+            continue;
+        end;
+
         // break the loop if worker was canceled
         if (IsCanceled) then
             break;
@@ -904,20 +1378,16 @@ begin
         fOnIdle;
 end;
 //--------------------------------------------------------------------------------------------------
-procedure TQRVCLThreadWorker.AddJob(pJob: TQRThreadJob);
+procedure TQRVCLThreadWorker.AddJob(pJob: TQRThreadJob; priority: NativeInt);
 begin
-    m_pLock.Lock;
+    // no job to add?
+    if (not Assigned(pJob)) then
+        Exit;
 
-    try
-        // check if job is already in the list, add it to job list if not
-        if (m_pJobs.IndexOf(pJob) = -1) then
-        begin
-            pJob.SetStatus(EQR_JS_NotStarted);
-            m_pJobs.Add(pJob);
-        end;
-    finally
-        m_pLock.Unlock;
-    end;
+    // set the status before the job is added, because another worker sharing the queue may get it
+    // immediately. NOTE the queue doesn't add the job if already in it
+    pJob.SetStatus(EQR_JS_NotStarted);
+    m_pQueue.Push(pJob, priority);
 end;
 //--------------------------------------------------------------------------------------------------
 procedure TQRVCLThreadWorker.DeleteJob(pJob: TQRThreadJob; doCancel: Boolean);
@@ -934,25 +1404,29 @@ begin
         pJob.SetStatus(EQR_JS_Canceled);
     end;
 
+    m_pQueue.Remove(pJob);
+end;
+//--------------------------------------------------------------------------------------------------
+procedure TQRVCLThreadWorker.MakeIdle(value: Boolean);
+begin
     m_pLock.Lock;
 
     try
-        m_pJobs.Remove(pJob);
+        m_Idle := value;
+
+        // sleep or wake up the worker
+        if (value) then
+            m_pResumeEvent.ResetEvent
+        else
+            m_pResumeEvent.SetEvent;
     finally
         m_pLock.Unlock;
     end;
 end;
 //--------------------------------------------------------------------------------------------------
-procedure TQRVCLThreadWorker.MakeIdle(value: Boolean);
-begin
-    m_pLock.Lock;
-    m_Idle := value;
-    m_pLock.Unlock;
-end;
-//--------------------------------------------------------------------------------------------------
 procedure TQRVCLThreadWorker.Cancel;
 var
-    pJob:    Pointer;
+    pJob:    TQRThreadJob;
     running: Boolean;
 begin
     running := False;
@@ -973,6 +1447,10 @@ begin
         m_pLock.Unlock;
     end;
 
+    // wake up the worker if sleeping, it will stop to work as soon as it notices it was canceled
+    m_pResumeEvent.SetEvent;
+    m_pQueue.WakeUp;
+
     if (m_Started and running) then
     begin
         // wait until worker has really stopped to work
@@ -983,9 +1461,14 @@ begin
     // notify that job is canceled
     Synchronize(OnCanceledNotify);
 
-    // iterate through jobs to cancel
-    for pJob in m_pJobs do
-    begin
+    // iterate through jobs to cancel, the jobs are removed from the queue
+    repeat
+        pJob := m_pQueue.Pop;
+
+        // no more job to cancel?
+        if (not Assigned(pJob)) then
+            break;
+
         m_pLock.Lock;
 
         try
@@ -998,11 +1481,10 @@ begin
 
         // notify that job is canceled
         Synchronize(OnCanceledNotify);
-    end;
+    until False;
 
     // clear local values
     m_pLock.Lock;
-    m_pJobs.Clear;
     m_pProcessingJob := nil;
     m_pLock.Unlock;
 end;
@@ -1014,5 +1496,143 @@ begin
     m_pLock.Unlock;
 end;
 //--------------------------------------------------------------------------------------------------
+// TQRVCLThreadPool
+//--------------------------------------------------------------------------------------------------
+constructor TQRVCLThreadPool.Create(workerCount: NativeUInt);
+var
+    i: NativeUInt;
+begin
+    inherited Create;
+
+    m_fOnProcess  := nil;
+    m_fOnDone     := nil;
+    m_fOnCanceled := nil;
+    m_fOnIdle     := nil;
+
+    // use one worker per processor by default
+    if (workerCount = 0) then
+        workerCount := TThread.ProcessorCount;
+
+    // the pool should contain at least one worker
+    if (workerCount = 0) then
+        workerCount := 1;
+
+    // create the job queue, shared by all the workers
+    m_pQueue := TQRVCLThreadJobQueue.Create;
+
+    SetLength(m_Workers, workerCount);
+
+    // create the workers
+    for i := 0 to workerCount - 1 do
+        m_Workers[i] := TQRVCLThreadWorker.Create(m_pQueue);
+end;
+//--------------------------------------------------------------------------------------------------
+destructor TQRVCLThreadPool.Destroy;
+var
+    i: NativeInt;
+begin
+    // free the workers, the queue should be freed only after they stopped to work
+    for i := 0 to Length(m_Workers) - 1 do
+        m_Workers[i].Free;
+
+    SetLength(m_Workers, 0);
+    m_pQueue.Free;
+
+    inherited Destroy;
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRVCLThreadPool.GetWorkerCount: NativeUInt;
+begin
+    Result := Length(m_Workers);
+end;
+//--------------------------------------------------------------------------------------------------
+procedure TQRVCLThreadPool.SetOnProcess(fOnProcess: TQRThreadJobProcessEvent);
+var
+    i: NativeInt;
+begin
+    m_fOnProcess := fOnProcess;
+
+    for i := 0 to Length(m_Workers) - 1 do
+        m_Workers[i].OnProcess := fOnProcess;
+end;
+//--------------------------------------------------------------------------------------------------
+procedure TQRVCLThreadPool.SetOnDone(fOnDone: TQRThreadJobDoneEvent);
+var
+    i: NativeInt;
+begin
+    m_fOnDone := fOnDone;
+
+    for i := 0 to Length(m_Workers) - 1 do
+        m_Workers[i].OnDone := fOnDone;
+end;
+//--------------------------------------------------------------------------------------------------
+procedure TQRVCLThreadPool.SetOnCanceled(fOnCanceled: TQRThreadJobCancelEvent);
+var
+    i: NativeInt;
+begin
+    m_fOnCanceled := fOnCanceled;
+
+    for i := 0 to Length(m_Workers) - 1 do
+        m_Workers[i].OnCanceled := fOnCanceled;
+end;
+//--------------------------------------------------------------------------------------------------
+procedure TQRVCLThreadPool.SetOnIdle(fOnIdle: TQRThreadJobIdleEvent);
+var
+    i: NativeInt;
+begin
+    m_fOnIdle := fOnIdle;
+
+    for i := 0 to Length(m_Workers) - 1 do
+        m_Workers[i].OnIdle := fOnIdle;
+end;
+//--------------------------------------------------------------------------------------------------
+procedure TQRVCLThreadPool.AddJob(pJob: TQRThreadJob; priority: NativeInt);
+begin
+    // the workers share the same queue, so any of them can add the job
+    m_Workers[0].AddJob(pJob, priority);
+end;
+//--------------------------------------------------------------------------------------------------
+procedure TQRVCLThreadPool.DeleteJob(pJob: TQRThreadJob; doCancel: Boolean);
+begin
+    // the workers share the same queue, so any of them can delete the job
+    m_Workers[0].DeleteJob(pJob, doCancel);
+end;
+//--------------------------------------------------------------------------------------------------
+function TQRVCLThreadPool.IsProcessing(pJob: TQRThreadJob): Boolean;
+var
+    i: NativeInt;
+begin
+    // no job?
+    if (not Assigned(pJob)) then
+        Exit(False);
+
+    // iterate through workers and check if one of them is processing the job
+    for i := 0 to Length(m_Workers) - 1 do
+        if (m_Workers[i].ProcessingJob = pJob) then
+            Exit(True);
+
+    Result := False;
+end;
+//--------------------------------------------------------------------------------------------------
+procedure TQRVCLThreadPool.MakeIdle(value: Boolean);
+var
+    i: NativeInt;
+begin
+    for i := 0 to Length(m_Workers) - 1 do
+        m_Workers[i].MakeIdle(value);
+end;
+//--------------------------------------------------------------------------------------------------
+procedure TQRVCLThreadPool.Cancel;
+var
+    i: NativeInt;
+begin
+    // prevent the workers to start new jobs while the queue is canceled
+    MakeIdle(True);
+
+    // cancel the workers, the first one also cancels the jobs remaining in the shared queue
+    for i := 0 to Length(m_Workers) - 1 do
+        m_Workers[i].Cancel;
+end;
+//--------------------------------------------------------------------------------------------------
 
 end.